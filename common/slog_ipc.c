@@ -0,0 +1,567 @@
+/**
+ * @file slog_ipc.c
+ * @brief Hand servicelog events to the shared servicelog writer
+ *
+ * rtas_errd owns a servicelog handle for as long as it runs and logs
+ * the events of the other ppc64-diag tools for them, so that they do
+ * not each open the database and write to it one event at a time.
+ * Requests and replies are single SOCK_SEQPACKET messages on
+ * SLOG_IPC_SOCKET: a header with the client's tag, followed for
+ * requests by the packed event.
+ *
+ * Only events of type SL_TYPE_BASIC, SL_TYPE_OS and SL_TYPE_ENCLOSURE
+ * can be packed; for anything else, and whenever the writer is not
+ * running, the client is expected to log the event itself.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "slog_ipc.h"
+
+#define SLOG_IPC_MAGIC		0x534c4731	/* "SLG1" */
+#define SLOG_IPC_NULL		0xffffffff	/* length of a NULL string */
+
+/* Seconds a client waits for a reply before logging the event itself */
+#define SLOG_IPC_TIMEOUT	30
+
+/* Milliseconds the writer waits for room to send a reply */
+#define SLOG_IPC_REPLY_TIMEOUT	1000
+
+struct slog_ipc_hdr {
+	uint32_t	magic;
+	uint32_t	status;		/* replies only */
+	uint64_t	tag;
+	uint64_t	key;		/* replies only */
+};
+
+struct pack_buf {
+	char		*data;
+	size_t		len;
+	size_t		size;
+	int		err;
+};
+
+static void
+put(struct pack_buf *b, const void *p, size_t len)
+{
+	if (b->err || len > b->size - b->len) {
+		b->err = 1;
+		return;
+	}
+
+	memcpy(b->data + b->len, p, len);
+	b->len += len;
+}
+
+static void
+put_u32(struct pack_buf *b, uint32_t val)
+{
+	put(b, &val, sizeof(val));
+}
+
+static void
+put_str(struct pack_buf *b, const char *str)
+{
+	uint32_t len = str ? strlen(str) : SLOG_IPC_NULL;
+
+	put_u32(b, len);
+	if (str)
+		put(b, str, len);
+}
+
+struct unpack_buf {
+	const char	*data;
+	size_t		len;
+	size_t		pos;
+	int		err;
+};
+
+static void
+get(struct unpack_buf *b, void *p, size_t len)
+{
+	if (b->err || len > b->len - b->pos) {
+		b->err = 1;
+		memset(p, 0, len);
+		return;
+	}
+
+	memcpy(p, b->data + b->pos, len);
+	b->pos += len;
+}
+
+static uint32_t
+get_u32(struct unpack_buf *b)
+{
+	uint32_t val;
+
+	get(b, &val, sizeof(val));
+	return val;
+}
+
+static char *
+get_str(struct unpack_buf *b)
+{
+	uint32_t len = get_u32(b);
+	char *str;
+
+	if (b->err || len == SLOG_IPC_NULL)
+		return NULL;
+
+	if (len > b->len - b->pos) {
+		b->err = 1;
+		return NULL;
+	}
+
+	str = (char *)malloc(len + 1);
+	if (str == NULL) {
+		b->err = 1;
+		return NULL;
+	}
+
+	memcpy(str, b->data + b->pos, len);
+	str[len] = '\0';
+	b->pos += len;
+	return str;
+}
+
+/**
+ * pack_event
+ * @brief Append an event to a request
+ *
+ * @return 0 on success, -1 if the event can not be sent
+ */
+static int
+pack_event(struct pack_buf *b, struct sl_event *event)
+{
+	struct sl_callout *callout;
+	uint32_t ncallouts = 0;
+	int64_t time_event = event->time_event;
+
+	if (event->type != SL_TYPE_BASIC && event->type != SL_TYPE_OS &&
+	    event->type != SL_TYPE_ENCLOSURE)
+		return -1;
+	if (event->type != SL_TYPE_BASIC && event->addl_data == NULL)
+		return -1;
+
+	put(b, &time_event, sizeof(time_event));
+	put_u32(b, event->type);
+	put_u32(b, event->severity);
+	put_str(b, event->platform);
+	put_str(b, event->machine_serial);
+	put_str(b, event->machine_model);
+	put_str(b, event->nodename);
+	put_str(b, event->refcode);
+	put_str(b, event->description);
+	put_u32(b, event->serviceable);
+	put_u32(b, event->predictive);
+	put_u32(b, event->disposition);
+	put_u32(b, event->call_home_status);
+	put_u32(b, event->closed);
+
+	put_u32(b, event->raw_data ? event->raw_data_len : 0);
+	if (event->raw_data)
+		put(b, event->raw_data, event->raw_data_len);
+
+	for (callout = event->callouts; callout; callout = callout->next)
+		ncallouts++;
+	put_u32(b, ncallouts);
+	for (callout = event->callouts; callout; callout = callout->next) {
+		put_u32(b, callout->priority);
+		put_u32(b, callout->type);
+		put_str(b, callout->procedure);
+		put_str(b, callout->location);
+		put_str(b, callout->fru);
+		put_str(b, callout->serial);
+		put_str(b, callout->ccin);
+	}
+
+	if (event->type == SL_TYPE_OS) {
+		struct sl_data_os *os = (struct sl_data_os *)event->addl_data;
+
+		put_str(b, os->version);
+		put_str(b, os->subsystem);
+		put_str(b, os->driver);
+		put_str(b, os->device);
+	} else if (event->type == SL_TYPE_ENCLOSURE) {
+		struct sl_data_enclosure *encl =
+				(struct sl_data_enclosure *)event->addl_data;
+
+		put_str(b, encl->enclosure_model);
+		put_str(b, encl->enclosure_serial);
+	}
+
+	return b->err ? -1 : 0;
+}
+
+/**
+ * slog_ipc_unpack
+ * @brief Rebuild the event of a request
+ *
+ * @param buf the request
+ * @param len length of the request
+ * @param tag returns the client's tag for the request
+ * @return the event, to be freed with servicelog_event_free(), or NULL
+ */
+struct sl_event *
+slog_ipc_unpack(const char *buf, size_t len, uint64_t *tag)
+{
+	struct unpack_buf b = { buf, len, 0, 0 };
+	struct slog_ipc_hdr hdr;
+	struct sl_event *event;
+	struct sl_callout **next;
+	uint32_t i, ncallouts, type;
+	int64_t time_event;
+
+	get(&b, &hdr, sizeof(hdr));
+	if (b.err || hdr.magic != SLOG_IPC_MAGIC)
+		return NULL;
+	*tag = hdr.tag;
+
+	event = (struct sl_event *)calloc(1, sizeof(*event));
+	if (event == NULL)
+		return NULL;
+
+	get(&b, &time_event, sizeof(time_event));
+	event->time_event = time_event;
+	/* event->type is only set once its addl_data is there */
+	type = get_u32(&b);
+	event->severity = get_u32(&b);
+	event->platform = get_str(&b);
+	event->machine_serial = get_str(&b);
+	event->machine_model = get_str(&b);
+	event->nodename = get_str(&b);
+	event->refcode = get_str(&b);
+	event->description = get_str(&b);
+	event->serviceable = get_u32(&b);
+	event->predictive = get_u32(&b);
+	event->disposition = get_u32(&b);
+	event->call_home_status = get_u32(&b);
+	event->closed = get_u32(&b);
+
+	event->raw_data_len = get_u32(&b);
+	if (event->raw_data_len > b.len - b.pos)
+		b.err = 1;
+	if (!b.err && event->raw_data_len) {
+		event->raw_data = (unsigned char *)malloc(event->raw_data_len);
+		if (event->raw_data == NULL)
+			b.err = 1;
+		else
+			get(&b, event->raw_data, event->raw_data_len);
+	}
+
+	ncallouts = get_u32(&b);
+	next = &event->callouts;
+	for (i = 0; i < ncallouts && !b.err; i++) {
+		*next = (struct sl_callout *)calloc(1, sizeof(**next));
+		if (*next == NULL) {
+			b.err = 1;
+			break;
+		}
+
+		(*next)->priority = get_u32(&b);
+		(*next)->type = get_u32(&b);
+		(*next)->procedure = get_str(&b);
+		(*next)->location = get_str(&b);
+		(*next)->fru = get_str(&b);
+		(*next)->serial = get_str(&b);
+		(*next)->ccin = get_str(&b);
+		next = &(*next)->next;
+	}
+
+	if (!b.err) {
+		if (type == SL_TYPE_BASIC) {
+			event->type = type;
+		} else if (type == SL_TYPE_OS) {
+			struct sl_data_os *os;
+
+			os = (struct sl_data_os *)calloc(1, sizeof(*os));
+			if (os == NULL) {
+				b.err = 1;
+			} else {
+				event->addl_data = os;
+				event->type = type;
+				os->version = get_str(&b);
+				os->subsystem = get_str(&b);
+				os->driver = get_str(&b);
+				os->device = get_str(&b);
+			}
+		} else if (type == SL_TYPE_ENCLOSURE) {
+			struct sl_data_enclosure *encl;
+
+			encl = (struct sl_data_enclosure *)
+					calloc(1, sizeof(*encl));
+			if (encl == NULL) {
+				b.err = 1;
+			} else {
+				event->addl_data = encl;
+				event->type = type;
+				encl->enclosure_model = get_str(&b);
+				encl->enclosure_serial = get_str(&b);
+			}
+		}
+	}
+
+	if (b.err || b.pos != b.len || event->type != type) {
+		servicelog_event_free(event);
+		return NULL;
+	}
+
+	return event;
+}
+
+/**
+ * slog_ipc_connect
+ * @brief Connect to the servicelog writer
+ *
+ * Waiting for a reply on the socket gives up after SLOG_IPC_TIMEOUT
+ * seconds, so a writer that has stopped answering does not hang the
+ * client.
+ *
+ * @return socket, or -1 if the writer is not running
+ */
+int
+slog_ipc_connect(void)
+{
+	struct sockaddr_un addr;
+	struct timeval tv = { SLOG_IPC_TIMEOUT, 0 };
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, SLOG_IPC_SOCKET, sizeof(addr.sun_path) - 1);
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/**
+ * slog_ipc_send
+ * @brief Ask the servicelog writer to log an event
+ *
+ * The reply, with the same tag, is read with slog_ipc_recv().
+ *
+ * @param fd socket from slog_ipc_connect()
+ * @param event the event; still owned by the caller
+ * @param tag identifies the request in the reply
+ * @return 0 on success, -1 if the event must be logged directly
+ */
+int
+slog_ipc_send(int fd, struct sl_event *event, uint64_t tag)
+{
+	struct pack_buf b;
+	struct slog_ipc_hdr hdr;
+	ssize_t rc;
+
+	b.data = (char *)malloc(SLOG_IPC_MAX_MSG);
+	if (b.data == NULL)
+		return -1;
+	b.len = 0;
+	b.size = SLOG_IPC_MAX_MSG;
+	b.err = 0;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = SLOG_IPC_MAGIC;
+	hdr.tag = tag;
+	put(&b, &hdr, sizeof(hdr));
+
+	if (pack_event(&b, event)) {
+		free(b.data);
+		return -1;
+	}
+
+	do {
+		rc = send(fd, b.data, b.len, MSG_NOSIGNAL);
+	} while (rc < 0 && errno == EINTR);
+
+	free(b.data);
+	return rc == (ssize_t)b.len ? 0 : -1;
+}
+
+/**
+ * slog_ipc_recv
+ * @brief Read the reply to a request
+ *
+ * @param fd socket from slog_ipc_connect()
+ * @param tag returns the tag of the request
+ * @param key returns the servicelog key of the event, may be NULL
+ * @param wait non-zero to wait for a reply, for up to SLOG_IPC_TIMEOUT
+ *	seconds
+ * @return SLOG_IPC_LOGGED, SLOG_IPC_FAILED, SLOG_IPC_NONE, or -1 if the
+ *	connection to the writer was lost or the wait timed out; the
+ *	socket must not be used after that
+ */
+int
+slog_ipc_recv(int fd, uint64_t *tag, uint64_t *key, int wait)
+{
+	struct slog_ipc_hdr hdr;
+	ssize_t rc;
+
+	do {
+		rc = recv(fd, &hdr, sizeof(hdr), wait ? 0 : MSG_DONTWAIT);
+	} while (rc < 0 && errno == EINTR);
+
+	if (rc < 0 && !wait && (errno == EAGAIN || errno == EWOULDBLOCK))
+		return SLOG_IPC_NONE;
+
+	if (rc != sizeof(hdr) || hdr.magic != SLOG_IPC_MAGIC)
+		return -1;
+
+	*tag = hdr.tag;
+	if (key)
+		*key = hdr.key;
+
+	return hdr.status ? SLOG_IPC_FAILED : SLOG_IPC_LOGGED;
+}
+
+/**
+ * slog_ipc_log
+ * @brief Log a single event through the servicelog writer
+ *
+ * If the connection is lost after the request was sent, or there is
+ * no reply within SLOG_IPC_TIMEOUT seconds, the caller logs the event
+ * itself and it may end up in servicelog twice; that is preferred to
+ * losing it.
+ *
+ * @param event the event; still owned by the caller
+ * @param key returns the servicelog key of the event, may be NULL
+ * @return SLOG_IPC_LOGGED, SLOG_IPC_FAILED, or -1 if the event must be
+ *	logged directly
+ */
+int
+slog_ipc_log(struct sl_event *event, uint64_t *key)
+{
+	uint64_t tag;
+	int fd, rc;
+
+	fd = slog_ipc_connect();
+	if (fd < 0)
+		return -1;
+
+	rc = slog_ipc_send(fd, event, 0);
+	if (rc == 0)
+		rc = slog_ipc_recv(fd, &tag, key, 1);
+
+	close(fd);
+	return rc;
+}
+
+/**
+ * slog_ipc_listen
+ * @brief Create the socket of the servicelog writer
+ *
+ * @return non-blocking listening socket, or -1 with errno set
+ */
+int
+slog_ipc_listen(void)
+{
+	struct sockaddr_un addr;
+	int fd, probe;
+
+	if (mkdir(SLOG_IPC_DIR, 0700) && errno != EEXIST)
+		return -1;
+
+	/* Don't take over from a writer that is still running */
+	probe = slog_ipc_connect();
+	if (probe >= 0) {
+		close(probe);
+		errno = EADDRINUSE;
+		return -1;
+	}
+	unlink(SLOG_IPC_SOCKET);
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, SLOG_IPC_SOCKET, sizeof(addr.sun_path) - 1);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    chmod(SLOG_IPC_SOCKET, 0600) < 0 || listen(fd, 16) < 0) {
+		int err = errno;
+
+		close(fd);
+		errno = err;
+		return -1;
+	}
+
+	return fd;
+}
+
+/**
+ * slog_ipc_reply
+ * @brief Tell a client the outcome of its request
+ *
+ * If the client's socket is full, waits up to SLOG_IPC_REPLY_TIMEOUT
+ * milliseconds for it to read its earlier replies.
+ *
+ * @param fd client socket
+ * @param tag tag of the request
+ * @param status SLOG_IPC_LOGGED or SLOG_IPC_FAILED
+ * @param key servicelog key of the event
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_ipc_reply(int fd, uint64_t tag, int status, uint64_t key)
+{
+	struct slog_ipc_hdr hdr;
+	struct pollfd pfd = { fd, POLLOUT, 0 };
+	ssize_t rc;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = SLOG_IPC_MAGIC;
+	hdr.status = status;
+	hdr.tag = tag;
+	hdr.key = key;
+
+	for (;;) {
+		rc = send(fd, &hdr, sizeof(hdr), MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (rc >= 0)
+			break;
+		if (errno == EINTR)
+			continue;
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+			break;
+
+		/* the client has not read its earlier replies yet */
+		if (poll(&pfd, 1, SLOG_IPC_REPLY_TIMEOUT) <= 0)
+			break;
+	}
+
+	return rc == sizeof(hdr) ? 0 : -1;
+}
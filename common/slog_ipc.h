@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#ifndef SLOG_IPC_H
+#define SLOG_IPC_H
+
+#include <stdint.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * Servicelog events can be handed to the writer in rtas_errd over this
+ * socket rather than each tool opening the servicelog database itself.
+ * Each request carries one event and a tag chosen by the client; the
+ * reply carries the same tag and the servicelog key of the new entry.
+ */
+#define SLOG_IPC_DIR		"/run/ppc64-diag"
+#define SLOG_IPC_SOCKET		SLOG_IPC_DIR "/servicelog.sock"
+
+/* Largest request; larger events are logged directly by the client */
+#define SLOG_IPC_MAX_MSG	(64 * 1024)
+
+/* Status of a request, from slog_ipc_recv() */
+#define SLOG_IPC_LOGGED		0	/* logged, the key is valid */
+#define SLOG_IPC_FAILED		1	/* the server could not log it */
+#define SLOG_IPC_NONE		2	/* no reply yet (non-blocking) */
+
+int	slog_ipc_connect(void);
+int	slog_ipc_send(int, struct sl_event *, uint64_t);
+int	slog_ipc_recv(int, uint64_t *, uint64_t *, int);
+int	slog_ipc_log(struct sl_event *, uint64_t *);
+
+int	slog_ipc_listen(void);
+struct sl_event *slog_ipc_unpack(const char *, size_t, uint64_t *);
+int	slog_ipc_reply(int, uint64_t, int, uint64_t);
+
+#endif
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+#define MAX_LEN		4096
+
+/*
+ * Reference implementation: the sprintf() based loop format_hexdump()
+ * replaced in rtas_errd's print_rtas_event().
+ */
+static int ref_hexdump(char *out, const char *tag, const unsigned char *data,
+		       int len)
+{
+	int i, offset = 0;
+
+	for (i = 0; i < len; i++) {
+		if ((i % 16) == 0)
+			offset += sprintf(out + offset, "%s %d:", tag, i/16);
+
+		if ((i % 4) == 0)
+			offset += sprintf(out + offset, " ");
+
+		offset += sprintf(out + offset, "%02x", data[i]);
+
+		if ((i % 16) == 15)
+			offset += sprintf(out + offset, "\n");
+	}
+	if ((i % 16) != 0)
+		offset += sprintf(out + offset, "\n");
+
+	return offset;
+}
+
+static int check(const char *tag, const unsigned char *data, int len)
+{
+	static char ref[HEXDUMP_SIZE(8, MAX_LEN) + 1];
+	static char out[HEXDUMP_SIZE(8, MAX_LEN) + 1];
+	int ref_len;
+	size_t out_len;
+
+	ref_len = ref_hexdump(ref, tag, data, len);
+	out_len = format_hexdump(out, tag, data, len);
+
+	if (out_len > HEXDUMP_SIZE(strlen(tag), len)) {
+		fprintf(stderr, "len %d: output overruns HEXDUMP_SIZE\n", len);
+		return 1;
+	}
+
+	if (out_len != ref_len || memcmp(ref, out, ref_len)) {
+		fprintf(stderr, "len %d: output differs from reference\n", len);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const char golden[] =
+		"RTAS 0: 00010203 04050607 08090a0b 0c0d0e0f\n"
+		"RTAS 1: 80ff7f10\n";
+	unsigned char data[MAX_LEN];
+	char out[sizeof(golden)];
+	size_t out_len;
+	int i, rc = 0;
+
+	/* Fixed layout check, including bytes with the top bit set */
+	for (i = 0; i < 16; i++)
+		data[i] = i;
+	data[16] = 0x80;
+	data[17] = 0xff;
+	data[18] = 0x7f;
+	data[19] = 0x10;
+
+	out_len = format_hexdump(out, "RTAS", data, 20);
+	if (out_len != sizeof(golden) - 1 || memcmp(out, golden, out_len)) {
+		fprintf(stderr, "golden output mismatch\n");
+		rc = 1;
+	}
+
+	/* Every length an RTAS event can have, over all byte values */
+	srandom(1);
+	for (i = 0; i < MAX_LEN; i++)
+		data[i] = (i < 256) ? i : random() & 0xff;
+
+	for (i = 0; i <= MAX_LEN; i++) {
+		rc |= check("RTAS", data, i);
+		rc |= check("", data, i);
+	}
+
+	exit(rc);
+}
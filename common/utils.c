@@ -170,3 +170,90 @@ int spclose(FILE *stream, pid_t cpid)
 
 	return 0;
 }
+
+/*
+ * Two hex characters for every byte value, so that each byte is
+ * converted with a single table lookup instead of a printf() call.
+ */
+static const char hex_pairs[] =
+	"000102030405060708090a0b0c0d0e0f"
+	"101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f"
+	"303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f"
+	"505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f"
+	"707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f"
+	"909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+	"b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+	"d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+	"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+/*
+ * Write the decimal representation of val to out.
+ * Returns the number of characters written.
+ */
+static size_t format_decimal(char *out, size_t val)
+{
+	char	tmp[20];
+	size_t	n = 0, i;
+
+	do {
+		tmp[n++] = '0' + (val % 10);
+		val /= 10;
+	} while (val);
+
+	for (i = 0; i < n; i++)
+		out[i] = tmp[n - i - 1];
+
+	return n;
+}
+
+/*
+ * Format len bytes of data as lines of the form
+ *
+ *	"<tag> <line>: xxxxxxxx xxxxxxxx xxxxxxxx xxxxxxxx\n"
+ *
+ * 16 bytes per line with a space before every 4 bytes, the last line
+ * holding whatever is left. This is byte for byte the layout produced by
+ * the historical sprintf("%02x") loops, built in a single pass.
+ *
+ * The caller must provide at least HEXDUMP_SIZE(strlen(tag), len) bytes
+ * in out. The output is not NUL terminated.
+ *
+ * Returns the number of characters written to out.
+ */
+size_t format_hexdump(char *out, const char *tag, const unsigned char *data,
+		      size_t len)
+{
+	size_t	taglen = strlen(tag);
+	size_t	i;
+	char	*p = out;
+
+	for (i = 0; i < len; i++) {
+		if ((i % 16) == 0) {
+			memcpy(p, tag, taglen);
+			p += taglen;
+			*p++ = ' ';
+			p += format_decimal(p, i / 16);
+			*p++ = ':';
+		}
+
+		if ((i % 4) == 0)
+			*p++ = ' ';
+
+		memcpy(p, &hex_pairs[data[i] * 2], 2);
+		p += 2;
+
+		if ((i % 16) == 15)
+			*p++ = '\n';
+	}
+	if ((i % 16) != 0)
+		*p++ = '\n';
+
+	return p - out;
+}
@@ -21,4 +21,16 @@
 FILE	*spopen(char **, pid_t *);
 int	spclose(FILE *, pid_t);
 
+/*
+ * Upper bound on the output of format_hexdump() for a tag of taglen
+ * characters and len bytes of data: each 16 byte line carries the tag,
+ * a space, up to 10 line number digits, a colon, four space separated
+ * 8 digit words and a newline.
+ */
+#define HEXDUMP_LINE_MAX(taglen)	((taglen) + 1 + 10 + 1 + (4 * 9) + 1)
+#define HEXDUMP_SIZE(taglen, len)	\
+	((((len) + 15) / 16) * HEXDUMP_LINE_MAX(taglen))
+
+size_t	format_hexdump(char *, const char *, const unsigned char *, size_t);
+
 #endif
@@ -29,6 +29,7 @@
 #include "encl_util.h"
 #include "diag_encl.h"
 #include "platform.h"
+#include "slog_ipc.h"
 
 struct event_severity_map {
 	int	severity;
@@ -582,6 +583,18 @@ servicelog_log_event(const char *refcode, int sev, const char *text,
 
 	entry->callouts = callouts;
 
+	/* Hand it to the servicelog writer in rtas_errd if that is running */
+	rc = slog_ipc_log(entry, &key);
+	if (rc != -1) {
+		servicelog_event_free(entry);
+		if (rc != SLOG_IPC_LOGGED) {
+			fprintf(stderr, "Could not log the event to "
+				"servicelog\n");
+			return 0;
+		}
+		return key;
+	}
+
 	rc = servicelog_open(&slog, 0);
 	if (rc != 0) {
 		fprintf(stderr, "%s", servicelog_error(slog));
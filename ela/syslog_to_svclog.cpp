@@ -26,6 +26,7 @@ using namespace std;
 
 #include <string>
 #include <vector>
+#include <map>
 #include <iostream>
 #include <sstream>
 
@@ -36,6 +37,7 @@ using namespace lsvpd;
 extern "C" {
 #include "platform.c"
 #include "utils.c"
+#include "slog_ipc.c"
 }
 
 //Workaround for deprecated warning.
@@ -60,6 +62,16 @@ extern EventCatalog event_catalog;
 
 static servicelog *slog = NULL;
 
+/*
+ * Events go to the servicelog writer in rtas_errd when that is running,
+ * and are logged directly otherwise.  The writer's replies are picked
+ * up as we go; events are kept, by tag, until the writer has replied,
+ * so that they can still be logged directly if it goes away.
+ */
+static int slog_fd = -1;
+static uint64_t slog_tag;
+static map<uint64_t, struct sl_event *> slog_pending;
+
 static void
 usage_message(FILE *out)
 {
@@ -412,6 +424,80 @@ sanitize_syslog_line(string& s)
 	}
 }
 
+static int
+open_servicelog(void)
+{
+	int result;
+
+	if (slog)
+		return 0;
+
+	result = servicelog_open(&slog, 0);
+	if (result != 0) {
+		cerr << "servicelog_open() failed, returning "
+							<< result << endl;
+		slog = NULL;
+	}
+	return result;
+}
+
+static int
+log_direct(struct sl_event *svc)
+{
+	int result;
+
+	result = open_servicelog();
+	if (result != 0)
+		return result;
+
+	result = servicelog_event_log(slog, svc, NULL);
+	if (result != 0) {
+		cerr << "servicelog_event_log() failed, returning "
+						<< result << endl;
+		cerr << servicelog_error(slog) << endl;
+	}
+	return result;
+}
+
+static void
+collect_replies(bool wait)
+{
+	map<uint64_t, struct sl_event *>::iterator it;
+	uint64_t tag;
+	int rc;
+
+	while (!slog_pending.empty()) {
+		rc = slog_ipc_recv(slog_fd, &tag, NULL, wait);
+		if (rc == SLOG_IPC_NONE)
+			break;
+		if (rc < 0) {
+			/* may log some of them twice, rather than not at all */
+			cerr << "Lost the servicelog writer, logging "
+				<< slog_pending.size()
+				<< " event(s) directly" << endl;
+			close(slog_fd);
+			slog_fd = -1;
+			for (it = slog_pending.begin();
+					it != slog_pending.end(); it++) {
+				log_direct(it->second);
+				servicelog_event_free(it->second);
+			}
+			slog_pending.clear();
+			break;
+		}
+
+		it = slog_pending.find(tag);
+		if (it == slog_pending.end())
+			continue;
+
+		if (rc == SLOG_IPC_FAILED)
+			cerr << "The servicelog writer failed to log an event"
+								<< endl;
+		servicelog_event_free(it->second);
+		slog_pending.erase(it);
+	}
+}
+
 static int
 log_event(SyslogEvent *sys, SyslogMessage *msg)
 {
@@ -476,13 +562,14 @@ log_event(SyslogEvent *sys, SyslogMessage *msg)
 	int result = 0;
 	if (debug)
 		servicelog_event_print(stdout, svc, 1);
-	else
-		result = servicelog_event_log(slog, svc, NULL);
-	if (result != 0) {
-		cerr << "servicelog_event_log() failed, returning "
-							<< result << endl;
-		cerr << servicelog_error(slog) << endl;
-	}
+	else if (slog_fd >= 0 &&
+		 slog_ipc_send(slog_fd, svc, ++slog_tag) == 0) {
+		/* freed once the writer has replied */
+		slog_pending[slog_tag] = svc;
+		collect_replies(false);
+		return 0;
+	} else
+		result = log_direct(svc);
 	servicelog_event_free(svc);
 	return result;
 }
@@ -694,7 +781,7 @@ print_help(void)
 
 int main(int argc, char **argv)
 {
-	int c, result;
+	int c;
 	int args_seen[0x100] = { 0 };
 	int platform = 0;
 	pid_t cpid;
@@ -796,10 +883,9 @@ int main(int argc, char **argv)
 		exit(2);
 	}
 
-	result = servicelog_open(&slog, 0);
-	if (result != 0) {
-		cerr << "servicelog_open() failed, returning "
-							<< result << endl;
+	if (!debug)
+		slog_fd = slog_ipc_connect();
+	if (slog_fd < 0 && open_servicelog() != 0) {
 		close_message_file(&cpid);
 		exit(3);
 	}
@@ -845,7 +931,11 @@ int main(int argc, char **argv)
 		}
 	}
 
-	servicelog_close(slog);
+	collect_replies(true);
+	if (slog_fd >= 0)
+		close(slog_fd);
+	if (slog)
+		servicelog_close(slog);
 	close_message_file(&cpid);
 	exit(0);
 }
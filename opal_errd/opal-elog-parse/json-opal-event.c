@@ -0,0 +1,538 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "libopalevents.h"
+#include "opal-event-data.h"
+#include "opal-event-log.h"
+#include "json-opal-event.h"
+
+#define JSON_BUF_MIN 4096
+
+static int json_reserve(struct json_buf *out, size_t len)
+{
+	size_t size;
+	char *data;
+
+	if (out->error)
+		return -1;
+	if (out->size - out->len >= len)
+		return 0;
+
+	size = out->size ? out->size : JSON_BUF_MIN;
+	while (size - out->len < len)
+		size *= 2;
+
+	data = realloc(out->data, size);
+	if (!data) {
+		out->error = ENOMEM;
+		return -1;
+	}
+	out->data = data;
+	out->size = size;
+	return 0;
+}
+
+void json_raw(struct json_buf *out, const char *s, size_t len)
+{
+	if (json_reserve(out, len))
+		return;
+	memcpy(out->data + out->len, s, len);
+	out->len += len;
+}
+
+static void json_putc(struct json_buf *out, char c)
+{
+	if (json_reserve(out, 1))
+		return;
+	out->data[out->len++] = c;
+}
+
+static void json_quoted(struct json_buf *out, const char *s, size_t maxlen)
+{
+	static const char hex[] = "0123456789abcdef";
+	const unsigned char *p = (const unsigned char *)s;
+	size_t i;
+
+	json_putc(out, '"');
+	for (i = 0; i < maxlen && p[i]; i++) {
+		switch (p[i]) {
+		case '"':
+			json_raw(out, "\\\"", 2);
+			break;
+		case '\\':
+			json_raw(out, "\\\\", 2);
+			break;
+		case '\n':
+			json_raw(out, "\\n", 2);
+			break;
+		case '\t':
+			json_raw(out, "\\t", 2);
+			break;
+		default:
+			/* Firmware strings are ASCII, keep the output valid UTF-8 */
+			if (p[i] < 0x20 || p[i] >= 0x7f) {
+				char esc[6] = { '\\', 'u', '0', '0',
+						hex[p[i] >> 4], hex[p[i] & 0xf] };
+				json_raw(out, esc, sizeof(esc));
+			} else {
+				json_putc(out, p[i]);
+			}
+		}
+	}
+	json_putc(out, '"');
+}
+
+/* Separator and key of the next member */
+static void json_member(struct json_buf *out, const char *key)
+{
+	if (out->depth > 0) {
+		if (!out->first[out->depth - 1])
+			json_putc(out, ',');
+		out->first[out->depth - 1] = 0;
+	}
+
+	if (key) {
+		json_quoted(out, key, strlen(key));
+		json_putc(out, ':');
+	}
+}
+
+static void json_open(struct json_buf *out, const char *key, char c)
+{
+	json_member(out, key);
+	json_putc(out, c);
+	if (out->depth == JSON_MAX_DEPTH) {
+		out->error = EINVAL;
+		return;
+	}
+	out->first[out->depth++] = 1;
+}
+
+static void json_close(struct json_buf *out, char c)
+{
+	if (out->depth > 0)
+		out->depth--;
+	json_putc(out, c);
+}
+
+void json_begin_object(struct json_buf *out, const char *key)
+{
+	json_open(out, key, '{');
+}
+
+void json_end_object(struct json_buf *out)
+{
+	json_close(out, '}');
+}
+
+void json_begin_array(struct json_buf *out, const char *key)
+{
+	json_open(out, key, '[');
+}
+
+void json_end_array(struct json_buf *out)
+{
+	json_close(out, ']');
+}
+
+void json_string(struct json_buf *out, const char *key,
+		 const char *s, size_t maxlen)
+{
+	json_member(out, key);
+	json_quoted(out, s, maxlen);
+}
+
+void json_uint(struct json_buf *out, const char *key, uint64_t value)
+{
+	char num[24];
+
+	json_member(out, key);
+	json_raw(out, num, snprintf(num, sizeof(num), "%" PRIu64, value));
+}
+
+void json_int(struct json_buf *out, const char *key, int64_t value)
+{
+	char num[24];
+
+	json_member(out, key);
+	json_raw(out, num, snprintf(num, sizeof(num), "%" PRId64, value));
+}
+
+void json_datetime(struct json_buf *out, const char *key,
+		   const struct opal_datetime *dt)
+{
+	char str[32];
+
+	json_member(out, key);
+	json_raw(out, str, snprintf(str, sizeof(str),
+		 "\"%04u-%02u-%02uT%02u:%02u:%02u.%02u\"",
+		 dt->year, dt->month, dt->day, dt->hour,
+		 dt->minutes, dt->seconds, dt->hundredths));
+}
+
+/* Binary data as a string of hex digits */
+static void json_hex(struct json_buf *out, const char *key,
+		     const uint8_t *data, int len)
+{
+	static const char hex[] = "0123456789abcdef";
+	int i;
+
+	json_member(out, key);
+	if (len < 0)
+		len = 0;
+	if (json_reserve(out, 2 * (size_t)len + 2))
+		return;
+
+	out->data[out->len++] = '"';
+	for (i = 0; i < len; i++) {
+		out->data[out->len++] = hex[data[i] >> 4];
+		out->data[out->len++] = hex[data[i] & 0xf];
+	}
+	out->data[out->len++] = '"';
+}
+
+void json_free(struct json_buf *out)
+{
+	free(out->data);
+	memset(out, 0, sizeof(*out));
+}
+
+static void json_v6_hdr(struct json_buf *out, const struct opal_v6_hdr *hdr)
+{
+	json_string(out, "id", hdr->id, sizeof(hdr->id));
+	json_uint(out, "version", hdr->version);
+	json_uint(out, "subtype", hdr->subtype);
+	json_uint(out, "length", hdr->length);
+	json_uint(out, "component_id", hdr->component_id);
+}
+
+static void json_mtms(struct json_buf *out, const struct opal_mtms_struct *mtms)
+{
+	json_string(out, "model", mtms->model, OPAL_SYS_MODEL_LEN);
+	json_string(out, "serial_no", mtms->serial_no, OPAL_SYS_SERIAL_LEN);
+}
+
+static void json_priv_hdr_scn(struct json_buf *out,
+			      const struct opal_priv_hdr_scn *privhdr)
+{
+	json_datetime(out, "create_time", &privhdr->create_datetime);
+	json_datetime(out, "commit_time", &privhdr->commit_datetime);
+	json_uint(out, "creator_id", privhdr->creator_id);
+	json_string(out, "creator", get_creator_name(privhdr->creator_id),
+		    SIZE_MAX);
+	json_uint(out, "creator_subid_hi", privhdr->creator_subid_hi);
+	json_uint(out, "creator_subid_lo", privhdr->creator_subid_lo);
+	json_uint(out, "plid", privhdr->plid);
+	json_uint(out, "log_entry_id", privhdr->log_entry_id);
+	json_uint(out, "scn_count", privhdr->scn_count);
+}
+
+static void json_usr_hdr_scn(struct json_buf *out,
+			     const struct opal_usr_hdr_scn *usrhdr)
+{
+	json_uint(out, "subsystem_id", usrhdr->subsystem_id);
+	json_string(out, "subsystem",
+		    get_subsystem_name(usrhdr->subsystem_id), SIZE_MAX);
+	json_uint(out, "event_scope_id", usrhdr->event_data);
+	json_string(out, "event_scope",
+		    get_event_scope(usrhdr->event_data), SIZE_MAX);
+	json_uint(out, "event_severity_id", usrhdr->event_severity);
+	json_string(out, "event_severity",
+		    get_severity_desc(usrhdr->event_severity), SIZE_MAX);
+	json_uint(out, "event_type_id", usrhdr->event_type);
+	json_string(out, "event_type",
+		    get_event_desc(usrhdr->event_type), SIZE_MAX);
+	json_uint(out, "problem_domain", usrhdr->problem_domain);
+	json_uint(out, "problem_vector", usrhdr->problem_vector);
+	json_uint(out, "action", usrhdr->action);
+}
+
+static void json_fru_scn(struct json_buf *out, const struct opal_fru_scn *fru)
+{
+	int total_mru;
+	int i;
+
+	json_begin_object(out, NULL);
+	json_uint(out, "type", fru->type);
+	json_string(out, "priority_id", (const char *)&fru->priority, 1);
+	json_string(out, "priority", get_fru_priority_desc(fru->priority),
+		    SIZE_MAX);
+	json_string(out, "location_code", fru->location_code,
+		    OPAL_FRU_LOC_CODE_MAX);
+
+	if (fru->type & OPAL_FRU_ID_SUB) {
+		json_begin_object(out, "id");
+		json_uint(out, "flags", fru->id.hdr.flags);
+		json_string(out, "component",
+			    get_fru_component_desc(fru->id.hdr.flags & 0xF0),
+			    SIZE_MAX);
+		if (fru->id.hdr.flags & OPAL_FRU_ID_PART)
+			json_string(out, "part", fru->id.part,
+				    OPAL_FRU_ID_PART_MAX);
+		if (fru->id.hdr.flags & OPAL_FRU_ID_PROC)
+			json_string(out, "procedure", fru->id.part,
+				    OPAL_FRU_ID_PART_MAX);
+		if (fru->id.hdr.flags & OPAL_FRU_ID_CCIN)
+			json_string(out, "ccin", fru->id.ccin,
+				    OPAL_FRU_ID_CCIN_MAX);
+		if (fru->id.hdr.flags & OPAL_FRU_ID_SERIAL)
+			json_string(out, "serial", fru->id.serial,
+				    OPAL_FRU_ID_SERIAL_MAX);
+		json_end_object(out);
+	}
+
+	if (fru->type & OPAL_FRU_PE_SUB) {
+		json_begin_object(out, "pe");
+		json_mtms(out, &fru->pe.mtms);
+		json_string(out, "pce", fru->pe.pce, OPAL_FRU_PE_PCE_MAX);
+		json_end_object(out);
+	}
+
+	if (fru->type & OPAL_FRU_MR_SUB) {
+		total_mru = fru->mr.hdr.flags & 0x0F;
+		if (total_mru > OPAL_FRU_MR_MRU_MAX)
+			total_mru = OPAL_FRU_MR_MRU_MAX;
+		json_begin_array(out, "mr");
+		for (i = 0; i < total_mru; i++) {
+			json_begin_object(out, NULL);
+			json_uint(out, "id", fru->mr.mru[i].id);
+			json_string(out, "priority",
+				    get_fru_priority_desc(fru->mr.mru[i].priority),
+				    SIZE_MAX);
+			json_end_object(out);
+		}
+		json_end_array(out);
+	}
+	json_end_object(out);
+}
+
+static void json_src_scn(struct json_buf *out, const struct opal_src_scn *src)
+{
+	int i;
+
+	json_uint(out, "src_version", src->version);
+	json_uint(out, "flags", src->flags);
+	json_uint(out, "wordcount", src->wordcount);
+	json_uint(out, "srclength", src->srclength);
+	json_string(out, "primary_refcode", src->primary_refcode,
+		    OPAL_SRC_SCN_PRIMARY_REFCODE_LEN);
+
+	json_begin_array(out, "hex_words");
+	json_uint(out, NULL, src->ext_refcode2);
+	json_uint(out, NULL, src->ext_refcode3);
+	json_uint(out, NULL, src->ext_refcode4);
+	json_uint(out, NULL, src->ext_refcode5);
+	json_uint(out, NULL, src->ext_refcode6);
+	json_uint(out, NULL, src->ext_refcode7);
+	json_uint(out, NULL, src->ext_refcode8);
+	json_uint(out, NULL, src->ext_refcode9);
+	json_end_array(out);
+
+	json_begin_array(out, "callouts");
+	for (i = 0; i < src->fru_count && i < OPAL_SRC_FRU_MAX; i++)
+		json_fru_scn(out, &src->fru[i]);
+	json_end_array(out);
+}
+
+static void json_eh_scn(struct json_buf *out, const struct opal_eh_scn *eh)
+{
+	json_mtms(out, &eh->mtms);
+	json_string(out, "release_version", eh->opal_release_version,
+		    OPAL_VER_LEN);
+	json_string(out, "subsys_version", eh->opal_subsys_version,
+		    OPAL_VER_LEN);
+	json_datetime(out, "event_ref_time", &eh->event_ref_datetime);
+	json_string(out, "symptom_id", eh->opalsymid, eh->opal_symid_len);
+}
+
+static void json_dh_scn(struct json_buf *out, const struct opal_dh_scn *dh)
+{
+	json_string(out, "dump_type", get_dh_type_desc(dh->v6hdr.subtype),
+		    SIZE_MAX);
+	json_uint(out, "dump_id", dh->dump_id);
+	json_uint(out, "flags", dh->flags);
+	json_uint(out, "length_dump_os", dh->length_dump_os);
+	json_uint(out, "dump_size", dh->dump_size);
+	if (dh->flags & DH_FLAG_DUMP_HEX)
+		json_uint(out, "os_dump_id", dh->shared.dump_hex);
+	else
+		json_string(out, "os_dump_file", dh->shared.dump_str,
+			    DH_DUMP_STR_MAX);
+}
+
+static void json_sw_scn(struct json_buf *out, const struct opal_sw_scn *sw)
+{
+	if (sw->v6hdr.version == 1) {
+		json_uint(out, "rc", sw->version.v1.rc);
+		json_uint(out, "line_num", sw->version.v1.line_num);
+		json_uint(out, "object_id", sw->version.v1.object_id);
+		json_string(out, "file_id", sw->version.v1.file_id,
+			    sw->version.v1.id_length);
+	} else if (sw->v6hdr.version == 2) {
+		json_uint(out, "rc", sw->version.v2.rc);
+		json_uint(out, "file_id", sw->version.v2.file_id);
+		json_uint(out, "location_id", sw->version.v2.location_id);
+		json_uint(out, "object_id", sw->version.v2.object_id);
+	}
+}
+
+static void json_lp_scn(struct json_buf *out, const struct opal_lp_scn *lp)
+{
+	int i;
+
+	json_uint(out, "primary", lp->primary);
+	json_uint(out, "partition_id", lp->partition_id);
+	json_string(out, "name", lp->name, lp->length_name);
+	json_begin_array(out, "targets");
+	for (i = 0; i < lp->lp_count; i++)
+		json_uint(out, NULL, opal_lp_target(lp, i));
+	json_end_array(out);
+}
+
+static void json_lr_scn(struct json_buf *out, const struct opal_lr_scn *lr)
+{
+	json_uint(out, "res_type", lr->res_type);
+	json_string(out, "res_type_desc", get_lr_res_desc(lr->res_type),
+		    SIZE_MAX);
+	json_uint(out, "capacity", lr->capacity);
+	json_uint(out, "shared", lr->shared);
+	json_uint(out, "memory_addr", lr->memory_addr);
+}
+
+static void json_ep_scn(struct json_buf *out, const struct opal_ep_scn *ep)
+{
+	json_uint(out, "sensor_value", ep->value >> OPAL_EP_VALUE_SHIFT);
+	json_uint(out, "epow_action", ep->value & OPAL_EP_ACTION_BITS);
+	json_uint(out, "epow_event", ep->modifier >> OPAL_EP_EVENT_SHIFT);
+	if ((ep->value >> OPAL_EP_VALUE_SHIFT) == OPAL_EP_VALUE_SET)
+		json_string(out, "epow_event_modifier",
+			    get_ep_event_desc(ep->modifier & OPAL_EP_EVENT_BITS),
+			    SIZE_MAX);
+	if (ep->v6hdr.version == OPAL_EP_HDR_V)
+		json_uint(out, "ext_modifier", ep->ext_modifier);
+	json_uint(out, "reason", ep->reason);
+}
+
+static void json_ie_scn(struct json_buf *out, const struct opal_ie_scn *ie)
+{
+	json_uint(out, "type", ie->type);
+	json_string(out, "type_desc", get_ie_type_desc(ie->type), SIZE_MAX);
+	json_uint(out, "drc", ie->drc);
+	if (ie->type == IE_TYPE_EVENT)
+		return;
+
+	json_uint(out, "scope", ie->scope);
+	json_string(out, "scope_desc", get_ie_scope_desc(ie->scope), SIZE_MAX);
+	json_uint(out, "subtype", ie->subtype);
+	json_string(out, "subtype_desc", get_ie_subtype_desc(ie->subtype),
+		    SIZE_MAX);
+	if (ie->type == IE_TYPE_RPC_PASS_THROUGH)
+		json_hex(out, "rpc_data", ie->data.rpc,
+			 ie->rpc_len < IE_DATA_MAX ? ie->rpc_len : IE_DATA_MAX);
+	if (ie->subtype == IE_SUBTYPE_PLAT_MAX_CHANGE)
+		json_uint(out, "max", ie->data.max);
+}
+
+static void json_ei_env(struct json_buf *out, const char *key,
+			const struct opal_ei_env_scn *env)
+{
+	json_begin_object(out, key);
+	json_uint(out, "corrosion", env->corrosion);
+	json_uint(out, "temperature", env->temperature);
+	json_uint(out, "rate", env->rate);
+	json_end_object(out);
+}
+
+static void json_ei_scn(struct json_buf *out, const struct opal_ei_scn *ei)
+{
+	struct opal_ei_env_scn reading;
+	int i;
+
+	json_uint(out, "g_timestamp", ei->g_timestamp);
+	json_ei_env(out, "genesis", &ei->genesis);
+	json_uint(out, "status", ei->status);
+	json_uint(out, "user_data_scn", ei->user_data_scn);
+	json_begin_array(out, "readings");
+	for (i = 0; i < ei->read_count; i++) {
+		reading = opal_ei_reading(ei, i);
+		json_ei_env(out, NULL, &reading);
+	}
+	json_end_array(out);
+}
+
+static void json_ed_scn(struct json_buf *out, const struct opal_ed_scn *ed)
+{
+	json_uint(out, "creator_id", ed->creator_id);
+	json_string(out, "creator", get_creator_name(ed->creator_id), SIZE_MAX);
+	json_hex(out, "data", ed->user_data,
+		 (int)ed->v6hdr.length - OPAL_ED_SCN_HDR_SIZE);
+}
+
+int json_opal_event_log(struct json_buf *out, opal_event_log *log)
+{
+	const struct opal_v6_hdr *hdr;
+	const void *scn;
+	int rc = 0;
+	int i;
+
+	json_begin_array(out, "sections");
+	for (i = 0; has_more_elements(log[i]); i++) {
+		scn = log[i].scn;
+		/* Every section starts with its v6 header */
+		hdr = scn;
+
+		json_begin_object(out, NULL);
+		json_v6_hdr(out, hdr);
+		if (strncmp(log[i].id, "PH", 2) == 0) {
+			json_priv_hdr_scn(out, scn);
+		} else if (strncmp(log[i].id, "UH", 2) == 0) {
+			json_usr_hdr_scn(out, scn);
+		} else if (strncmp(log[i].id, "PS", 2) == 0 ||
+			   strncmp(log[i].id, "SS", 2) == 0) {
+			json_src_scn(out, scn);
+		} else if (strncmp(log[i].id, "EH", 2) == 0) {
+			json_eh_scn(out, scn);
+		} else if (strncmp(log[i].id, "MT", 2) == 0) {
+			json_mtms(out, &((const struct opal_mtms_scn *)scn)->mtms);
+		} else if (strncmp(log[i].id, "HM", 2) == 0) {
+			json_mtms(out, &((const struct opal_hm_scn *)scn)->mtms);
+		} else if (strncmp(log[i].id, "DH", 2) == 0) {
+			json_dh_scn(out, scn);
+		} else if (strncmp(log[i].id, "SW", 2) == 0) {
+			json_sw_scn(out, scn);
+		} else if (strncmp(log[i].id, "LP", 2) == 0) {
+			json_lp_scn(out, scn);
+		} else if (strncmp(log[i].id, "LR", 2) == 0) {
+			json_lr_scn(out, scn);
+		} else if (strncmp(log[i].id, "EP", 2) == 0) {
+			json_ep_scn(out, scn);
+		} else if (strncmp(log[i].id, "IE", 2) == 0) {
+			json_ie_scn(out, scn);
+		} else if (strncmp(log[i].id, "MI", 2) == 0) {
+			json_uint(out, "flags",
+				  ((const struct opal_mi_scn *)scn)->flags);
+		} else if (strncmp(log[i].id, "CH", 2) == 0) {
+			json_string(out, "comment",
+				    ((const struct opal_ch_scn *)scn)->comment,
+				    OPAL_CH_COMMENT_MAX_LEN);
+		} else if (strncmp(log[i].id, "UD", 2) == 0) {
+			json_hex(out, "data", ((const struct opal_ud_scn *)scn)->data,
+				 (int)hdr->length - (int)sizeof(struct opal_v6_hdr));
+		} else if (strncmp(log[i].id, "EI", 2) == 0) {
+			json_ei_scn(out, scn);
+		} else if (strncmp(log[i].id, "ED", 2) == 0) {
+			json_ed_scn(out, scn);
+		} else {
+			fprintf(stderr, "ERROR: %s malformed opal-event-log structure"
+					"unknown log section type %c%c\n", __func__,
+					log[i].id[0], log[i].id[1]);
+			rc = -EINVAL;
+		}
+		json_end_object(out);
+	}
+	json_end_array(out);
+
+	return rc;
+}
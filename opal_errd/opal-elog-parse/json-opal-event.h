@@ -0,0 +1,45 @@
+#ifndef _H_OPAL_JSON_EVENT
+#define _H_OPAL_JSON_EVENT
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "opal-event-log.h"
+#include "opal-datetime.h"
+
+#define JSON_MAX_DEPTH 8
+
+/*
+ * A JSON text built in memory.  Start from a zeroed struct; members are
+ * added with a key inside an object and with a NULL key inside an array.
+ * Running out of memory is remembered in error and checked once at the
+ * end rather than after every call.
+ */
+struct json_buf {
+	char *data;
+	size_t len;
+	size_t size;
+	int depth;
+	uint8_t first[JSON_MAX_DEPTH];	/* nothing written at this level yet */
+	int error;
+};
+
+void json_free(struct json_buf *out);
+
+void json_begin_object(struct json_buf *out, const char *key);
+void json_end_object(struct json_buf *out);
+void json_begin_array(struct json_buf *out, const char *key);
+void json_end_array(struct json_buf *out);
+
+void json_string(struct json_buf *out, const char *key,
+		 const char *s, size_t maxlen);
+void json_uint(struct json_buf *out, const char *key, uint64_t value);
+void json_int(struct json_buf *out, const char *key, int64_t value);
+void json_datetime(struct json_buf *out, const char *key,
+		   const struct opal_datetime *dt);
+void json_raw(struct json_buf *out, const char *s, size_t len);
+
+/* Adds "sections": [...] with every section of the log */
+int json_opal_event_log(struct json_buf *out, opal_event_log *log);
+
+#endif /* _H_OPAL_JSON_EVENT */
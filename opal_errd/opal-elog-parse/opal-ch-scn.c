@@ -9,12 +9,13 @@
 /* Call Home Section */
 int parse_ch_scn(struct opal_ch_scn **r_ch,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_ch_scn *ch;
 	struct opal_ch_scn *bufch = (struct opal_ch_scn*)buf;
 
-	*r_ch = malloc(hdr->length);
+	*r_ch = opal_event_log_alloc(log, hdr->length);
 	if (!*r_ch)
 		return -ENOMEM;
 	ch = *r_ch;
@@ -23,7 +24,6 @@ int parse_ch_scn(struct opal_ch_scn **r_ch,
 		fprintf(stderr, "%s: corrupted, expected length >= %lu, got %u\n",
 			__func__,
 			sizeof(struct opal_ch_scn), buflen);
-		free(ch);
 		return -EINVAL;
 	}
 
@@ -31,7 +31,6 @@ int parse_ch_scn(struct opal_ch_scn **r_ch,
 		fprintf(stderr, "%s: corrupted, call home comment is longer than %u,"
 			  " got %lu\n", __func__, OPAL_CH_COMMENT_MAX_LEN,
 			  hdr->length - sizeof(struct opal_v6_hdr));
-		free(ch);
 		return -EINVAL;
 	}
 
@@ -2,6 +2,7 @@
 #define _H_OPAL_CH_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 #define OPAL_CH_COMMENT_MAX_LEN 144
 
@@ -12,7 +13,8 @@ struct opal_ch_scn {
 
 int parse_ch_scn(struct opal_ch_scn **r_ch,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_ch_scn(const struct opal_ch_scn *ch);
 
@@ -10,7 +10,8 @@
 
 int parse_dh_scn(struct opal_dh_scn **r_dh,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_dh_scn *dhbuf = (struct opal_dh_scn *)buf;
 	struct opal_dh_scn *dh;
@@ -19,7 +20,7 @@ int parse_dh_scn(struct opal_dh_scn **r_dh,
 	    __func__) < 0)
 		return -EINVAL;
 
-	*r_dh = malloc(sizeof(struct opal_dh_scn));
+	*r_dh = opal_event_log_alloc(log, sizeof(struct opal_dh_scn));
 	if(!*r_dh)
 		return -ENOMEM;
 	dh = *r_dh;
@@ -32,14 +33,12 @@ int parse_dh_scn(struct opal_dh_scn **r_dh,
 	if (dh->flags & DH_FLAG_DUMP_HEX) {
 		if (check_buflen(buflen, sizeof(struct opal_dh_scn) + sizeof(uint32_t),
 		    __func__) < 0) {
-			free(dh);
 			return -EINVAL;
 		}
 		dh->shared.dump_hex = be32toh(dh->shared.dump_hex);
 	} else { /* therefore it is in ascii */
 		if (check_buflen(buflen, sizeof(struct opal_dh_scn) + dh->length_dump_os,
 		    __func__) < 0) {
-			free(dh);
 			return -EINVAL;
 		}
 		memcpy(dh->shared.dump_str, dhbuf->shared.dump_str, dh->length_dump_os);
@@ -2,6 +2,7 @@
 #define _H_OPAL_DH_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 #define DH_FLAG_DUMP_HEX 0x40
 
@@ -22,7 +23,8 @@ struct opal_dh_scn {
 
 int parse_dh_scn(struct opal_dh_scn **r_dh,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_dh_scn(const struct opal_dh_scn *dh);
 
@@ -10,23 +10,23 @@
 
 int parse_ed_scn(struct opal_ed_scn **r_ed,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_ed_scn *ed;
-	struct opal_ed_scn *edbuf = (struct opal_ed_scn *)buf;
 
-	if (check_buflen(buflen, sizeof(struct opal_ed_scn), __func__) < 0 ||
+	if (check_buflen(buflen, OPAL_ED_SCN_HDR_SIZE, __func__) < 0 ||
 	    check_buflen(buflen, hdr->length, __func__) < 0 ||
-	    check_buflen(hdr->length, sizeof(struct opal_ed_scn), __func__) < 0)
+	    check_buflen(hdr->length, OPAL_ED_SCN_HDR_SIZE, __func__) < 0)
 		return -EINVAL;
-	*r_ed = malloc(hdr->length);
+	*r_ed = opal_event_log_alloc(log, sizeof(struct opal_ed_scn));
 	if (!*r_ed)
 		return -ENOMEM;
 	ed = *r_ed;
 
 	ed->v6hdr = *hdr;
-	ed->creator_id = edbuf->creator_id;
-	memcpy(ed->user_data, edbuf->user_data, hdr->length - 12);
+	ed->creator_id = buf[sizeof(struct opal_v6_hdr)];
+	ed->user_data = (const uint8_t *)buf + OPAL_ED_SCN_HDR_SIZE;
 
 	return 0;
 }
@@ -36,7 +36,7 @@ int print_ed_scn(const struct opal_ed_scn *ed)
 	print_header("Extended User Defined Data");
 	print_opal_v6_hdr(ed->v6hdr);
 	print_line("Created by", "%s", get_creator_name(ed->creator_id));
-	print_hex(ed->user_data, ed->v6hdr.length - 12);
+	print_hex(ed->user_data, ed->v6hdr.length - OPAL_ED_SCN_HDR_SIZE);
 	print_bar();
 	return 0;
 }
@@ -2,17 +2,22 @@
 #define _H_OPAL_ED_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
+
+/* Size of the section before the user data */
+#define OPAL_ED_SCN_HDR_SIZE 12
 
 struct opal_ed_scn {
 	struct opal_v6_hdr v6hdr;
 	uint8_t creator_id;
 	uint8_t reserved[3];
-	uint8_t user_data[0]; /* variable length */
-} __attribute__((packed));
+	const uint8_t *user_data; /* variable length, in the elog buffer */
+};
 
 int parse_ed_scn(struct opal_ed_scn **r_ed,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_ed_scn(const struct opal_ed_scn *ed);
 
@@ -9,7 +9,8 @@
 
 int parse_eh_scn(struct opal_eh_scn **r_eh,
                  const struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_eh_scn *eh;
 	struct opal_eh_scn *bufeh = (struct opal_eh_scn*)buf;
@@ -20,14 +21,13 @@ int parse_eh_scn(struct opal_eh_scn **r_eh,
 		return -EINVAL;
 	}
 
-	eh = malloc(hdr->length);
+	eh = opal_event_log_alloc(log, hdr->length);
 	if (!eh)
 		return -ENOMEM;
 
 	if (buflen < sizeof(struct opal_eh_scn)) {
 		fprintf(stderr, "%s: corrupted input buffer, expected length >= %lu, "
 				"got %u\n", __func__,  sizeof(struct opal_eh_scn), buflen);
-		free(eh);
 		return -EINVAL;
 	}
 
@@ -45,7 +45,6 @@ int parse_eh_scn(struct opal_eh_scn **r_eh,
 		fprintf(stderr, "%s: corrupted EH section, opalsymid is larger than header"
 		        " specified length %lu > %u", __func__,
 		        sizeof(struct opal_eh_scn) + strlen(bufeh->opalsymid), hdr->length);
-		free(eh);
 		return -EINVAL;
 	}
 	strncpy(eh->opalsymid, bufeh->opalsymid, eh->opal_symid_len);
@@ -2,6 +2,7 @@
 #define _H_OPAL_EH_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 #include "opal-mtms-struct.h"
 #include "opal-datetime.h"
 
@@ -23,7 +24,8 @@ struct opal_eh_scn {
 
 int parse_eh_scn(struct opal_eh_scn **r_eh,
                  const struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_eh_scn(const struct opal_eh_scn *eh);
 
@@ -8,16 +8,17 @@
 
 int parse_ei_scn(struct opal_ei_scn **r_ei,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_ei_scn *ei;
 	struct opal_ei_scn *eibuf = (struct opal_ei_scn *)buf;
 
-	if (check_buflen(buflen, sizeof(struct opal_ei_scn), __func__) < 0 ||
-		 check_buflen(hdr->length, sizeof(struct opal_ei_scn), __func__) < 0)
+	if (check_buflen(buflen, OPAL_EI_SCN_HDR_SIZE, __func__) < 0 ||
+		 check_buflen(hdr->length, OPAL_EI_SCN_HDR_SIZE, __func__) < 0)
 		return -EINVAL;
 
-	*r_ei = malloc(hdr->length);
+	*r_ei = opal_event_log_alloc(log, sizeof(struct opal_ei_scn));
 	if (!*r_ei)
 		return -ENOMEM;
 
@@ -31,22 +32,16 @@ int parse_ei_scn(struct opal_ei_scn **r_ei,
 	ei->status = eibuf->status;
 	ei->user_data_scn = eibuf->user_data_scn;
 	ei->read_count = be16toh(eibuf->read_count);
-	if (check_buflen(hdr->length, sizeof(struct opal_ei_scn) +
+	if (check_buflen(hdr->length, OPAL_EI_SCN_HDR_SIZE +
 		 (ei->read_count * sizeof(struct opal_ei_env_scn)),
 		 __func__) < 0 ||
-		 check_buflen(buflen, sizeof(struct opal_ei_scn) +
+		 check_buflen(buflen, OPAL_EI_SCN_HDR_SIZE +
 		 (ei->read_count * sizeof(struct opal_ei_env_scn)),
 		 __func__)) {
-		free(ei);
 		return -EINVAL;
 	}
 
-	int i;
-	for (i = 0; i < ei->read_count; i++) {
-		ei->readings[i].corrosion = be32toh(eibuf->readings[i].corrosion);
-		ei->readings[i].temperature = be16toh(eibuf->readings[i].temperature);
-		ei->readings[i].rate = be16toh(eibuf->readings[i].rate);
-	}
+	ei->readings = (const struct opal_ei_env_scn *)(buf + OPAL_EI_SCN_HDR_SIZE);
 
 	return 0;
 }
@@ -82,8 +77,10 @@ int print_ei_scn(const struct opal_ei_scn *ei)
 
 	print_line("Sensor Reading Count", "0x%04x", ei->read_count);
 	int i;
-	for(i = 0; i < ei->read_count; i++)
-		print_ei_env_scn(ei->readings + i);
+	for(i = 0; i < ei->read_count; i++) {
+		struct opal_ei_env_scn reading = opal_ei_reading(ei, i);
+		print_ei_env_scn(&reading);
+	}
 
 	return 0;
 }
@@ -1,7 +1,12 @@
 #ifndef _H_OPAL_EI_SCN
 #define _H_OPAL_EI_SCN
 
+#include <endian.h>
+#include <stddef.h>
+#include <string.h>
+
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 struct opal_ei_env_scn {
 	uint32_t corrosion;
@@ -19,12 +24,30 @@ struct opal_ei_scn {
 	uint8_t status;
 	uint8_t user_data_scn;
 	uint16_t read_count;
-	struct opal_ei_env_scn readings[0]; /* variable length */
+	/* variable length, big endian in the elog buffer, see opal_ei_reading() */
+	const struct opal_ei_env_scn *readings;
 } __attribute__((packed));
 
+/* Size of the section before the readings */
+#define OPAL_EI_SCN_HDR_SIZE offsetof(struct opal_ei_scn, readings)
+
+static inline struct opal_ei_env_scn
+opal_ei_reading(const struct opal_ei_scn *ei, int n)
+{
+	struct opal_ei_env_scn env;
+
+	memcpy(&env, ei->readings + n, sizeof(env));
+	env.corrosion = be32toh(env.corrosion);
+	env.temperature = be16toh(env.temperature);
+	env.rate = be16toh(env.rate);
+
+	return env;
+}
+
 int parse_ei_scn(struct opal_ei_scn **r_ei,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_ei_scn(const struct opal_ei_scn *ei);
 
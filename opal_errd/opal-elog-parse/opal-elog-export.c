@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "libopalevents.h"
+#include "opal-event-log.h"
+#include "parse-opal-event.h"
+#include "json-opal-event.h"
+#include "opal-elog-export.h"
+
+/* stdout buffer, records are written whole into it */
+#define EXPORT_WRITE_BUF (256 * 1024)
+
+struct export_job {
+	char *path;
+	struct json_buf out;
+	struct opal_datetime commit_time;
+	int has_commit_time;
+	int done;
+};
+
+struct export_pool {
+	struct export_job *jobs;
+	int count;
+	int next;	/* next job to be taken by a worker */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;	/* a job is done */
+};
+
+/* Render one elog into job->out, a line of its own */
+static void export_elog(struct export_job *job)
+{
+	struct json_buf *out = &job->out;
+	struct opal_priv_hdr_scn *ph;
+	opal_event_log *log = NULL;
+	const char *name;
+	char *buf;
+	ssize_t sz;
+	int rc;
+
+	name = strrchr(job->path, '/');
+	name = name ? name + 1 : job->path;
+
+	json_begin_object(out, NULL);
+	json_string(out, "file", name, SIZE_MAX);
+
+	sz = read_elog(job->path, &buf, true);
+	if (sz < 0) {
+		json_int(out, "error", -EIO);
+		goto out;
+	}
+
+	rc = parse_opal_event_log(buf, sz, &log, 1);
+	if (log) {
+		ph = get_priv_hdr_scn(log);
+		json_uint(out, "logid", ph->log_entry_id);
+		json_datetime(out, "commit_time", &ph->commit_datetime);
+		job->commit_time = ph->commit_datetime;
+		job->has_commit_time = 1;
+
+		if (json_opal_event_log(out, log) && rc >= 0)
+			rc = -EINVAL;
+		free_opal_event_log(log);
+	}
+	if (rc < 0)
+		json_int(out, "error", rc);
+	free(buf);
+
+out:
+	json_end_object(out);
+	json_raw(out, "\n", 1);
+}
+
+static void *export_worker(void *arg)
+{
+	struct export_pool *pool = arg;
+	int i;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		i = pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+		if (i >= pool->count)
+			break;
+
+		export_elog(&pool->jobs[i]);
+
+		pthread_mutex_lock(&pool->lock);
+		pool->jobs[i].done = 1;
+		pthread_cond_broadcast(&pool->cond);
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	return NULL;
+}
+
+static int export_write(struct export_job *job)
+{
+	int rc = 0;
+
+	if (job->out.error) {
+		fprintf(stderr, "%s: could not export %s: %s\n", __func__,
+			job->path, strerror(job->out.error));
+		rc = -1;
+	} else if (fwrite(job->out.data, 1, job->out.len, stdout) !=
+		   job->out.len) {
+		rc = -1;
+	}
+	json_free(&job->out);
+
+	return rc;
+}
+
+static int compare_datetime(const struct opal_datetime *a,
+			    const struct opal_datetime *b)
+{
+	if (a->year != b->year)
+		return a->year < b->year ? -1 : 1;
+	if (a->month != b->month)
+		return a->month < b->month ? -1 : 1;
+	if (a->day != b->day)
+		return a->day < b->day ? -1 : 1;
+	if (a->hour != b->hour)
+		return a->hour < b->hour ? -1 : 1;
+	if (a->minutes != b->minutes)
+		return a->minutes < b->minutes ? -1 : 1;
+	if (a->seconds != b->seconds)
+		return a->seconds < b->seconds ? -1 : 1;
+	if (a->hundredths != b->hundredths)
+		return a->hundredths < b->hundredths ? -1 : 1;
+	return 0;
+}
+
+/* Oldest first, elogs that could not be parsed last */
+static int compare_commit_time(const void *a, const void *b)
+{
+	const struct export_job *ja = *(struct export_job * const *)a;
+	const struct export_job *jb = *(struct export_job * const *)b;
+	int rc;
+
+	if (ja->has_commit_time != jb->has_commit_time)
+		return ja->has_commit_time ? -1 : 1;
+	if (ja->has_commit_time) {
+		rc = compare_datetime(&ja->commit_time, &jb->commit_time);
+		if (rc)
+			return rc;
+	}
+
+	/* The jobs are in one array, in the order given */
+	return ja < jb ? -1 : (ja > jb);
+}
+
+int elog_export(char **paths, int count, int nthreads, int by_commit_time)
+{
+	struct export_pool pool;
+	struct export_job **sorted = NULL;
+	pthread_t threads[EXPORT_THREADS_MAX];
+	int nstarted = 0;
+	int rc = 0;
+	int err;
+	int i;
+
+	if (nthreads <= 0)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads > EXPORT_THREADS_MAX)
+		nthreads = EXPORT_THREADS_MAX;
+	if (nthreads > count)
+		nthreads = count;
+
+	memset(&pool, 0, sizeof(pool));
+	pool.count = count;
+	pool.jobs = calloc(count ? count : 1, sizeof(*pool.jobs));
+	if (by_commit_time)
+		sorted = calloc(count ? count : 1, sizeof(*sorted));
+	if (!pool.jobs || (by_commit_time && !sorted)) {
+		fprintf(stderr, "%s: Failed to allocate buffer\n", __func__);
+		free(pool.jobs);
+		free(sorted);
+		return -1;
+	}
+	for (i = 0; i < count; i++)
+		pool.jobs[i].path = paths[i];
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.cond, NULL);
+
+	setvbuf(stdout, NULL, _IOFBF, EXPORT_WRITE_BUF);
+
+	for (i = 0; i < nthreads; i++) {
+		err = pthread_create(&threads[nstarted], NULL, export_worker,
+				     &pool);
+		if (err) {
+			fprintf(stderr, "%s: Could not start thread: %s\n",
+				__func__, strerror(err));
+			break;
+		}
+		nstarted++;
+	}
+
+	/* Do it all here if no thread could be started */
+	if (nstarted == 0)
+		export_worker(&pool);
+
+	if (by_commit_time) {
+		for (i = 0; i < nstarted; i++)
+			pthread_join(threads[i], NULL);
+
+		for (i = 0; i < count; i++)
+			sorted[i] = &pool.jobs[i];
+		qsort(sorted, count, sizeof(*sorted), compare_commit_time);
+
+		for (i = 0; i < count; i++)
+			if (export_write(sorted[i]))
+				rc = -1;
+	} else {
+		/* Write each as soon as it and all before it are done */
+		for (i = 0; i < count; i++) {
+			pthread_mutex_lock(&pool.lock);
+			while (!pool.jobs[i].done)
+				pthread_cond_wait(&pool.cond, &pool.lock);
+			pthread_mutex_unlock(&pool.lock);
+
+			if (export_write(&pool.jobs[i]))
+				rc = -1;
+		}
+
+		for (i = 0; i < nstarted; i++)
+			pthread_join(threads[i], NULL);
+	}
+
+	if (fflush(stdout) || ferror(stdout)) {
+		fprintf(stderr, "%s: Failed to write the elogs: %s\n",
+			__func__, strerror(errno));
+		rc = -1;
+	}
+
+	pthread_cond_destroy(&pool.cond);
+	pthread_mutex_destroy(&pool.lock);
+	free(sorted);
+	free(pool.jobs);
+
+	return rc;
+}
@@ -0,0 +1,23 @@
+#ifndef _H_OPAL_ELOG_EXPORT
+#define _H_OPAL_ELOG_EXPORT
+
+#include <stdbool.h>
+
+/* Upper bound for the number of parsing threads */
+#define EXPORT_THREADS_MAX 64
+
+/* In opal-elog-parse.c */
+int read_elog(char path[], char **buf, bool skip_chdir);
+
+/*
+ * Write the elogs at paths to stdout as JSON Lines, one object per elog
+ * with every section decoded.  The elogs are parsed on up to nthreads
+ * threads (0 for one per online CPU) but written in the order of paths,
+ * or sorted by commit time (ties keep the order of paths) when
+ * by_commit_time is set.  Sorting needs every elog parsed before the
+ * first is written; otherwise each is written as soon as the ones before
+ * it are.
+ */
+int elog_export(char **paths, int count, int nthreads, int by_commit_time);
+
+#endif /* _H_OPAL_ELOG_EXPORT */
@@ -17,6 +17,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -37,6 +39,8 @@
 #include "parse-opal-event.h"
 #include "opal-elog.h"
 #include "opal-esel-parse.h"
+#include "opal-elog-summary.h"
+#include "opal-elog-export.h"
 
 #define DEFAULT_opt_platform_dir "/var/log/opal-elog"
 char *opt_platform_dir = DEFAULT_opt_platform_dir;
@@ -44,13 +48,16 @@ char *opt_platform_dir = DEFAULT_opt_platform_dir;
 void print_usage(char *command)
 {
 	printf("%s - Parse OPAL plaform error logs\n\n", command);
-	printf("Usage: %s { -d  <logid> | -e <logid> | -a | -l | -s | -h }"
-			" [ -p dir | -f file]\n\n"
+	printf("Usage: %s { -d  <logid> | -e <logid> | -a | -l | -s | -j | -h }"
+			" [ -p dir | -f file] [ -c ] [ -t threads ]\n\n"
 			"\t-a       - Display all error log entry details\n"
 			"\t-d logid - Display error log entry details\n"
 			"\t-e logid - Erase error log entry details (cannot be combined with -f)\n"
 			"\t-l       - List all error logs\n"
 			"\t-s       - List all service action logs\n"
+			"\t-j       - Export all error logs as JSON Lines\n"
+			"\t-c       - Export in commit time order (with -j)\n"
+			"\t-t n     - Parse on n threads (with -j, default one per CPU)\n"
 			"\t-p dir   - Use dir as elog directory (default %s)\n"
 			"\t-f file  - Specify elog by filename\n"
 			"\t-h       - Print this message and exit\n",
@@ -62,6 +69,9 @@ static int file_filter(const struct dirent *d)
 	struct stat sbuf;
 	char filename[PATH_MAX];
 
+	/* The summary index */
+	if (d->d_name[0] == '.')
+		return 0;
 	if (d->d_type == DT_DIR)
 		return 0;
 	if (d->d_type == DT_REG)
@@ -92,14 +102,40 @@ uint32_t validate_eid_str(const char *eid)
 	return rc;
 }
 
+/* Look the elog up in the summary index, 1 if the index is not usable */
+static int get_elog_filename_indexed(uint32_t eid, char **name)
+{
+	struct elog_summary *summaries;
+	int count;
+	int i;
+
+	if (summary_index_list(opt_platform_dir, &summaries, &count))
+		return 1;
+
+	*name = NULL;
+	for (i = 0; i < count; i++) {
+		if (summaries[i].logid == eid) {
+			*name = strdup(summaries[i].name);
+			break;
+		}
+	}
+	free(summaries);
+
+	return 0;
+}
+
 char *get_elog_filename_int(uint32_t eid)
 {
 	struct dirent **filelist;
 	char *ret_str = NULL;
 	char *feid;
 	int i;
-	int nfiles = scandir(opt_platform_dir, &filelist, file_filter, alphasort);
+	int nfiles;
 
+	if (get_elog_filename_indexed(eid, &ret_str) == 0)
+		return ret_str;
+
+	nfiles = scandir(opt_platform_dir, &filelist, file_filter, alphasort);
 	if (nfiles < 1)
 		return NULL;
 
@@ -203,34 +239,27 @@ out:
 
 }
 
-void print_elog_summary(char *buffer, int bufsz, uint32_t service_flag)
+void print_elog_summary(const struct elog_summary *summary,
+			uint32_t service_flag)
 {
 	const char *parse;
-	uint32_t logid;
 	char src[ELOG_SRC_SIZE + 1];
-	char severity;
-	uint16_t action;
-	struct opal_datetime date_time_in, date_time_out;
-	uint8_t creator_id;
+	struct opal_datetime date_time_out;
 	int plus;
-	logid = be32toh(*(uint32_t*)(buffer+ELOG_ID_OFFSET));
-	memcpy(src, (buffer + ELOG_SRC_OFFSET), sizeof(src));
+	memcpy(src, summary->src, ELOG_SRC_SIZE);
 	src[ELOG_SRC_SIZE] = '\0';
-	severity = buffer[ELOG_SEVERITY_OFFSET];
-	action = be16toh(*(uint16_t *)(buffer + ELOG_ACTION_OFFSET));
-	plus = ((action & ELOG_ACTION_FLAG_SERVICE) == ELOG_ACTION_FLAG_SERVICE);
-	parse = get_severity_desc(severity & 0xF0);
+	plus = ((summary->action & ELOG_ACTION_FLAG_SERVICE) == ELOG_ACTION_FLAG_SERVICE);
+	parse = get_severity_desc(summary->severity & 0xF0);
 	/* & with 0xF0 to get only the category of severity, not the full description */
 
-	date_time_in = *(const struct opal_datetime *)(buffer + ELOG_COMMIT_TIME_OFFSET);
-	date_time_out = parse_opal_datetime(date_time_in);
-	creator_id = buffer[ELOG_CREATOR_ID_OFFSET];
+	date_time_out = parse_opal_datetime(summary->commit_time);
 	if (service_flag != 1 || plus)
 		printf("|%08X %04u-%02u-%02u %02u:%02u:%02u %8.8s %c %-17.17s %-20.20s|\n",
-		       logid, date_time_out.year, date_time_out.month,
+		       summary->logid, date_time_out.year, date_time_out.month,
 		       date_time_out.day, date_time_out.hour,
 		       date_time_out.minutes, date_time_out.seconds,
-		       src, (plus && !service_flag) ? '+' : ' ', get_creator_name(creator_id), parse);
+		       src, (plus && !service_flag) ? '+' : ' ',
+		       get_creator_name(summary->creator_id), parse);
 }
 
 /* parse error log entry from file */
@@ -281,6 +310,21 @@ int elogdisplayentry(uint32_t eid, int display_all)
 	int i;
 	int done = 0;
 	int offset = ELOG_ID_OFFSET;
+	char *name;
+
+	/* A single elog is looked up in the summary index */
+	if (!display_all && get_elog_filename_indexed(eid, &name) == 0 &&
+	    name) {
+		if (chdir(opt_platform_dir) < 0) {
+			fprintf(stderr, "Failed to change to platform log "
+				"directory: %s\n", opt_platform_dir);
+			free(name);
+			return -1;
+		}
+		ret = elogdisplayfile(name, eid, 0);
+		free(name);
+		return ret;
+	}
 
 	nfiles = scandir(opt_platform_dir, &filelist,
 			 file_filter, alphasort);
@@ -336,6 +380,7 @@ int elog_summary(char *elog_path, uint32_t service_flag)
 	int ret = 0;
 	char *buffer;
 	ssize_t sz = 0;
+	struct elog_summary summary;
 
 	printf("|------------------------------------------------------------------------------|\n");
 	printf("|ID       Date       Time     SRC        Creator           Event Severity      |\n");
@@ -345,16 +390,12 @@ int elog_summary(char *elog_path, uint32_t service_flag)
 	if (sz < 0)
 		return -1;
 
-	if (sz < ELOG_MIN_READ_OFFSET) {
+	/* The name is not needed for printing */
+	if (elog_summary_fill(&summary, "", buffer, sz)) {
 		fprintf(stderr, "Partially read elog, cannot parse\n");
 		ret = -1;
 	} else {
-		/* If the file is an eSEL, we need to ignore the header. */
-		if (is_esel_header(buffer))
-			print_elog_summary(buffer + sizeof(struct esel_header),
-					   sz, service_flag);
-		else
-			print_elog_summary(buffer, sz, service_flag);
+		print_elog_summary(&summary, service_flag);
 	}
 
 	if (!ret)
@@ -369,6 +410,8 @@ int eloglist(uint32_t service_flag)
 {
 	char *buffer;
 	struct dirent **filelist;
+	struct elog_summary *summaries;
+	struct elog_summary summary;
 	int nfiles;
 	ssize_t sz = 0;
 	int i;
@@ -377,6 +420,22 @@ int eloglist(uint32_t service_flag)
 	printf("|ID       Date       Time     SRC        Creator           Event Severity      |\n");
 	printf("|------------------------------------------------------------------------------|\n");
 
+	/* Without the index every elog is read */
+	if (summary_index_list(opt_platform_dir, &summaries, &nfiles) == 0) {
+		if (nfiles == 0) {
+			fprintf(stderr, "0 files found in directory: %s\n",
+				opt_platform_dir);
+			return -1;
+		}
+
+		for (i = 0; i < nfiles; i++)
+			print_elog_summary(&summaries[i], service_flag);
+		free(summaries);
+
+		printf("|------------------------------------------------------------------------------|\n");
+		return 0;
+	}
+
 	nfiles = scandir(opt_platform_dir, &filelist,
 			 file_filter, alphasort);
 
@@ -394,15 +453,10 @@ int eloglist(uint32_t service_flag)
 		if (sz < 0){
 			free(filelist[i]);
 			continue;
-		} else if (sz < ELOG_MIN_READ_OFFSET) {
+		} else if (elog_summary_fill(&summary, "", buffer, sz)) {
 			fprintf(stderr, "Partially read elog, cannot parse\n");
 		} else {
-			/* If the file is an eSEL, we need to ignore the header */
-			if (is_esel_header(buffer))
-				print_elog_summary(buffer+sizeof(struct esel_header),
-						   sz, service_flag);
-			else
-				print_elog_summary(buffer, sz, service_flag);
+			print_elog_summary(&summary, service_flag);
 		}
 
 		free(buffer);
@@ -415,14 +469,65 @@ int eloglist(uint32_t service_flag)
 	return 0;
 }
 
+/* export all the error logs, or the one in elog_path */
+int elogexport(char *elog_path, int nthreads, int by_commit_time)
+{
+	struct dirent **filelist;
+	char **paths;
+	int nfiles;
+	int ret = -1;
+	int i;
+
+	if (elog_path)
+		return elog_export(&elog_path, 1, nthreads, by_commit_time);
+
+	nfiles = scandir(opt_platform_dir, &filelist,
+			 file_filter, alphasort);
+	if (nfiles < 0){
+		fprintf(stderr,"Error accessing directory: %s\n",opt_platform_dir);
+		return -1;
+	}
+
+	paths = calloc(nfiles ? nfiles : 1, sizeof(*paths));
+	for (i = 0; paths && i < nfiles; i++) {
+		if (asprintf(&paths[i], "%s/%s", opt_platform_dir,
+			     filelist[i]->d_name) < 0) {
+			paths[i] = NULL;
+			break;
+		}
+	}
+
+	if (paths && i == nfiles)
+		ret = elog_export(paths, nfiles, nthreads, by_commit_time);
+	else
+		fprintf(stderr, "Failed to allocate buffer\n");
+
+	for (i = 0; i < nfiles; i++) {
+		if (paths)
+			free(paths[i]);
+		free(filelist[i]);
+	}
+	free(paths);
+	free(filelist);
+
+	return ret;
+}
+
 int delete_elog(const char *eid)
 {
+	struct summary_index index;
 	int error = -1;
 	char *f_name = get_elog_filename_str(eid);
 	if (f_name) {
 		error = chdir(opt_platform_dir);
-		if (!error)
+		if (!error) {
+			/* Not in the way of opal_errd, or of a listing */
+			summary_index_lock(&index, opt_platform_dir);
 			error = remove(f_name);
+			if (!error)
+				summary_index_remove(&index, f_name);
+			summary_index_unlock(&index);
+		}
 		free(f_name);
 	}
 	return error;
@@ -438,8 +543,11 @@ int main(int argc, char *argv[])
 	char *elog_path = NULL;
 	int opt_display_file = 0;
 	int opt_display_all = 0;
+	int opt_commit_order = 0;
+	int opt_threads = 0;
+	char *end;
 
-	while ((opt = getopt(argc, argv, "ad:lshf:p:e:")) != -1) {
+	while ((opt = getopt(argc, argv, "ad:lshf:p:e:jct:")) != -1) {
 		switch (opt) {
 		case 'e':
 		case 'd':
@@ -453,6 +561,7 @@ int main(int argc, char *argv[])
 			/* fallthrough */
 		case 'l':
 		case 's':
+		case 'j':
 			arg_cnt++;
 			do_operation = opt;
 			break;
@@ -468,6 +577,18 @@ int main(int argc, char *argv[])
 		case 'p':
 			opt_platform_dir = optarg;
 			break;
+		case 'c':
+			opt_commit_order = 1;
+			break;
+		case 't':
+			opt_threads = strtol(optarg, &end, 10);
+			if (*end != '\0' || opt_threads < 1 ||
+			    opt_threads > EXPORT_THREADS_MAX) {
+				fprintf(stderr, "Invalid thread count '%s'\n", optarg);
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
 		case 'h':
 			print_usage(argv[0]);
 			exit(EXIT_SUCCESS);
@@ -478,7 +599,7 @@ int main(int argc, char *argv[])
 	}
 
 	if (arg_cnt > 1) {
-		fprintf(stderr, "Only one operation (-d | -a | -l | -s | -e) "
+		fprintf(stderr, "Only one operation (-d | -a | -l | -s | -e | -j) "
 			"can be selected at any one time.\n");
 		print_usage(argv[0]);
 		return -1;
@@ -490,6 +611,12 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
+	if ((opt_commit_order || opt_threads) && do_operation != 'j') {
+		fprintf(stderr, "-c and -t can only be used with -j\n");
+		print_usage(argv[0]);
+		return -1;
+	}
+
 	switch (do_operation) {
 	case 'l':
 		if(opt_display_file){
@@ -517,6 +644,10 @@ int main(int argc, char *argv[])
 			ret = eloglist(1);
 		}
 		break;
+	case 'j':
+		ret = elogexport(opt_display_file ? elog_path : NULL,
+				 opt_threads, opt_commit_order);
+		break;
 	default:
 		fprintf(stderr, "No operation specified\n");
 		print_usage(argv[0]);
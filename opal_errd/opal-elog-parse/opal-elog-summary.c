@@ -0,0 +1,519 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <endian.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "opal-elog-summary.h"
+#include "opal-esel-parse.h"
+
+#define SUMMARY_INDEX_MAGIC	"OELOGIDX"
+#define SUMMARY_INDEX_VERSION	2
+#define SUMMARY_INDEX_TMP	ELOG_SUMMARY_INDEX ".tmp"
+
+/*
+ * opal_errd only appends, so once the index holds more than twice the
+ * records it was last written with, plus this many, it is rewritten
+ * with only the live ones
+ */
+#define SUMMARY_INDEX_SLACK	4096
+
+struct summary_index_hdr {
+	char	magic[8];
+	uint32_t version;
+	uint32_t rec_size;
+	int64_t	dir_mtime_sec;	/* 0 until the index matches the directory */
+	int64_t	dir_mtime_nsec;
+	uint32_t live;		/* records when last written whole */
+	uint32_t reserved;
+};
+
+/* Summary fields of an elog (with or without an eSEL header) */
+int elog_summary_fill(struct elog_summary *summary, const char *name,
+		      const char *buf, size_t len)
+{
+	if (strlen(name) >= ELOG_SUMMARY_NAME_MAX)
+		return -1;
+
+	if (len >= sizeof(struct esel_header) && is_esel_header(buf)) {
+		buf += sizeof(struct esel_header);
+		len -= sizeof(struct esel_header);
+	}
+
+	if (len < ELOG_MIN_READ_OFFSET)
+		return -1;
+
+	memset(summary, 0, sizeof(*summary));
+	strcpy(summary->name, name);
+	summary->logid = be32toh(*(const uint32_t *)(buf + ELOG_ID_OFFSET));
+	summary->action = be16toh(*(const uint16_t *)(buf + ELOG_ACTION_OFFSET));
+	summary->severity = buf[ELOG_SEVERITY_OFFSET];
+	summary->creator_id = buf[ELOG_CREATOR_ID_OFFSET];
+	memcpy(summary->src, buf + ELOG_SRC_OFFSET, ELOG_SRC_SIZE);
+	memcpy(&summary->commit_time, buf + ELOG_COMMIT_TIME_OFFSET,
+	       sizeof(summary->commit_time));
+
+	return 0;
+}
+
+static int read_index_hdr(int fd, struct summary_index_hdr *hdr)
+{
+	if (pread(fd, hdr, sizeof(*hdr), 0) != sizeof(*hdr) ||
+	    memcmp(hdr->magic, SUMMARY_INDEX_MAGIC, sizeof(hdr->magic)) ||
+	    hdr->version != SUMMARY_INDEX_VERSION ||
+	    hdr->rec_size != sizeof(struct elog_summary))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Write the header, stamped with the directory's mtime if dir_fd >= 0,
+ * for an index last written whole with live records
+ */
+static int write_index_hdr(int fd, int dir_fd, uint32_t live)
+{
+	struct summary_index_hdr hdr;
+	struct stat sbuf;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SUMMARY_INDEX_MAGIC, sizeof(hdr.magic));
+	hdr.version = SUMMARY_INDEX_VERSION;
+	hdr.rec_size = sizeof(struct elog_summary);
+	hdr.live = live;
+
+	if (dir_fd >= 0) {
+		if (fstat(dir_fd, &sbuf))
+			return -1;
+		hdr.dir_mtime_sec = sbuf.st_mtim.tv_sec;
+		hdr.dir_mtime_nsec = sbuf.st_mtim.tv_nsec;
+	}
+
+	if (pwrite(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr))
+		return -1;
+
+	return 0;
+}
+
+/* Has the directory changed since the index was last stamped? */
+static int index_matches_dir(int dir_fd, const struct summary_index_hdr *hdr)
+{
+	struct stat sbuf;
+
+	if (fstat(dir_fd, &sbuf))
+		return 0;
+
+	return hdr->dir_mtime_sec == sbuf.st_mtim.tv_sec &&
+	       hdr->dir_mtime_nsec == sbuf.st_mtim.tv_nsec;
+}
+
+static int compare_summary_names(const void *a, const void *b)
+{
+	const struct elog_summary *sa = a;
+	const struct elog_summary *sb = b;
+
+	return strcoll(sa->name, sb->name);
+}
+
+/* By name, and in the order appended for the same name */
+static int compare_summary_recs(const void *a, const void *b)
+{
+	const struct elog_summary *sa = *(const struct elog_summary **)a;
+	const struct elog_summary *sb = *(const struct elog_summary **)b;
+	int rc;
+
+	rc = strcoll(sa->name, sb->name);
+	if (rc)
+		return rc;
+
+	return sa < sb ? -1 : sa > sb;
+}
+
+/*
+ * The elogs the index says are in the directory, sorted by name: the
+ * last record for each name wins, and is dropped if it is a removal.
+ */
+static int load_index(int fd, struct elog_summary **summaries, int *count)
+{
+	const struct elog_summary *recs;
+	const struct elog_summary **sorted = NULL;
+	struct elog_summary *live = NULL;
+	struct stat sbuf;
+	void *map = MAP_FAILED;
+	size_t nrecs, i, n = 0;
+	int ret = -1;
+
+	if (fstat(fd, &sbuf) || sbuf.st_size < sizeof(struct summary_index_hdr))
+		return -1;
+
+	/* A record cut short by a crash is ignored */
+	nrecs = (sbuf.st_size - sizeof(struct summary_index_hdr)) /
+		sizeof(struct elog_summary);
+	if (nrecs == 0) {
+		*summaries = NULL;
+		*count = 0;
+		return 0;
+	}
+
+	map = mmap(NULL, sbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED)
+		return -1;
+	recs = (const struct elog_summary *)
+			((char *)map + sizeof(struct summary_index_hdr));
+
+	sorted = malloc(nrecs * sizeof(*sorted));
+	live = malloc(nrecs * sizeof(*live));
+	if (!sorted || !live)
+		goto out;
+
+	for (i = 0; i < nrecs; i++) {
+		if (memchr(recs[i].name, '\0', ELOG_SUMMARY_NAME_MAX) == NULL)
+			goto out;
+		sorted[i] = &recs[i];
+	}
+	qsort(sorted, nrecs, sizeof(*sorted), compare_summary_recs);
+
+	for (i = 0; i < nrecs; i++) {
+		if (i + 1 < nrecs && !strcoll(sorted[i]->name, sorted[i + 1]->name))
+			continue;
+		if (sorted[i]->flags & ELOG_SUMMARY_REMOVED)
+			continue;
+		live[n++] = *sorted[i];
+	}
+
+	*summaries = live;
+	*count = n;
+	live = NULL;
+	ret = 0;
+out:
+	free(live);
+	free(sorted);
+	munmap(map, sbuf.st_size);
+	return ret;
+}
+
+/* Not the index; whether the rest are regular files is checked when read */
+static int summary_filter(const struct dirent *d)
+{
+	if (d->d_name[0] == '.' || d->d_type == DT_DIR)
+		return 0;
+
+	return 1;
+}
+
+/* Summary of an elog the index did not know about, from its headers */
+static int read_summary(int dir_fd, const char *name,
+			struct elog_summary *summary)
+{
+	char buf[sizeof(struct esel_header) + ELOG_MIN_READ_OFFSET];
+	struct stat sbuf;
+	ssize_t readsz;
+	size_t sz = 0;
+	int fd;
+	int ret = -1;
+
+	fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+
+	if (fstat(fd, &sbuf) || !S_ISREG(sbuf.st_mode))
+		goto out;
+
+	do {
+		readsz = read(fd, buf + sz, sizeof(buf) - sz);
+		if (readsz < 0 && errno == EINTR)
+			continue;
+		if (readsz <= 0)
+			break;
+		sz += readsz;
+	} while (sz != sizeof(buf));
+
+	ret = elog_summary_fill(summary, name, buf, sz);
+out:
+	close(fd);
+	return ret;
+}
+
+/*
+ * Index the directory again, reading only the files not in the old
+ * index.  The new index replaces the old one if it can be written; the
+ * summaries are returned either way.
+ */
+static int rebuild_index(const char *dir, int dir_fd,
+			 struct elog_summary *old, int nold,
+			 struct elog_summary **summaries, int *count)
+{
+	struct elog_summary *live, *found, key;
+	struct dirent **filelist;
+	int nfiles, i, n = 0;
+	size_t len;
+	int fd;
+
+	nfiles = scandir(dir, &filelist, summary_filter, alphasort);
+	if (nfiles < 0)
+		return -1;
+
+	live = malloc((nfiles ? nfiles : 1) * sizeof(*live));
+	if (!live) {
+		for (i = 0; i < nfiles; i++)
+			free(filelist[i]);
+		free(filelist);
+		return -1;
+	}
+
+	for (i = 0; i < nfiles; i++) {
+		found = NULL;
+		if (strlen(filelist[i]->d_name) < ELOG_SUMMARY_NAME_MAX) {
+			strcpy(key.name, filelist[i]->d_name);
+			found = bsearch(&key, old, nold, sizeof(*old),
+					compare_summary_names);
+		}
+
+		if (found)
+			live[n++] = *found;
+		else if (!read_summary(dir_fd, filelist[i]->d_name, &live[n]))
+			n++;
+
+		free(filelist[i]);
+	}
+	free(filelist);
+
+	qsort(live, n, sizeof(*live), compare_summary_names);
+	*summaries = live;
+	*count = n;
+
+	/* The index is only a cache, e.g. the directory may be read-only */
+	fd = openat(dir_fd, SUMMARY_INDEX_TMP,
+		    O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+		    S_IRUSR | S_IWUSR | S_IRGRP);
+	if (fd < 0)
+		return 0;
+
+	len = n * sizeof(*live);
+	if (write_index_hdr(fd, -1, n) ||
+	    pwrite(fd, live, len, sizeof(struct summary_index_hdr)) != len ||
+	    renameat(dir_fd, SUMMARY_INDEX_TMP, dir_fd, ELOG_SUMMARY_INDEX)) {
+		unlinkat(dir_fd, SUMMARY_INDEX_TMP, 0);
+		close(fd);
+		return 0;
+	}
+
+	/* The rename changed the directory too */
+	write_index_hdr(fd, dir_fd, n);
+	close(fd);
+	return 0;
+}
+
+/*
+ * The elogs in a directory, sorted by name.  The index is used if it
+ * matches the directory, and rebuilt otherwise.
+ */
+int summary_index_list(const char *dir, struct elog_summary **summaries,
+		       int *count)
+{
+	struct summary_index_hdr hdr;
+	struct elog_summary *old = NULL;
+	int nold = 0;
+	int dir_fd, fd;
+	int ret = -1;
+
+	dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dir_fd < 0)
+		return -1;
+
+	if (flock(dir_fd, LOCK_SH))
+		goto out;
+
+	fd = openat(dir_fd, ELOG_SUMMARY_INDEX, O_RDONLY | O_CLOEXEC);
+	if (fd >= 0) {
+		if (!read_index_hdr(fd, &hdr) && index_matches_dir(dir_fd, &hdr))
+			ret = load_index(fd, summaries, count);
+		close(fd);
+		if (!ret)
+			goto out;
+	}
+
+	/* Someone else may rebuild it first */
+	if (flock(dir_fd, LOCK_EX))
+		goto out;
+
+	fd = openat(dir_fd, ELOG_SUMMARY_INDEX, O_RDONLY | O_CLOEXEC);
+	if (fd >= 0) {
+		if (!read_index_hdr(fd, &hdr)) {
+			if (index_matches_dir(dir_fd, &hdr))
+				ret = load_index(fd, summaries, count);
+			else if (load_index(fd, &old, &nold))
+				nold = 0;
+		}
+		close(fd);
+		if (!ret)
+			goto out;
+	}
+
+	ret = rebuild_index(dir, dir_fd, old, nold, summaries, count);
+	free(old);
+out:
+	close(dir_fd);
+	return ret;
+}
+
+/*
+ * Rewrite a locked index with only its live records, replacing the
+ * index the same way rebuild_index() does.  The old index is kept if
+ * the new one can not be written.
+ */
+static void compact_index(struct summary_index *index)
+{
+	struct elog_summary *live;
+	size_t len;
+	int n, fd;
+
+	if (load_index(index->fd, &live, &n))
+		return;
+
+	fd = openat(index->dir_fd, SUMMARY_INDEX_TMP,
+		    O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+		    S_IRUSR | S_IWUSR | S_IRGRP);
+	if (fd < 0) {
+		free(live);
+		return;
+	}
+
+	len = n * sizeof(*live);
+	if (write_index_hdr(fd, -1, n) ||
+	    pwrite(fd, live, len, sizeof(struct summary_index_hdr)) != len ||
+	    renameat(index->dir_fd, SUMMARY_INDEX_TMP, index->dir_fd,
+		     ELOG_SUMMARY_INDEX)) {
+		unlinkat(index->dir_fd, SUMMARY_INDEX_TMP, 0);
+		close(fd);
+		free(live);
+		return;
+	}
+	free(live);
+
+	close(index->fd);
+	index->fd = fd;
+	index->live = n;
+
+	/* The rename changed the directory too */
+	if (index->fresh)
+		write_index_hdr(fd, index->dir_fd, n);
+}
+
+/*
+ * Lock the directory against other writers and readers and open its
+ * index for records to be added.  An index that is missing or not
+ * usable is started over empty, to be rebuilt by its next reader; one
+ * grown well past its live records is compacted.
+ */
+int summary_index_lock(struct summary_index *index, const char *dir)
+{
+	struct summary_index_hdr hdr;
+	struct stat sbuf;
+	off_t nrecs;
+
+	index->fd = -1;
+	index->fresh = 0;
+	index->changed = 0;
+	index->live = 0;
+
+	index->dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (index->dir_fd < 0)
+		return -1;
+
+	if (flock(index->dir_fd, LOCK_EX))
+		goto err;
+
+	index->fd = openat(index->dir_fd, ELOG_SUMMARY_INDEX,
+			   O_RDWR | O_CREAT | O_CLOEXEC,
+			   S_IRUSR | S_IWUSR | S_IRGRP);
+	if (index->fd < 0)
+		goto err;
+
+	if (fstat(index->fd, &sbuf) || read_index_hdr(index->fd, &hdr)) {
+		if (ftruncate(index->fd, 0) ||
+		    write_index_hdr(index->fd, -1, 0))
+			goto err;
+		return 0;
+	}
+
+	index->fresh = index_matches_dir(index->dir_fd, &hdr);
+	index->live = hdr.live;
+
+	nrecs = (sbuf.st_size - sizeof(hdr)) / sizeof(struct elog_summary);
+	if (nrecs > 2 * (off_t)hdr.live + SUMMARY_INDEX_SLACK)
+		compact_index(index);
+
+	return 0;
+err:
+	if (index->fd >= 0)
+		close(index->fd);
+	close(index->dir_fd);
+	index->fd = index->dir_fd = -1;
+	return -1;
+}
+
+static void append_summary(struct summary_index *index,
+			   const struct elog_summary *summary)
+{
+	if (index->fd < 0)
+		return;
+
+	index->changed = 1;
+	if (lseek(index->fd, 0, SEEK_END) < 0 ||
+	    write(index->fd, summary, sizeof(*summary)) != sizeof(*summary))
+		index->fresh = 0;
+}
+
+/* Record an elog written to the directory */
+void summary_index_add(struct summary_index *index,
+		       const struct elog_summary *summary)
+{
+	append_summary(index, summary);
+}
+
+/* Record an elog removed from the directory */
+void summary_index_remove(struct summary_index *index, const char *name)
+{
+	struct elog_summary summary;
+
+	if (strlen(name) >= ELOG_SUMMARY_NAME_MAX) {
+		summary_index_invalidate(index);
+		return;
+	}
+
+	memset(&summary, 0, sizeof(summary));
+	strcpy(summary.name, name);
+	summary.flags = ELOG_SUMMARY_REMOVED;
+	append_summary(index, &summary);
+}
+
+/* The directory changed in a way the index does not record */
+void summary_index_invalidate(struct summary_index *index)
+{
+	index->fresh = 0;
+	index->changed = 1;
+}
+
+/*
+ * Stamp the index with the directory as it is now, if the index
+ * matched it before the changes just recorded, and unlock.
+ */
+void summary_index_unlock(struct summary_index *index)
+{
+	if (index->fd >= 0) {
+		if (index->changed && index->fresh)
+			write_index_hdr(index->fd, index->dir_fd, index->live);
+		close(index->fd);
+	}
+	if (index->dir_fd >= 0)
+		close(index->dir_fd);
+	index->fd = index->dir_fd = -1;
+}
@@ -0,0 +1,64 @@
+#ifndef _H_OPAL_ELOG_SUMMARY
+#define _H_OPAL_ELOG_SUMMARY
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "opal-elog.h"
+#include "opal-datetime.h"
+
+/*
+ * Summary index of the elogs in the platform elog directory.
+ *
+ * opal_errd appends a record with the summary fields of every elog it
+ * writes to the directory, and a "removed" record for every elog it
+ * rotates out, so that opal-elog-parse can list the elogs and find them
+ * by ID without reading each file.  The header holds the modification
+ * time of the directory as it was after the last change recorded in the
+ * index; when the directory has changed since (or the index is missing)
+ * opal-elog-parse rebuilds the index, reading only the files the old
+ * one did not know about.  Writers hold an exclusive flock() on the
+ * directory while they change it.
+ *
+ * The index is a local cache, records are in host endian.
+ */
+#define ELOG_SUMMARY_INDEX	".summary.idx"
+#define ELOG_SUMMARY_NAME_MAX	48
+
+#define ELOG_SUMMARY_REMOVED	0x01
+
+struct elog_summary {
+	char	name[ELOG_SUMMARY_NAME_MAX];	/* file name */
+	uint32_t logid;
+	uint16_t action;
+	uint8_t	severity;
+	uint8_t	creator_id;
+	uint8_t	flags;
+	uint8_t	reserved[3];
+	char	src[ELOG_SRC_SIZE];
+	struct opal_datetime commit_time;	/* as in the elog */
+};
+
+/* An index opened for changes, see summary_index_lock() */
+struct summary_index {
+	int	dir_fd;
+	int	fd;
+	int	fresh;	/* matched the directory when it was locked */
+	int	changed;
+	unsigned int live;	/* records when it was last written whole */
+};
+
+int elog_summary_fill(struct elog_summary *summary, const char *name,
+		      const char *buf, size_t len);
+
+int summary_index_lock(struct summary_index *index, const char *dir);
+void summary_index_add(struct summary_index *index,
+		       const struct elog_summary *summary);
+void summary_index_remove(struct summary_index *index, const char *name);
+void summary_index_invalidate(struct summary_index *index);
+void summary_index_unlock(struct summary_index *index);
+
+int summary_index_list(const char *dir, struct elog_summary **summaries,
+		       int *count);
+
+#endif /* _H_OPAL_ELOG_SUMMARY */
@@ -8,7 +8,8 @@
 
 int parse_ep_scn(struct opal_ep_scn **r_ep,
                  const struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_ep_scn *bufep = (struct opal_ep_scn *)buf;
 	struct opal_ep_scn *ep;
@@ -20,7 +21,7 @@ int parse_ep_scn(struct opal_ep_scn **r_ep,
 		return -EINVAL;
 	}
 
-	*r_ep = malloc(sizeof(struct opal_ep_scn));
+	*r_ep = opal_event_log_alloc(log, sizeof(struct opal_ep_scn));
 	if(!*r_ep)
 		return -ENOMEM;
 	ep = *r_ep;
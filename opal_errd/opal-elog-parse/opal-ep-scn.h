@@ -2,6 +2,7 @@
 #define _H_OPAL_EP_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 #define OPAL_EP_VALUE_SHIFT 4
 #define OPAL_EP_ACTION_BITS 0x0F
@@ -22,7 +23,8 @@ struct opal_ep_scn {
 
 int parse_ep_scn(struct opal_ep_scn **r_ep,
                  const struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_ep_scn(const struct opal_ep_scn *ep);
 
@@ -3,11 +3,6 @@
 
 #include <stdint.h>
 
-struct generic_desc{
-	uint8_t id;
-	const char *desc;
-};
-
 const char *get_event_desc(uint8_t id);
 
 const char *get_subsystem_name(uint8_t id);
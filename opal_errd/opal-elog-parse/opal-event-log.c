@@ -1,20 +1,98 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <stddef.h>
 #include "opal-event-log.h"
 
+/*
+ * A log and everything parsed into it live in one arena: the log's
+ * section array comes first in a block of OPAL_EVENT_LOG_BLOCK_SIZE,
+ * the parsed sections follow, and further blocks are only allocated if
+ * a log does not fit.  Freeing the log frees the blocks, however many
+ * sections were parsed.
+ */
+#define OPAL_EVENT_LOG_BLOCK_SIZE	(16 * 1024)
+#define OPAL_EVENT_LOG_ALIGN		8
+
+struct opal_event_log_block {
+	struct opal_event_log_block *next;
+	size_t size;
+	size_t used;
+	char data[] __attribute__((aligned(OPAL_EVENT_LOG_ALIGN)));
+};
+
+struct opal_event_log_arena {
+	struct opal_event_log_block *more;	/* blocks added since */
+	size_t size;
+	size_t used;
+	opal_event_log log[];	/* n + 1 entries, then the rest of the block */
+};
+
+static struct opal_event_log_arena *log_arena(opal_event_log *log) {
+	return (struct opal_event_log_arena *)
+		((char *)log - offsetof(struct opal_event_log_arena, log));
+}
+
 opal_event_log *create_opal_event_log(int n) {
-	opal_event_log *log = malloc(sizeof(struct opal_event_log_scn) * (n + 1));
-	if (!log)
+	struct opal_event_log_arena *arena;
+	size_t entries = sizeof(struct opal_event_log_scn) * (n + 1);
+
+	entries = (entries + OPAL_EVENT_LOG_ALIGN - 1) &
+		  ~(size_t)(OPAL_EVENT_LOG_ALIGN - 1);
+	arena = malloc(sizeof(*arena) + entries + OPAL_EVENT_LOG_BLOCK_SIZE);
+	if (!arena)
 		return NULL;
 
-	log[n].id[0] = '\0';
-	log[n].id[1] = '\0';
-	log[n].scn = NULL;
+	arena->more = NULL;
+	arena->size = entries + OPAL_EVENT_LOG_BLOCK_SIZE;
+	arena->used = entries;
 
-	return log;
+	arena->log[n].id[0] = '\0';
+	arena->log[n].id[1] = '\0';
+	arena->log[n].scn = NULL;
+
+	return arena->log;
 }
 
+/*
+ * Zeroed memory that lives as long as the log.  Sections point into
+ * the buffer they were parsed from where they can, so this is only
+ * needed for what has to be converted or terminated.
+ */
+void *opal_event_log_alloc(opal_event_log *log, size_t size) {
+	struct opal_event_log_arena *arena = log_arena(log);
+	struct opal_event_log_block *block;
+	size_t bsize;
+	void *p;
+
+	size = (size + OPAL_EVENT_LOG_ALIGN - 1) &
+	       ~(size_t)(OPAL_EVENT_LOG_ALIGN - 1);
+
+	if (arena->size - arena->used >= size) {
+		p = (char *)arena->log + arena->used;
+		arena->used += size;
+		goto out;
+	}
+
+	block = arena->more;
+	if (!block || block->size - block->used < size) {
+		bsize = size > OPAL_EVENT_LOG_BLOCK_SIZE ?
+				size : OPAL_EVENT_LOG_BLOCK_SIZE;
+		block = malloc(sizeof(*block) + bsize);
+		if (!block)
+			return NULL;
+		block->size = bsize;
+		block->used = 0;
+		block->next = arena->more;
+		arena->more = block;
+	}
+
+	p = block->data + block->used;
+	block->used += size;
+out:
+	memset(p, 0, size);
+	return p;
+}
 
 int add_opal_event_log_scn(opal_event_log *log, const char *id, void *scn, int n) {
 	if(!log || n < 0)
@@ -61,16 +139,18 @@ get_nth_opal_event_log_scn(opal_event_log *log, int n)
 }
 
 int free_opal_event_log(opal_event_log *log) {
+	struct opal_event_log_arena *arena;
+	struct opal_event_log_block *block;
+
 	if (!log)
 		return -EINVAL;
 
-	int i = 0;
-	while(has_more_elements(log[i])) {
-		free(log[i].scn);
-		i++;
+	arena = log_arena(log);
+	while ((block = arena->more)) {
+		arena->more = block->next;
+		free(block);
 	}
-
-	free(log);
+	free(arena);
 
 	return 0;
 }
@@ -1,6 +1,8 @@
 #ifndef _H_OPAL_EVENT_LOG
 #define _H_OPAL_EVENT_LOG
 
+#include <stddef.h>
+
 struct opal_event_log_scn {
    char id[2];
    void *scn;
@@ -10,6 +12,8 @@ typedef struct opal_event_log_scn opal_event_log;
 
 opal_event_log *create_opal_event_log(int n);
 
+void *opal_event_log_alloc(opal_event_log *log, size_t size);
+
 int add_opal_event_log_scn(opal_event_log *log, const char *id, void *scn, int n);
 
 int has_more_elements(struct opal_event_log_scn log_scn);
@@ -8,7 +8,8 @@
 
 int parse_hm_scn(struct opal_hm_scn **r_hm,
                  const struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_hm_scn *bufhm = (struct opal_hm_scn *)buf;
 	struct opal_hm_scn *hm;
@@ -19,7 +20,7 @@ int parse_hm_scn(struct opal_hm_scn **r_hm,
 		return -EINVAL;
 	}
 
-	*r_hm = malloc(sizeof(struct opal_hm_scn));
+	*r_hm = opal_event_log_alloc(log, sizeof(struct opal_hm_scn));
 	if(!*r_hm)
 		return -ENOMEM;
 	hm = *r_hm;
@@ -2,6 +2,7 @@
 #define _H_OPAL_HM_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 #include "opal-mtms-struct.h"
 
 struct opal_hm_scn {
@@ -11,7 +12,8 @@ struct opal_hm_scn {
 
 int parse_hm_scn(struct opal_hm_scn **r_hm,
                  const struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_hm_scn(const struct opal_hm_scn *hm);
 
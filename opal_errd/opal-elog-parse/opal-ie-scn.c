@@ -9,7 +9,8 @@
 
 int parse_ie_scn(struct opal_ie_scn **r_ie,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_ie_scn *iebuf = (struct opal_ie_scn *)buf;
 	struct opal_ie_scn *ie;
@@ -20,7 +21,7 @@ int parse_ie_scn(struct opal_ie_scn **r_ie,
 		return -EINVAL;
 	}
 
-	*r_ie = malloc(sizeof(struct opal_ie_scn));
+	*r_ie = opal_event_log_alloc(log, sizeof(struct opal_ie_scn));
 	if (!*r_ie)
 		return -ENOMEM;
 	ie = *r_ie;
@@ -36,7 +37,6 @@ int parse_ie_scn(struct opal_ie_scn **r_ie,
 			fprintf(stderr, "%s: corrupted, exptected length => %lu, got %u",
 			        __func__, sizeof(struct opal_ie_scn) - IE_DATA_MAX +
 			        ie->rpc_len, buflen);
-			free(ie);
 			return -EINVAL;
 		}
 		memcpy(ie->data.rpc, iebuf->data.rpc, ie->rpc_len);
@@ -46,7 +46,6 @@ int parse_ie_scn(struct opal_ie_scn **r_ie,
 			fprintf(stderr, "%s: corrupted, exptected length => %lu, got %u",
 			        __func__, sizeof(struct opal_ie_scn) - IE_DATA_MAX +
 			        sizeof(uint64_t), buflen);
-			free(ie);
 			return -EINVAL;
 		}
 		ie->data.max = be64toh(iebuf->data.max);
@@ -2,6 +2,7 @@
 #define _H_OPAL_IE_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 #define IE_TYPE_ERROR_DET 0x01
 #define IE_TYPE_ERROR_REC 0x02
@@ -30,7 +31,8 @@ struct opal_ie_scn {
 
 int parse_ie_scn(struct opal_ie_scn **r_ie,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_ie_scn(const struct opal_ie_scn *ie);
 
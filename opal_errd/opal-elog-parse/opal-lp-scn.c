@@ -7,21 +7,23 @@
 #include "print_helpers.h"
 
 int parse_lp_scn(struct opal_lp_scn **r_lp,
-                 struct opal_v6_hdr *hdr, const char *buf, int buflen)
+                 struct opal_v6_hdr *hdr, const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_lp_scn *lp;
 	struct opal_lp_scn *lpbuf = (struct opal_lp_scn *)buf;
-	uint16_t *lps;
-	uint16_t *lpsbuf;
-	if (buflen < sizeof(struct opal_lp_scn) ||
-			hdr->length < sizeof(struct opal_lp_scn)) {
+	const char *namebuf = buf + OPAL_LP_SCN_HDR_SIZE;
+	if (buflen < OPAL_LP_SCN_HDR_SIZE ||
+			hdr->length < OPAL_LP_SCN_HDR_SIZE) {
 		fprintf(stderr, "%s: corrupted, expected length => %lu, got %u\n",
-		        __func__, sizeof(struct opal_lp_scn),
+		        __func__, OPAL_LP_SCN_HDR_SIZE,
 		        buflen < hdr->length ? buflen : hdr->length);
 		return -EINVAL;
 	}
 
-	*r_lp = malloc(hdr->length);
+	/* Room for the name and its null */
+	*r_lp = opal_event_log_alloc(log, sizeof(struct opal_lp_scn) +
+				     lpbuf->length_name + 1);
 	if (!*r_lp) {
 		fprintf(stderr, "%s: out of memory\n", __func__);
 		return -ENOMEM;
@@ -34,31 +36,24 @@ int parse_lp_scn(struct opal_lp_scn **r_lp,
 	lp->length_name = lpbuf->length_name;
 	lp->lp_count = lpbuf->lp_count;
 	lp->partition_id = be32toh(lpbuf->partition_id);
-	lp->name[0] = '\0';
-	int expected_len = sizeof(struct opal_lp_scn) + lp->length_name;
+	int expected_len = OPAL_LP_SCN_HDR_SIZE + lp->length_name;
 	if (buflen < expected_len || hdr->length < expected_len) {
 		fprintf(stderr, "%s: corrupted, expected length => %u, got %u",
 		        __func__, expected_len,
 		        buflen < hdr->length ? buflen : hdr->length);
-		free(lp);
 		return -EINVAL;
 	}
-	memcpy(lp->name, lpbuf->name, lp->length_name);
+	memcpy(lp->name, namebuf, lp->length_name);
 
 	expected_len += lp->lp_count * sizeof(uint16_t);
 	if (buflen < expected_len || hdr->length < expected_len) {
 		fprintf(stderr, "%s: corrupted, expected length => %u, got %u",
 		        __func__, expected_len,
 		        buflen < hdr->length ? buflen : hdr->length);
-		free(lp);
 		return -EINVAL;
 	}
 
-	lpsbuf = (uint16_t *)(lpbuf->name + lpbuf->length_name);
-	lps = (uint16_t *)(lp->name + lp->length_name);
-	int i;
-	for(i = 0; i < lp->lp_count; i++)
-		lps[i] = be16toh(lpsbuf[i]);
+	lp->lps = (const uint16_t *)(namebuf + lp->length_name);
 
 	return 0;
 }
@@ -72,13 +67,13 @@ int print_lp_scn(const struct opal_lp_scn *lp)
 	print_line("Length of LP Name", "0x%02x", lp->length_name);
 	print_line("Primary Partition Name", "%s", lp->name);
 	int i;
-	uint16_t *lps = (uint16_t *) (lp->name + lp->length_name);
 	print_line("Target LP Count", "0x%02x", lp->lp_count);
 	for(i = 0; i < lp->lp_count; i+=2) {
 		if (i + 1 < lp->lp_count)
-			print_line("Target LP", "0x%04x	 0x%04x", lps[i], lps[i+1]);
+			print_line("Target LP", "0x%04x	 0x%04x",
+			           opal_lp_target(lp, i), opal_lp_target(lp, i + 1));
 		else
-			print_line("Target LP", "0x%04X", lps[i]);
+			print_line("Target LP", "0x%04X", opal_lp_target(lp, i));
 	}
 
 	print_bar();
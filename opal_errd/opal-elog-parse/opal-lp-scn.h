@@ -1,7 +1,12 @@
 #ifndef _H_OPAL_LP_SCN
 #define _H_OPAL_LP_SCN
 
+#include <endian.h>
+#include <stddef.h>
+#include <string.h>
+
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 struct opal_lp_scn {
 	struct opal_v6_hdr v6hdr;
@@ -9,14 +14,27 @@ struct opal_lp_scn {
 	uint8_t length_name;
 	uint8_t lp_count;
 	uint32_t partition_id;
-	char name[0]; /* variable length */
-	/* uint16_t *lps; variable length
-	 * exists after name, position will be name + length name
+	/* variable length, exists after name in the elog buffer,
+	 * big endian, see opal_lp_target()
 	 */
+	const uint16_t *lps;
+	char name[0]; /* variable length, null terminated */
 } __attribute__((packed));
 
+/* Size of the section before the name */
+#define OPAL_LP_SCN_HDR_SIZE offsetof(struct opal_lp_scn, lps)
+
+static inline uint16_t opal_lp_target(const struct opal_lp_scn *lp, int n)
+{
+	uint16_t target;
+
+	memcpy(&target, lp->lps + n, sizeof(target));
+	return be16toh(target);
+}
+
 int parse_lp_scn(struct opal_lp_scn **r_lp,
-                 struct opal_v6_hdr *hdr, const char *buf, int buflen);
+                 struct opal_v6_hdr *hdr, const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_lp_scn(const struct opal_lp_scn *lp);
 
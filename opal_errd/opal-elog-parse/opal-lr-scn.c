@@ -7,7 +7,8 @@
 #include "print_helpers.h"
 
 int parse_lr_scn(struct opal_lr_scn **r_lr,
-                 struct opal_v6_hdr *hdr, const char *buf, int buflen)
+                 struct opal_v6_hdr *hdr, const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_lr_scn *lrbuf = (struct opal_lr_scn *)buf;
 	struct opal_lr_scn *lr;
@@ -18,7 +19,7 @@ int parse_lr_scn(struct opal_lr_scn **r_lr,
 		return -EINVAL;
 	}
 
-	*r_lr = malloc(sizeof(struct opal_lr_scn));
+	*r_lr = opal_event_log_alloc(log, sizeof(struct opal_lr_scn));
 	if (!*r_lr)
 		return -ENOMEM;
 	lr = *r_lr;
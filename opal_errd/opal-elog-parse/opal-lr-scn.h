@@ -2,6 +2,7 @@
 #define _H_OPAL_LR_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 #define LR_RES_TYPE_PROC 0x10
 #define LR_RES_TYPE_SHARED_PROC 0x11
@@ -18,7 +19,8 @@ struct opal_lr_scn {
 } __attribute__((packed));
 
 int parse_lr_scn(struct opal_lr_scn **r_lr,
-                 struct opal_v6_hdr *hdr, const char *buf, int buflen);
+                 struct opal_v6_hdr *hdr, const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_lr_scn(const struct opal_lr_scn *lr);
 
@@ -7,7 +7,8 @@
 
 int parse_mi_scn(struct opal_mi_scn **r_mi,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_mi_scn *mibuf = (struct opal_mi_scn *)buf;
 	struct opal_mi_scn *mi;
@@ -18,7 +19,7 @@ int parse_mi_scn(struct opal_mi_scn **r_mi,
 		return -EINVAL;
 	}
 
-	*r_mi = malloc(sizeof(struct opal_mi_scn));
+	*r_mi = opal_event_log_alloc(log, sizeof(struct opal_mi_scn));
 	if (!*r_mi)
 		return -ENOMEM;
 	mi = *r_mi;
@@ -2,6 +2,7 @@
 #define _H_OPAL_MI_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 struct opal_mi_scn {
 	struct opal_v6_hdr v6hdr;
@@ -11,7 +12,8 @@ struct opal_mi_scn {
 
 int parse_mi_scn(struct opal_mi_scn **r_mi,
                  struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen);
+                 const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_mi_scn(const struct opal_mi_scn *mi);
 
@@ -7,7 +7,7 @@
 #include "print_helpers.h"
 
 int parse_mtms_scn(struct opal_mtms_scn **r_mtms, const struct opal_v6_hdr *hdr,
-		const char *buf, int buflen) {
+		const char *buf, int buflen, opal_event_log *log) {
 
 	struct opal_mtms_scn *bufmtms = (struct opal_mtms_scn*)buf;
 	struct opal_mtms_scn *mtms;
@@ -24,7 +24,7 @@ int parse_mtms_scn(struct opal_mtms_scn **r_mtms, const struct opal_v6_hdr *hdr,
 		return -EINVAL;
 	}
 
-	*r_mtms = malloc(sizeof(struct opal_mtms_scn));
+	*r_mtms = opal_event_log_alloc(log, sizeof(struct opal_mtms_scn));
 	if(!*r_mtms)
 		return -ENOMEM;
 	mtms = *r_mtms;
@@ -2,6 +2,7 @@
 #define _H_OPAL_MTMS_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 #include "opal-mtms-struct.h"
 
 struct opal_mtms_scn {
@@ -10,7 +11,8 @@ struct opal_mtms_scn {
 } __attribute__((packed));
 
 int parse_mtms_scn(struct opal_mtms_scn **r_mtms, const struct opal_v6_hdr *hdr,
-                   const char *buf, int buflen);
+                   const char *buf, int buflen,
+                   opal_event_log *log);
 
 int print_mtms_scn(const struct opal_mtms_scn *mtms);
 
@@ -8,12 +8,12 @@
 #include "opal-event-data.h"
 #include "print_helpers.h"
 
-int parse_priv_hdr_scn(struct opal_priv_hdr_scn **r_privhdr,
+/* Parsed into the caller's privhdr, the log is not allocated yet */
+int parse_priv_hdr_scn(struct opal_priv_hdr_scn *privhdr,
                        const struct opal_v6_hdr *hdr, const char *buf,
                        int buflen)
 {
 	struct opal_priv_hdr_scn *bufhdr = (struct opal_priv_hdr_scn*)buf;
-	struct opal_priv_hdr_scn *privhdr;
 
 	if (buflen < sizeof(struct opal_priv_hdr_scn)) {
 		fprintf(stderr, "%s: corrupted, expected length %lu, got %u\n",
@@ -30,11 +30,6 @@ int parse_priv_hdr_scn(struct opal_priv_hdr_scn **r_privhdr,
 		return -EINVAL;
 	}
 
-	*r_privhdr = malloc(sizeof(struct opal_priv_hdr_scn));
-	if (!*r_privhdr)
-		return -ENOMEM;
-	privhdr = *r_privhdr;
-
 	privhdr->v6hdr = *hdr;
 	privhdr->create_datetime = parse_opal_datetime(bufhdr->create_datetime);
 	privhdr->commit_datetime = parse_opal_datetime(bufhdr->commit_datetime);
@@ -25,7 +25,7 @@ struct opal_priv_hdr_scn {
 	uint32_t log_entry_id;  /* Unique log entry id */
 } __attribute__((packed));
 
-int parse_priv_hdr_scn(struct opal_priv_hdr_scn **r_privhdr,
+int parse_priv_hdr_scn(struct opal_priv_hdr_scn *privhdr,
                        const struct opal_v6_hdr *hdr, const char *buf,
                        int buflen);
 
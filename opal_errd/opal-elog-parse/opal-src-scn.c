@@ -9,7 +9,8 @@
 
 int parse_src_scn(struct opal_src_scn **r_src,
                   const struct opal_v6_hdr *hdr,
-                  const char *buf, int buflen)
+                  const char *buf, int buflen,
+                  opal_event_log *log)
 {
 	struct opal_src_scn *bufsrc = (struct opal_src_scn*)buf;
 	struct opal_src_scn *src;
@@ -30,7 +31,7 @@ int parse_src_scn(struct opal_src_scn **r_src,
 		return -EINVAL;
 	}
 
-	*r_src = malloc(sizeof(struct opal_src_scn));
+	*r_src = opal_event_log_alloc(log, sizeof(struct opal_src_scn));
 	if(!*r_src)
 		return -ENOMEM;
 	src = *r_src;
@@ -55,17 +56,14 @@ int parse_src_scn(struct opal_src_scn **r_src,
 	src->fru_count = 0;
 	if (src->flags & OPAL_SRC_ADD_SCN) {
 		error = check_buflen(buflen, offset + sizeof(struct opal_src_add_scn_hdr), __func__);
-		if (error) {
-			free(src);
+		if (error)
 			return error;
-		}
 
 		src->addhdr.flags = bufsrc->addhdr.flags;
 		src->addhdr.id = bufsrc->addhdr.id;
 		if (src->addhdr.id != OPAL_FRU_SCN_ID) {
 			fprintf(stderr, "%s: invalid section id, expecting 0x%x but found"
 			        " 0x%x", __func__, OPAL_FRU_SCN_ID, src->addhdr.id);
-			free(src);
 			return -EINVAL;
 		}
 		src->addhdr.length = be16toh(bufsrc->addhdr.length);
@@ -73,10 +71,8 @@ int parse_src_scn(struct opal_src_scn **r_src,
 
 		while(offset < src->srclength && src->fru_count < OPAL_SRC_FRU_MAX) {
 			error = parse_fru_scn(&(src->fru[src->fru_count]), buf + offset, buflen - offset);
-			if (error < 0) {
-				free(src);
+			if (error < 0)
 				return error;
-			}
 			offset += error;
 			src->fru_count++;
 		}
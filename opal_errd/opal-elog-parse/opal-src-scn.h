@@ -2,6 +2,7 @@
 #define _H_OPAL_SRC_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 #include "opal-src-fru-scn.h"
 
 #define OPAL_SRC_SCN_PRIMARY_REFCODE_LEN 32
@@ -50,7 +51,8 @@ struct opal_src_scn {
 
 int parse_src_scn(struct opal_src_scn **r_src,
                   const struct opal_v6_hdr *hdr,
-                  const char *buf, int buflen);
+                  const char *buf, int buflen,
+                  opal_event_log *log);
 
 int print_opal_src_scn(const struct opal_src_scn *src);
 
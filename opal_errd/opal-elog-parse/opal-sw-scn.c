@@ -61,18 +61,18 @@ int parse_sw_v2_scn(struct opal_sw_v2_scn *swv2,
 
 
 int parse_sw_scn(struct opal_sw_scn **r_sw,
-                 struct opal_v6_hdr *hdr, const char *buf, int buflen)
+                 struct opal_v6_hdr *hdr, const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_sw_scn *sw;
 	int rc = 0;
 
-	*r_sw = malloc(hdr->length);
+	*r_sw = opal_event_log_alloc(log, hdr->length);
 	if(!*r_sw)
 		return -ENOMEM;
 	sw = *r_sw;
 
 	if (buflen < sizeof(struct opal_v6_hdr)) {
-		free(sw);
 		return -EINVAL;
 	}
 
@@ -102,7 +102,6 @@ int parse_sw_scn(struct opal_sw_scn **r_sw,
 	}
 
 	if(rc != 0) {
-		free(sw);
 		return rc;
 	}
 
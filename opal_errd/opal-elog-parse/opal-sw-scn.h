@@ -2,6 +2,7 @@
 #define _H_OPAL_SW_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 #include "opal-sw-v1-scn.h"
 #include "opal-sw-v2-scn.h"
 
@@ -14,7 +15,8 @@ struct opal_sw_scn {
 } __attribute__((packed));
 
 int parse_sw_scn(struct opal_sw_scn **r_sw,
-                 struct opal_v6_hdr *hdr, const char *buf, int buflen);
+                 struct opal_v6_hdr *hdr, const char *buf, int buflen,
+                 opal_event_log *log);
 
 int print_sw_scn(const struct opal_sw_scn *sw);
 
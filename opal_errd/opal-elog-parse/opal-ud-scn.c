@@ -8,24 +8,24 @@
 
 int parse_ud_scn(struct opal_ud_scn **r_ud,
                  const struct opal_v6_hdr *hdr,
-                 const char *buf, int buflen)
+                 const char *buf, int buflen,
+                 opal_event_log *log)
 {
 	struct opal_ud_scn *ud;
-	struct opal_ud_scn *bufud = (struct opal_ud_scn *)buf;
 
-	if (buflen < sizeof(struct opal_ud_scn)) {
-		fprintf(stderr, "%s: corrupted, expected length >= %lu, got %u\n",
-		        __func__, sizeof(struct opal_ud_scn), buflen);
+	if (buflen < hdr->length) {
+		fprintf(stderr, "%s: corrupted, expected length >= %u, got %u\n",
+		        __func__, hdr->length, buflen);
 		return -EINVAL;
 	}
 
-	*r_ud = malloc(hdr->length);
+	*r_ud = opal_event_log_alloc(log, sizeof(struct opal_ud_scn));
 	if (!*r_ud)
 		return -ENOMEM;
 	ud = *r_ud;
 
 	ud->v6hdr = *hdr;
-	memcpy(ud->data, bufud->data, hdr->length - sizeof(struct opal_v6_hdr));
+	ud->data = (const uint8_t *)buf + sizeof(struct opal_v6_hdr);
 
 	return 0;
 }
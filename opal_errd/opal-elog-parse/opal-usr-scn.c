@@ -8,7 +8,8 @@
 
 int parse_usr_hdr_scn(struct opal_usr_hdr_scn **r_usrhdr,
                       const struct opal_v6_hdr *hdr,
-                      const char *buf, int buflen, int *is_error)
+                      const char *buf, int buflen, int *is_error,
+                      opal_event_log *log)
 {
 	struct opal_usr_hdr_scn *bufhdr = (struct opal_usr_hdr_scn*)buf;
 	struct opal_usr_hdr_scn *usrhdr;
@@ -26,7 +27,7 @@ int parse_usr_hdr_scn(struct opal_usr_hdr_scn **r_usrhdr,
 		return -EINVAL;
 	}
 
-	*r_usrhdr = malloc(sizeof(struct opal_usr_hdr_scn));
+	*r_usrhdr = opal_event_log_alloc(log, sizeof(struct opal_usr_hdr_scn));
 	if(!*r_usrhdr)
 		return -ENOMEM;
 	usrhdr = *r_usrhdr;
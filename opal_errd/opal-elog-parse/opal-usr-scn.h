@@ -2,6 +2,7 @@
 #define _H_OPAL_USR_SCN
 
 #include "opal-v6-hdr.h"
+#include "opal-event-log.h"
 
 #define OPAL_UH_TYPE_NA                   0x00
 #define OPAL_UH_TYPE_INFO_ONLY            0x01
@@ -41,7 +42,8 @@ struct opal_usr_hdr_scn {
 
 int parse_usr_hdr_scn(struct opal_usr_hdr_scn **r_usrhdr,
                       const struct opal_v6_hdr *hdr,
-                      const char *buf, int buflen, int *is_error);
+                      const char *buf, int buflen, int *is_error,
+                      opal_event_log *log);
 
 int print_opal_usr_hdr_scn(const struct opal_usr_hdr_scn *usrhdr);
 
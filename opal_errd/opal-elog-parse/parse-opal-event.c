@@ -21,7 +21,8 @@ int header_id_lookup(struct header_id *elog_hdr_id, int size, char *id) {
 	return -1;
 }
 
-int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **r_log)
+int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **r_log,
+			 int quiet)
 {
 	struct header_id elog_hdr_id[] = {
 				HEADER_ORDER
@@ -29,10 +30,12 @@ int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **r_lo
 
 	int rc = -1;
 	struct opal_v6_hdr hdr;
-	struct opal_priv_hdr_scn *ph;
+	struct opal_priv_hdr_scn privhdr;
+	struct opal_priv_hdr_scn *ph = NULL;
 	int header_pos;
 	struct header_id *hdr_data;
 	char *start = buf;
+	char *end = buf + buflen;
 	int nrsections = 0;
 	int is_error = 0;
 	int i;
@@ -42,18 +45,20 @@ int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **r_lo
 	*r_log = NULL;
 
 	if (is_esel_header(buf)) {
-		print_esel_header(buf);
+		if (!quiet)
+			print_esel_header(buf);
 		buf += sizeof(struct esel_header);
 	}
 
-	while (buflen) {
-		rc = parse_section_header(&hdr, buf, buflen);
+	while (buf < end) {
+		rc = parse_section_header(&hdr, buf, end - buf);
 		if (rc < 0) {
 			break;
 		}
 
 		header_pos = header_id_lookup(elog_hdr_id, HEADER_ORDER_MAX, hdr.id);
 		if (header_pos == -1) {
+			if (!quiet) {
 				printf("Unknown section header: %c%c at %lu:\n",
 						hdr.id[0], hdr.id[1], buf-start);
 				printf("Length: %u (incl 8 byte header)\n", hdr.length);
@@ -69,8 +74,10 @@ int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **r_lo
 							(isgraph(*(buf+i)) | isspace(*(buf+i))) ?
 							*(buf+i) : '.');
 				}
+			}
 
-				continue;
+			buf += hdr.length;
+			continue;
 		}
 
 		hdr_data = &elog_hdr_id[header_pos];
@@ -97,14 +104,16 @@ int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **r_lo
 		}
 
 		if (strncmp(hdr.id, "PH", 2) == 0) {
-			if (parse_priv_hdr_scn(&ph, &hdr, buf, buflen) == 0) {
-				log = create_opal_event_log(ph->scn_count);
+			if (parse_priv_hdr_scn(&privhdr, &hdr, buf, end - buf) == 0) {
+				/* Everything parsed from here on is in the log's arena */
+				log = create_opal_event_log(privhdr.scn_count);
 				if (!log) {
-					free(ph);
 					fprintf(stderr, "ERROR %s: Could not allocate internal log buffer\n",
 							__func__);
 					return -ENOMEM;
 				}
+				ph = opal_event_log_alloc(log, sizeof(*ph));
+				*ph = privhdr;
 				add_opal_event_log_scn(log, "PH", ph, log_pos++);
 			} else {
 				/* We didn't parse the private header and therefore couldn't malloc
@@ -114,90 +123,96 @@ int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **r_lo
 						" cannot continue\n", __func__);
 				return -EINVAL;
 			}
+		} else if (!log) {
+			fprintf(stderr, "ERROR %s: Section %c%c found before the private "
+					"header, cannot continue\n", __func__,
+					hdr.id[0], hdr.id[1]);
+			rc = -EINVAL;
+			break;
 		} else if (strncmp(hdr.id, "UH", 2) == 0) {
 			struct opal_usr_hdr_scn *usr;
-			if (parse_usr_hdr_scn(&usr, &hdr, buf, buflen,
-					      &is_error) == 0) {
+			if (parse_usr_hdr_scn(&usr, &hdr, buf, end - buf,
+					      &is_error, log) == 0) {
 				add_opal_event_log_scn(log, "UH", usr, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "PS", 2) == 0) {
 			struct opal_src_scn *src;
-			if (parse_src_scn(&src, &hdr, buf, buflen) == 0) {
+			if (parse_src_scn(&src, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "PS", src, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "EH", 2) == 0) {
 			struct opal_eh_scn *eh;
-			if (parse_eh_scn(&eh, &hdr, buf, buflen) == 0) {
+			if (parse_eh_scn(&eh, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "EH", eh, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "MT", 2) == 0) {
 			struct opal_mtms_scn *mtms;
-			if (parse_mtms_scn(&mtms, &hdr, buf, buflen) == 0) {
+			if (parse_mtms_scn(&mtms, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "MT", mtms, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "SS", 2) == 0) {
 			struct opal_src_scn *src;
-			if (parse_src_scn(&src, &hdr, buf, buflen) == 0) {
+			if (parse_src_scn(&src, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "SS", src, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "DH", 2) == 0) {
 			struct opal_dh_scn *dh;
-			if (parse_dh_scn(&dh, &hdr, buf, buflen) == 0) {
+			if (parse_dh_scn(&dh, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "DH", dh, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "SW", 2) == 0) {
 			struct opal_sw_scn *sw;
-			if (parse_sw_scn(&sw, &hdr, buf, buflen) == 0) {
+			if (parse_sw_scn(&sw, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "SW", sw, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "LP", 2) == 0) {
 			struct opal_lp_scn *lp;
-			if (parse_lp_scn(&lp, &hdr, buf, buflen) == 0) {
+			if (parse_lp_scn(&lp, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "LP", lp, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "LR", 2) == 0) {
 			struct opal_lr_scn *lr;
-			if (parse_lr_scn(&lr, &hdr, buf, buflen) == 0) {
+			if (parse_lr_scn(&lr, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "LR", lr, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "HM", 2) == 0) {
 			struct opal_hm_scn *hm;
-			if (parse_hm_scn(&hm, &hdr, buf, buflen) == 0) {
+			if (parse_hm_scn(&hm, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "HM", hm, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "EP", 2) == 0) {
 			struct opal_ep_scn *ep;
-			if (parse_ep_scn(&ep, &hdr, buf, buflen) == 0) {
+			if (parse_ep_scn(&ep, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "EP", ep, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "IE", 2) == 0) {
 			struct opal_ie_scn *ie;
-			if (parse_ie_scn(&ie, &hdr, buf, buflen) == 0) {
+			if (parse_ie_scn(&ie, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "IE", ie, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "MI", 2) == 0) {
 			struct opal_mi_scn *mi;
-			if (parse_mi_scn(&mi, &hdr, buf, buflen) == 0) {
+			if (parse_mi_scn(&mi, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "MI", mi, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "CH", 2) == 0) {
 			struct opal_ch_scn *ch;
-			if (parse_ch_scn(&ch, &hdr, buf, buflen) == 0) {
+			if (parse_ch_scn(&ch, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "CH", ch, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "UD", 2) == 0) {
 			struct opal_ud_scn *ud;
-			if (parse_ud_scn(&ud, &hdr, buf, buflen) == 0) {
+			if (parse_ud_scn(&ud, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "UD", ud, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "EI", 2) == 0) {
 			struct opal_ei_scn *ei;
-			if (parse_ei_scn(&ei, &hdr, buf, buflen) == 0) {
+			if (parse_ei_scn(&ei, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "EI", ei, log_pos++);
 			}
 		} else if (strncmp(hdr.id, "ED", 2) == 0) {
 			struct opal_ed_scn *ed;
-			if (parse_ed_scn(&ed, &hdr, buf, buflen) == 0) {
+			if (parse_ed_scn(&ed, &hdr, buf, end - buf, log) == 0) {
 				add_opal_event_log_scn(log, "ED", ed, log_pos++);
 			}
 		}
@@ -237,7 +252,7 @@ int parse_opal_event(char *buf, int buflen)
 	int rc;
 	opal_event_log *log = NULL;
 
-	rc = parse_opal_event_log(buf, buflen, &log);
+	rc = parse_opal_event_log(buf, buflen, &log, 0);
 
 	if (log) {
 		print_opal_event_log(log);
@@ -6,7 +6,17 @@
 
 #include "opal-mtms-scn.h"
 
-int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **log);
+/*
+ * The sections of the log point into buf where they can (user data,
+ * readings and so on), so buf must not be freed before the log.  The
+ * log and all of its sections are freed with free_opal_event_log().
+ *
+ * Unless quiet is set the eSEL header and any section that cannot be
+ * parsed are printed to stdout as they are found.  Errors always go to
+ * stderr.
+ */
+int parse_opal_event_log(char *buf, int buflen, struct opal_event_log_scn **log,
+			 int quiet);
 
 int parse_opal_event(char *buf, int buflen);
 
@@ -11,13 +11,6 @@ int print_opal_v6_hdr(const struct opal_v6_hdr hdr);
 
 int print_usr_hdr_action(const struct opal_usr_hdr_scn *usrhdr);
 
-int get_field_desc(
-		struct generic_desc *data,
-		int length,
-		int id,
-		int default_id,
-		int default_index);
-
 int print_usr_hdr_event_data(const struct opal_usr_hdr_scn *usrhdr);
 
 int print_usr_hdr_subsystem_id(const struct opal_usr_hdr_scn *usrhdr);
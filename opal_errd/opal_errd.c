@@ -53,10 +53,12 @@
 #include "opal-elog-parse/opal-elog.h"
 #include "opal-elog-parse/opal-event-data.h"
 #include "opal-elog-parse/opal-esel-parse.h"
+#include "opal-elog-parse/opal-elog-summary.h"
 
 #define INOTIFY_FD	0
 #define UDEV_FD		1
 #define POLL_TIMEOUT	1000 /* In milliseconds */
+#define SWEEP_INTERVAL	60 /* In seconds, between full elog rescans */
 
 #define DEFAULT_SYSFS_PATH		"/sys"
 #define DEFAULT_DUMP_PATH		"firmware/opal/dump"
@@ -74,6 +76,11 @@
  */
 #define DEFAULT_MAX_ELOGS		1000
 
+/**
+ * Most elog IDs waiting to be read; beyond that the directory is rescanned
+ */
+#define MAX_PENDING_ELOGS		1024
+
 volatile int terminate;
 
 enum {
@@ -94,31 +101,21 @@ enum {
 static bool rotate_info_logs = false;
 static bool rotate_srvc_logs = false;
 
+/*
+ * Elogs named by inotify or udev are read directly; the whole elog
+ * directory is only scanned at startup, when a name may have been
+ * missed and every SWEEP_INTERVAL in case one was missed silently.
+ */
+static char pending_elogs[MAX_PENDING_ELOGS][ELOG_STR_SIZE];
+static int npending_elogs;
+static bool rescan_elogs = true;
+
 /* Safe to ignore sig, this only gets called on SIGTERM */
 static void term_handler(int sig)
 {
 	terminate = 1;
 }
 
-/* may move this into header to avoid code duplication */
-static bool is_regular_file(const struct dirent *d)
-{
-	struct stat sbuf;
-
-	if (d->d_type == DT_DIR)
-		return 0;
-	if (d->d_type == DT_REG)
-		return 1;
-	if (stat(d->d_name,&sbuf))
-		return 0;
-	if (S_ISDIR(sbuf.st_mode))
-		return 0;
-	if (d->d_type == DT_UNKNOWN)
-		return 1;
-
-	return 0;
-}
-
 /* Your job to free the return value */
 static char *find_opal_errd_dir(void)
 {
@@ -218,28 +215,14 @@ static int get_elog_filetype(const char *name)
 	return ret;
 }
 
-static int is_serviceable_elog_file(const struct dirent *d)
-{
-	if (is_regular_file(d) &&
-	    (get_elog_filetype(d->d_name) == OPAL_ELOG_SERVICEABLE))
-		return 1;
-
-	return 0;
-}
-
-static int is_informational_elog_file(const struct dirent *d)
+/* Elog file names, old ones without a type suffix included */
+static int is_elog_filename(const struct dirent *d)
 {
-	if (is_regular_file(d) &&
-	    (get_elog_filetype(d->d_name) == OPAL_ELOG_INFORMATIONAL))
-		return 1;
-
-	return 0;
-}
+	if (d->d_type != DT_REG && d->d_type != DT_UNKNOWN)
+		return 0;
 
-static int is_suffixless_elog_filename(const struct dirent *d)
-{
-	if (strstr(d->d_name, "-0x") && is_regular_file(d) &&
-	    (get_elog_filetype(d->d_name) == OPAL_ELOG_INVALID))
+	if (get_elog_filetype(d->d_name) != OPAL_ELOG_INVALID ||
+	    strstr(d->d_name, "-0x"))
 		return 1;
 
 	return 0;
@@ -293,26 +276,114 @@ out:
 }
 
 /*
- * The pruning logic depends on the file name formatting to determine the log
- * type before considering them for pruning. The old log files which are in
- * the naming format of <timestamp>-<logid> are renamed here to
- * <timestamp>-<logid>-<elog_type>.
+ * The elog files retained of each type, oldest first, kept as a ring.
+ * It is built from the output directory once at startup and then kept
+ * up to date as elogs are written and rotated out, so rotation does not
+ * have to look at the directory again.
+ */
+struct elog_index {
+	char	**names;
+	int	first;
+	int	count;
+	int	size;
+};
+
+/* Indexed by elog type */
+static struct elog_index elog_index[2];
+
+/*
+ * Summary index for opal-elog-parse, kept locked while the output
+ * directory is being changed
  */
-static void rename_old_logs(const char *output_dir)
+static struct summary_index elog_summaries = { -1, -1 };
+
+#define ELOG_INDEX_AT(idx, i)	((idx)->names[((idx)->first + (i)) % (idx)->size])
+
+static int elog_index_grow(struct elog_index *idx)
+{
+	int new_size = idx->size ? idx->size * 2 : 256;
+	char **names;
+	int i;
+
+	names = malloc(new_size * sizeof(*names));
+	if (!names)
+		return -1;
+
+	for (i = 0; i < idx->count; i++)
+		names[i] = ELOG_INDEX_AT(idx, i);
+
+	free(idx->names);
+	idx->names = names;
+	idx->first = 0;
+	idx->size = new_size;
+	return 0;
+}
+
+/* Add a file, normally the newest, in name order */
+static void elog_index_add(int elog_type, const char *name)
+{
+	struct elog_index *idx = &elog_index[elog_type];
+	char *copy;
+	int pos, cmp = 1;
+
+	if (idx->count == idx->size && elog_index_grow(idx))
+		goto err;
+
+	/* Only an older timestamp (a clock set back) gets further */
+	for (pos = idx->count; pos > 0; pos--) {
+		cmp = strcmp(name, ELOG_INDEX_AT(idx, pos - 1));
+		if (cmp >= 0)
+			break;
+	}
+	if (pos > 0 && cmp == 0)
+		return;	/* rewritten in place */
+
+	copy = strdup(name);
+	if (!copy)
+		goto err;
+
+	for (cmp = idx->count; cmp > pos; cmp--)
+		ELOG_INDEX_AT(idx, cmp) = ELOG_INDEX_AT(idx, cmp - 1);
+	ELOG_INDEX_AT(idx, pos) = copy;
+	idx->count++;
+	return;
+
+err:
+	syslog(LOG_NOTICE, "Failed to allocate memory, %s will not be "
+	       "rotated out\n", name);
+}
+
+static int compare_names(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*
+ * Build the index from the output directory.
+ *
+ * The pruning logic depends on the file name formatting to determine the
+ * log type. The old log files which are in the naming format of
+ * <timestamp>-<logid> are renamed here to <timestamp>-<logid>-<elog_type>.
+ */
+static void init_elog_index(const char *output_dir)
 {
 	int n;
 	int dir_fd = -1;
-	size_t i;
+	int i;
+	int renamed = 0;
 	char oldname[PATH_MAX];
 	char newname[PATH_MAX];
 	int elog_type;
-	char *out_dir = NULL;
 	struct dirent **namelist;
 	struct dirent *dirent;
+	struct stat sbuf;
 
-	n = scandir(output_dir, &namelist, is_suffixless_elog_filename, alphasort);
-	if (n < 0)
+	n = scandir(output_dir, &namelist, is_elog_filename, alphasort);
+	if (n < 0) {
+		syslog(LOG_NOTICE, "Error scanning the log directory %s\n",
+		       output_dir);
 		return;
+	}
 
 	for (i = 0; i < n; i++) {
 		dirent = namelist[i];
@@ -324,6 +395,19 @@ static void rename_old_logs(const char *output_dir)
 		snprintf(oldname, sizeof(oldname), "%s/%s",
 			 output_dir, dirent->d_name);
 
+		if (dirent->d_type == DT_UNKNOWN &&
+		    (stat(oldname, &sbuf) || !S_ISREG(sbuf.st_mode))) {
+			free(namelist[i]);
+			continue;
+		}
+
+		elog_type = get_elog_filetype(dirent->d_name);
+		if (elog_type != OPAL_ELOG_INVALID) {
+			elog_index_add(elog_type, dirent->d_name);
+			free(namelist[i]);
+			continue;
+		}
+
 		elog_type = get_elog_type_from_file_data(oldname);
 		if (elog_type == OPAL_ELOG_INVALID) {
 			free(namelist[i]);
@@ -336,78 +420,64 @@ static void rename_old_logs(const char *output_dir)
 		if (rename(oldname, newname) < 0) {
 			syslog(LOG_WARNING, "Couldn't rename logfile %s to "
 			       "%s : %s\n", oldname, newname, strerror(errno));
+		} else {
+			elog_index_add(elog_type, basename(newname));
+			summary_index_invalidate(&elog_summaries);
+			renamed = 1;
 		}
 		free(namelist[i]);
 	}
 	free(namelist);
 
-	out_dir = strdup(output_dir);
-	if (!out_dir)
+	/* Renamed files may sort differently from the new names */
+	for (i = 0; i < 2; i++) {
+		if (elog_index[i].count)
+			qsort(elog_index[i].names, elog_index[i].count,
+			      sizeof(char *), compare_names);
+	}
+
+	if (!renamed)
 		return;
 
-	dir_fd = open(dirname(out_dir), O_RDONLY|O_DIRECTORY);
+	dir_fd = open(output_dir, O_RDONLY|O_DIRECTORY);
 	if (dir_fd == -1) {
 		syslog(LOG_NOTICE, "Failed to open platform elog directory: %s"
-		       " (%d:%s)\n", out_dir, errno, strerror(errno));
+		       " (%d:%s)\n", output_dir, errno, strerror(errno));
 	} else {
 		if (fsync(dir_fd) == -1)
 			syslog(LOG_NOTICE, "Failed to sync platform elog "
 			       "directory: %s (%d:%s)\n",
-			       out_dir, errno, strerror(errno));
+			       output_dir, errno, strerror(errno));
 		close(dir_fd);
 	}
-
-	free(out_dir);
 }
 
+/*
+ * Remove the oldest files of a type beyond max_logs.  A file that
+ * cannot be removed stays at the head of the index, so the next
+ * rotation tries it again.
+ */
 static void rotate_logs(const char *elog_dir, int max_logs, int elog_type)
 {
-	int i;
-	int nfiles;
-	int ret = 0;
-	int trim = 1;
-	struct dirent **filelist;
-	int (* filter)(const struct dirent *);
-
-	if (elog_type == OPAL_ELOG_SERVICEABLE)
-		filter = &is_serviceable_elog_file;
-	else
-		filter = &is_informational_elog_file;
-
-	/* Retrieve file list */
-	if (chdir(elog_dir) < 0) {
-		syslog(LOG_NOTICE, "chdir failed\n");
-		return;
-	}
+	struct elog_index *idx = &elog_index[elog_type];
+	char path[PATH_MAX];
+	char *name;
 
-	nfiles = scandir(elog_dir, &filelist, filter, alphasort);
-	if (nfiles < 0) {
-		syslog(LOG_NOTICE, "Error scanning the log directory %s\n",
-					elog_dir);
-		return;
-	}
+	while (idx->count > max_logs) {
+		name = ELOG_INDEX_AT(idx, 0);
 
-	for (i = 0; i < nfiles; i++) {
-		if (!trim){
-			free(filelist[i]);
-			continue;
+		snprintf(path, sizeof(path), "%s/%s", elog_dir, name);
+		if (remove(path) && errno != ENOENT) {
+			syslog(LOG_NOTICE, "Error removing %s: %s\n", name,
+			       strerror(errno));
+			break;
 		}
 
-		/* Names are ordered 'oldest first' from scandir */
-		if (i >= (nfiles - max_logs))
-			trim = 0;
-
-		if (trim) {
-			ret = remove(filelist[i]->d_name);
-			if(ret)
-				syslog(LOG_NOTICE, "Error removing %s\n",
-				       filelist[i]->d_name);
-		}
-		free(filelist[i]);
+		idx->first = (idx->first + 1) % idx->size;
+		idx->count--;
+		summary_index_remove(&elog_summaries, name);
+		free(name);
 	}
-	free(filelist);
-
-	return;
 }
 
 /* Parse required fields from error log */
@@ -560,11 +630,28 @@ static int ack_elog(const char *elog_path)
 	return 0;
 }
 
+/*
+ * Buffer for the elog being copied, kept from one elog to the next
+ */
+static char *elog_buf;
+static size_t elog_buf_size;
+
+/*
+ * Elogs copied but not yet acknowledged.  They are acknowledged
+ * together once the output directory has been synced, so that an elog
+ * is never acknowledged before its copy is on disk.
+ */
+#define ELOG_BATCH_MAX	64
+
+static char *batch_elogs[ELOG_BATCH_MAX];
+static int nbatch_elogs;
+
+/* Copy an elog to the output directory and sync the copy */
 static int process_elog(const char *elog_path, const char *output)
 {
 	int in_fd = -1;
 	int out_fd = -1;
-	int dir_fd = -1;
+	struct elog_summary summary;
 	char elog_raw_path[PATH_MAX];
 	char *name;
 	size_t bufsz;
@@ -573,9 +660,9 @@ static int process_elog(const char *elog_path, const char *output)
 	ssize_t sz = 0;
 	ssize_t readsz = 0;
 	int rc;
-	char *output_dir = NULL;
-	char *buf = NULL;
+	char *buf;
 	char output_file[PATH_MAX];
+	char *file_name;
 	int elog_type;
 
 	rc = snprintf(elog_raw_path, sizeof(elog_raw_path),
@@ -589,11 +676,16 @@ static int process_elog(const char *elog_path, const char *output)
 		goto err;
 
 	bufsz = sbuf.st_size;
-	buf = malloc(bufsz);
-	if (!buf) {
-		syslog(LOG_ERR, "Failed to allocate memory\n");
-		goto err;
+	if (bufsz > elog_buf_size) {
+		buf = realloc(elog_buf, bufsz);
+		if (!buf) {
+			syslog(LOG_ERR, "Failed to allocate memory\n");
+			goto err;
+		}
+		elog_buf = buf;
+		elog_buf_size = bufsz;
 	}
+	buf = elog_buf;
 
 	in_fd = open(elog_raw_path, O_RDONLY);
 	if (in_fd == -1) {
@@ -609,6 +701,11 @@ static int process_elog(const char *elog_path, const char *output)
 			       elog_raw_path, errno, strerror(errno));
 			goto err;
 		}
+		if (readsz == 0) {
+			syslog(LOG_ERR, "Elog shorter than expected: %s\n",
+			       elog_raw_path);
+			goto err;
+		}
 
 		sz += readsz;
 	} while(sz != bufsz);
@@ -651,35 +748,101 @@ static int process_elog(const char *elog_path, const char *output)
 		goto err;
 	}
 
-	output_dir = strdup(output);
-	if (!output_dir)
-		goto err;
+	file_name = output_file + strlen(output) + 1;
+	elog_index_add(elog_type, file_name);
 
-	dir_fd = open(dirname(output_dir), O_RDONLY|O_DIRECTORY);
-	if (dir_fd == -1) {
-		syslog(LOG_ERR, "Failed to open platform elog directory: %s"
-		       " (%d:%s)\n", output_dir, errno, strerror(errno));
-	} else {
-		rc = fsync(dir_fd);
-		if (rc == -1)
-			syslog(LOG_ERR, "Failed to sync platform elog "
-			       "directory: %s (%d:%s)\n",
-			       output_dir, errno, strerror(errno));
-	}
+	if (elog_summary_fill(&summary, file_name, buf, bufsz) == 0)
+		summary_index_add(&elog_summaries, &summary);
+	else
+		summary_index_invalidate(&elog_summaries);
 
 	ret = 0;
 err:
 	if (in_fd != -1)
 		close(in_fd);
-	if (out_fd != -1)
+	if (out_fd != -1) {
+		/* A file left behind is not in the summary index */
+		if (ret)
+			summary_index_invalidate(&elog_summaries);
 		close(out_fd);
-	if (dir_fd != -1)
-		close(dir_fd);
-	free(output_dir);
-	free(buf);
+	}
 	return ret;
 }
 
+/* Make the names of the files created in the output directory durable */
+static int sync_output_dir(const char *output)
+{
+	int dir_fd;
+	int rc;
+
+	dir_fd = open(output, O_RDONLY|O_DIRECTORY);
+	if (dir_fd == -1) {
+		syslog(LOG_ERR, "Failed to open platform elog directory: %s"
+		       " (%d:%s)\n", output, errno, strerror(errno));
+		return -1;
+	}
+
+	rc = fsync(dir_fd);
+	if (rc == -1)
+		syslog(LOG_ERR, "Failed to sync platform elog "
+		       "directory: %s (%d:%s)\n",
+		       output, errno, strerror(errno));
+	close(dir_fd);
+
+	return rc;
+}
+
+/*
+ * Sync the output directory, then acknowledge the elogs copied to it.
+ * If the copies may not survive a crash, the elogs are left with the
+ * firmware to be read again rather than acknowledged.
+ */
+static void commit_elog_batch(const char *output)
+{
+	int i;
+	int rc;
+
+	if (nbatch_elogs == 0)
+		return;
+
+	/* One sync for all of the new files */
+	rc = sync_output_dir(output);
+	if (rc)
+		syslog(LOG_ERR, "Not acknowledging %d elog(s)\n",
+		       nbatch_elogs);
+
+	for (i = 0; i < nbatch_elogs; i++) {
+		if (rc == 0)
+			ack_elog(batch_elogs[i]);
+		free(batch_elogs[i]);
+	}
+	nbatch_elogs = 0;
+}
+
+/* Copy an elog and queue it to be acknowledged with the batch */
+static int read_elog(const char *elog_path, const char *output)
+{
+	char *path;
+	int rc;
+
+	rc = process_elog(elog_path, output);
+
+	path = strdup(elog_path);
+	if (!path) {
+		/* Acknowledge it on its own */
+		commit_elog_batch(output);
+		if (sync_output_dir(output) == 0)
+			ack_elog(elog_path);
+		return rc;
+	}
+
+	batch_elogs[nbatch_elogs++] = path;
+	if (nbatch_elogs == ELOG_BATCH_MAX)
+		commit_elog_batch(output);
+
+	return rc;
+}
+
 /* Read logs from opal sysfs interface */
 static int find_and_read_elog_events(const char *elog_dir, const char *output_path)
 {
@@ -727,12 +890,11 @@ static int find_and_read_elog_events(const char *elog_dir, const char *output_pa
 		}
 
 		if (is_dir) {
-			rc = process_elog(elog_path, output_path);
+			rc = read_elog(elog_path, output_path);
 			if (rc != 0 && retval == 0)
 				retval = -1;
 			if (rc == 0 && retval >= 0)
 				retval++;
-			ack_elog(elog_path);
 		}
 
 		free(namelist[i]);
@@ -740,9 +902,119 @@ static int find_and_read_elog_events(const char *elog_dir, const char *output_pa
 
 	free(namelist);
 
+	commit_elog_batch(output_path);
+
+	return retval;
+}
+
+/* Remember an elog to read, by its ID (eg: 0x12345678) */
+static void queue_elog(const char *name)
+{
+	int i;
+
+	if (strncmp(name, "0x", 2) || strlen(name) >= ELOG_STR_SIZE) {
+		/* Not an elog ID, have a look at everything */
+		rescan_elogs = true;
+		return;
+	}
+
+	for (i = 0; i < npending_elogs; i++) {
+		if (!strcmp(pending_elogs[i], name))
+			return;
+	}
+
+	if (npending_elogs == MAX_PENDING_ELOGS) {
+		rescan_elogs = true;
+		return;
+	}
+
+	strcpy(pending_elogs[npending_elogs++], name);
+}
+
+static int compare_elog_names(const void *a, const void *b)
+{
+	return strcmp(a, b);
+}
+
+/* Read the elogs queued by queue_elog() */
+static int read_pending_elog_events(const char *elog_dir,
+				    const char *output_path)
+{
+	char elog_path[PATH_MAX];
+	struct stat sbuf;
+	int retval = 0;
+	int rc;
+	int i;
+
+	/* In the order a directory scan would have found them */
+	qsort(pending_elogs, npending_elogs, ELOG_STR_SIZE,
+	      compare_elog_names);
+
+	for (i = 0; i < npending_elogs; i++) {
+		snprintf(elog_path, sizeof(elog_path), "%s/%s",
+			 elog_dir, pending_elogs[i]);
+
+		/* Already read and acknowledged */
+		if (stat(elog_path, &sbuf) == -1 || !S_ISDIR(sbuf.st_mode))
+			continue;
+
+		rc = read_elog(elog_path, output_path);
+		if (rc != 0 && retval == 0)
+			retval = -1;
+		if (rc == 0 && retval >= 0)
+			retval++;
+	}
+
+	npending_elogs = 0;
+
+	commit_elog_batch(output_path);
+
 	return retval;
 }
 
+/* Queue the elogs named in a buffer of inotify events */
+static void read_inotify_events(const char *buf, ssize_t len, int elog_wd)
+{
+	const struct inotify_event *event;
+	const char *p;
+
+	for (p = buf; p < buf + len;
+	     p += sizeof(struct inotify_event) + event->len) {
+		event = (const struct inotify_event *)p;
+
+		if (event->mask & IN_Q_OVERFLOW)
+			rescan_elogs = true;
+		else if (event->wd == elog_wd && event->len)
+			queue_elog(event->name);
+		else if (event->len && !strcmp(event->name, "elog"))
+			/* The elog directory itself (re)appeared */
+			rescan_elogs = true;
+	}
+}
+
+/* Queue the elog a udev event is about */
+static void read_udev_event(struct udev_device *udev_dev)
+{
+	const char *subsystem, *action, *devpath;
+
+	subsystem = udev_device_get_subsystem(udev_dev);
+	action = udev_device_get_action(udev_dev);
+	devpath = udev_device_get_devpath(udev_dev);
+
+	/* Dumps are checked for on every pass anyway */
+	if (!subsystem || strcmp(subsystem, "elog"))
+		return;
+
+	/* Removed ones are those we acknowledged */
+	if (action && strcmp(action, "add"))
+		return;
+
+	if (devpath && strrchr(devpath, '/'))
+		queue_elog(strrchr(devpath, '/') + 1);
+	else
+		rescan_elogs = true;
+}
+
 static char *validate_extract_opal_dump(const char *cmd)
 {
 	char *extract_opal_dump_cmd = NULL;
@@ -857,11 +1129,14 @@ int main(int argc, char *argv[])
 	struct udev_monitor *udev_mon = NULL;
 	struct udev_device *udev_dev = NULL;
 	struct pollfd fds[2];
+	struct pollfd udev_pfd;
 	fds[INOTIFY_FD].fd = -1;
-	char inotifybuf[sizeof(struct inotify_event) + NAME_MAX + 1];
+	char inotifybuf[64 * (sizeof(struct inotify_event) + NAME_MAX + 1)]
+		__attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t inotifylen;
+	int elog_wd;
+	struct timespec now, last_sweep = { 0, 0 };
 
-	const char *devpath;
-	char elog_str_name[ELOG_STR_SIZE];
 	struct sigaction siga;
 
 	int opt_daemon = 1;
@@ -1018,6 +1293,9 @@ int main(int argc, char *argv[])
 		goto exit;
 	}
 
+	/* New elogs by name, where the directory supports it */
+	elog_wd = inotify_add_watch(fds[INOTIFY_FD].fd, elog_path, IN_CREATE);
+
 	rc = opal_init_udev(&udev, &udev_mon, &(fds[UDEV_FD].fd));
 	if (rc != 0)
 		goto exit;
@@ -1047,14 +1325,33 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	rename_old_logs(opt_output_dir);
+	summary_index_lock(&elog_summaries, opt_output_dir);
+	init_elog_index(opt_output_dir);
+	summary_index_unlock(&elog_summaries);
 
 	fds[INOTIFY_FD].events = POLLIN;
 	fds[UDEV_FD].events = POLLIN;
 	/* Read error/event log until we get termination signal */
 	while (!terminate) {
 		rotate_srvc_logs = rotate_info_logs = false;
-		find_and_read_elog_events(elog_path, opt_output_dir);
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (now.tv_sec - last_sweep.tv_sec >= SWEEP_INTERVAL)
+			rescan_elogs = true;
+
+		/* A missing index only means opal-elog-parse rebuilds it */
+		if (rescan_elogs || npending_elogs)
+			summary_index_lock(&elog_summaries, opt_output_dir);
+
+		if (rescan_elogs) {
+			/* Finds the pending ones too */
+			rescan_elogs = false;
+			npending_elogs = 0;
+			last_sweep = now;
+			find_and_read_elog_events(elog_path, opt_output_dir);
+		} else if (npending_elogs) {
+			read_pending_elog_events(elog_path, opt_output_dir);
+		}
 
 		if (rotate_srvc_logs) {
 			rotate_logs(opt_output_dir, max_serviceable_logs,
@@ -1065,6 +1362,8 @@ int main(int argc, char *argv[])
 				    OPAL_ELOG_INFORMATIONAL);
 		}
 
+		summary_index_unlock(&elog_summaries);
+
 		if (extract_opal_dump_cmd)
 			check_platform_dump(extract_opal_dump_cmd,
 					opt_sysfs, opt_max_dump);
@@ -1072,27 +1371,33 @@ int main(int argc, char *argv[])
 		if (!opt_watch) {
 			terminate = 1;
 		} else {
-			/* We don't care about the content of the inotify
-			 * event, we'll just scan the directory anyway
-			 */
+			/* Only the elogs named by the events are read */
 			rc = poll(fds, sizeof(fds)/sizeof(struct pollfd), POLL_TIMEOUT);
 			if (rc > 0 && fds[INOTIFY_FD].revents) {
-				if (read(fds[INOTIFY_FD].fd, inotifybuf, sizeof(inotifybuf)) == -1) {
+				inotifylen = read(fds[INOTIFY_FD].fd, inotifybuf,
+						  sizeof(inotifybuf));
+				if (inotifylen == -1) {
 					syslog(LOG_WARNING, "Can not read platform log directory:"
 					       " (%d:%s)\n", errno, strerror(errno));
 					goto exit;
 				}
+				read_inotify_events(inotifybuf, inotifylen, elog_wd);
 			}
 
 			if (rc > 0 && fds[UDEV_FD].revents) {
-				udev_dev = udev_monitor_receive_device(udev_mon);
-				devpath = udev_device_get_devpath(udev_dev);
-				if (devpath && strrchr(devpath, '/'))
-					strncpy(elog_str_name, strrchr(devpath, '/'), ELOG_STR_SIZE);
-				udev_device_unref(udev_dev);
-				/* The id of the elog should be in elog_str_name
-				 * Perhaps more can be done with the udev information
-				 */
+				/* Take all of an elog storm in one go */
+				udev_pfd.fd = fds[UDEV_FD].fd;
+				udev_pfd.events = POLLIN;
+				do {
+					udev_dev = udev_monitor_receive_device(udev_mon);
+					if (!udev_dev) {
+						rescan_elogs = true;
+						break;
+					}
+					read_udev_event(udev_dev);
+					udev_device_unref(udev_dev);
+				} while (npending_elogs < MAX_PENDING_ELOGS &&
+					 poll(&udev_pfd, 1, 0) > 0);
 			}
 		}
 		rc = 0;
@@ -1108,6 +1413,7 @@ exit:
 		close(fds[INOTIFY_FD].fd);
 
 	free(extract_opal_dump_cmd);
+	free(elog_buf);
 	closelog();
 	return rc;
 }
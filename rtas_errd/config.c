@@ -601,6 +601,54 @@ parse_config_entries(char *buf, char *buf_end, int update_sysconfig)
 				break;
 			}
 
+		/* StatsFile */
+		} else if (strcmp(tok, "StatsFile") == 0) {
+			cur = get_config_string(cur, buf_end,
+						d_cfg.stats_file, &line_no);
+			if (cur == NULL) {
+				d_cfg.log_msg("Parsing error for "
+					      "configuration file entry "
+					      "\"StatsFile\", line %d",
+					      line_no);
+				rc = -1;
+				break;
+			}
+
+			d_cfg.log_msg("Configuring Statistics File to "
+				      "\"%s\"", d_cfg.stats_file);
+
+		/* LogFlushPolicy */
+		} else if (strcmp(tok, "LogFlushPolicy") == 0) {
+			char policy[1024];
+
+			cur = get_config_string(cur, buf_end, policy, &line_no);
+			if (cur == NULL) {
+				d_cfg.log_msg("Parsing error for "
+					      "configuration file entry "
+					      "\"LogFlushPolicy\", line %d",
+					      line_no);
+				rc = -1;
+				break;
+			}
+
+			if (strcmp(policy, "async") == 0)
+				d_cfg.log_flush_policy = LOG_FLUSH_ASYNC;
+			else if (strcmp(policy, "event") == 0)
+				d_cfg.log_flush_policy = LOG_FLUSH_EVENT;
+			else if (strcmp(policy, "sync") == 0)
+				d_cfg.log_flush_policy = LOG_FLUSH_SYNC;
+			else {
+				d_cfg.log_msg("Invalid value \"%s\" for "
+					      "LogFlushPolicy (line %d), "
+					      "expecting async, event or sync",
+					      policy, line_no);
+				rc = -1;
+				break;
+			}
+
+			d_cfg.log_msg("Configuring Log Flush Policy to %s",
+				      policy);
+
 		} 
 		else {
 			d_cfg.log_msg("Configuration error: \"%s\", line %d, "
@@ -626,8 +674,10 @@ init_d_cfg(void (*log_msg)(char *, ...))
 	
 	strcpy(d_cfg.scanlog_dump_path, "/var/log/");
 	strcpy(d_cfg.platform_dump_path, "/var/log/dump/");
+	strcpy(d_cfg.stats_file, "/var/log/rtas_errd.prom");
 
 	d_cfg.restart_policy = -1;
+	d_cfg.log_flush_policy = LOG_FLUSH_ASYNC;
 
 	d_cfg.log_msg = log_msg;
 };
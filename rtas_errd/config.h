@@ -34,12 +34,20 @@ struct ppc64_diag_config {
 	int			min_entitled_capacity;
 	char			scanlog_dump_path[512];
 	char			platform_dump_path[512];
+	char			stats_file[512];
 	int			restart_policy;
+	int			log_flush_policy;
 	void			(*log_msg)(char *, ...);
 };
 
 #define RE_CFG_RECEIVED_SIGHUP	0x00000001
 #define RE_CFG_RECFG_SAFE	0x00000002
+#define RE_CFG_RECEIVED_SIGTERM	0x00000004
+
+/* log_flush_policy values, see log_ring.c */
+#define LOG_FLUSH_ASYNC		0
+#define LOG_FLUSH_EVENT		1
+#define LOG_FLUSH_SYNC		2
 
 extern struct ppc64_diag_config d_cfg;
 
@@ -31,43 +31,55 @@
 #include "utils.h"
 #include "rtas_errd.h"
 
+#ifndef CMD_LSVPD
 #define CMD_LSVPD "/usr/sbin/lsvpd"
+#endif
 
 char target_status[80];
 
+static void
+free_vpd_fields(struct diag_vpd *vpd)
+{
+	free(vpd->ds);
+	free(vpd->yl);
+	free(vpd->fn);
+	free(vpd->sn);
+	free(vpd->se);
+	free(vpd->tm);
+	memset(vpd, 0, sizeof(*vpd));
+}
+
+/* The fields are in the event's arena and go with it */
 void
 free_diag_vpd(struct event *event)
 {
-	if (event->diag_vpd.ds != NULL) {
-		free(event->diag_vpd.ds);
-		event->diag_vpd.ds = NULL;
-	}
-
-	if (event->diag_vpd.yl != NULL) {
-		free(event->diag_vpd.yl);
-		event->diag_vpd.yl = NULL;
-	}
-
-	if (event->diag_vpd.fn != NULL) {
-		free(event->diag_vpd.fn);
-		event->diag_vpd.fn = NULL;
-	}
-
-	if (event->diag_vpd.sn != NULL) {
-		free(event->diag_vpd.sn);
-		event->diag_vpd.sn = NULL;
-	}
+	memset(&event->diag_vpd, 0, sizeof(event->diag_vpd));
+}
 
-	if (event->diag_vpd.se != NULL) {
-		free(event->diag_vpd.se);
-		event->diag_vpd.se = NULL;
-	}
+/**
+ * struct vpd_entry
+ * @brief One lsvpd record in the VPD cache
+ */
+struct vpd_entry {
+	struct diag_vpd	vpd;
+	int		order;	/**< position in the lsvpd output */
+};
 
-	if (event->diag_vpd.tm != NULL) {
-		free(event->diag_vpd.tm);
-		event->diag_vpd.tm = NULL;
-	}
-}
+/**
+ * @var vpd_cache
+ * @brief Every lsvpd record that has a location code, sorted by it
+ *
+ * lsvpd walks the whole system every time it runs, so its output is
+ * read once and kept until the hardware configuration changes (see
+ * invalidate_vpd_cache()).  The first lookup that misses after that
+ * reloads it once more, in case the change was made without rtas_errd
+ * seeing an event for it; later misses are answered from the cache.
+ */
+static struct vpd_entry *vpd_cache;
+static int vpd_cache_count;
+static int vpd_cache_size;
+static int vpd_cache_valid;
+static int vpd_cache_retried;	/**< a miss has reloaded the cache */
 
 /*
  * Execute the 'lsvpd' command and open a pipe to read the data
@@ -110,106 +122,141 @@ lsvpd_term(FILE *fp, pid_t *cpid)
         return rc;
 }
 
+static void
+free_vpd_cache(void)
+{
+	int i;
 
+	for (i = 0; i < vpd_cache_count; i++)
+		free_vpd_fields(&vpd_cache[i].vpd);
+
+	vpd_cache_count = 0;
+	vpd_cache_valid = 0;
+}
 
-/*
- * Read the next lsvpd keyword, value pair
- */
 static int
-lsvpd_read(struct event *event, FILE *fp)
+vpd_entry_cmp(const void *a, const void *b)
 {
-	int rc = 1;
-	char line[512];
+	const struct vpd_entry *e1 = a, *e2 = b;
+	int rc;
 
-	dbg("start lsvpd_read");
+	rc = strcmp(e1->vpd.yl, e2->vpd.yl);
+	if (rc == 0)
+		rc = e1->order - e2->order;
 
-	if (!fp)
-		return rc;
+	return rc;
+}
 
-	/* clear all residual data */
-	free_diag_vpd(event);
+/*
+ * Add the record just read to the cache; records without a
+ * location code cannot be looked up and are dropped.
+ */
+static int
+vpd_cache_add(struct diag_vpd *vpd)
+{
+	struct vpd_entry *tmp;
 
-	while (fgets(line, sizeof(line), fp)) {
-		if (line[strlen(line) - 1] == '\n')
-			line[strlen(line) - 1] = '\0';
+	if (vpd->yl == NULL) {
+		free_vpd_fields(vpd);
+		return 0;
+	}
 
-		if (! strncmp(line, "*DS", 3)) {
-			event->diag_vpd.ds = malloc(strlen (line) + 1);
-			if (event->diag_vpd.ds == NULL)
-				return rc;
+	if (vpd_cache_count == vpd_cache_size) {
+		int new_size = vpd_cache_size ? vpd_cache_size * 2 : 256;
 
-			strcpy(event->diag_vpd.ds, &line[4]);
-			dbg("found DS: \"%s\"", event->diag_vpd.ds);
-		}
+		tmp = realloc(vpd_cache, new_size * sizeof(*vpd_cache));
+		if (tmp == NULL)
+			return 1;
 
-		if (! strncmp(line, "*YL", 3)) {
-			event->diag_vpd.yl = malloc(strlen (line) + 1);
-			if (event->diag_vpd.yl == NULL)
-				return rc;
+		vpd_cache = tmp;
+		vpd_cache_size = new_size;
+	}
 
-			strcpy(event->diag_vpd.yl, &line[4]);
-			dbg("found YL: \"%s\"", event->diag_vpd.yl);
-		}
+	vpd_cache[vpd_cache_count].vpd = *vpd;
+	vpd_cache[vpd_cache_count].order = vpd_cache_count;
+	vpd_cache_count++;
 
-		if (! strncmp(line, "*FN", 3)) {
-			event->diag_vpd.fn = malloc(strlen (line) + 1);
-			if (event->diag_vpd.fn == NULL)
-				return rc;
+	memset(vpd, 0, sizeof(*vpd));
+	return 0;
+}
 
-			strcpy(event->diag_vpd.fn, &line[4]);
-			dbg("found FN: \"%s\"", event->diag_vpd.fn);
-		}
+/*
+ * Read the lsvpd keyword, value pairs.  Records are separated by
+ * *FC lines.
+ */
+static int
+lsvpd_read(FILE *fp)
+{
+	struct diag_vpd vpd;
+	char line[512];
+	char **field;
+	char *value;
+	int len;
 
-		if (! strncmp(line, "*SN", 3)) {
-			event->diag_vpd.sn = malloc(strlen (line) + 1);
-			if (event->diag_vpd.sn == NULL)
-				return rc;
+	dbg("start lsvpd_read");
 
-			strcpy(event->diag_vpd.sn, &line[4]);
-			dbg("found SN: \"%s\"", event->diag_vpd.sn);
-		}
+	memset(&vpd, 0, sizeof(vpd));
 
-		if (! strncmp(line, "*SE", 3)) {
-			event->diag_vpd.se = malloc(strlen (line) + 1);
-			if (event->diag_vpd.se == NULL)
-				return rc;
+	while (fgets(line, sizeof(line), fp)) {
+		len = strlen(line);
+		if (len && line[len - 1] == '\n')
+			line[--len] = '\0';
 
-			strcpy(event->diag_vpd.se, &line[4]);
-			dbg("found SE: \"%s\"", event->diag_vpd.se);
+		if (! strncmp(line, "*FC", 3)) {
+			/* start of next record */
+			if (vpd_cache_add(&vpd))
+				goto err;
+			continue;
 		}
 
-		if (! strncmp(line, "*TM", 3)) {
-			event->diag_vpd.tm = malloc(strlen (line) + 1);
-			if (event->diag_vpd.tm == NULL)
-				return rc;
+		if (! strncmp(line, "*DS", 3))
+			field = &vpd.ds;
+		else if (! strncmp(line, "*YL", 3))
+			field = &vpd.yl;
+		else if (! strncmp(line, "*FN", 3))
+			field = &vpd.fn;
+		else if (! strncmp(line, "*SN", 3))
+			field = &vpd.sn;
+		else if (! strncmp(line, "*SE", 3))
+			field = &vpd.se;
+		else if (! strncmp(line, "*TM", 3))
+			field = &vpd.tm;
+		else
+			continue;
 
-			strcpy(event->diag_vpd.tm, &line[4]);
-			dbg("found TM: \"%s\"", event->diag_vpd.tm);
-		}
+		value = (len > 4) ? &line[4] : "";
 
-		if (! strncmp(line, "*FC", 3)) {
-			/* start of next record */
-			dbg("found FC - start next record");
-			return 0;
-		}
+		free(*field);
+		*field = strdup(value);
+		if (*field == NULL)
+			goto err;
 	}
 
-	dbg("end lsvpd_read");
+	if (vpd_cache_add(&vpd))
+		goto err;
+
+	dbg("end lsvpd_read, %d records", vpd_cache_count);
+	return 0;
+
+err:
+	free_vpd_fields(&vpd);
 	return 1;
 }
 
-
-int
-get_diag_vpd(struct event *event, char *phyloc)
+/**
+ * load_vpd_cache
+ * @brief Read the VPD of the whole system with a single lsvpd run
+ *
+ * @return 0 on success, 1 on failure
+ */
+static int
+load_vpd_cache(void)
 {
-	int rc = 0;
 	FILE *fp = NULL;
 	pid_t cpid;                       /* child pid */
+	int rc;
 
-	dbg("start get_diag_vpd");
-
-	if (event->diag_vpd.yl != NULL)
-		free_diag_vpd(event);
+	free_vpd_cache();
 
 	/* sigchld_handler() messes up pclose(). */
 	restore_sigchld_default();
@@ -219,169 +266,173 @@ get_diag_vpd(struct event *event, char *phyloc)
 		return 1;
 	}
 
-	while (event->diag_vpd.yl == NULL ||
-	       strcmp(event->diag_vpd.yl, phyloc)) {
-		if (lsvpd_read(event, fp)) {
-			dbg("end get_diag_vpd, failure");
-			rc = lsvpd_term(fp, &cpid);
-			setup_sigchld_handler();
-			return 1;
-		}
+	rc = lsvpd_read(fp);
+	if (lsvpd_term(fp, &cpid)) {
+		dbg("lsvpd pclose failure");
+		rc = 1;
 	}
-	rc = lsvpd_term(fp, &cpid);
-	if (rc)
-		dbg("end get_diag_vpd, pclose failure");
-	else
-		dbg("end get_diag_vpd, success");
 
 	setup_sigchld_handler();
 
-	return rc;
+	if (rc) {
+		free_vpd_cache();
+		return 1;
+	}
+
+	qsort(vpd_cache, vpd_cache_count, sizeof(*vpd_cache), vpd_entry_cmp);
+	vpd_cache_valid = 1;
+
+	return 0;
 }
 
-char *
-get_dt_status(char *dev)
+/**
+ * invalidate_vpd_cache
+ * @brief Drop the cached VPD after a hardware configuration change
+ *
+ * The cache is reloaded on the next lookup.
+ */
+void
+invalidate_vpd_cache(void)
+{
+	dbg("VPD cache invalidated");
+	vpd_cache_valid = 0;
+	vpd_cache_retried = 0;
+}
+
+static char *
+dup_vpd_field(struct event *event, const char *field, int *rc)
 {
-	FILE *fp1 = NULL, *fp2 = NULL;
-	char loc_file[80];
-	char target[80];
-	char *ptr;
-	char *system_args[6] = {NULL, };		/* execv args		*/
-	char tmp_file[] = "/tmp/get_dt_files-XXXXXX";
-	int fd;
-	pid_t cpid;					/* child pid		*/
-	int rc;						/* return value		*/
-	int status;					/* child exit status	*/
-	int len = 0;
-
-	system_args[0] = "/usr/bin/find";
-	system_args[1] = "/proc/device-tree";
-	system_args[2] = "-name";
-	system_args[3] = "status";
-	system_args[4] = "-print";
-
-	fd = mkstemp(tmp_file);
-	if (fd == -1) {
-		log_msg(NULL, "tmp file creation failed, at "
-			"get_dt_status\n");
-		exit (-2);
-	} /* open */
-
-	cpid = fork();
-	if (cpid == -1) {
-		close(fd);
-		log_msg(NULL, "Fork failed, at get_dt_status\n");
+	char *tmp;
+
+	if (field == NULL)
 		return NULL;
-	} /* fork */
-
-	if (cpid == 0) { /* child */
-		int fd = open(tmp_file, O_CREAT | O_WRONLY | O_TRUNC,
-					S_IRUSR | S_IWUSR);
-		if (fd == -1) {
-			log_msg(NULL, "tmp file creation failed, at "
-				"get_dt_status\n");
-			exit (-2);
-		} /* open */
-
-		rc = dup2(fd, STDOUT_FILENO);
-		if (rc == -1) {
-			log_msg(NULL, "STDOUT redirection failed, at "
-				"get_dt_status\n");
-			close(fd);
-			exit (-2);
-		}
 
-		rc = execv(system_args[0], system_args);
-		log_msg(NULL, "get_dt_status find command failed\n");
-		close(fd);
-		exit (-2);
-	} else { /* parent */
-		close(fd);
-		rc = waitpid(cpid, &status, 0);
-		if (rc == -1) {
-			log_msg(NULL, "wait on child failed at, "
-				"get_dt_status\n");
-			return NULL;
-		} /* waitpid */
+	tmp = event_strdup(event, field);
+	if (tmp == NULL)
+		*rc = 1;
 
-		/* Return on EXIT_FAILURE */
-		if ((signed char)WEXITSTATUS(status) == -2)
-			return NULL;
+	return tmp;
+}
+
+/**
+ * vpd_cache_find
+ * @brief Find the first cached record with the given location code
+ *
+ * @return the record, NULL if there is none
+ */
+static struct vpd_entry *
+vpd_cache_find(const char *phyloc)
+{
+	int lo, hi, mid;
+
+	lo = 0;
+	hi = vpd_cache_count;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strcmp(vpd_cache[mid].vpd.yl, phyloc) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	/* results of the find command */
-	fp1 = fopen(tmp_file, "r");
-	if (fp1 == NULL) {
-		fprintf(stderr, "open failed on %s\n", tmp_file);
+	if (lo == vpd_cache_count || strcmp(vpd_cache[lo].vpd.yl, phyloc))
 		return NULL;
-	}
 
-	while (fscanf (fp1, "%s", loc_file) != EOF) {
-		dbg("read from /%s, \"%s\"", tmp_file, loc_file);
+	return &vpd_cache[lo];
+}
+
+static int
+_get_diag_vpd(struct event *event, char *phyloc)
+{
+	struct vpd_entry *entry;
+	int loaded = 0;
+	int rc = 0;
+
+	dbg("start get_diag_vpd");
+
+	free_diag_vpd(event);
 
-		/* read the status in case this is the one */
-		fp2 = fopen(loc_file, "r");
-		if (fp2 == NULL) {
-			fprintf(stderr, "open failed on %s\n", loc_file);
-			goto out;
+	if (!vpd_cache_valid) {
+		if (load_vpd_cache()) {
+			dbg("end get_diag_vpd, lsvpd failure");
+			return 1;
 		}
+		loaded = 1;
+	}
 
-		if (fscanf(fp2, "%s", target_status) != EOF) {
-			dbg("target_status = \"%s\", loc_file = \"%s\"",
-			    target_status, loc_file);
-		} else {
-			fprintf(stderr, "read failed on %s\n", loc_file);
-			goto out;
+	entry = vpd_cache_find(phyloc);
+
+	/* A FRU added behind our back (e.g. DLPAR from the HMC) is not in
+	 * an older cache; rerun lsvpd once before giving up on it.  Only
+	 * once until the next invalidation though, a location code that
+	 * lsvpd does not know would otherwise rerun it on every lookup.
+	 */
+	if (entry == NULL && !loaded && !vpd_cache_retried) {
+		dbg("%s not in the VPD cache, reloading", phyloc);
+		vpd_cache_retried = 1;
+		if (load_vpd_cache()) {
+			dbg("end get_diag_vpd, lsvpd failure");
+			return 1;
 		}
+		entry = vpd_cache_find(phyloc);
+	}
 
-		fclose(fp2);
-		fp2 = NULL;
+	if (entry == NULL) {
+		dbg("end get_diag_vpd, failure");
+		return 1;
+	}
 
-		/* read the loc-code file to determine if found dev */
-		ptr = strstr(loc_file, "status");
-		if (!ptr)
-			continue;
+	event->diag_vpd.ds = dup_vpd_field(event, entry->vpd.ds, &rc);
+	event->diag_vpd.yl = dup_vpd_field(event, entry->vpd.yl, &rc);
+	event->diag_vpd.fn = dup_vpd_field(event, entry->vpd.fn, &rc);
+	event->diag_vpd.sn = dup_vpd_field(event, entry->vpd.sn, &rc);
+	event->diag_vpd.se = dup_vpd_field(event, entry->vpd.se, &rc);
+	event->diag_vpd.tm = dup_vpd_field(event, entry->vpd.tm, &rc);
 
-		len = strlen("ibm,loc-code");
-		if ((ptr - loc_file + len + 1) > sizeof(loc_file))
-			continue;
+	if (rc) {
+		free_diag_vpd(event);
+		dbg("end get_diag_vpd, allocation failure");
+	} else
+		dbg("end get_diag_vpd, success");
 
-		strncpy(ptr, "ibm,loc-code", len);
-		ptr[len] = '\0';
+	return rc;
+}
 
-		fp2 = fopen(loc_file, "r");
-		if (fp2 == NULL) {
-			fprintf(stderr, "open failed on %s\n", loc_file);
-			goto out;
-		}
+int
+get_diag_vpd(struct event *event, char *phyloc)
+{
+	uint64_t start = stats_now();
+	int rc;
 
-		if (fscanf(fp2, "%s", target) != EOF) {
-			dbg("target = \"%s\", loc_file = \"%s\"",
-			    target, loc_file);
-			if (strcmp(dev, target) == 0) {
-				dbg("status = \"%s\"", target_status);
-					fclose (fp2);
-					fclose (fp1);
-					return target_status;
-			}
-		} else {
-			fprintf(stderr, "read failed on %s\n", loc_file);
-			goto out;
-		}
+	rc = _get_diag_vpd(event, phyloc);
+	stats_record(STAGE_VPD, start);
 
-		fclose(fp2);
-		fp2 = NULL;
-	}
+	return rc;
+}
 
-	fprintf(stderr, "error: status NOT FOUND\n");
+/**
+ * get_dt_status
+ * @brief Device tree status of the node with the given location code
+ *
+ * @param dev location code
+ * @return status string, NULL if no node with a status was found
+ */
+char *
+get_dt_status(char *dev)
+{
+	struct dt_node *node;
 
-out:
-	if (fp2)
-		fclose(fp2);
+	for (node = dt_index_find_loc(dev); node; node = dt_index_next(node)) {
+		if (node->status == NULL)
+			continue;
 
-	if (fp1)
-		fclose(fp1);
+		snprintf(target_status, sizeof(target_status), "%s",
+			 node->status);
+		dbg("status = \"%s\"", target_status);
+		return target_status;
+	}
 
+	dbg("status of \"%s\" NOT FOUND", dev ? dev : "");
 	return NULL;
 }
 
@@ -0,0 +1,848 @@
+/**
+ * @file drc_info.c
+ * @brief Loaded-once index of DRC names, indexes and interrupt servers
+ *
+ * Used by convert_dt_node_props and directly by rtas_errd, so that
+ * resolving a drc-name does not mean re-reading the device tree
+ * properties (or spawning a process) for every lookup.
+ *
+ * Copyright (C) 2005 - 2016, 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <string.h>
+#include <endian.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <fcntl.h>
+
+#include "drc_info.h"
+
+/*
+ * The original version of this code processed 4 property arrays whose value
+ * at any specific array index described a single system entity.
+ *
+ *   ibm,drc-names: <num entries>; Array of name <encode-string>
+ *   ibm,drc-types: <num entries>; Array of entity 'type' <encode-string>
+ *   ibm,drc-indexes: <num entries>; Array of <encode-int> values
+ *   ibm,drc-power-domains: Array of <encode-int> values
+ *
+ * In a later version of the system firmware, a compressed representation
+ * of this information property was added named 'ibm,drc-info'.  Here is
+ * a summary of the representation of the property.
+ *
+ * <int word: num drc-info entries>
+ * Each entry has the following fields in sequential order:
+ *     <encode-string: drc-type e.g. "MEM" "PHB" "CPU">
+ *     <encode-string: drc-name-prefix >
+ *     <encode-int:    drc-index-start >
+ *     <encode-int:    drc-name-suffix-start >
+ *     <encode-int:    number-sequential-elements >
+ *     <encode-int:    sequential-increment >
+ *     <encode-int:    drc-power-domain >
+ * Each entry describes a subset of all of the 'ibm,drc-info'
+ * values.
+ *
+ * Both forms are loaded into a table of ranges sorted by drc-index;
+ * an ibm,drc-indexes/ibm,drc-names pair becomes one range of a single
+ * element per entry.
+ */
+
+#define DRC_TYPE_LEN		16
+#define CPUS_PATH		"/proc/device-tree/cpus"
+
+/*
+ * A run of drc-indexes with sequentially numbered names
+ */
+struct drc_range {
+	uint32_t	start_index;
+	uint32_t	count;
+	uint32_t	incr;
+	uint32_t	name_start;
+	char		*name;		/* name prefix, or the whole name */
+};
+
+/*
+ * Association between older and newer 'drc info' structions
+ * used to drive search routines.
+ */
+struct drc_info_search_config {
+	char *drc_type;		/* device kind sought e.g. "MEM" "PHB" "CPU" */
+	char *v1_tree_address;
+	char *v1_tree_name_address;
+	char *v2_tree_address;
+
+	/* loaded index */
+	int loaded;
+	int v2;			/* ranges came from ibm,drc-info */
+	struct drc_range *ranges;	/* sorted by start_index */
+	struct drc_range **by_name;	/* v1 only, sorted by name */
+	int nranges;
+};
+
+/*
+ * Configuration of 'drc info' structures for memory-to-name association
+ */
+static struct drc_info_search_config mem_to_name = {
+	"MEM",
+	"/proc/device-tree/ibm,drc-indexes",
+	"/proc/device-tree/ibm,drc-names",
+	"/proc/device-tree/ibm,drc-info",
+};
+
+/*
+ * Configuration of 'drc info' structures for cpu-to-name association
+ */
+static struct drc_info_search_config cpu_to_name = {
+	"CPU",
+	"/proc/device-tree/cpus/ibm,drc-indexes",
+	"/proc/device-tree/cpus/ibm,drc-names",
+	"/proc/device-tree/cpus/ibm,drc-info",
+};
+
+/*
+ * Interrupt servers of each cpu node
+ */
+struct cpu_servers {
+	uint32_t	drc_index;
+	uint32_t	*servers;
+	int		nservers;
+};
+
+struct server_map {
+	uint32_t	server;
+	uint32_t	drc_index;
+	int		pos;		/* order the cpus listed it in */
+};
+
+/*
+ * Where error messages go; set by drc_info_init().  rtas_errd is a
+ * daemon without a usable stderr, so it passes its own log function.
+ */
+static void (*drc_log)(char *, ...);
+
+static int cpus_loaded;
+static struct cpu_servers *cpus;	/* sorted by drc_index */
+static int ncpus;
+static struct server_map *server_map;	/* sorted by server, pos */
+static int nservers;
+
+static void
+drc_msg(char *fmt, ...)
+{
+	char buf[1024];
+	va_list ap;
+
+	if (!drc_log)
+		return;
+
+	va_start(ap, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	drc_log("%s", buf);
+}
+
+/**
+ * drc_info_init
+ * @brief Set the function used to report errors
+ *
+ * @param log_msg printf() like function, NULL to stay quiet
+ */
+void
+drc_info_init(void (*log_msg)(char *, ...))
+{
+	drc_log = log_msg;
+}
+
+/**
+ * read_property
+ * @brief Read a whole device tree property
+ *
+ * @param path property path
+ * @param len set to the property length
+ * @return malloc'ed buffer, NULL on failure
+ */
+static char *
+read_property(const char *path, size_t *len)
+{
+	struct stat sbuf;
+	char *buf;
+	ssize_t rc;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &sbuf) < 0) {
+		close(fd);
+		return NULL;
+	}
+
+	/* leave room for a terminating null on string properties */
+	buf = malloc(sbuf.st_size + 1);
+	if (!buf) {
+		close(fd);
+		return NULL;
+	}
+
+	rc = read(fd, buf, sbuf.st_size);
+	close(fd);
+	if (rc < 0) {
+		drc_msg("Error reading %s: %s", path, strerror(errno));
+		free(buf);
+		return NULL;
+	}
+
+	buf[rc] = '\0';
+	*len = rc;
+	return buf;
+}
+
+static uint32_t
+get_uint32(const char *p)
+{
+	uint32_t val;
+
+	memcpy(&val, p, sizeof(val));
+	return be32toh(val);
+}
+
+static int
+range_cmp(const void *a, const void *b)
+{
+	const struct drc_range *r1 = a, *r2 = b;
+
+	if (r1->start_index < r2->start_index)
+		return -1;
+	return r1->start_index > r2->start_index;
+}
+
+static int
+range_name_cmp(const void *a, const void *b)
+{
+	const struct drc_range *r1 = *(struct drc_range **)a;
+	const struct drc_range *r2 = *(struct drc_range **)b;
+
+	return strcmp(r1->name, r2->name);
+}
+
+static void
+free_drc_table(struct drc_info_search_config *sr)
+{
+	int i;
+
+	for (i = 0; i < sr->nranges; i++)
+		free(sr->ranges[i].name);
+
+	free(sr->ranges);
+	free(sr->by_name);
+	sr->ranges = NULL;
+	sr->by_name = NULL;
+	sr->nranges = 0;
+	sr->loaded = 0;
+}
+
+static int
+load_drc_table_v1(struct drc_info_search_config *sr)
+{
+	char *indexes, *names, *p, *end;
+	size_t ilen, nlen;
+	uint32_t num;
+	int i;
+
+	indexes = read_property(sr->v1_tree_address, &ilen);
+	if (!indexes) {
+		drc_msg("Error: property %s not found", sr->v1_tree_address);
+		return -1;
+	}
+
+	names = read_property(sr->v1_tree_name_address, &nlen);
+	if (!names || ilen < 4 || nlen < 4) {
+		drc_msg("Error: property %s not found",
+			sr->v1_tree_name_address);
+		free(indexes);
+		free(names);
+		return -1;
+	}
+
+	num = (ilen - 4) / 4;
+	sr->ranges = calloc(num ? num : 1, sizeof(*sr->ranges));
+	sr->by_name = calloc(num ? num : 1, sizeof(*sr->by_name));
+	if (!sr->ranges || !sr->by_name)
+		goto err;
+
+	/* skip the first word of each; it indicates how many there are */
+	p = names + 4;
+	end = names + nlen;
+	for (i = 0; i < num && p < end; i++) {
+		struct drc_range *r = &sr->ranges[i];
+
+		r->start_index = get_uint32(indexes + 4 + i * 4);
+		r->count = 1;
+		r->incr = 1;
+		r->name = strndup(p, DRC_NAME_LEN - 1);
+		if (!r->name)
+			goto err;
+
+		sr->nranges++;
+		p += strlen(p) + 1;
+	}
+
+	free(indexes);
+	free(names);
+
+	qsort(sr->ranges, sr->nranges, sizeof(*sr->ranges), range_cmp);
+	for (i = 0; i < sr->nranges; i++)
+		sr->by_name[i] = &sr->ranges[i];
+	qsort(sr->by_name, sr->nranges, sizeof(*sr->by_name), range_name_cmp);
+
+	return 0;
+
+err:
+	free(indexes);
+	free(names);
+	free_drc_table(sr);
+	return -1;
+}
+
+static int
+load_drc_table_v2(struct drc_info_search_config *sr)
+{
+	char *buf, *p, *end;
+	char *drc_type, *drc_name_base;
+	size_t len;
+	uint32_t num;
+	int i;
+
+	buf = read_property(sr->v2_tree_address, &len);
+	if (!buf) {
+		drc_msg("Error opening %s: %s", sr->v2_tree_address,
+			strerror(errno));
+		return -1;
+	}
+
+	if (len < 4)
+		goto err;
+
+	/* drc-info: need the first word to iterate over the subsets */
+	num = get_uint32(buf);
+	sr->ranges = calloc(num ? num : 1, sizeof(*sr->ranges));
+	if (!sr->ranges)
+		goto err;
+
+	p = buf + 4;
+	end = buf + len;
+	for (i = 0; i < num; i++) {
+		struct drc_range *r = &sr->ranges[sr->nranges];
+
+		drc_type = p;
+		p += strnlen(p, end - p) + 1;
+		drc_name_base = p;
+		p += strnlen(p, end - p) + 1;
+		if (p + 5 * 4 > end)
+			break;
+
+		r->start_index = get_uint32(p);
+		r->name_start = get_uint32(p + 4);
+		r->count = get_uint32(p + 8);
+		r->incr = get_uint32(p + 12);
+		/* drc-power-domain is not needed */
+		p += 5 * 4;
+
+		/* Drc-type sought match current entry? */
+		if (strncmp(drc_type, sr->drc_type, DRC_TYPE_LEN) ||
+		    r->count == 0)
+			continue;
+
+		r->name = strndup(drc_name_base, DRC_NAME_LEN - 1);
+		if (!r->name)
+			goto err;
+
+		sr->nranges++;
+	}
+
+	free(buf);
+	sr->v2 = 1;
+	qsort(sr->ranges, sr->nranges, sizeof(*sr->ranges), range_cmp);
+	return 0;
+
+err:
+	free(buf);
+	free_drc_table(sr);
+	return -1;
+}
+
+static int
+load_drc_table(struct drc_info_search_config *sr)
+{
+	struct stat sbuf;
+	int rc;
+
+	if (sr->loaded)
+		return 0;
+
+	sr->v2 = 0;
+	if (stat(sr->v2_tree_address, &sbuf))
+		rc = load_drc_table_v1(sr);
+	else
+		rc = load_drc_table_v2(sr);
+
+	if (rc)
+		return rc;
+
+	sr->loaded = 1;
+	return 0;
+}
+
+/*
+ * Drop a table loaded before this lookup started and load it again, so
+ * that an entry added by a DLPAR operation rtas_errd did not see (from
+ * the HMC, or by hand) is found.  Returns non-zero if nothing changed.
+ */
+static int
+reload_drc_table(struct drc_info_search_config *sr, int was_loaded)
+{
+	if (!was_loaded)
+		return -1;
+
+	free_drc_table(sr);
+	return load_drc_table(sr);
+}
+
+static int
+lookup_drcname(struct drc_info_search_config *sr, uint32_t drc_idx,
+	       char *drc_name, int buf_size)
+{
+	struct drc_range *r;
+	int lo, hi, mid;
+
+	/* last range starting at or below drc_idx */
+	lo = 0;
+	hi = sr->nranges;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (sr->ranges[mid].start_index <= drc_idx)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo == 0)
+		return 0;
+
+	r = &sr->ranges[lo - 1];
+	if (drc_idx > r->start_index + (r->count - 1) * r->incr)
+		return 0;
+
+	if (sr->v2)
+		snprintf(drc_name, buf_size, "%s%d", r->name,
+			 r->name_start + (drc_idx - r->start_index));
+	else
+		snprintf(drc_name, buf_size, "%s", r->name);
+
+	return 1;
+}
+
+static int
+search_drcindex_to_drcname(struct drc_info_search_config *sr, uint32_t drc_idx,
+			char *drc_name, int buf_size)
+{
+	int was_loaded = sr->loaded;
+
+	if (load_drc_table(sr))
+		return 0;
+
+	if (lookup_drcname(sr, drc_idx, drc_name, buf_size))
+		return 1;
+
+	if (reload_drc_table(sr, was_loaded))
+		return 0;
+
+	return lookup_drcname(sr, drc_idx, drc_name, buf_size);
+}
+
+static int
+lookup_drcindex(struct drc_info_search_config *sr, char *drc_name,
+		uint32_t *drc_idx)
+{
+	struct drc_range key, *keyp = &key, **found;
+	unsigned long suffix;
+	uint32_t delta;
+	char *end;
+	int i;
+
+	if (!sr->v2) {
+		key.name = drc_name;
+		found = bsearch(&keyp, sr->by_name, sr->nranges,
+				sizeof(*sr->by_name), range_name_cmp);
+		if (!found)
+			return 0;
+
+		*drc_idx = (*found)->start_index;
+		return 1;
+	}
+
+	/* The inverse of search_drcindex_to_drcname() */
+	for (i = 0; i < sr->nranges; i++) {
+		struct drc_range *r = &sr->ranges[i];
+		size_t len = strlen(r->name);
+
+		if (strncmp(drc_name, r->name, len))
+			continue;
+
+		errno = 0;
+		suffix = strtoul(drc_name + len, &end, 10);
+		if (errno || end == drc_name + len || *end != '\0' ||
+		    suffix < r->name_start)
+			continue;
+
+		delta = suffix - r->name_start;
+		if (delta > (r->count - 1) * r->incr)
+			continue;
+
+		*drc_idx = r->start_index + delta;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int
+search_drcname_to_drcindex(struct drc_info_search_config *sr, char *drc_name,
+			uint32_t *drc_idx)
+{
+	int was_loaded = sr->loaded;
+
+	if (load_drc_table(sr))
+		return 0;
+
+	if (lookup_drcindex(sr, drc_name, drc_idx))
+		return 1;
+
+	if (reload_drc_table(sr, was_loaded))
+		return 0;
+
+	return lookup_drcindex(sr, drc_name, drc_idx);
+}
+
+/**
+ * mem_drcindex_to_drcname
+ * @brief converts drcindex of mem type to drcname
+ *
+ * @param drc_idx - drc index whose drc name is to be found.
+ * @param drc_name - buffer for drc_name
+ * @param buf_size - size of buffer.
+ */
+int
+mem_drcindex_to_drcname(uint32_t drc_idx, char *drc_name, int buf_size)
+{
+	return search_drcindex_to_drcname(&mem_to_name, drc_idx, drc_name,
+					buf_size);
+}
+
+/**
+ * cpu_drcindex_to_drcname
+ * @brief converts drcindex of cpu type to drcname
+ *
+ * @param drc_idx - drc index whose drc name is to be found.
+ * @param drc_name - buffer for drc_name
+ * @param buf_size - size of buffer.
+ */
+int
+cpu_drcindex_to_drcname(uint32_t drc_idx, char *drc_name, int buf_size)
+{
+	return search_drcindex_to_drcname(&cpu_to_name, drc_idx, drc_name,
+					buf_size);
+}
+
+/**
+ * cpu_drcname_to_drcindex
+ * @brief converts cpu type drcname to drcindex
+ *
+ * @param drc_name - drc name whose drc index is to be found.
+ * @param drc_idx - storage for the drc index
+ */
+int
+cpu_drcname_to_drcindex(char *drc_name, uint32_t *drc_idx)
+{
+	return search_drcname_to_drcindex(&cpu_to_name, drc_name, drc_idx);
+}
+
+static int
+cpu_cmp(const void *a, const void *b)
+{
+	const struct cpu_servers *c1 = a, *c2 = b;
+
+	if (c1->drc_index < c2->drc_index)
+		return -1;
+	return c1->drc_index > c2->drc_index;
+}
+
+static int
+server_cmp(const void *a, const void *b)
+{
+	const struct server_map *s1 = a, *s2 = b;
+
+	if (s1->server < s2->server)
+		return -1;
+	return s1->server > s2->server;
+}
+
+/*
+ * qsort() is not stable; sorting on the position as well keeps the
+ * entries for a server in the order the cpus listed them.
+ */
+static int
+server_pos_cmp(const void *a, const void *b)
+{
+	const struct server_map *s1 = a, *s2 = b;
+	int rc = server_cmp(a, b);
+
+	if (rc)
+		return rc;
+	return (s1->pos > s2->pos) - (s1->pos < s2->pos);
+}
+
+static void
+free_cpus(void)
+{
+	int i;
+
+	for (i = 0; i < ncpus; i++)
+		free(cpus[i].servers);
+
+	free(cpus);
+	free(server_map);
+	cpus = NULL;
+	server_map = NULL;
+	ncpus = 0;
+	nservers = 0;
+	cpus_loaded = 0;
+}
+
+/*
+ * Read ibm,my-drc-index and ibm,ppc-interrupt-server#s of every cpu
+ */
+static int
+load_cpus(void)
+{
+	DIR *dir;
+	struct dirent *entry;
+	char path[1024];
+	char *buf;
+	size_t len;
+	void *tmp;
+	int size = 0, i, j;
+
+	if (cpus_loaded)
+		return 0;
+
+	dir = opendir(CPUS_PATH);
+	if (!dir)
+		return -1;
+
+	while ((entry = readdir(dir)) != NULL) {
+		struct cpu_servers *cpu;
+
+		if (strncmp(entry->d_name, "PowerPC,POWER", 13))
+			continue;
+
+		if (ncpus == size) {
+			size = size ? size * 2 : 64;
+			tmp = realloc(cpus, size * sizeof(*cpus));
+			if (!tmp)
+				goto err;
+			cpus = tmp;
+		}
+
+		cpu = &cpus[ncpus];
+		memset(cpu, 0, sizeof(*cpu));
+
+		snprintf(path, sizeof(path), "%s/%s/ibm,my-drc-index",
+			 CPUS_PATH, entry->d_name);
+		buf = read_property(path, &len);
+		if (!buf || len < 4) {
+			drc_msg("Error opening %s: %s", path,
+				strerror(errno));
+			free(buf);
+			goto err;
+		}
+		cpu->drc_index = get_uint32(buf);
+		free(buf);
+
+		snprintf(path, sizeof(path),
+			 "%s/%s/ibm,ppc-interrupt-server#s", CPUS_PATH,
+			 entry->d_name);
+		buf = read_property(path, &len);
+		if (!buf) {
+			drc_msg("Error opening %s: %s", path,
+				strerror(errno));
+			goto err;
+		}
+
+		cpu->nservers = len / 4;
+		cpu->servers = calloc(cpu->nservers ? cpu->nservers : 1,
+				      sizeof(uint32_t));
+		if (!cpu->servers) {
+			free(buf);
+			goto err;
+		}
+
+		for (i = 0; i < cpu->nservers; i++)
+			cpu->servers[i] = get_uint32(buf + i * 4);
+		free(buf);
+
+		nservers += cpu->nservers;
+		ncpus++;
+	}
+
+	closedir(dir);
+	dir = NULL;
+
+	server_map = calloc(nservers ? nservers : 1, sizeof(*server_map));
+	if (!server_map)
+		goto err;
+
+	nservers = 0;
+	for (i = 0; i < ncpus; i++) {
+		for (j = 0; j < cpus[i].nservers; j++) {
+			server_map[nservers].server = cpus[i].servers[j];
+			server_map[nservers].drc_index = cpus[i].drc_index;
+			server_map[nservers].pos = nservers;
+			nservers++;
+		}
+	}
+
+	qsort(cpus, ncpus, sizeof(*cpus), cpu_cmp);
+	qsort(server_map, nservers, sizeof(*server_map), server_pos_cmp);
+
+	cpus_loaded = 1;
+	return 0;
+
+err:
+	if (dir)
+		closedir(dir);
+	free_cpus();
+	return -1;
+}
+
+/*
+ * As reload_drc_table(), for the cpu nodes
+ */
+static int
+reload_cpus(int was_loaded)
+{
+	if (!was_loaded)
+		return -1;
+
+	free_cpus();
+	return load_cpus();
+}
+
+/*
+ * The first cpu listing a server wins, as with the linear search.
+ * bsearch() may land on any entry for the server, so step back to
+ * the first.
+ */
+static struct server_map *
+find_server(uint32_t int_serv)
+{
+	struct server_map key, *found;
+
+	key.server = int_serv;
+	found = bsearch(&key, server_map, nservers, sizeof(*server_map),
+			server_cmp);
+	while (found && found > server_map &&
+	       (found - 1)->server == int_serv)
+		found--;
+
+	return found;
+}
+
+static struct cpu_servers *
+find_cpu(uint32_t drc_idx)
+{
+	struct cpu_servers key;
+
+	key.drc_index = drc_idx;
+	return bsearch(&key, cpus, ncpus, sizeof(*cpus), cpu_cmp);
+}
+
+int
+cpu_interruptserver_to_drcindex(uint32_t int_serv, uint32_t *drc_idx)
+{
+	struct server_map *found;
+	int was_loaded = cpus_loaded;
+
+	if (load_cpus())
+		return 0;
+
+	found = find_server(int_serv);
+	if (!found && !reload_cpus(was_loaded))
+		found = find_server(int_serv);
+	if (!found)
+		return 0;
+
+	*drc_idx = found->drc_index;
+	return 1;
+}
+
+/* returns # of interrupt-server numbers found, rather than a boolean value */
+int
+cpu_drcindex_to_interruptserver(uint32_t drc_idx, uint32_t *int_servs,
+		int array_elements)
+{
+	struct cpu_servers *found;
+	int was_loaded = cpus_loaded;
+	int i;
+
+	if (load_cpus())
+		return 0;
+
+	found = find_cpu(drc_idx);
+	if (!found && !reload_cpus(was_loaded))
+		found = find_cpu(drc_idx);
+	if (!found)
+		return 0;
+
+	for (i = 0; i < found->nservers && i < array_elements; i++)
+		int_servs[i] = found->servers[i];
+
+	return i;
+}
+
+/**
+ * drc_info_invalidate
+ * @brief Drop the loaded index after a DLPAR or PRRN change
+ *
+ * It is reloaded by the next lookup.
+ */
+void
+drc_info_invalidate(void)
+{
+	free_drc_table(&mem_to_name);
+	free_drc_table(&cpu_to_name);
+	free_cpus();
+}
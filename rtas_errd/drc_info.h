@@ -0,0 +1,45 @@
+/**
+ * @file drc_info.h
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _DRC_INFO_H
+#define _DRC_INFO_H
+
+#include <stdint.h>
+
+#define DRC_NAME_LEN		256   /* Worst case length to expect */
+
+/*
+ * Conversions between drc-index, drc-name and interrupt server.  The
+ * device tree properties are read the first time they are needed and
+ * kept until drc_info_invalidate() is called, or reread once when a
+ * value is not found in them.  Each function returns non-zero when the
+ * value was found (the interrupt server lookup returns the number of
+ * servers found).
+ */
+int cpu_interruptserver_to_drcindex(uint32_t, uint32_t *);
+int cpu_drcindex_to_drcname(uint32_t, char *, int);
+int cpu_drcindex_to_interruptserver(uint32_t, uint32_t *, int);
+int cpu_drcname_to_drcindex(char *, uint32_t *);
+int mem_drcindex_to_drcname(uint32_t, char *, int);
+
+void drc_info_init(void (*)(char *, ...));
+void drc_info_invalidate(void);
+
+#endif /* _DRC_INFO_H */
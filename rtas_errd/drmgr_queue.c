@@ -0,0 +1,423 @@
+/**
+ * @file drmgr_queue.c
+ * @brief Coalesce hotplug and deallocation requests into few drmgr calls
+ *
+ * Firmware initiated DLPAR of many resources (typically LMBs) arrives
+ * as one RTAS event per resource.  Rather than running drmgr for each
+ * of them, consecutive requests of the same kind (resource type, add
+ * or remove, by drc-index or by count) are queued for a short window
+ * and then handed to drmgr together:
+ *
+ *  - count requests are summed into a single "-q <total>" call
+ *  - runs of consecutive memory drc-indexes become one indexed-count
+ *    call ("-q <n> -s <first index>")
+ *  - any other drc-index request gets its own "-s <index>" call
+ *
+ * The outcome for every resource is written to the platform log along
+ * with the number of the RTAS event that asked for it.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include "rtas_errd.h"
+#include "drc_info.h"
+
+#ifndef DRMGR_PROGRAM
+#define DRMGR_PROGRAM		"/usr/sbin/drmgr"
+#endif
+#define DRMGR_PROGRAM_NOPATH	"drmgr"
+
+/**
+ * @def DRMGR_QUEUE_WINDOW_MS
+ * @brief Flush once no request has been queued for this long
+ */
+#define DRMGR_QUEUE_WINDOW_MS	250
+
+/**
+ * @def DRMGR_QUEUE_MAX_DELAY_MS
+ * @brief Never hold the first queued request for longer than this
+ */
+#define DRMGR_QUEUE_MAX_DELAY_MS	5000
+
+/**
+ * @def DRMGR_QUEUE_MAX
+ * @brief Flush when this many requests are queued
+ */
+#define DRMGR_QUEUE_MAX		4096
+
+struct drmgr_req {
+	int		seq_num;	/**< RTAS event that asked for it */
+	uint32_t	value;		/**< drc-index or count */
+	int		status;		/**< drmgr exit status */
+};
+
+/**
+ * @var dq
+ * @brief The requests waiting for drmgr; all of the same kind
+ */
+static struct {
+	const char		*type;	/**< drmgr -c argument */
+	int			remove;
+	int			by_count;
+	struct drmgr_req	*reqs;
+	int			nreqs;
+	int			size;
+	int			distinct;	/**< different values queued */
+	struct timespec		first;	/**< when the first was queued */
+	struct timespec		last;	/**< when the last was queued */
+} dq;
+
+static long
+elapsed_ms(struct timespec *since)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - since->tv_sec) * 1000 +
+	       (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+/**
+ * exec_drmgr
+ * @brief Run drmgr and wait for it
+ *
+ * @param index drc-index, 0 for none
+ * @param count quantity, 0 for none
+ * @return drmgr exit status, -1 if it could not be run
+ */
+static int
+exec_drmgr(uint32_t index, uint32_t count)
+{
+	pid_t child;
+	int status, rc;
+	uint64_t start;
+	int i = 0;
+	char index_str[11], count_str[11];
+	char *drmgr_args[12];
+
+	drmgr_args[i++] = DRMGR_PROGRAM_NOPATH;
+	drmgr_args[i++] = "-c";
+	drmgr_args[i++] = (char *)dq.type;
+	drmgr_args[i++] = dq.remove ? "-r" : "-a";
+	if (count) {
+		snprintf(count_str, sizeof(count_str), "%u", count);
+		drmgr_args[i++] = "-q";
+		drmgr_args[i++] = count_str;
+	}
+	if (index) {
+		snprintf(index_str, sizeof(index_str), "%#x", index);
+		drmgr_args[i++] = "-s";
+		drmgr_args[i++] = index_str;
+	}
+	if (!strcmp(dq.type, "pci"))
+		drmgr_args[i++] = "-n";
+	drmgr_args[i++] = "-d4";
+	drmgr_args[i++] = "-V";
+	drmgr_args[i] = NULL;
+
+	dbg("run: %s -c %s %s -q %s -s %s", drmgr_args[0], dq.type,
+	    drmgr_args[3], count ? count_str : "-", index ? index_str : "-");
+
+#ifdef DEBUG
+	if (no_drmgr)
+		return 0;
+#endif
+
+	start = stats_now();
+	child = fork();
+	if (child == -1) {
+		log_msg(NULL, "%s cannot be run to handle a hotplug event, %s",
+			DRMGR_PROGRAM, strerror(errno));
+		return -1;
+	} else if (child == 0) {
+		/* child process */
+		execv(DRMGR_PROGRAM, drmgr_args);
+
+		/* shouldn't get here */
+		log_msg(NULL, "Could not exec %s in response to hotplug event, %s",
+			DRMGR_PROGRAM, strerror(errno));
+		exit(1);
+	}
+
+	rc = waitpid(child, &status, 0);
+	stats_record(STAGE_DRMGR, start);
+	if (rc == -1)
+		return -1;
+
+	dbg("drmgr call exited with %d", WEXITSTATUS(status));
+	return WEXITSTATUS(status);
+}
+
+static int
+req_value_cmp(const void *a, const void *b)
+{
+	const struct drmgr_req *r1 = a, *r2 = b;
+
+	if (r1->value < r2->value)
+		return -1;
+	return r1->value > r2->value;
+}
+
+static int
+req_seq_cmp(const void *a, const void *b)
+{
+	const struct drmgr_req *r1 = a, *r2 = b;
+
+	return r1->seq_num - r2->seq_num;
+}
+
+/**
+ * report_req
+ * @brief Record the outcome of one request in the platform log
+ */
+static void
+report_req(struct drmgr_req *req)
+{
+	platform_log_write("DLPAR Notification\n");
+	platform_log_write("(resulting from RTAS event %d)\n", req->seq_num);
+	if (dq.by_count)
+		platform_log_write("    %s %u %s resource(s)\n",
+				   dq.remove ? "remove" : "add", req->value,
+				   dq.type);
+	else
+		platform_log_write("    %s %s drc-index %#x\n",
+				   dq.remove ? "remove" : "add", dq.type,
+				   req->value);
+	if (req->status == 0)
+		platform_log_write("    drmgr completed successfully\n");
+	else
+		platform_log_write("    drmgr failed, status %d\n",
+				   req->status);
+}
+
+/**
+ * drmgr_queue_flush
+ * @brief Run drmgr for everything queued
+ */
+void
+drmgr_queue_flush(void)
+{
+	uint32_t total = 0;
+	int i, j, status;
+
+	if (dq.nreqs == 0)
+		return;
+
+	dbg("Flushing %d queued %s %s requests", dq.nreqs, dq.type,
+	    dq.remove ? "remove" : "add");
+
+	if (dq.by_count) {
+		for (i = 0; i < dq.nreqs; i++)
+			total += dq.reqs[i].value;
+
+		status = exec_drmgr(0, total);
+		for (i = 0; i < dq.nreqs; i++)
+			dq.reqs[i].status = status;
+	} else {
+		/* Sort so that consecutive indexes form runs */
+		qsort(dq.reqs, dq.nreqs, sizeof(*dq.reqs), req_value_cmp);
+
+		for (i = 0; i < dq.nreqs; i = j) {
+			uint32_t count = 1;
+
+			j = i + 1;
+			if (!strcmp(dq.type, "mem")) {
+				/* duplicates and the next index extend a run */
+				while (j < dq.nreqs &&
+				       dq.reqs[j].value - dq.reqs[j - 1].value <= 1) {
+					count += dq.reqs[j].value !=
+						 dq.reqs[j - 1].value;
+					j++;
+				}
+			}
+
+			status = exec_drmgr(dq.reqs[i].value,
+					    count > 1 ? count : 0);
+			for ( ; i < j; i++)
+				dq.reqs[i].status = status;
+		}
+
+		/* and report them in the order the events arrived */
+		qsort(dq.reqs, dq.nreqs, sizeof(*dq.reqs), req_seq_cmp);
+	}
+
+	for (i = 0; i < dq.nreqs; i++) {
+		report_req(&dq.reqs[i]);
+		dt_index_hotplug(dq.type, dq.remove,
+				 dq.by_count ? 0 : dq.reqs[i].value,
+				 dq.reqs[i].status);
+	}
+
+	dq.nreqs = 0;
+	dq.distinct = 0;
+
+	/* The partition configuration has changed */
+	invalidate_vpd_cache();
+	invalidate_phandle_map();
+	drc_info_invalidate();
+	topology_invalidate();
+}
+
+/**
+ * dq_queued
+ * @brief Check whether a request for the same resource is queued
+ *
+ * @return non-zero if it is
+ */
+static int
+dq_queued(const char *type, int remove, int by_count, uint32_t value)
+{
+	int i;
+
+	if (dq.nreqs == 0 || strcmp(dq.type, type) || dq.remove != remove ||
+	    dq.by_count != by_count)
+		return 0;
+
+	for (i = 0; i < dq.nreqs; i++)
+		if (dq.reqs[i].value == value)
+			return 1;
+
+	return 0;
+}
+
+/**
+ * drmgr_queue_add
+ * @brief Queue a hotplug or deallocation request for drmgr
+ *
+ * @param seq_num number of the RTAS event making the request
+ * @param type drmgr resource type ("cpu", "mem", "pci" or "phb")
+ * @param remove non-zero to remove the resource, zero to add it
+ * @param by_count non-zero if value is a count rather than a drc-index
+ * @param value drc-index or count
+ */
+void
+drmgr_queue_add(int seq_num, const char *type, int remove, int by_count,
+		uint32_t value)
+{
+	struct drmgr_req *tmp;
+	int queued;
+
+	if (dq.nreqs && (strcmp(dq.type, type) || dq.remove != remove ||
+			 dq.by_count != by_count))
+		drmgr_queue_flush();
+
+	if (dq.nreqs == dq.size) {
+		int new_size = dq.size ? dq.size * 2 : 64;
+
+		tmp = realloc(dq.reqs, new_size * sizeof(*dq.reqs));
+		if (tmp == NULL) {
+			/* Run what we have to make room */
+			drmgr_queue_flush();
+			if (dq.size == 0) {
+				/* Nothing to reuse; run this one directly */
+				struct drmgr_req req = {seq_num, value, 0};
+
+				dq.type = type;
+				dq.remove = remove;
+				dq.by_count = by_count;
+				req.status = by_count ? exec_drmgr(0, value) :
+							exec_drmgr(value, 0);
+				report_req(&req);
+				return;
+			}
+		} else {
+			dq.reqs = tmp;
+			dq.size = new_size;
+		}
+	}
+
+	/* by_count values are quantities, every one of them counts */
+	queued = !by_count && dq_queued(type, remove, by_count, value);
+
+	if (dq.nreqs == 0) {
+		dq.type = type;
+		dq.remove = remove;
+		dq.by_count = by_count;
+		clock_gettime(CLOCK_MONOTONIC, &dq.first);
+	}
+
+	if (!queued)
+		dq.distinct++;
+
+	dq.reqs[dq.nreqs].seq_num = seq_num;
+	dq.reqs[dq.nreqs].value = value;
+	dq.reqs[dq.nreqs].status = 0;
+	dq.nreqs++;
+	clock_gettime(CLOCK_MONOTONIC, &dq.last);
+
+	if (dq.nreqs >= DRMGR_QUEUE_MAX)
+		drmgr_queue_flush();
+}
+
+/**
+ * drmgr_queue_lmb_queued
+ * @brief Check whether an LMB is already queued for removal
+ *
+ * @param drc_index drc-index of the LMB
+ * @return non-zero if it is
+ */
+int
+drmgr_queue_lmb_queued(uint32_t drc_index)
+{
+	return dq_queued("mem", 1, 0, drc_index);
+}
+
+/**
+ * drmgr_queue_lmbs_removing
+ * @brief Number of different LMBs queued for removal by drc-index
+ *
+ * Until the queue is run they are still online, but must be counted
+ * as gone when deciding whether another LMB can be given up.
+ */
+int
+drmgr_queue_lmbs_removing(void)
+{
+	if (dq.nreqs == 0 || strcmp(dq.type, "mem") || !dq.remove ||
+	    dq.by_count)
+		return 0;
+
+	return dq.distinct;
+}
+
+/**
+ * drmgr_queue_timeout
+ * @brief How long the event loop may wait before flushing the queue
+ *
+ * @return milliseconds, or -1 if nothing is queued
+ */
+int
+drmgr_queue_timeout(void)
+{
+	long idle, age;
+
+	if (dq.nreqs == 0)
+		return -1;
+
+	idle = DRMGR_QUEUE_WINDOW_MS - elapsed_ms(&dq.last);
+	age = DRMGR_QUEUE_MAX_DELAY_MS - elapsed_ms(&dq.first);
+
+	idle = idle < age ? idle : age;
+	return idle > 0 ? idle : 0;
+}
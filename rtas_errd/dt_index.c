@@ -0,0 +1,542 @@
+/**
+ * @file dt_index.c
+ * @brief In-memory index of device tree nodes by location code
+ *
+ * Looking up the status of a FRU used to mean running find over all of
+ * /proc/device-tree and opening two files per node.  Instead the tree
+ * is walked once and the properties rtas_errd cares about (status,
+ * ibm,loc-code and ibm,my-drc-index) are kept in memory, hashed by
+ * location code.
+ *
+ * DLPAR operations update the index in place (see dt_index_hotplug()),
+ * by the drc-index of the resource.  After a PRRN event the index is
+ * dropped and rebuilt on the next lookup: drmgr changes the device tree
+ * for it in the background, rtas_errd does not see when it is done.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <endian.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "rtas_errd.h"
+
+#define DT_INDEX_BASE	"/proc/device-tree"
+
+/**
+ * @var dt_nodes
+ * @brief Every device tree node that has a location code or a drc-index
+ *
+ * In device tree order, so the nodes below a node follow it.
+ */
+static struct dt_node *dt_nodes;
+static int dt_node_count;
+static int dt_node_size;
+
+/**
+ * @var dt_loc_hash
+ * @brief Open addressed hash of location codes to the first dt_nodes
+ * entry with that location code; -1 marks an empty slot.
+ */
+static int *dt_loc_hash;
+static unsigned int dt_loc_hash_size;
+
+static int dt_index_valid;
+
+/**
+ * @var dt_drconf
+ * @brief Memory is described by ibm,dynamic-reconfiguration-memory
+ *
+ * The LMBs then have no device tree node of their own.
+ */
+static int dt_drconf;
+
+static unsigned int
+loc_hash(const char *loc_code)
+{
+	unsigned int hash = 2166136261u;	/* FNV-1a */
+
+	while (*loc_code) {
+		hash ^= (unsigned char)*loc_code++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/**
+ * read_prop
+ * @brief Read a device tree property relative to a node directory
+ *
+ * @param dfd node directory file descriptor
+ * @param name property name
+ * @param buf buffer for the property value
+ * @param len size of buf
+ * @return number of bytes read, -1 if the property does not exist
+ */
+static int
+read_prop(int dfd, const char *name, void *buf, size_t len)
+{
+	int fd, rc;
+
+	fd = openat(dfd, name, O_RDONLY);
+	if (fd < 0)
+		return -1;
+
+	rc = read(fd, buf, len);
+	close(fd);
+
+	return rc;
+}
+
+/**
+ * read_string_prop
+ * @brief Read a device tree string property
+ *
+ * Only the first word is kept, as reading it with fscanf("%s") did.
+ *
+ * @return newly allocated string, NULL if the property does not exist
+ */
+static char *
+read_string_prop(int dfd, const char *name)
+{
+	char buf[256];
+	int len;
+
+	len = read_prop(dfd, name, buf, sizeof(buf) - 1);
+	if (len < 0)
+		return NULL;
+
+	buf[len] = '\0';
+	buf[strcspn(buf, " \t\n")] = '\0';
+
+	return strdup(buf);
+}
+
+static void
+free_dt_nodes(void)
+{
+	int i;
+
+	for (i = 0; i < dt_node_count; i++) {
+		free(dt_nodes[i].path);
+		free(dt_nodes[i].loc_code);
+		free(dt_nodes[i].status);
+	}
+
+	dt_node_count = 0;
+
+	free(dt_loc_hash);
+	dt_loc_hash = NULL;
+	dt_loc_hash_size = 0;
+}
+
+/**
+ * add_dt_node
+ * @brief Record the properties of one device tree node
+ *
+ * @param dfd node directory file descriptor
+ * @param path node path relative to the device tree root
+ * @return 0 on success, -1 on allocation failure
+ */
+static int
+add_dt_node(int dfd, const char *path)
+{
+	struct dt_node *node, *tmp;
+	uint32_t drc_index;
+
+	if (dt_node_count == dt_node_size) {
+		int new_size = dt_node_size ? dt_node_size * 2 : 1024;
+
+		tmp = realloc(dt_nodes, new_size * sizeof(*dt_nodes));
+		if (tmp == NULL)
+			return -1;
+
+		dt_nodes = tmp;
+		dt_node_size = new_size;
+	}
+
+	node = &dt_nodes[dt_node_count];
+	memset(node, 0, sizeof(*node));
+	node->next = -1;
+
+	if (read_prop(dfd, "ibm,my-drc-index", &drc_index,
+		      sizeof(drc_index)) == sizeof(drc_index))
+		node->drc_index = be32toh(drc_index);
+
+	node->loc_code = read_string_prop(dfd, "ibm,loc-code");
+	if (node->loc_code == NULL && node->drc_index == 0)
+		return 0;	/* nothing worth looking up */
+
+	node->status = read_string_prop(dfd, "status");
+
+	node->path = strdup(path);
+	if (node->path == NULL) {
+		free(node->loc_code);
+		free(node->status);
+		return -1;
+	}
+
+	dt_node_count++;
+	return 0;
+}
+
+/**
+ * walk_dt
+ * @brief Add a node and all of its children to the index
+ *
+ * @param dfd node directory file descriptor, closed on return
+ * @param path node path relative to the device tree root
+ * @return 0 on success, -1 on failure
+ */
+static int
+walk_dt(int dfd, char *path)
+{
+	struct dirent *de;
+	struct stat sbuf;
+	size_t plen = strlen(path);
+	DIR *d;
+	int cfd, rc = 0;
+
+	if (add_dt_node(dfd, path)) {
+		close(dfd);
+		return -1;
+	}
+
+	d = fdopendir(dfd);
+	if (d == NULL) {
+		close(dfd);
+		return -1;
+	}
+
+	while (rc == 0 && (de = readdir(d)) != NULL) {
+		if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+			continue;
+
+		if (de->d_type == DT_UNKNOWN) {
+			if (fstatat(dirfd(d), de->d_name, &sbuf,
+				    AT_SYMLINK_NOFOLLOW) ||
+			    !S_ISDIR(sbuf.st_mode))
+				continue;
+		} else if (de->d_type != DT_DIR)
+			continue;
+
+		if (plen + strlen(de->d_name) + 2 > PATH_MAX)
+			continue;
+
+		cfd = openat(dirfd(d), de->d_name, O_RDONLY | O_DIRECTORY);
+		if (cfd < 0)
+			continue;
+
+		sprintf(path + plen, "/%s", de->d_name);
+		rc = walk_dt(cfd, path);
+		path[plen] = '\0';
+	}
+
+	closedir(d);
+	return rc;
+}
+
+/**
+ * hash_dt_nodes
+ * @brief Build the location code hash over dt_nodes
+ *
+ * Nodes sharing a location code are chained in device tree order.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+static int
+hash_dt_nodes(void)
+{
+	unsigned int slot;
+	int i, *last;
+
+	dt_loc_hash_size = 64;
+	while (dt_loc_hash_size < (unsigned int)dt_node_count * 2)
+		dt_loc_hash_size <<= 1;
+
+	dt_loc_hash = malloc(dt_loc_hash_size * sizeof(*dt_loc_hash));
+	if (dt_loc_hash == NULL)
+		return -1;
+
+	memset(dt_loc_hash, -1, dt_loc_hash_size * sizeof(*dt_loc_hash));
+
+	for (i = 0; i < dt_node_count; i++)
+		dt_nodes[i].next = -1;
+
+	for (i = 0; i < dt_node_count; i++) {
+		if (dt_nodes[i].loc_code == NULL)
+			continue;
+
+		slot = loc_hash(dt_nodes[i].loc_code) & (dt_loc_hash_size - 1);
+		while (dt_loc_hash[slot] != -1 &&
+		       strcmp(dt_nodes[dt_loc_hash[slot]].loc_code,
+			      dt_nodes[i].loc_code))
+			slot = (slot + 1) & (dt_loc_hash_size - 1);
+
+		/* append to the end of the chain to keep tree order */
+		last = &dt_loc_hash[slot];
+		while (*last != -1)
+			last = &dt_nodes[*last].next;
+		*last = i;
+	}
+
+	return 0;
+}
+
+/**
+ * build_dt_index
+ * @brief Walk the device tree and build the index
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int
+build_dt_index(void)
+{
+	char path[PATH_MAX] = "";
+	int dfd;
+
+	free_dt_nodes();
+
+	dfd = open(DT_INDEX_BASE, O_RDONLY | O_DIRECTORY);
+	if (dfd < 0) {
+		log_msg(NULL, "Could not open %s, %s", DT_INDEX_BASE,
+			strerror(errno));
+		return -1;
+	}
+
+	dt_drconf = !faccessat(dfd, "ibm,dynamic-reconfiguration-memory",
+			       F_OK, 0);
+
+	if (walk_dt(dfd, path) || hash_dt_nodes()) {
+		log_msg(NULL, "Could not index %s", DT_INDEX_BASE);
+		free_dt_nodes();
+		return -1;
+	}
+
+	dbg("Indexed %d device tree nodes", dt_node_count);
+	dt_index_valid = 1;
+	return 0;
+}
+
+/**
+ * invalidate_dt_index
+ * @brief Drop the index after the device tree may have changed
+ *
+ * The index is rebuilt on the next lookup.
+ */
+void
+invalidate_dt_index(void)
+{
+	dbg("Device tree index invalidated");
+	dt_index_valid = 0;
+}
+
+/**
+ * in_subtree
+ * @brief Check whether a node path is at or below another
+ */
+static int
+in_subtree(const char *node_path, const char *path, size_t len)
+{
+	return !strncmp(node_path, path, len) &&
+	       (node_path[len] == '\0' || node_path[len] == '/');
+}
+
+/**
+ * rescan_dt_subtree
+ * @brief Read the nodes at and below a path again
+ *
+ * The nodes found there now take the place of those indexed before,
+ * so the index stays in device tree order.
+ *
+ * @param path node path relative to the device tree root
+ * @return 0 on success, -1 on failure
+ */
+static int
+rescan_dt_subtree(const char *path)
+{
+	char full_path[PATH_MAX], walk_path[PATH_MAX];
+	struct dt_node *moved = NULL;
+	size_t len = strlen(path);
+	int i, first = -1, count = 0, added;
+	int dfd, rc = 0;
+
+	/* drop what is indexed there now */
+	for (i = 0; i < dt_node_count; i++) {
+		if (in_subtree(dt_nodes[i].path, path, len)) {
+			if (first == -1)
+				first = i;
+			free(dt_nodes[i].path);
+			free(dt_nodes[i].loc_code);
+			free(dt_nodes[i].status);
+			continue;
+		}
+
+		dt_nodes[count++] = dt_nodes[i];
+	}
+
+	dt_node_count = count;
+	if (first == -1)
+		first = count;
+
+	snprintf(full_path, sizeof(full_path), "%s%s", DT_INDEX_BASE, path);
+	dfd = open(full_path, O_RDONLY | O_DIRECTORY);
+	if (dfd >= 0) {
+		snprintf(walk_path, sizeof(walk_path), "%s", path);
+		rc = walk_dt(dfd, walk_path);
+	} else if (errno != ENOENT) {
+		rc = -1;
+	}
+
+	/* move the nodes walk_dt() appended to where the old ones were */
+	added = dt_node_count - count;
+	if (rc == 0 && added && first < count) {
+		moved = malloc(added * sizeof(*moved));
+		if (moved == NULL)
+			return -1;
+
+		memcpy(moved, &dt_nodes[count], added * sizeof(*moved));
+		memmove(&dt_nodes[first + added], &dt_nodes[first],
+			(count - first) * sizeof(*moved));
+		memcpy(&dt_nodes[first], moved, added * sizeof(*moved));
+		free(moved);
+	}
+
+	return rc;
+}
+
+/**
+ * dt_index_hotplug
+ * @brief Bring the index up to date after a DLPAR operation
+ *
+ * A resource that was removed takes the nodes at and below the one
+ * with its drc-index along.  Processors are added below /cpus, which
+ * is read again on its own, and LMBs added to a partition that has
+ * ibm,dynamic-reconfiguration-memory have no node at all.  Anything
+ * else, or a failed operation, drops the whole index.
+ *
+ * @param type drmgr resource type, e.g. "cpu", "mem" or "pci"
+ * @param remove non-zero if the resource was removed
+ * @param drc_index drc-index of the resource, 0 if it is not known
+ * @param status drmgr exit status
+ */
+void
+dt_index_hotplug(const char *type, int remove, uint32_t drc_index,
+		 int status)
+{
+	char path[PATH_MAX];
+	int i, rc = 0;
+
+	if (!dt_index_valid)
+		return;
+
+	if (status || drc_index == 0) {
+		invalidate_dt_index();
+		return;
+	}
+
+	if (!strcmp(type, "mem") && dt_drconf)
+		return;
+
+	if (remove) {
+		for (i = 0; i < dt_node_count; i++)
+			if (dt_nodes[i].drc_index == drc_index)
+				break;
+
+		if (i == dt_node_count)
+			return;
+
+		/* the path is freed along with the node */
+		snprintf(path, sizeof(path), "%s", dt_nodes[i].path);
+		rc = rescan_dt_subtree(path);
+	} else if (!strcmp(type, "cpu")) {
+		rc = rescan_dt_subtree("/cpus");
+	} else {
+		invalidate_dt_index();
+		return;
+	}
+
+	free(dt_loc_hash);
+	dt_loc_hash = NULL;
+
+	if (rc || hash_dt_nodes()) {
+		log_msg(NULL, "Could not update the index of %s",
+			DT_INDEX_BASE);
+		invalidate_dt_index();
+		return;
+	}
+
+	dbg("Device tree index updated for %s drc-index %#x, %d nodes",
+	    type, drc_index, dt_node_count);
+}
+
+/**
+ * dt_index_find_loc
+ * @brief Find the device tree nodes with a given location code
+ *
+ * Further nodes with the same location code follow the returned
+ * node's next field, in device tree order.
+ *
+ * @param loc_code location code to look up
+ * @return first matching node, NULL if there is none
+ */
+struct dt_node *
+dt_index_find_loc(const char *loc_code)
+{
+	unsigned int slot;
+
+	if (loc_code == NULL)
+		return NULL;
+
+	if (!dt_index_valid && build_dt_index())
+		return NULL;
+
+	slot = loc_hash(loc_code) & (dt_loc_hash_size - 1);
+	while (dt_loc_hash[slot] != -1) {
+		if (!strcmp(dt_nodes[dt_loc_hash[slot]].loc_code, loc_code))
+			return &dt_nodes[dt_loc_hash[slot]];
+
+		slot = (slot + 1) & (dt_loc_hash_size - 1);
+	}
+
+	return NULL;
+}
+
+/**
+ * dt_index_next
+ * @brief Next node with the same location code
+ *
+ * @param node node returned by dt_index_find_loc() or dt_index_next()
+ * @return next matching node, NULL if there is none
+ */
+struct dt_node *
+dt_index_next(struct dt_node *node)
+{
+	if (node == NULL || node->next == -1)
+		return NULL;
+
+	return &dt_nodes[node->next];
+}
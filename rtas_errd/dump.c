@@ -37,12 +37,16 @@
 
 #define DUMP_MAX_FNAME_LEN	40
 #define DUMP_BUF_SZ		4096
+#ifndef EXTRACT_PLATDUMP_CMD
 #define EXTRACT_PLATDUMP_CMD	"/usr/sbin/extract_platdump"
+#endif
 #define SCANLOG_DUMP_FILE	"/proc/ppc64/scan-log-dump"
 #define SCANLOG_DUMP_EXISTS	"/proc/device-tree/chosen/ibm,scan-log-data"
 #define SYSID_FILE		"/proc/device-tree/system-id"
 #define SCANLOG_MODULE		"scanlog"
+#ifndef MODPROBE_PROGRAM
 #define MODPROBE_PROGRAM	"/sbin/modprobe"
+#endif
 
 /**
  * get_machine_serial
@@ -289,8 +293,12 @@ check_platform_dump(struct event *event)
 	char	*pathname = NULL;
 	FILE	*f;
 	int	rc, bytes;
-	char    *system_args[3] = {NULL, };     /* execv arguments      */
+	char    *system_args[5] = {NULL, };     /* execv arguments      */
 	char 	tmp_sys_arg[60];		/* tmp sys_args		*/
+	char	size_arg[24];
+	char	checksum[40] = "";
+	uint64_t dump_size;
+	int	i = 0;
 	pid_t	cpid;                           /* child pid            */
 
 	dump_scn = rtas_get_dump_scn(event->rtas_event);
@@ -312,8 +320,17 @@ check_platform_dump(struct event *event)
 	dbg("Dump ID: 0x%016LX", dump_tag);
 
 	snprintf(tmp_sys_arg, 60, "0x%016LX", (long long unsigned int)dump_tag);
-	system_args[0] = EXTRACT_PLATDUMP_CMD;
-	system_args[1] = tmp_sys_arg;
+	system_args[i++] = EXTRACT_PLATDUMP_CMD;
+
+	/* Let extract_platdump preallocate the dump file */
+	dump_size = ((uint64_t)dump_scn->size_hi << 32) | dump_scn->size_lo;
+	if (dump_size) {
+		snprintf(size_arg, sizeof(size_arg), "%llu",
+			 (unsigned long long)dump_size);
+		system_args[i++] = "-s";
+		system_args[i++] = size_arg;
+	}
+	system_args[i++] = tmp_sys_arg;
 
 	/* sigchld_handler() messes up pclose(). */
 	restore_sigchld_default();
@@ -331,6 +348,9 @@ check_platform_dump(struct event *event)
 		setup_sigchld_handler();
 		return;
 	}
+	/* followed by the checksum of the dump file */
+	if (!fgets(checksum, sizeof(checksum), f))
+		checksum[0] = '\0';
 	rc = spclose(f, cpid);
 
 	setup_sigchld_handler();
@@ -361,6 +381,12 @@ check_platform_dump(struct event *event)
 	}
 	platform_log_write("Platform Dump Notification\n");
 	platform_log_write("    Dump Location: %s\n", pathname);
+	if (!strncmp(checksum, "crc32 ", 6)) {
+		if ((pos = strchr(checksum, '\n')) != NULL)
+			*pos = '\0';
+		platform_log_write("    Dump Checksum (CRC-32): %s\n",
+				   checksum + 6);
+	}
 	free(pathname);
 
 	return;
@@ -40,6 +40,7 @@
 
 #include "rtas_errd.h"
 #include "ela_msg.h"
+#include "ela_symptom.h"
 
 /* Function prototypes */
 static int analyze_io_bus_error(struct event *, int, int);
@@ -218,12 +219,12 @@ set_srn_and_callouts(struct event *event, struct event_description_pre_v6 *ptr,
 	else
 		snprintf(srn, 80, "%0X", post_error);
 
-	event->sl_entry->refcode = strdup(srn);
+	event->sl_entry->refcode = event_strdup(event, srn);
 	if (!event->sl_entry->refcode) {
 		log_msg(event, "Memory allocation failed, at "
 				"event->l_entry->refcode");
 		return -1;
-	} /* strdup(sl_entry->refcode) */
+	} /* event_strdup(sl_entry->refcode) */
 
 	dbg("SRN: \"%s\"", event->sl_entry->refcode);
 
@@ -560,7 +561,6 @@ process_pre_v6(struct event *event)
 	int loc_mode;
 	int ignore_fru;
 	char *devtree = NULL;
-	char target[80];
 
 	struct rtas_event_exthdr *exthdr;
 
@@ -570,10 +570,7 @@ process_pre_v6(struct event *event)
 	memset(&sendev, 0, sizeof(struct device_ela));
 
         /* Reset for this analysis */
-        if (event->loc_codes != NULL) {
-                free(event->loc_codes);
-                event->loc_codes = NULL;
-        }
+        event->loc_codes = NULL;
 
 	exthdr = rtas_get_event_exthdr_scn(event->rtas_event);
 	if (exthdr == NULL) {
@@ -582,7 +579,7 @@ process_pre_v6(struct event *event)
 	}
 
 	/* create and populate an entry to be logged to servicelog */
-	event->sl_entry = calloc(1, sizeof(struct sl_event));
+	event->sl_entry = event_alloc(event, sizeof(struct sl_event));
 	if (event->sl_entry == NULL) {
 		log_msg(event, "Memory allocation failed");
 		return -1;
@@ -603,9 +600,9 @@ process_pre_v6(struct event *event)
 		event->sl_entry->disposition = SL_DISP_UNRECOVERABLE;
 
 	event->sl_entry->raw_data_len = event->length;
-	event->sl_entry->raw_data = malloc(event->length);
+	event->sl_entry->raw_data = event_alloc(event, event->length);
 	if (event->sl_entry->raw_data == NULL) {
-		free(event->sl_entry);
+		event->sl_entry = NULL;
 		log_msg(event, "Memory allocation failed");
 		return -1;
 	}
@@ -625,11 +622,11 @@ process_pre_v6(struct event *event)
 	if ((loc = strstr((char *)&event->event_buf[I_IBM], "IBM")) != NULL) {
 		/* loc code is a null terminated string beginning at loc + 4 */
 		if (strlen(loc + 4)) {
-			event->loc_codes = strdup(loc+4);
+			event->loc_codes = event_strdup(event, loc+4);
 			if (!event->loc_codes) {
 				log_msg(event, "Memory allocation failed, at event->loc_codes");
 				return 0;
-			} /* strdup (event->loc_codes) */
+			} /* event_strdup (event->loc_codes) */
 		}
 	} /* vendor tag */
 
@@ -668,11 +665,9 @@ process_pre_v6(struct event *event)
 		ignore_fru = FALSE;
 		while ((loc = get_loc_code(event, loc_mode, NULL)) != NULL) {
 			loc_mode = NEXT_LOC;
-			if (devtree == NULL)
-				devtree = get_dt_status(NULL);
+			devtree = get_dt_status(loc);
 			if (devtree) {
-				sprintf(target, "%s fail-offline", loc);
-				if (strstr(devtree, target)) {
+				if (!strcmp(devtree, "fail-offline")) {
 					/* found FRU and status in devtree */
 					/* can ignore this fru */
 					ignore_fru = TRUE;
@@ -1315,7 +1310,10 @@ report_srn(struct event *event, int nlocs,
 
 		/* allocate space for more FRUs */
 		temp_event = (struct event_description_pre_v6 *)
-			     calloc(1, sizeof(struct event_description_pre_v6));
+			     event_alloc(event,
+				sizeof(struct event_description_pre_v6));
+		if (temp_event == NULL)
+			return -1;
 
 		/* copy everything over from the original event */
 		strcpy(temp_event->dname, e_desc->dname);
@@ -1341,18 +1339,15 @@ report_srn(struct event *event, int nlocs,
 		/* Log additional error descriptions */
 		if (add_more_descrs(event, temp_event))
 			return -1;
-
-		free(temp_event);
         }
 
 	event->sl_entry->call_home_status = SL_CALLHOME_CANDIDATE;
 
-	event->sl_entry->description = malloc(strlen(e_desc->rmsg)+1);
+	event->sl_entry->description = event_strdup(event, e_desc->rmsg);
 	if (event->sl_entry->description == NULL) {
 		log_msg(event, "Memory allocation failed");
 		return -1;
 	}
-	strcpy(event->sl_entry->description, e_desc->rmsg);
 
 	dbg("srn: \"%s\"", event->sl_entry->refcode);
 
@@ -1385,7 +1380,6 @@ get_loc_code(struct event *event, int mode, int *nlocs)
 	char *loc;
 	int prev_space = 0;
 	static char *copyLCB = NULL;
-	static char *save_copyLCB = NULL;
 	static char *start_loc = NULL;	/* start or next pointer for loc code */
 	static char *end_loc = NULL;	/* end of location code buffer */
 
@@ -1396,19 +1390,11 @@ get_loc_code(struct event *event, int mode, int *nlocs)
 	}
 
 	if (mode == FIRST_LOC) {
-		if (save_copyLCB) {
-			/* throw away the previous allocation of buffer */
-			/* even though not used up by get next calls */
-			free(save_copyLCB);
-			copyLCB = NULL;
-		}
-
-		copyLCB = malloc(strlen(event->loc_codes) + 1);
+		/* the copy goes with the event */
+		copyLCB = event_strdup(event, event->loc_codes);
 		if (copyLCB == NULL)
 			return NULL;
 
-		save_copyLCB = copyLCB;
-		strcpy(copyLCB, event->loc_codes);
 		start_loc = copyLCB;
 
 		/* Force processing to stop at special "Hide" character */
@@ -1563,22 +1549,19 @@ report_menugoal(struct event *event, char *fmt, ...)
 		}
 
 		snprintf(menu_num_str, 20, "#%d", atoi(buffer));
-		event->sl_entry->refcode = malloc(
-						strlen(menu_num_str)+1);
+		event->sl_entry->refcode = event_strdup(event, menu_num_str);
 		if (event->sl_entry->refcode == NULL) {
 			log_msg(event, "Memory allocation failed.\n");
 			return -1;
 		}
-		strcpy(event->sl_entry->refcode, menu_num_str);
 
 		msg = strchr(buffer, ' ') + 1;
-		event->sl_entry->description = malloc(strlen(msg)+1);
+		event->sl_entry->description = event_strdup(event, msg);
 		if (event->sl_entry->description == NULL) {
-			free(event->sl_entry->refcode);
+			event->sl_entry->refcode = NULL;
 			log_msg(event, "Memory allocation failed.\n");
 			return -1;
 		}
-		strcpy(event->sl_entry->description, msg);
 
 		dbg("menugoal: number = %s, message = \"%s\"", menu_num_str,
 		    msg);
@@ -1730,12 +1713,12 @@ report_io_error_frus(struct event *event, int sn,
 static int
 get_cpu_frus(struct event *event)
 {
-	char *buf, *tbuf = NULL, *free_me = NULL;
+	char *buf, *tbuf = NULL;
 	char *loc1 = NULL, *loc2 = NULL, *loc3 = NULL;
 	int nlocs = 0;
 	int rc = RC_INVALID;
 
-	buf = malloc(strlen(event->loc_codes)+4);
+	buf = event_alloc(event, strlen(event->loc_codes)+4);
 	if (buf == NULL)
 		return 0;
 
@@ -1745,7 +1728,6 @@ get_cpu_frus(struct event *event)
 	if ((tbuf == NULL) || (nlocs < 1))
 		goto out;
 
-	free_me = tbuf;
 	strcpy(loc1, tbuf);
 
 	if (nlocs > 1) {
@@ -1779,10 +1761,8 @@ get_cpu_frus(struct event *event)
 		if (is_planar(loc2)) {
 			if (is_not_fru(loc3)) {
 				/* Rearrange locs as loc2, loc1 */
-				if (event->loc_codes != NULL)
-					free(event->loc_codes);
 				event->loc_codes =
-					malloc(strlen(loc1) +
+					event_alloc(event, strlen(loc1) +
 							strlen(loc2) + 2);
 				if (event->loc_codes == NULL)
 					goto out;
@@ -1791,10 +1771,8 @@ get_cpu_frus(struct event *event)
 				rc = RC_PLANAR_CPU;
 			} else if (is_cpu(loc3)) {
 				/* Rearrange loc as loc2, loc1, loc3 */
-				if (event->loc_codes != NULL)
-					free(event->loc_codes);
 				event->loc_codes =
-					malloc(strlen(loc1) +
+					event_alloc(event, strlen(loc1) +
 							strlen(loc2) +
 							strlen(loc3) + 3);
 				if (event->loc_codes == NULL)
@@ -1807,8 +1785,6 @@ get_cpu_frus(struct event *event)
 		} /* is_planar(loc2) */
 	} /* is_cpu(loc1) */
 out:
-	free(buf);
-	free(free_me);
 	return rc;
 }
 
@@ -2481,148 +2457,16 @@ process_v3_logs(struct event *event, int error_type)
  * 	displayed in lieu of encoding a SRN.
  *
  */
-#define NCPUSYMPTOMS	 9
-#define NMEMSYMPTOMS	17
-#define NIOSYMPTOMS	17
-#define NSPSYMPTOMS	33
-#define NSPSYMPTOMS_ADDITIONAL	9
 int
 convert_symptom(struct event *event, int format_type, int predictive,
 		char **msg)
 {
 	int seqn;
 	int sbits;
-	int signature;
 	int msg_index;
 	int error_type;
 
-	/* Look up tables for sequence number to reason code messages. */
-	int cpu_log_sig[NCPUSYMPTOMS] = {0x00, 0x80, 0x40, 0x20, 0x10,
-					0x08, 0x04, 0x02, 0x01};
-	char *cpu_log[NCPUSYMPTOMS][2]= {
-		{ MSGCPUALLZERO, DEFER_MSGALLZERO},
-		{ MSGCPUB12b0, DEFER_MSGCPUB12b0},
-		{ MSGCPUB12b1, DEFER_MSGCPUB12b1},
-		{ MSGCPUB12b2, DEFER_MSGCPUB12b2},
-		{ MSGCPUB12b3, DEFER_MSGCPUB12b3},
-		{ MSGCPUB12b4, DEFER_MSGCPUB12b4},
-		{ MSGCPUB12b5, DEFER_MSGCPUB12b5},
-		{ MSGCPUB12b6, DEFER_MSGCPUB12b6},
-		{ MSGCPUB12b7, DEFER_MSGCPUB12b7}
-	};
-
-	int mem_log_sig[NMEMSYMPTOMS] = {0x0000, 0x8000, 0x4000, 0x2000, 0x1000,
-					 0x0800, 0x0400, 0x0200, 0x0100,
-					 0x0080, 0x0040, 0x0020, 0x0010,
-					 0x0008, 0x0004, 0x0002, 0x0001};
-	char *mem_log[NMEMSYMPTOMS][2] = {
-		{ MSGMEMALLZERO, DEFER_MSGALLZERO},
-		{ MSGMEMB12b0, DEFER_MSGMEMB12b0},
-		{ MSGMEMB12b1, DEFER_MSGMEMB12b1},
-		{ MSGMEMB12b2, DEFER_MSGMEMB12b2},
-		{ MSGMEMB12b3, DEFER_MSGMEMB12b3},
-		{ MSGMEMB12b4, DEFER_MSGMEMB12b4},
-		{ MSGMEMB12b5, DEFER_MSGMEMB12b5},
-		{ MSGMEMB12b6, DEFER_MSGMEMB12b6},
-		{ MSGMEMB12b7, DEFER_MSGMEMB12b7},
-		{ MSGMEMB13b0, DEFER_MSGMEMB13b0},
-		{ MSGMEMB13b1, DEFER_MSGMEMB13b1},
-		{ MSGMEMB13b2, DEFER_MSGMEMB13b2},
-		{ MSGMEMB13b3, DEFER_MSGMEMB13b3},
-		{ MSGMEMB13b4, DEFER_MSGMEMB13b4},
-		{ MSGRESERVED, DEFER_MSGRESERVED},
-		{ MSGMEMB13b6, DEFER_MSGMEMB13b6},
-		{ MSGMEMB13b7, DEFER_MSGMEMB13b7},
-	};
-
-	/* I/O Byte 13, bits 0-2 are describtions */
-	/* that are masked off the symptom bits. */
-	int io_log_sig[NIOSYMPTOMS] = {0x0000, 0x8000, 0x4000, 0x2000, 0x1000,
-				       0x0800, 0x0400, 0x0410, 0x0200, 0x0210,
-				       0x0100, 0x0110, 0x0010,
-				       0x0008, 0x0004, 0x0002, 0x0001};
-	char * io_log[NIOSYMPTOMS][3] = {
-		{ MSGIOALLZERO, DEFER_MSGALLZERO},
-		{ MSGIOB12b0, DEFER_MSGIOB12b0},
-		{ MSGIOB12b1, DEFER_MSGIOB12b1},
-		{ MSGIOB12b2, DEFER_MSGIOB12b2},
-		{ MSGIOB12b3, DEFER_MSGIOB12b3},
-		{ MSGIOB12b4, DEFER_MSGIOB12b4},
-		{ MSGIOB12b5, DEFER_MSGIOB12b5},
-		{ MSGIOB12b5B13b3, DEFER_MSGIOB12b5B13b3},
-		{ MSGIOB12b6, DEFER_MSGIOB12b6},
-		{ MSGIOB12b6B13b3, DEFER_MSGIOB12b6B13b3},
-		{ MSGIOB12b7, DEFER_MSGIOB12b7},
-		{ MSGIOB12b7B13b3, DEFER_MSGIOB12b7B13b3},
-		{ MSGIOB13b3, DEFER_MSGIOB13b3},
-		{ MSGIOB13b4, DEFER_MSGIOB13b4},
-		{ MSGIOB13b5, DEFER_MSGIOB13b5},
-		{ MSGIOB13b6, DEFER_MSGIOB13b6},
-		{ MSGIOB13b7, DEFER_MSGIOB13b7},
-	};
-
-	int sp_log_sig[NSPSYMPTOMS] = { 0x00000000,
-		0x80000000, 0x40000000, 0x20000000, 0x10000000,
-		0x08000000, 0x04000000, 0x02000000, 0x01000000,
-		0x00800000, 0x00400000, 0x00200000, 0x00100000,
-		0x00080000, 0x00040000, 0x00020000, 0x00010000,
-		0x00008000, 0x00004000, 0x00002000, 0x00001000,
-		0x00000800, 0x00000400, 0x00000200, 0x00000100,
-		0x00000080, 0x00000040, 0x00000020, 0x00000010,
-		0x00000008, 0x00000004, 0x00000002, 0x00000001};
-	char *sp_log[NSPSYMPTOMS][2] = {
-		{ MSGSPALLZERO, DEFER_MSGALLZERO},
-		{ MSGSPB16b0, DEFER_MSGSPB16b0},
-		{ MSGSPB16b1, DEFER_MSGSPB16b1},
-		{ MSGSPB16b2, DEFER_MSGSPB16b2},
-		{ MSGSPB16b3, DEFER_MSGSPB16b3},
-		{ MSGSPB16b4, DEFER_MSGSPB16b4},
-		{ MSGSPB16b5, DEFER_MSGSPB16b5},
-		{ MSGSPB16b6, DEFER_MSGSPB16b6},
-		{ MSGSPB16b7, DEFER_MSGSPB16b7},
-		{ MSGSPB17b0, DEFER_MSGSPB17b0},
-		{ MSGSPB17b1, DEFER_MSGSPB17b1},
-		{ MSGSPB17b2, DEFER_MSGSPB17b2},
-		{ MSGSPB17b3, DEFER_MSGSPB17b3},
-		{ MSGSPB17b4, DEFER_MSGSPB17b4},
-		{ MSGSPB17b5, DEFER_MSGSPB17b5},
-		{ MSGRESERVED,DEFER_MSGRESERVED},
-		{ MSGRESERVED,DEFER_MSGRESERVED},
-		{ MSGSPB18b0, DEFER_MSGSPB18b0},
-		{ MSGSPB18b1, DEFER_MSGSPB18b1},
-		{ MSGSPB18b2, DEFER_MSGSPB18b2},
-		{ MSGSPB18b3, DEFER_MSGSPB18b3},
-		{ MSGSPB18b4, DEFER_MSGSPB18b4},
-		{ MSGRESERVED,DEFER_MSGRESERVED},
-		{ MSGSPB18b6, DEFER_MSGSPB18b6},
-		{ MSGSPB18b7, DEFER_MSGSPB18b7},
-		{ MSGSPB19b0, DEFER_MSGSPB19b0},
-		{ MSGSPB19b1, DEFER_MSGSPB19b1},
-		{ MSGRESERVED, DEFER_MSGRESERVED},
-		{ MSGRESERVED, DEFER_MSGRESERVED},
-		{ MSGSPB19b4, DEFER_MSGSPB19b4},
-		{ MSGSPB19b5, DEFER_MSGSPB19b5},
-		{ MSGSPB19b6, DEFER_MSGSPB19b6},
-		{ MSGRESERVED, DEFER_MSGRESERVED},
-	};
-
-	int sp_log_additional_sig[NSPSYMPTOMS_ADDITIONAL] = {0x00,
-						0x80, 0x40, 0x20, 0x10,
-						0x08, 0x04, 0x02, 0x01};
-	char *sp_log_additional[NSPSYMPTOMS_ADDITIONAL][2] = {
-		{ MSGSPALLZERO, DEFER_MSGALLZERO},
-		{ MSGSPB28b0, DEFER_MSGSPB28b0},
-		{ MSGSPB28b1, DEFER_MSGSPB28b1},
-		{ MSGSPB28b2, DEFER_MSGSPB28b2},
-		{ MSGSPB28b3, DEFER_MSGSPB28b3},
-		{ MSGSPB28b4, DEFER_MSGSPB28b4},
-		{ MSGSPB28b5, DEFER_MSGSPB28b5},
-		{ MSGSPB28b6, DEFER_MSGSPB28b6},
-		{ MSGSPB28b7, DEFER_MSGSPB28b7},
-	};
-
 	*msg = NULL;
-	seqn = 1;
 	msg_index = 0;
 
 	if (predictive)
@@ -2631,30 +2475,17 @@ convert_symptom(struct event *event, int format_type, int predictive,
 	switch (format_type) {
 		case RTAS_EXTHDR_FMT_CPU:
 			sbits = event->event_buf[I_BYTE12];
-			while (seqn < NCPUSYMPTOMS) {
-				signature = cpu_log_sig[seqn];
-				if ((sbits & signature) == signature)
-					break;
-				seqn++;
-			}
-			if (seqn == NCPUSYMPTOMS)
-				seqn = 0;
-			*msg = cpu_log[seqn][msg_index];
+			seqn = ela_symptom_row(sbits,
+					       ELA_NROWS(ela_cpu_msg) - 1);
+			*msg = ela_cpu_msg[seqn][msg_index];
 			break;
 
 		case RTAS_EXTHDR_FMT_MEMORY:
 			sbits = (event->event_buf[I_BYTE12] << 8) |
 				 event->event_buf[I_BYTE13];
-
-			while (seqn < NMEMSYMPTOMS) {
-				signature = mem_log_sig[seqn];
-				if ((sbits & signature) == signature)
-					break;
-				seqn++;
-			}
-			if (seqn == NMEMSYMPTOMS)
-				seqn = 0;
-			*msg = mem_log[seqn][msg_index];
+			seqn = ela_symptom_row(sbits,
+					       ELA_NROWS(ela_mem_msg) - 1);
+			*msg = ela_mem_msg[seqn][msg_index];
 			break;
 
 		case RTAS_EXTHDR_FMT_IO:
@@ -2667,17 +2498,8 @@ convert_symptom(struct event *event, int format_type, int predictive,
 
 			sbits = (event->event_buf[I_BYTE12] << 8) |
 				 event->event_buf[I_BYTE13];
-			sbits &= 0x0FF1F;
-
-			while (seqn < NIOSYMPTOMS) {
-				signature = io_log_sig[seqn];
-				if ((sbits & signature) == signature)
-					break;
-				seqn++;
-			}
-			if (seqn == NIOSYMPTOMS)
-				seqn = 0;
-			*msg = io_log[seqn][msg_index];
+			seqn = ela_symptom_io_row(sbits);
+			*msg = ela_io_msg[seqn][msg_index];
 			break;
 
 		case RTAS_EXTHDR_FMT_IBM_SP:
@@ -2686,45 +2508,22 @@ convert_symptom(struct event *event, int format_type, int predictive,
 				(event->event_buf[I_BYTE18] << 8 ) |
 				event->event_buf[I_BYTE19]);
 			if (sbits) {
-				while (seqn < NSPSYMPTOMS) {
-					signature = sp_log_sig[seqn];
-					if ((sbits & signature) == signature)
-						break;
-					seqn++;
-				}
-				if (seqn >= NSPSYMPTOMS)
-					seqn = 0;
-				*msg = sp_log[seqn][msg_index];
-				break;
-			} else {
-				/* use additional symptom bits */
-				sbits = event->event_buf[I_BYTE28];
-				if (!sbits) {
-					seqn = 0;
-					*msg =
-					    sp_log_additional[seqn][msg_index];
-				} else {
-				  while ((seqn < NSPSYMPTOMS_ADDITIONAL)) {
-					signature = sp_log_additional_sig[seqn];
-					if ((sbits & signature) == signature)
-						break;
-					seqn++;
-				  }
-
-				  if (seqn >= NSPSYMPTOMS_ADDITIONAL) {
-					seqn = 0;
-					*msg =
-					    sp_log_additional[seqn][msg_index];
-				  } else {
-					*msg =
-					    sp_log_additional[seqn][msg_index];
-					seqn += (NSPSYMPTOMS - 1);
-					/* after original symptom bits */
-				  }
-				}
+				seqn = ela_symptom_row(sbits,
+						ELA_NROWS(ela_sp_msg) - 1);
+				*msg = ela_sp_msg[seqn][msg_index];
 				break;
 			}
 
+			/* use additional symptom bits */
+			sbits = event->event_buf[I_BYTE28];
+			seqn = ela_symptom_row(sbits,
+					ELA_NROWS(ela_sp_additional_msg) - 1);
+			*msg = ela_sp_additional_msg[seqn][msg_index];
+			/* after original symptom bits */
+			if (seqn)
+				seqn += ELA_NROWS(ela_sp_msg) - 1;
+			break;
+
 		default:
 			/*
 			 * Should not get here unless the format is
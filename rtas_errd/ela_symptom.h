@@ -0,0 +1,193 @@
+/**
+ * @file ela_symptom.h
+ * @brief Lookup tables for the pre-v6 ELA symptom bit messages
+ *
+ * Each error log format lists the reason code messages for its symptom
+ * bits once below, most significant bit first, and the read-only
+ * message tables are generated from those lists.  Row 0 of each table
+ * is the message for all symptom bits clear.  The highest symptom bit
+ * set picks the row (its sequence number), so a lookup is a bit scan
+ * and an array index rather than a search.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _H_ELA_SYMPTOM
+#define _H_ELA_SYMPTOM
+
+#include "ela_msg.h"
+
+/* CPU, byte 12 */
+#define ELA_CPU_LIST(X) \
+	X(MSGCPUB12b0) X(MSGCPUB12b1) X(MSGCPUB12b2) X(MSGCPUB12b3) \
+	X(MSGCPUB12b4) X(MSGCPUB12b5) X(MSGCPUB12b6) X(MSGCPUB12b7)
+
+/* Memory, bytes 12 - 13 */
+#define ELA_MEM_LIST(X) \
+	X(MSGMEMB12b0) X(MSGMEMB12b1) X(MSGMEMB12b2) X(MSGMEMB12b3) \
+	X(MSGMEMB12b4) X(MSGMEMB12b5) X(MSGMEMB12b6) X(MSGMEMB12b7) \
+	X(MSGMEMB13b0) X(MSGMEMB13b1) X(MSGMEMB13b2) X(MSGMEMB13b3) \
+	X(MSGMEMB13b4) X(MSGRESERVED) X(MSGMEMB13b6) X(MSGMEMB13b7)
+
+/*
+ * I/O, bytes 12 - 13.  Byte 13, bits 0-2 are descriptions that are
+ * masked off the symptom bits.  The B13b3 combinations follow the
+ * byte 12 bit they go with, but the byte 12 bit on its own comes
+ * first and always matches, so they are never picked; they keep
+ * their rows so the sequence numbers do not change.
+ */
+#define ELA_IO_LIST(X) \
+	X(MSGIOB12b0) X(MSGIOB12b1) X(MSGIOB12b2) X(MSGIOB12b3) \
+	X(MSGIOB12b4) X(MSGIOB12b5) X(MSGIOB12b5B13b3) X(MSGIOB12b6) \
+	X(MSGIOB12b6B13b3) X(MSGIOB12b7) X(MSGIOB12b7B13b3) X(MSGIOB13b3) \
+	X(MSGIOB13b4) X(MSGIOB13b5) X(MSGIOB13b6) X(MSGIOB13b7)
+
+#define ELA_IO_MASK	0xFF1F
+
+/* Service processor, bytes 16 - 19 */
+#define ELA_SP_LIST(X) \
+	X(MSGSPB16b0) X(MSGSPB16b1) X(MSGSPB16b2) X(MSGSPB16b3) \
+	X(MSGSPB16b4) X(MSGSPB16b5) X(MSGSPB16b6) X(MSGSPB16b7) \
+	X(MSGSPB17b0) X(MSGSPB17b1) X(MSGSPB17b2) X(MSGSPB17b3) \
+	X(MSGSPB17b4) X(MSGSPB17b5) X(MSGRESERVED) X(MSGRESERVED) \
+	X(MSGSPB18b0) X(MSGSPB18b1) X(MSGSPB18b2) X(MSGSPB18b3) \
+	X(MSGSPB18b4) X(MSGRESERVED) X(MSGSPB18b6) X(MSGSPB18b7) \
+	X(MSGSPB19b0) X(MSGSPB19b1) X(MSGRESERVED) X(MSGRESERVED) \
+	X(MSGSPB19b4) X(MSGSPB19b5) X(MSGSPB19b6) X(MSGRESERVED)
+
+/* Service processor, byte 28, used when bytes 16 - 19 are all clear */
+#define ELA_SP_ADDITIONAL_LIST(X) \
+	X(MSGSPB28b0) X(MSGSPB28b1) X(MSGSPB28b2) X(MSGSPB28b3) \
+	X(MSGSPB28b4) X(MSGSPB28b5) X(MSGSPB28b6) X(MSGSPB28b7)
+
+/* The message and the deferred repair message for a symptom bit */
+#define ELA_MSG_ROW(msg)	{ msg, DEFER_##msg },
+
+/*
+ * Reason code messages by sequence number, the second column is used
+ * for predictive errors.
+ */
+static char * const ela_cpu_msg[][2] = {
+	{ MSGCPUALLZERO, DEFER_MSGALLZERO },
+	ELA_CPU_LIST(ELA_MSG_ROW)
+};
+
+static char * const ela_mem_msg[][2] = {
+	{ MSGMEMALLZERO, DEFER_MSGALLZERO },
+	ELA_MEM_LIST(ELA_MSG_ROW)
+};
+
+static char * const ela_io_msg[][2] = {
+	{ MSGIOALLZERO, DEFER_MSGALLZERO },
+	ELA_IO_LIST(ELA_MSG_ROW)
+};
+
+static char * const ela_sp_msg[][2] = {
+	{ MSGSPALLZERO, DEFER_MSGALLZERO },
+	ELA_SP_LIST(ELA_MSG_ROW)
+};
+
+static char * const ela_sp_additional_msg[][2] = {
+	{ MSGSPALLZERO, DEFER_MSGALLZERO },
+	ELA_SP_ADDITIONAL_LIST(ELA_MSG_ROW)
+};
+
+#define ELA_NROWS(table)	((int)(sizeof(table) / sizeof((table)[0])))
+
+/*
+ * Row of the ela_io_msg table for the highest symptom bit set, bit 0
+ * being the least significant; bits 5 - 7 are masked off.
+ */
+static const unsigned char ela_io_row[16] = {
+	16, 15, 14, 13, 12, 0, 0, 0, 10, 8, 6, 5, 4, 3, 2, 1
+};
+
+/**
+ * ela_symptom_msb
+ * @brief Find the highest bit set
+ *
+ * @param sbits symptom bits, not 0
+ * @return the bit number, 0 being the least significant
+ */
+static inline int
+ela_symptom_msb(unsigned int sbits)
+{
+	int msb = 0;
+
+	if (sbits & 0xFFFF0000) {
+		sbits >>= 16;
+		msb += 16;
+	}
+	if (sbits & 0xFF00) {
+		sbits >>= 8;
+		msb += 8;
+	}
+	if (sbits & 0xF0) {
+		sbits >>= 4;
+		msb += 4;
+	}
+	if (sbits & 0xC) {
+		sbits >>= 2;
+		msb += 2;
+	}
+	if (sbits & 0x2)
+		msb += 1;
+
+	return msb;
+}
+
+/**
+ * ela_symptom_row
+ * @brief Sequence number of a symptom bit table
+ *
+ * For the tables with one row per symptom bit, most significant first.
+ *
+ * @param sbits symptom bits
+ * @param nbits number of symptom bits, the table has one row more
+ * @return the row of the highest bit set, 0 if none are
+ */
+static inline int
+ela_symptom_row(unsigned int sbits, int nbits)
+{
+	if (nbits < 32)
+		sbits &= (1U << nbits) - 1;
+
+	if (!sbits)
+		return 0;
+
+	return nbits - ela_symptom_msb(sbits);
+}
+
+/**
+ * ela_symptom_io_row
+ * @brief Sequence number of the I/O symptom bit table
+ *
+ * @param sbits symptom bits, bytes 12 - 13
+ * @return the row of the ela_io_msg table
+ */
+static inline int
+ela_symptom_io_row(unsigned int sbits)
+{
+	sbits &= ELA_IO_MASK;
+
+	if (!sbits)
+		return 0;
+
+	return ela_io_row[ela_symptom_msb(sbits)];
+}
+
+#endif /* _H_ELA_SYMPTOM */
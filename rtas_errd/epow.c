@@ -39,7 +39,9 @@
 #define SENSOR_TOKEN_EPOW_SENSOR		9
 
 /* File paths */
+#ifndef EPOW_PROGRAM
 #define EPOW_PROGRAM		"/etc/rc.powerfail"
+#endif
 #define EPOW_PROGRAM_NOPATH	"rc.powerfail"
 
 /**
@@ -51,6 +53,23 @@
  */
 static int time_remaining = 0;
 
+/**
+ * @var epow_deadline_ms
+ * @brief Time the platform allows before it loses power, by EPOW status
+ *
+ * Indexed by the values parse_epow() returns; 0 where there is no
+ * deadline.
+ */
+static const int epow_deadline_ms[] = {
+	[1] = 4,
+	[2] = 4,
+	[3] = 4,
+	[4] = 20 * 1000,
+	[5] = 20 * 1000,
+	[6] = 10 * 60 * 1000,
+	[7] = 10 * 60 * 1000,
+};
+
 /**
  * epow_timer_handler
  * @brief Routine to handle SIGALRM timer interrupts.
@@ -111,18 +130,49 @@ epow_timer_handler(int sig, siginfo_t siginfo, void *context)
 	return;
 }
 
+/*
+ * The message is only kept in the event's additional text here;
+ * check_epow() logs it once the EPOW has been acted on.
+ */
 static void
 log_epow(struct event *event, char *fmt, ...)
 {
 	va_list ap;
-	char	buf[1024];
 
 	va_start(ap, fmt);
-	vsprintf(buf, fmt, ap);
+	vsnprintf(event->addl_text, ADDL_TEXT_MAX, fmt, ap);
 	va_end(ap);
+}
+
+/**
+ * epow_action_time
+ * @brief Record how long it took from reading an EPOW to acting on it
+ *
+ * @param event pointer to the RTAS event
+ * @param status EPOW status, as returned by parse_epow()
+ */
+static void
+epow_action_time(struct event *event, int status)
+{
+	uint64_t ns;
+	int deadline = 0;
+
+	/* Events not read from the kernel (e.g. from update.c) */
+	if (event->read_time == 0)
+		return;
+
+	ns = stats_record(STAGE_EPOW_ACTION, event->read_time);
+	dbg("EPOW action taken %llu us after the event was read",
+	    (unsigned long long)ns / 1000);
+
+	if (status > 0 &&
+	    status < sizeof(epow_deadline_ms) / sizeof(epow_deadline_ms[0]))
+		deadline = epow_deadline_ms[status];
 
-	log_msg(event, buf);
-	snprintf(event->addl_text, ADDL_TEXT_MAX, "%s", buf);
+	if (deadline && ns / 1000000 >= deadline)
+		log_msg(event, "EPOW action was taken %llu ms after the event "
+			"was read, the platform allows %d ms",
+			(unsigned long long)ns / 1000000, deadline);
 }
 
 /**
@@ -404,6 +454,7 @@ check_epow(struct event *event)
 	 * if the error is serious enough to warrant further action,
 	 * fork and exec the script to handle it
 	 */
+	event->addl_text[0] = '\0';
 	current_status = parse_epow(event);
 	update_epow_status_file(current_status);
 
@@ -428,5 +479,11 @@ check_epow(struct event *event)
 		}
 	}
 
+	epow_action_time(event, current_status);
+
+	/* Only now is there time to log what parse_epow() found */
+	if (event->addl_text[0])
+		log_msg(event, "%s", event->addl_text);
+
 	return current_status;
 }
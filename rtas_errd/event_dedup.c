@@ -0,0 +1,408 @@
+/**
+ * @file event_dedup.c
+ * @brief Recognize RTAS events that have already been handled
+ *
+ * Firmware delivers some events again (marked ALREADY_REPORTED), in
+ * floods after a service processor reset, and events found in syslog
+ * at startup may have been seen before.  A v6 event is identified by
+ * its platform log ID, creator, creation time and primary SRC; a hash
+ * of these is kept for the last EVENT_DEDUP_MAX events put in
+ * servicelog.  An event whose hash is already known is still written to
+ * the platform log and acted on (a dump is extracted, a resource
+ * deallocated, ...), but it is not analyzed or put in servicelog again.
+ *
+ * An event is only remembered once its servicelog entry has been
+ * written, which the servicelog writer does from its own thread, so
+ * the store is locked.
+ *
+ * The hashes are kept in a sidecar of the platform log
+ * (<platform_log>.seen) used as a ring, so they survive a reboot.  Each
+ * record is written in place, and at startup the newest record (highest
+ * generation) tells where the ring continues.  Older (pre-v6) events do
+ * not carry a platform log ID and are always analyzed.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <librtasevent.h>
+#include "rtas_errd.h"
+
+#define EVENT_DEDUP_MAGIC	"RTASSEEN"
+#define EVENT_DEDUP_VERSION	1
+
+/**
+ * @def EVENT_DEDUP_MAX
+ * @brief Number of events remembered; the oldest is forgotten first
+ */
+#define EVENT_DEDUP_MAX		4096
+
+/**
+ * @def EVENT_DEDUP_BUCKETS
+ * @brief Hash chains for the in-memory lookup, a power of two
+ */
+#define EVENT_DEDUP_BUCKETS	1024
+
+/**
+ * struct event_dedup_hdr
+ * @brief On-disk header of the store
+ */
+struct event_dedup_hdr {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	entry_size;
+	uint32_t	max;
+	uint32_t	reserved;
+};
+
+/**
+ * struct event_dedup_entry
+ * @brief On-disk (and in-memory) record for one event
+ *
+ * Like the platform log index the store is local to the partition, so
+ * records are in host endian.
+ */
+struct event_dedup_entry {
+	uint64_t	hash;		/**< 0 for an unused slot */
+	uint32_t	plid;		/**< platform log ID */
+	uint32_t	seq_num;	/**< RTAS event it was first seen in */
+	uint32_t	gen;		/**< increases with every record */
+	uint32_t	seen;		/**< times it was delivered again */
+};
+
+/**
+ * @var event_dedup_file
+ * @brief Path of the store, derived from platform_log
+ */
+static char event_dedup_file[PATH_MAX];
+static int event_dedup_fd = -1;
+
+static struct event_dedup_entry dedup[EVENT_DEDUP_MAX];
+static int dedup_chain[EVENT_DEDUP_MAX];	/**< next in bucket, or -1 */
+static int dedup_bucket[EVENT_DEDUP_BUCKETS];	/**< first in bucket, or -1 */
+static int dedup_next;				/**< slot to write next */
+static uint32_t dedup_gen;
+static pthread_mutex_t dedup_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t
+fnv1a(uint64_t hash, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+
+	while (len--) {
+		hash ^= *p++;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+/**
+ * event_hash
+ * @brief Hash what identifies an event, however often it is delivered
+ *
+ * @return the hash, 0 if the event cannot be identified
+ */
+static uint64_t
+event_hash(struct event *event, uint32_t *plid)
+{
+	struct rtas_priv_hdr_scn *privhdr;
+	struct rtas_src_scn *src;
+	uint32_t fields[9];
+	uint64_t hash = 14695981039346656037ull;	/* FNV-1a */
+
+	if (event->rtas_hdr->version != 6)
+		return 0;
+
+	privhdr = rtas_get_priv_hdr_scn(event->rtas_event);
+	if (privhdr == NULL)
+		return 0;
+
+	fields[0] = privhdr->plid;
+	fields[1] = privhdr->creator_id;
+	fields[2] = privhdr->date.year;
+	fields[3] = privhdr->date.month;
+	fields[4] = privhdr->date.day;
+	fields[5] = privhdr->time.hour;
+	fields[6] = privhdr->time.minutes;
+	fields[7] = privhdr->time.seconds;
+	fields[8] = privhdr->time.hundredths;
+	hash = fnv1a(hash, fields, sizeof(fields));
+
+	src = rtas_get_src_scn(event->rtas_event);
+	if (src != NULL)
+		hash = fnv1a(hash, src->primary_refcode,
+			     strnlen(src->primary_refcode,
+				     sizeof(src->primary_refcode)));
+
+	*plid = privhdr->plid;
+	return hash ? hash : 1;
+}
+
+static void
+dedup_link(int slot)
+{
+	int b = dedup[slot].hash & (EVENT_DEDUP_BUCKETS - 1);
+
+	dedup_chain[slot] = dedup_bucket[b];
+	dedup_bucket[b] = slot;
+}
+
+static void
+dedup_unlink(int slot)
+{
+	int *p = &dedup_bucket[dedup[slot].hash & (EVENT_DEDUP_BUCKETS - 1)];
+
+	while (*p != -1) {
+		if (*p == slot) {
+			*p = dedup_chain[slot];
+			return;
+		}
+		p = &dedup_chain[*p];
+	}
+}
+
+static int
+dedup_find(uint64_t hash, uint32_t plid)
+{
+	int slot;
+
+	for (slot = dedup_bucket[hash & (EVENT_DEDUP_BUCKETS - 1)];
+	     slot != -1; slot = dedup_chain[slot]) {
+		if (dedup[slot].hash == hash && dedup[slot].plid == plid)
+			return slot;
+	}
+
+	return -1;
+}
+
+static void
+dedup_write(int slot)
+{
+	off_t offset;
+
+	offset = sizeof(struct event_dedup_hdr) + slot * sizeof(*dedup);
+	if (pwrite(event_dedup_fd, &dedup[slot], sizeof(*dedup), offset) !=
+	    sizeof(*dedup))
+		dbg("Could not update %s", event_dedup_file);
+}
+
+/**
+ * create_event_dedup
+ * @brief Start an empty store
+ */
+static int
+create_event_dedup(void)
+{
+	struct event_dedup_hdr hdr;
+
+	memset(dedup, 0, sizeof(dedup));
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, EVENT_DEDUP_MAGIC, sizeof(hdr.magic));
+	hdr.version = EVENT_DEDUP_VERSION;
+	hdr.entry_size = sizeof(struct event_dedup_entry);
+	hdr.max = EVENT_DEDUP_MAX;
+
+	if (ftruncate(event_dedup_fd, 0) ||
+	    pwrite(event_dedup_fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+	    pwrite(event_dedup_fd, dedup, sizeof(dedup), sizeof(hdr)) !=
+							sizeof(dedup)) {
+		log_msg(NULL, "Could not create %s, %s", event_dedup_file,
+			strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * load_event_dedup
+ * @brief Read an existing store
+ *
+ * @return 0 if it was read, -1 if it is missing or not usable
+ */
+static int
+load_event_dedup(void)
+{
+	struct event_dedup_hdr hdr;
+
+	if (pread(event_dedup_fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+	    memcmp(hdr.magic, EVENT_DEDUP_MAGIC, sizeof(hdr.magic)) ||
+	    hdr.version != EVENT_DEDUP_VERSION ||
+	    hdr.entry_size != sizeof(struct event_dedup_entry) ||
+	    hdr.max != EVENT_DEDUP_MAX)
+		return -1;
+
+	if (pread(event_dedup_fd, dedup, sizeof(dedup), sizeof(hdr)) !=
+								sizeof(dedup))
+		return -1;
+
+	return 0;
+}
+
+/**
+ * init_event_dedup
+ * @brief Open (creating if needed) the store of events already seen
+ *
+ * Must be called after the platform log name is known.
+ *
+ * @return 0 on success, -1 if every event will be analyzed
+ */
+int
+init_event_dedup(void)
+{
+	int i;
+
+	snprintf(event_dedup_file, sizeof(event_dedup_file), "%s.seen",
+		 platform_log);
+
+	event_dedup_fd = open(event_dedup_file, O_RDWR | O_CREAT,
+			      S_IRUSR | S_IWUSR | S_IRGRP /*0640*/);
+	if (event_dedup_fd < 0) {
+		log_msg(NULL, "Could not open %s, already reported events "
+			"will be analyzed again, %s", event_dedup_file,
+			strerror(errno));
+		return -1;
+	}
+
+	if (load_event_dedup() && create_event_dedup()) {
+		close(event_dedup_fd);
+		event_dedup_fd = -1;
+		return -1;
+	}
+
+	for (i = 0; i < EVENT_DEDUP_BUCKETS; i++)
+		dedup_bucket[i] = -1;
+
+	dedup_gen = 0;
+	dedup_next = 0;
+	for (i = 0; i < EVENT_DEDUP_MAX; i++) {
+		if (dedup[i].hash == 0)
+			continue;
+
+		dedup_link(i);
+		if (dedup[i].gen >= dedup_gen) {
+			dedup_gen = dedup[i].gen + 1;
+			dedup_next = (i + 1) % EVENT_DEDUP_MAX;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * close_event_dedup
+ * @brief Close the store of events already seen
+ */
+void
+close_event_dedup(void)
+{
+	pthread_mutex_lock(&dedup_lock);
+	if (event_dedup_fd >= 0)
+		close(event_dedup_fd);
+	event_dedup_fd = -1;
+	pthread_mutex_unlock(&dedup_lock);
+}
+
+/**
+ * event_dedup_check
+ * @brief Check whether an event has been put in servicelog before
+ *
+ * A repeat is counted in the store.
+ *
+ * @param event the event to check
+ * @return sequence number of the event it repeats, 0 if it is new
+ */
+int
+event_dedup_check(struct event *event)
+{
+	uint64_t hash;
+	uint32_t plid;
+	int slot, seq_num = 0;
+
+	hash = event_hash(event, &plid);
+	if (hash == 0)
+		return 0;
+
+	pthread_mutex_lock(&dedup_lock);
+	if (event_dedup_fd >= 0) {
+		slot = dedup_find(hash, plid);
+		if (slot >= 0) {
+			dedup[slot].seen++;
+			dedup_write(slot);
+
+			/* 0 would read as "not seen" */
+			seq_num = dedup[slot].seq_num;
+			if (seq_num == 0)
+				seq_num = -1;
+		}
+	}
+	pthread_mutex_unlock(&dedup_lock);
+
+	return seq_num;
+}
+
+/**
+ * event_dedup_add
+ * @brief Remember an event that has been put in servicelog
+ *
+ * Called once its servicelog entry has been written.
+ *
+ * @param event the event
+ */
+void
+event_dedup_add(struct event *event)
+{
+	uint64_t hash;
+	uint32_t plid;
+	int slot;
+
+	hash = event_hash(event, &plid);
+	if (hash == 0)
+		return;
+
+	pthread_mutex_lock(&dedup_lock);
+	if (event_dedup_fd < 0 || dedup_find(hash, plid) >= 0) {
+		pthread_mutex_unlock(&dedup_lock);
+		return;
+	}
+
+	slot = dedup_next;
+	if (dedup[slot].hash)
+		dedup_unlink(slot);
+
+	dedup[slot].hash = hash;
+	dedup[slot].plid = plid;
+	dedup[slot].seq_num = event->seq_num;
+	dedup[slot].gen = dedup_gen++;
+	dedup[slot].seen = 0;
+	dedup_link(slot);
+	dedup_write(slot);
+
+	dedup_next = (slot + 1) % EVENT_DEDUP_MAX;
+	pthread_mutex_unlock(&dedup_lock);
+}
@@ -0,0 +1,268 @@
+/**
+ * @file event_pool.c
+ * @brief Reusable event objects, each with an arena for its analysis
+ *
+ * Handling an RTAS event used to mean clearing a struct event (with its
+ * RTAS_ERROR_LOG_MAX buffer) and then a malloc() for every string the
+ * analysis produced: the servicelog entry and its callouts, the VPD
+ * copied out of the lsvpd cache, location code buffers, each freed
+ * again one by one afterwards.
+ *
+ * Instead, events come from a pool and are put back once nothing refers
+ * to them any more; the servicelog writer holds a reference until the
+ * event is logged.  Everything built for an event is allocated from the
+ * event's arena with event_alloc() and event_strdup(), and is released
+ * all at once, without walking anything, when the event goes back to
+ * the pool.  The arena keeps its chunks, so that once rtas_errd has
+ * seen a few events, handling another needs no allocations of its own.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <librtasevent.h>
+#include "rtas_errd.h"
+
+/**
+ * @def EVENT_POOL_PREALLOC
+ * @brief Events allocated up front; more are added if ever needed
+ */
+#define EVENT_POOL_PREALLOC	4
+
+/**
+ * @def ARENA_CHUNK_SIZE
+ * @brief Usual size of an arena chunk; larger allocations get their own
+ */
+#define ARENA_CHUNK_SIZE	(16 * 1024)
+
+#define ARENA_ALIGN		16
+
+struct arena_chunk {
+	struct arena_chunk	*next;
+	size_t			size;
+	size_t			used;
+	char			data[] __attribute__((aligned(ARENA_ALIGN)));
+};
+
+static struct event *event_free_list;
+static int event_pool_filled;
+static pthread_mutex_t event_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * arena_alloc
+ * @brief Allocate zeroed memory from an arena
+ *
+ * Chunks after the current one are left over from earlier events and
+ * are reused before any new chunk is allocated.
+ */
+static void *
+arena_alloc(struct arena *arena, size_t size)
+{
+	struct arena_chunk *chunk, *last = NULL, *new;
+	void *p;
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	for (chunk = arena->cur; chunk; chunk = chunk->next) {
+		if (chunk != arena->cur)
+			chunk->used = 0;
+		if (chunk->size - chunk->used >= size)
+			goto found;
+		last = chunk;
+	}
+
+	new = malloc(sizeof(*new) + MAX(size, ARENA_CHUNK_SIZE));
+	if (new == NULL)
+		return NULL;
+
+	new->next = NULL;
+	new->size = MAX(size, ARENA_CHUNK_SIZE);
+	new->used = 0;
+	if (last)
+		last->next = new;
+	else
+		arena->first = new;
+	chunk = new;
+
+found:
+	arena->cur = chunk;
+	p = chunk->data + chunk->used;
+	chunk->used += size;
+
+	memset(p, 0, size);
+	return p;
+}
+
+/**
+ * arena_reset
+ * @brief Release everything allocated from an arena
+ */
+static void
+arena_reset(struct arena *arena)
+{
+	arena->cur = arena->first;
+	if (arena->cur)
+		arena->cur->used = 0;
+}
+
+/**
+ * event_alloc
+ * @brief Allocate zeroed memory that lives as long as the event
+ *
+ * @param event the event the memory is for
+ * @param size number of bytes
+ * @return the memory, or NULL if it could not be allocated
+ */
+void *
+event_alloc(struct event *event, size_t size)
+{
+	return arena_alloc(&event->arena, size);
+}
+
+/**
+ * event_strdup
+ * @brief Copy a string into the event's arena
+ *
+ * @param event the event the string is for
+ * @param str string to copy
+ * @return the copy, or NULL if it could not be allocated
+ */
+char *
+event_strdup(struct event *event, const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *copy;
+
+	copy = arena_alloc(&event->arena, len);
+	if (copy)
+		memcpy(copy, str, len);
+
+	return copy;
+}
+
+/**
+ * event_reset
+ * @brief Forget everything about the event the object was last used for
+ *
+ * The event buffer and the additional text are not cleared: only as
+ * much of the buffer as was read is parsed, and the text is used as a
+ * string.
+ */
+static void
+event_reset(struct event *event)
+{
+	if (event->rtas_event)
+		cleanup_rtas_event(event->rtas_event);
+
+	arena_reset(&event->arena);
+
+	event->seq_num = 0;
+	event->length = 0;
+	event->rtas_hdr = NULL;
+	event->flags = 0;
+	event->loc_codes = NULL;
+	event->addl_text[0] = '\0';
+	memset(&event->errdata, 0, sizeof(event->errdata));
+	memset(&event->diag_vpd, 0, sizeof(event->diag_vpd));
+	event->rtas_event = NULL;
+	event->sl_entry = NULL;
+	event->read_time = 0;
+}
+
+/**
+ * event_get
+ * @brief Take an event object from the pool
+ *
+ * @return a cleared event with one reference, or NULL
+ */
+struct event *
+event_get(void)
+{
+	struct event *event;
+	int i;
+
+	pthread_mutex_lock(&event_pool_mutex);
+
+	if (!event_pool_filled) {
+		event = calloc(EVENT_POOL_PREALLOC, sizeof(*event));
+		for (i = 0; event && i < EVENT_POOL_PREALLOC; i++) {
+			event[i].next_free = event_free_list;
+			event_free_list = &event[i];
+		}
+		event_pool_filled = 1;
+	}
+
+	event = event_free_list;
+	if (event)
+		event_free_list = event->next_free;
+
+	pthread_mutex_unlock(&event_pool_mutex);
+
+	if (event == NULL) {
+		event = calloc(1, sizeof(*event));
+		if (event == NULL) {
+			log_msg(NULL, "Could not allocate an event, %s",
+				strerror(errno));
+			return NULL;
+		}
+	}
+
+	event->next_free = NULL;
+	event->refs = 1;
+	return event;
+}
+
+/**
+ * event_hold
+ * @brief Take another reference to an event
+ */
+void
+event_hold(struct event *event)
+{
+	pthread_mutex_lock(&event_pool_mutex);
+	event->refs++;
+	pthread_mutex_unlock(&event_pool_mutex);
+}
+
+/**
+ * event_put
+ * @brief Drop a reference to an event, returning it to the pool
+ *	after the last one
+ */
+void
+event_put(struct event *event)
+{
+	int refs;
+
+	pthread_mutex_lock(&event_pool_mutex);
+	refs = --event->refs;
+	pthread_mutex_unlock(&event_pool_mutex);
+
+	if (refs > 0)
+		return;
+
+	event_reset(event);
+
+	pthread_mutex_lock(&event_pool_mutex);
+	event->next_free = event_free_list;
+	event_free_list = event;
+	pthread_mutex_unlock(&event_pool_mutex);
+}
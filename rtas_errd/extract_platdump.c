@@ -30,6 +30,9 @@
 #include <errno.h>
 #include <dirent.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <pthread.h>
 #include <librtas.h>
 #include <sys/stat.h>
 
@@ -40,16 +43,62 @@
 #define DUMP_HDR_FNAME_OFFSET	0x18	/* suggested filename in dump header */
 #define DUMP_MAX_FNAME_LEN	40
 #define TOKEN_PLATDUMP_MAXSIZE	32
-#define DUMP_BUF_SZ		4096
+#define DUMP_BUF_SZ		4096	/* per ibm,platform-dump call */
+#define DUMP_CHUNK_SZ		(1024 * 1024)	/* per write to the file */
+#define DUMP_NCHUNKS		4
+#define DUMP_CHECKPOINT_SZ	(64 * 1024 * 1024)
+#define DUMP_PROGRESS_SUFFIX	".progress"
 
 int flag_v = 0;
 
 static struct option long_options[] = {
 	{"help",		no_argument,		NULL, 'h'},
+	{"size",		required_argument,	NULL, 's'},
 	{"verbose",		no_argument,		NULL, 'v'},
 	{0,0,0,0}
 };
 
+/*
+ * The dump is fetched from firmware by the main thread into one of
+ * DUMP_NCHUNKS chunk buffers while a writer thread writes the previous
+ * ones out, so that firmware and the filesystem are kept busy at the
+ * same time.  Every DUMP_CHECKPOINT_SZ bytes the writer syncs the file
+ * and records the sequence number to continue from in
+ * <dump file>.progress; if the extraction is interrupted, the next one
+ * for the same dump tag picks up from there.
+ */
+struct dump_chunk {
+	char		*buf;
+	size_t		len;
+	uint64_t	seq_next;	/* sequence number after this chunk */
+};
+
+static struct {
+	struct dump_chunk	chunks[DUMP_NCHUNKS];
+	int			head;	/* next chunk to fill */
+	int			tail;	/* next chunk to write */
+	int			nfull;	/* chunks waiting for the writer */
+	int			done;	/* no more chunks are coming */
+	int			error;	/* the writer failed */
+	pthread_mutex_t		lock;
+	pthread_cond_t		cond;
+
+	int			out;
+	const char		*pathname;
+	char			progress[PATH_MAX + sizeof(DUMP_PROGRESS_SUFFIX)];
+	uint64_t		dump_tag;
+	uint64_t		offset;		/* bytes written */
+	uint64_t		seq_written;	/* sequence number after them */
+	uint64_t		checkpoint;	/* offset of the last checkpoint */
+	uint32_t		crc;		/* CRC-32 of the bytes written */
+} dp = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+static uint32_t crc32_table[256];
+
 /**
  * msg
  * @brief Print message if verbose flag is set
@@ -80,8 +129,9 @@ msg(char *fmt, ...)
  */
 static void
 print_usage(const char *name) {
-	printf("Usage: %s [-h] [-v] <dump_tag>\n"
+	printf("Usage: %s [-h] [-v] [-s size] <dump_tag>\n"
 		"\t-h: print this help message\n"
+		"\t-s: size of the dump in bytes, to preallocate the file\n"
 		"\t-v: verbose output\n"
 		"\t<dump_tag>: the tag of the dump(s) to extract, in hex\n",
 		name);
@@ -204,15 +254,327 @@ remove_old_dumpfiles(char *dumpname, int prefix_size)
 	closedir(dir);
 }
 
+static void
+crc32_init(void)
+{
+	uint32_t c;
+	int i, k;
+
+	for (i = 0; i < 256; i++) {
+		c = i;
+		for (k = 0; k < 8; k++)
+			c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+		crc32_table[i] = c;
+	}
+}
+
+static uint32_t
+crc32_update(uint32_t crc, const char *buf, size_t len)
+{
+	const unsigned char *p = (const unsigned char *)buf;
+
+	crc = ~crc;
+	while (len--)
+		crc = crc32_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+	return ~crc;
+}
+
+static void
+stop_handler(int sig)
+{
+	stop_requested = 1;
+}
+
+/**
+ * write_dump_data
+ * @brief Append data to the dump file and the checksum
+ *
+ * @param buf data
+ * @param len length of buf
+ * @return 0 on success, -1 on failure
+ */
+static int
+write_dump_data(const char *buf, size_t len)
+{
+	size_t done = 0;
+	ssize_t rc;
+
+	while (done < len) {
+		rc = pwrite(dp.out, buf + done, len - done, dp.offset + done);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			msg("Could not write to %s: %s\nThe platform "
+				"dump could not be retrieved", dp.pathname,
+				strerror(errno));
+			return -1;
+		}
+		done += rc;
+	}
+
+	dp.crc = crc32_update(dp.crc, buf, len);
+	dp.offset += len;
+	return 0;
+}
+
+/**
+ * save_progress
+ * @brief Record how far the extraction has got
+ *
+ * The dump file is synced first, so that the progress file never
+ * claims more than is on disk.
+ */
+static void
+save_progress(void)
+{
+	char tmp[sizeof(dp.progress) + 4];
+	FILE *fp;
+
+	if (fdatasync(dp.out) < 0) {
+		msg("Could not sync %s: %s", dp.pathname, strerror(errno));
+		return;
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", dp.progress);
+	fp = fopen(tmp, "w");
+	if (fp == NULL) {
+		msg("Could not open %s: %s", tmp, strerror(errno));
+		return;
+	}
+
+	fprintf(fp, "%016" PRIx64 " %016" PRIx64 " %" PRIu64 " %08" PRIx32
+		"\n", dp.dump_tag, dp.seq_written, dp.offset, dp.crc);
+	if (fclose(fp) || rename(tmp, dp.progress)) {
+		msg("Could not write %s: %s", dp.progress, strerror(errno));
+		unlink(tmp);
+		return;
+	}
+
+	dp.checkpoint = dp.offset;
+	msg("Checkpoint at offset %" PRIu64 ", seq 0x%016" PRIx64,
+	    dp.offset, dp.seq_written);
+}
+
+/**
+ * load_progress
+ * @brief Find where an interrupted extraction of this dump stopped
+ *
+ * @return 1 if the extraction can be resumed, 0 otherwise
+ */
+static int
+load_progress(void)
+{
+	struct stat sbuf;
+	uint64_t tag, seq, offset;
+	uint32_t crc;
+	FILE *fp;
+	int n;
+
+	fp = fopen(dp.progress, "r");
+	if (fp == NULL)
+		return 0;
+
+	n = fscanf(fp, "%" SCNx64 " %" SCNx64 " %" SCNu64 " %" SCNx32,
+		   &tag, &seq, &offset, &crc);
+	fclose(fp);
+
+	if (n != 4 || tag != dp.dump_tag || offset == 0) {
+		msg("Ignoring stale progress file %s", dp.progress);
+		return 0;
+	}
+
+	if (stat(dp.pathname, &sbuf) < 0 || sbuf.st_size < offset) {
+		msg("%s is shorter than recorded in %s, starting over",
+		    dp.pathname, dp.progress);
+		return 0;
+	}
+
+	dp.seq_written = seq;
+	dp.offset = dp.checkpoint = offset;
+	dp.crc = crc;
+	return 1;
+}
+
+/**
+ * dump_writer
+ * @brief Writer thread; writes out the chunks filled by the main thread
+ */
+static void *
+dump_writer(void *arg)
+{
+	struct dump_chunk *chunk;
+	int failed = 0;
+
+	pthread_mutex_lock(&dp.lock);
+	while (1) {
+		while (dp.nfull == 0 && !dp.done)
+			pthread_cond_wait(&dp.cond, &dp.lock);
+		if (dp.nfull == 0)
+			break;
+
+		chunk = &dp.chunks[dp.tail];
+		pthread_mutex_unlock(&dp.lock);
+
+		/* After a failure, just keep the fetcher going until
+		 * it notices */
+		if (!failed) {
+			failed = write_dump_data(chunk->buf, chunk->len);
+			if (!failed) {
+				dp.seq_written = chunk->seq_next;
+				if (dp.offset - dp.checkpoint >=
+				    DUMP_CHECKPOINT_SZ)
+					save_progress();
+			}
+		}
+
+		pthread_mutex_lock(&dp.lock);
+		if (failed)
+			dp.error = 1;
+		dp.tail = (dp.tail + 1) % DUMP_NCHUNKS;
+		dp.nfull--;
+		pthread_cond_broadcast(&dp.cond);
+	}
+	pthread_mutex_unlock(&dp.lock);
+
+	return NULL;
+}
+
+/**
+ * fetch_chunk
+ * @brief Fill a chunk from firmware
+ *
+ * @param chunk chunk to fill
+ * @param seq sequence number to start at; updated
+ * @return 1 if the dump is complete, 0 if there is more, -1 on failure
+ */
+static int
+fetch_chunk(struct dump_chunk *chunk, uint64_t *seq)
+{
+	uint64_t seq_next, bytes;
+	char	dump_err[RTAS_ERROR_LOG_MAX];
+	int	librtas_rc;
+
+	chunk->len = 0;
+	while (chunk->len + DUMP_BUF_SZ <= DUMP_CHUNK_SZ) {
+		msg("Calling rtas_platform_dump, seq 0x%016LX", *seq);
+		librtas_rc = rtas_platform_dump(dp.dump_tag, *seq,
+						chunk->buf + chunk->len,
+						DUMP_BUF_SZ, &seq_next, &bytes);
+		if (librtas_rc < 0) {
+			handle_platform_dump_error(librtas_rc, dump_err, 1024);
+			msg("%s\nThe platform dump could not be "
+				"retrieved from firmware", dump_err);
+			return -1;
+		}
+
+		chunk->len += bytes;
+		*seq = seq_next;
+		chunk->seq_next = seq_next;
+
+		if (librtas_rc == 0)
+			return 1;
+
+		if (stop_requested)
+			break;
+	}
+
+	return 0;
+}
+
+/**
+ * fetch_dump
+ * @brief Fetch the rest of the dump, overlapped with writing it out
+ *
+ * @param seq sequence number to start at; updated to where it stopped
+ * @return 0 if the whole dump was written, 1 otherwise
+ */
+static int
+fetch_dump(uint64_t *seq)
+{
+	struct dump_chunk *chunk;
+	pthread_t writer;
+	sigset_t all, old;
+	int i, rc = 0, complete = 0;
+
+	for (i = 0; i < DUMP_NCHUNKS; i++) {
+		dp.chunks[i].buf = malloc(DUMP_CHUNK_SZ);
+		if (dp.chunks[i].buf == NULL) {
+			msg("Could not allocate buffer to retrieve dump: %s",
+				strerror(errno));
+			rc = 1;
+			goto fetch_out;
+		}
+	}
+
+	dp.head = dp.tail = dp.nfull = dp.done = dp.error = 0;
+
+	/* Leave signals to the fetching thread */
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	i = pthread_create(&writer, NULL, dump_writer, NULL);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (i) {
+		msg("Could not start the dump writer thread: %s",
+			strerror(i));
+		rc = 1;
+		goto fetch_out;
+	}
+
+	while (!complete && !stop_requested) {
+		pthread_mutex_lock(&dp.lock);
+		while (dp.nfull == DUMP_NCHUNKS && !dp.error)
+			pthread_cond_wait(&dp.cond, &dp.lock);
+		if (dp.error) {
+			pthread_mutex_unlock(&dp.lock);
+			rc = 1;
+			break;
+		}
+		chunk = &dp.chunks[dp.head];
+		pthread_mutex_unlock(&dp.lock);
+
+		i = fetch_chunk(chunk, seq);
+		if (i < 0) {
+			rc = 1;
+			break;
+		}
+		complete = i;
+
+		pthread_mutex_lock(&dp.lock);
+		dp.head = (dp.head + 1) % DUMP_NCHUNKS;
+		dp.nfull++;
+		pthread_cond_broadcast(&dp.cond);
+		pthread_mutex_unlock(&dp.lock);
+	}
+
+	pthread_mutex_lock(&dp.lock);
+	dp.done = 1;
+	pthread_cond_broadcast(&dp.cond);
+	pthread_mutex_unlock(&dp.lock);
+	pthread_join(writer, NULL);
+
+	if (dp.error || !complete)
+		rc = 1;
+
+fetch_out:
+	for (i = 0; i < DUMP_NCHUNKS; i++) {
+		free(dp.chunks[i].buf);
+		dp.chunks[i].buf = NULL;
+	}
+
+	return rc;
+}
+
 /**
  * extract_platform_dump
  * @brief Extract a platform dump with a given tag to the filesystem
  *
  * @param dump_tag tag of the platform dump to extract
+ * @param dump_size size of the dump in bytes, 0 if not known
  * @return 0 on success, 1 on failure
  */
 int
-extract_platform_dump(uint64_t dump_tag)
+extract_platform_dump(uint64_t dump_tag, uint64_t dump_size)
 {
 	uint64_t seq=0, seq_next, bytes;
 	uint16_t prefix_size = 7;
@@ -221,7 +583,7 @@ extract_platform_dump(uint64_t dump_tag)
 	char	pathname[PATH_MAX];
 	char	dump_err[RTAS_ERROR_LOG_MAX];
 	char	dumpid[5];
-	int	out=-1, rc, librtas_rc, dump_complete=0, ret=0;
+	int	out=-1, librtas_rc, dump_complete=0, resume=0, ret=0;
 
 	msg("Dump tag: 0x%016LX", dump_tag);
 
@@ -290,60 +652,81 @@ extract_platform_dump(uint64_t dump_tag)
 		}
 	}
 
-	/*
-	 * Before writing the new dump out, we need to see if any older
-	 * dumps need to be removed first
-	 */
-	remove_old_dumpfiles(filename, prefix_size);
-
-	/* Copy the dump off to the filesystem */
 	pathname[0] = '\0';
 	strcpy(pathname, d_cfg.platform_dump_path);
 	strcat(pathname, filename);
 	msg("Dump path/filename: %s", pathname);
-	out = creat(pathname, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+	dp.dump_tag = dump_tag;
+	dp.pathname = pathname;
+	dp.offset = dp.seq_written = dp.checkpoint = 0;
+	dp.crc = 0;
+	snprintf(dp.progress, sizeof(dp.progress), "%s%s", pathname,
+		 DUMP_PROGRESS_SUFFIX);
+
+	/* Pick up where an interrupted extraction of this dump stopped */
+	if (!dump_complete)
+		resume = load_progress();
+
+	if (resume) {
+		msg("Resuming at offset %" PRIu64 ", seq 0x%016" PRIx64,
+		    dp.offset, dp.seq_written);
+		seq = dp.seq_written;
+		out = open(pathname, O_WRONLY);
+		if (out >= 0 && ftruncate(out, dp.offset) < 0) {
+			close(out);
+			out = -1;
+		}
+	} else {
+		/*
+		 * Before writing the new dump out, we need to see if any
+		 * older dumps need to be removed first
+		 */
+		remove_old_dumpfiles(filename, prefix_size);
+
+		/* Copy the dump off to the filesystem */
+		out = creat(pathname, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	}
 	if (out <= 0) {
 		msg("Could not open %s for writing: %s.\nThe platform dump "
 			"could not be retrieved", pathname, strerror(errno));
+		out = -1;
 		ret = 1;
 		goto platdump_error_out;
 	}
+	dp.out = out;
 
-	rc = write(out, dump_buf, (size_t)bytes);
-	if (rc < 0) {
-		msg("Could not write to %s: %s.\nThe platform dump "
-			"could not be retrieved", pathname, strerror(errno));
-		ret = 1;
-		goto platdump_error_out;
-	}
+	/* Reserve the space up front, so the dump is laid out in one go */
+	if (dump_size > dp.offset &&
+	    fallocate(out, FALLOC_FL_KEEP_SIZE, dp.offset,
+		      dump_size - dp.offset) < 0)
+		msg("Could not preallocate %" PRIu64 " bytes for %s: %s",
+		    dump_size, pathname, strerror(errno));
 
-	while (dump_complete == 0) {
-		msg("Calling rtas_platform_dump, seq 0x%016LX", seq);
-		librtas_rc = rtas_platform_dump(dump_tag, seq, dump_buf,
-						DUMP_BUF_SZ, &seq_next, &bytes);
-		if (librtas_rc < 0) {
-			handle_platform_dump_error(librtas_rc, dump_err, 1024);
-			msg("%s\nThe platform dump could not be "
-				"retrieved from firmware", dump_err);
+	if (!resume) {
+		if (write_dump_data(dump_buf, (size_t)bytes)) {
 			ret = 1;
 			goto platdump_error_out;
 		}
-		if (librtas_rc == 0) {
-			dump_complete = 1;
-		}
-
-		seq = seq_next;
+		dp.seq_written = seq;
+	}
 
-		rc = write(out, dump_buf, (size_t)bytes);
-		if (rc < 0) {
-			msg("Could not write to %s: %s\nThe platform "
-				"dump could not be retrieved", pathname,
-				strerror(errno));
-			ret = 1;
-			goto platdump_error_out;
-		}
+	if (!dump_complete && fetch_dump(&seq)) {
+		if (dp.offset > dp.checkpoint)
+			save_progress();
+		if (dp.checkpoint)
+			msg("%" PRIu64 " bytes of the platform dump were "
+				"saved; the next extraction of dump tag "
+				"0x%016LX will continue from there",
+				dp.checkpoint, dump_tag);
+		ret = 1;
+		goto platdump_error_out;
 	}
 
+	unlink(dp.progress);
+	msg("Retrieved %" PRIu64 " bytes, CRC-32 %08" PRIx32, dp.offset,
+	    dp.crc);
+
 	/* 
 	 * Got the dump; signal the platform that it is okay for
 	 * them to delete/invalidate their copy 
@@ -359,6 +742,7 @@ extract_platform_dump(uint64_t dump_tag)
 
 	/* rtas_errd depends on this line being printed */
 	printf("%s\n", filename);
+	printf("crc32 %08" PRIx32 "\n", dp.crc);
 
 platdump_error_out:
 	if (out != -1)
@@ -374,7 +758,8 @@ main(int argc, char *argv[])
 {
 	int option_index, rc, fail=0;
 	int platform = 0;
-	uint64_t dump_tag;
+	uint64_t dump_tag, dump_size = 0;
+	struct sigaction sigact;
 
 	platform = get_platform();
 	switch (platform) {
@@ -387,7 +772,7 @@ main(int argc, char *argv[])
 
 	for (;;) {
 		option_index = 0;
-		rc = getopt_long(argc, argv, "hv", long_options,
+		rc = getopt_long(argc, argv, "hs:v", long_options,
 				&option_index);
 
 		if (rc == -1)
@@ -397,6 +782,9 @@ main(int argc, char *argv[])
 		case 'h':
 			print_usage(argv[0]);
 			return 0;
+		case 's':
+			dump_size = strtoull(optarg, NULL, 0);
+			break;
 		case 'v':
 			flag_v = 1;
 			break;
@@ -419,9 +807,19 @@ main(int argc, char *argv[])
 			return -2;
 		}
 
-		while (optind < argc) {
+		crc32_init();
+
+		/* Stop cleanly, so that the extraction can be resumed */
+		memset(&sigact, 0, sizeof(sigact));
+		sigact.sa_handler = stop_handler;
+		sigact.sa_flags = SA_RESTART;
+		sigaction(SIGINT, &sigact, NULL);
+		sigaction(SIGTERM, &sigact, NULL);
+		sigaction(SIGHUP, &sigact, NULL);
+
+		while (optind < argc && !stop_requested) {
 			dump_tag = strtoll(argv[optind++], NULL, 16);
-			fail += extract_platform_dump(dump_tag);
+			fail += extract_platform_dump(dump_tag, dump_size);
 		}
 	}
 	else {
@@ -19,6 +19,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -32,6 +33,10 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/wait.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <limits.h>
+#include "utils.h"
 #include "rtas_errd.h"
 
 char *platform_log = "/var/log/platform";
@@ -292,7 +297,8 @@ init_files(void)
 	}
 
 	/* Next, open /var/log/platform */
-	platform_log_fd = open(platform_log, O_RDWR | O_SYNC | O_CREAT,
+	platform_log_fd = open(platform_log,
+			       O_RDWR | O_SYNC | O_CREAT | O_APPEND,
 			       S_IRUSR | S_IWUSR | S_IRGRP /*0640*/);
 	if (platform_log_fd < 0) {
 		log_msg(NULL, "Could not open log file %s, %s\nThe daemon "
@@ -301,6 +307,13 @@ init_files(void)
 		return -1;
 	}
 
+	/* The index of the RTAS events in /var/log/platform is only an
+	 * optimization, carry on without it if it cannot be set up.
+	 */
+	if (init_platform_index())
+		log_msg(NULL, "Could not set up the index for %s, RTAS events "
+			"will be located by searching it", platform_log);
+
 	/* Now, the epow status file. Updating the status to zero will 
 	 * have the side effect of also opening the file. 
 	 */
@@ -329,12 +342,27 @@ close_files(void)
 		close(rtas_errd_log_fd);
 	if (proc_error_log_fd)
 		close(proc_error_log_fd);
+	close_platform_index();
 	if (platform_log_fd)
 		close(platform_log_fd);
 	if (epow_status_fd)
 		close(epow_status_fd);
 }
 
+#ifdef DEBUG
+static int
+hexval(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+#endif
+
 /** 
  * read_proc_error_log
  * @brief Read data from proc_error_log
@@ -357,13 +385,15 @@ read_proc_error_log(char *buf, int buflen)
 	 * we need to convert it to binary.  proc_error_log2 should
 	 * only be NULL when a debug proc_error_log file is specified
 	 */
+	if (proc_error_log2 == NULL && replay_active())
+		return replay_read(buf, buflen);
+
 	if (proc_error_log2 == NULL) {
 		struct stat	tf_sbuf;
 		char		*data;
 		char		*tf_mmap;
 		int		seq_num = 1000 + scenario_index;
-		int		j = 0, k = 0, ch;
-		char		str[4];
+		int		j = 0, k = 0, ch, hi, lo;
 
 		if ((fstat(proc_error_log_fd, &tf_sbuf)) < 0) {
 			log_msg(NULL, "Cannot get status of test file %s, %s",
@@ -383,8 +413,6 @@ read_proc_error_log(char *buf, int buflen)
 		buf += sizeof(int);
 
 		data = tf_mmap;
-		str[2] = ' ';
-		str[3] = '\0';
 
 		while (&data[j] != (tf_mmap + tf_sbuf.st_size)) {
 			if (strncmp(&data[j], "RTAS:", 5) == 0) {
@@ -415,11 +443,12 @@ read_proc_error_log(char *buf, int buflen)
 				continue;
 			}
 
-			str[0] = data[j];
-			str[1] = data[j + 1];
+			hi = hexval(data[j]);
+			lo = hexval(data[j + 1]);
 			j += 2;
-			if (sscanf(str, "%02x", &ch) != 1)
+			if (hi < 0 || lo < 0)
 				continue;
+			ch = hi << 4 | lo;
 
 			buf[k++] = ch;
 			if (k >= buflen) { /* Buffer overflow */
@@ -460,6 +489,48 @@ read_proc_error_log(char *buf, int buflen)
 	return len;
 }
 
+/**
+ * wait_for_rtas_event
+ * @brief Wait for an RTAS event to become available
+ *
+ * Used to bound the wait for the next event while there is work
+ * waiting on it (see drmgr_queue.c), and as the one place signals
+ * such as SIGHUP are let in (see read_rtas_events()).
+ *
+ * @param timeout maximum time to wait in milliseconds, -1 for no limit
+ * @param sigmask signal mask to wait with
+ * @return 1 if an event can be read, 0 on timeout, -1 if interrupted
+ */
+int
+wait_for_rtas_event(int timeout, const sigset_t *sigmask)
+{
+	struct pollfd pfd;
+	struct timespec ts;
+	int rc;
+
+#ifdef DEBUG
+	/* test files are always readable */
+	if (proc_error_log2 == NULL)
+		return 1;
+#endif
+
+	pfd.fd = proc_error_log_fd;
+	pfd.events = POLLIN;
+
+	ts.tv_sec = timeout / 1000;
+	ts.tv_nsec = (timeout % 1000) * 1000000L;
+
+	rc = ppoll(&pfd, 1, timeout < 0 ? NULL : &ts, sigmask);
+	if (rc < 0 && errno != EINTR) {
+		log_msg(NULL, "Could not poll the error log file, %s",
+			strerror(errno));
+		/* let the read report it */
+		return 1;
+	}
+
+	return rc;
+}
+
 /**
  * reformat_msg
  * @brief Re-format a log message to wrap at 80 characters.
@@ -527,73 +598,23 @@ reformat_msg(char *msg)
 }
 
 /**
- * _log_msg
- * @brief The real routine to write messages to rtas_errd_log
- *
- * This is a common routine for formatting messages that go to the
- * /var/log/rtas_errd.log file.  Users should pass in a reference to
- * the rtas_event structure if this message is directly related a rtas
- * event and a formatted message a la printf() style.  Please make sure
- * that the message passed in does not have any ending punctuation or
- * ends with a newline.  It should also not have any internal newlines.
- *
- * This routine will do several things to the message before printing
- * it out;
- * - Add a timestamp
- * - If a rtas_event reference is passed in, a sequenbce number is added
- * - If errno is set, the results of perror are added.
- * - The entire message is then formatted to fit in 80 cols.
+ * rtas_errd_log_write
+ * @brief Append a message to rtas_errd_log, rotating it when full
  *
- * @param event reference to event
- * @param fmt formatted string a la printf()
- * @param ... additional args a la printf()
+ * @param buf formatted message
+ * @param len length of the message
  */
 static void
-_log_msg(struct event *event, const char *fmt, va_list ap)
+rtas_errd_log_write(const char *buf, int len)
 {
 	struct stat sbuf;
-	char	buf[RTAS_ERROR_LOG_MAX];
-	int	len = 0, rc;
+	int	rc;
 	char	*dir_name;
         char	*rtas_errd_log_c; /* Both rtas_errd_log/rtas_errd_log0 are
 				     global, so make a copy. */
 
-	if (rtas_errd_log_fd == -1) {
-		dbg("rtas_errd log file is not available");
-
-		vsprintf(buf, fmt, ap);
-		_dbg(buf);
-
+	if (rtas_errd_log_fd == -1)
 		return;
-	}
-
-#ifndef DEBUG
-	{
-		time_t	cal;
-		/* In order to make testing easier we don't print the date
-		 * to the log file for debug versions of rtas_errd.  This helps
-		 * avoid lots of ugly date munging when comparing files.
-		 */
-		cal = time(NULL);
-		len = sprintf(buf, "%s ", ctime(&cal));
-	}
-#endif
-
-	/* Add the sequence number */
-	if (event)
-		len += sprintf(buf, "(Sequence #%d) ",
-			       event->seq_num);
-
-	/* Add the actual message */
-	len += vsprintf(buf + len, fmt, ap);
-
-	/* Add ending punctuation */
-	len += sprintf(buf + len, ".");
-
-	_dbg(buf);
-
-	/* reformat the new message */
-	len = reformat_msg(buf);
 
 	rc = write(rtas_errd_log_fd, buf, len);
 	if (rc == -1)
@@ -677,6 +698,130 @@ _log_msg(struct event *event, const char *fmt, va_list ap)
 	return;
 }
 
+/**
+ * log_write_record
+ * @brief Write a formatted message to its destination
+ *
+ * Called by the log writer thread, or directly when a message is
+ * not queued (see log_ring.c).
+ *
+ * @param dest LOG_RTAS_ERRD, LOG_PLATFORM or LOG_STDOUT
+ * @param buf formatted message
+ * @param len length of the message
+ * @return return code from write()
+ */
+int
+log_write_record(int dest, const char *buf, int len)
+{
+	switch (dest) {
+	case LOG_RTAS_ERRD:
+		rtas_errd_log_write(buf, len);
+		return len;
+	case LOG_PLATFORM:
+		return write(platform_log_fd, buf, len);
+	case LOG_STDOUT:
+		fwrite(buf, 1, len, stdout);
+		fflush(stdout);
+		return len;
+	}
+
+	return -1;
+}
+
+/**
+ * log_output
+ * @brief Queue a formatted message, or write it out if it is not queued
+ */
+static int
+log_output(int dest, const char *buf, int len, int urgent)
+{
+	int locked, rc;
+
+	if (log_ring_write(dest, buf, len, urgent) == 0)
+		return len;
+
+	locked = log_ring_lock();
+	rc = log_write_record(dest, buf, len);
+	log_ring_unlock(locked);
+
+	return rc;
+}
+
+/**
+ * _log_msg
+ * @brief The real routine to write messages to rtas_errd_log
+ *
+ * This is a common routine for formatting messages that go to the
+ * /var/log/rtas_errd.log file.  Users should pass in a reference to
+ * the rtas_event structure if this message is directly related a rtas
+ * event and a formatted message a la printf() style.  Please make sure
+ * that the message passed in does not have any ending punctuation or
+ * ends with a newline.  It should also not have any internal newlines.
+ *
+ * This routine will do several things to the message before printing
+ * it out;
+ * - Add a timestamp
+ * - If a rtas_event reference is passed in, a sequenbce number is added
+ * - If errno is set, the results of perror are added.
+ * - The entire message is then formatted to fit in 80 cols.
+ *
+ * @param event reference to event
+ * @param fmt formatted string a la printf()
+ * @param ... additional args a la printf()
+ */
+static void
+_log_msg(struct event *event, const char *fmt, va_list ap)
+{
+	char	buf[RTAS_ERROR_LOG_MAX];
+	int	len = 0;
+	int	urgent = 0;
+
+	if (rtas_errd_log_fd == -1) {
+		dbg("rtas_errd log file is not available");
+
+		vsprintf(buf, fmt, ap);
+		_dbg(buf);
+
+		return;
+	}
+
+#ifndef DEBUG
+	{
+		time_t	cal;
+		/* In order to make testing easier we don't print the date
+		 * to the log file for debug versions of rtas_errd.  This helps
+		 * avoid lots of ugly date munging when comparing files.
+		 */
+		cal = time(NULL);
+		len = sprintf(buf, "%s ", ctime(&cal));
+	}
+#endif
+
+	/* Add the sequence number */
+	if (event)
+		len += sprintf(buf, "(Sequence #%d) ",
+			       event->seq_num);
+
+	/* Messages about EPOW and fatal events are written out at once */
+	if (event && event->rtas_hdr &&
+	    (event->rtas_hdr->type == RTAS_HDR_TYPE_EPOW ||
+	     event->rtas_hdr->severity == RTAS_HDR_SEV_FATAL))
+		urgent = 1;
+
+	/* Add the actual message */
+	len += vsprintf(buf + len, fmt, ap);
+
+	/* Add ending punctuation */
+	len += sprintf(buf + len, ".");
+
+	_dbg(buf);
+
+	/* reformat the new message */
+	len = reformat_msg(buf);
+
+	log_output(LOG_RTAS_ERRD, buf, len, urgent);
+}
+
 /**
  * cfg_log
  * @brief dummy interface for calls to diag_cfg
@@ -741,25 +886,39 @@ _dbg(const char *fmt, ...)
 	va_end(ap);
 
 	len = reformat_msg(buf);
-	fprintf(stdout, "%s", buf);
-	fflush(stdout);
+	log_output(LOG_STDOUT, buf, len, 0);
 }
 
+/**
+ * @var rtas_hexdump_buf
+ * @brief Reusable buffer for the hexdump of an RTAS event
+ *
+ * Sized for the largest event that fits in struct event so that
+ * print_rtas_event() never has to allocate.
+ */
+static char rtas_hexdump_buf[HEXDUMP_SIZE(sizeof("RTAS") - 1,
+					  RTAS_ERROR_LOG_MAX)];
+
 /**
  * print_rtas_event
  * @brief Print an RTAS event to the platform log
  * 
  * Prints the binary hexdump of an RTAS event to the PLATFORM_LOG file.
+ * The begin marker, optional scanlog line, hexdump and end marker are
+ * handed to the kernel in a single writev() so that the event lands in
+ * the (O_APPEND) platform log as one contiguous record, whose location
+ * is then recorded in the platform log index.
  * 
  * @param event pointer to the struct event to print
- * @return 0 on success, !0 on failure
+ * @return number of bytes written on success, <= 0 on failure
  */
 int
 print_rtas_event(struct event *event)
 {
-	char	*out_buf;
-	int	len, buf_size, offset;
-	int	i, rc, nlines;
+	char	begin[64], end[64], scanlog_line[PATH_MAX + 8];
+	struct iovec iov[4];
+	int	len, iovcnt = 0;
+	int	rc, total = 0, locked;
 
 	/* Determine the length of the log */
 	len = event->length;
@@ -771,76 +930,64 @@ print_rtas_event(struct event *event)
 	if (len == 0)
 		len = 32;
 
-	/* We need to allocate a buffer big enough to hold all the data
-	 * from the RTAS event plus the additional strings printed
-	 * before and after the RTAS event (roughly 0x40 in length)
-	 * _and_ the strings printed in front of every line (roughly 0x10
-	 * in length).  
-	 *
-	 * We calculate the number of lines needed to print the RTAS event, 
-	 * mulitply that by the space for the strings then add in the 
-	 * beginning/end strings.  For a little extra padding we double the 
-	 * len value also.
-	 *
-	 * size = (len * 2) + (number of lines * 0x10) + (2 * 0x40)
-	 */
-	nlines = len / 0x10;
-	if (len % 0x10)
-		nlines++;
-	buf_size = (len * 2) + (nlines * 0x10) + (2 * 0x40);
-	/* event_dump(event); */
-
-	out_buf = calloc(1, buf_size);
-	if (out_buf == NULL) {
-		log_msg(NULL, "Could not allocate buffer to print RTAS event "
-			"%d, %s.  The event will not copied to %s",
-			event->seq_num, strerror(errno),
-			platform_log);
-		return -1;
-	}
+	if (len > RTAS_ERROR_LOG_MAX)
+		len = RTAS_ERROR_LOG_MAX;
 
-	offset = sprintf(out_buf,
-			 "RTAS: %d -------- RTAS event begin --------\n",
-			 event->seq_num);
+	iov[iovcnt].iov_base = begin;
+	iov[iovcnt].iov_len = snprintf(begin, sizeof(begin),
+			"RTAS: %d -------- RTAS event begin --------\n",
+			event->seq_num);
+	total += iov[iovcnt++].iov_len;
 
 	if (event->flags & RE_SCANLOG_AVAIL) {
-		offset += sprintf(out_buf + offset, "RTAS: %s\n", scanlog);
+		iov[iovcnt].iov_base = scanlog_line;
+		iov[iovcnt].iov_len = snprintf(scanlog_line,
+					       sizeof(scanlog_line),
+					       "RTAS: %s\n", scanlog);
+		if (iov[iovcnt].iov_len >= sizeof(scanlog_line))
+			iov[iovcnt].iov_len = sizeof(scanlog_line) - 1;
+		total += iov[iovcnt++].iov_len;
 		free(scanlog);
 		scanlog = NULL;
 	}
 
 	/* Print 16 bytes/line in hex, with a space after every 4 bytes */
-	for (i = 0; i < len; i++) {
-		if ((i % 16) == 0)
-			offset += sprintf(out_buf + offset, "RTAS %d:", i/16);
-
-		if ((i % 4) == 0)
-			offset += sprintf(out_buf + offset, " ");
+	iov[iovcnt].iov_base = rtas_hexdump_buf;
+	iov[iovcnt].iov_len = format_hexdump(rtas_hexdump_buf, "RTAS",
+				(unsigned char *)event->event_buf, len);
+	total += iov[iovcnt++].iov_len;
 
-		offset += sprintf(out_buf + offset, "%02x",
-				  event->event_buf[i]);
+	iov[iovcnt].iov_base = end;
+	iov[iovcnt].iov_len = snprintf(end, sizeof(end),
+			"RTAS: %d -------- RTAS event end ----------\n",
+			event->seq_num);
+	total += iov[iovcnt++].iov_len;
 
-		if ((i % 16) == 15)
-			offset += sprintf(out_buf + offset, "\n");
-	}
-	if ((i % 16) != 0)
-		offset += sprintf(out_buf + offset, "\n");
+	dbg("Writing RTAS event %d to %s", event->seq_num, platform_log);
 
-	offset += sprintf(out_buf + offset,
-			  "RTAS: %d -------- RTAS event end ----------\n",
-			  event->seq_num);
+	/* Queued platform log messages (about earlier events) go first */
+	log_ring_flush();
+	locked = log_ring_lock();
 
-	dbg("Writing RTAS event %d to %s", event->seq_num, platform_log);
-	lseek(platform_log_fd, 0, SEEK_END);
-	rc = write(platform_log_fd, out_buf, offset);
-	if (rc != offset) {
+	rc = writev(platform_log_fd, iov, iovcnt);
+	if (rc != total) {
 		log_msg(NULL, "Writing RTAS event %d to %s failed."
 			"expected to write %d, only wrote %d. %s",
-			event->seq_num, platform_log, offset, rc,
+			event->seq_num, platform_log, total, rc,
 			strerror(errno));
+	} else {
+		/* With O_APPEND the file offset is left at the end of
+		 * our own write, even if others append after us.
+		 */
+		off_t end_offset = lseek(platform_log_fd, 0, SEEK_CUR);
+
+		if (end_offset != -1)
+			platform_index_add(event->seq_num, end_offset - total,
+					   total);
 	}
 
-	free(out_buf);
+	log_ring_unlock(locked);
+
 	return rc;
 }
 
@@ -869,7 +1016,10 @@ platform_log_write(char *fmt, ...)
 	len += vsnprintf(buf + len, (1024 - len), fmt, ap);
 	va_end(ap);
 
-	rc = write(platform_log_fd, &buf, len);
+	if (len >= sizeof(buf))
+		len = sizeof(buf) - 1;
+
+	rc = log_output(LOG_PLATFORM, buf, len, 0);
 
 	return rc;
 }
@@ -31,10 +31,12 @@
 #include <dirent.h>
 #include "utils.h"
 #include "rtas_errd.h"
+#include "drc_info.h"
 
+#ifndef DRMGR_PROGRAM
 #define DRMGR_PROGRAM		"/usr/sbin/drmgr"
+#endif
 #define DRMGR_PROGRAM_NOPATH	"drmgr"
-#define CONVERT_DT_PROPS_PROGRAM "/usr/sbin/convert_dt_node_props"
 
 #define RTAS_V6_TYPE_RESOURCE_DEALLOC	0xE3
 
@@ -120,8 +122,14 @@ run_drmgr(enum resource_dealloc_type resource_type, char *drc_name,
 		exit(1);
 	}
 
+	/* The processor configuration is changing */
+	topology_invalidate();
+
 	if (wait) {
+		uint64_t start = stats_now();
+
 		child = waitpid(child, &status, 0);
+		stats_record(STAGE_DRMGR, start);
 	}
 }
 
@@ -131,66 +139,28 @@ run_drmgr(enum resource_dealloc_type resource_type, char *drc_name,
  *
  * This function returns true or false. It counts the lmb's in the system
  * and returns true if there is more than one lmb in the system. Which allows
- * us to call the appropriate delete function.
+ * us to call the appropriate delete function.  LMBs already queued for
+ * removal are counted as gone, so a burst of predictive memory failures
+ * can not remove the last LMB.
  * @return true if deletion can occur or false if it is the last lmb.
  */
 static int
 can_delete_lmb(void)
 {
-	DIR *dir;
-	struct dirent *entry;
-	int ret_val, fd, ctr=0;
-	char buffer[1024], state[7];
-
-	ret_val = 0; /* default state is false, unless count is positive */
-
-	dir = opendir("/sys/devices/system/memory");
-	if (!dir)
-		return 0;
-
-	while ((entry = readdir(dir)) != NULL) {
-
-		/* ignore memory@0 situation */
-		if (!strncmp(entry->d_name, "memory@0", 8))
-				continue;
-
-		if (!strncmp(entry->d_name, "memory", 6)) {
-
-			snprintf(buffer, 1024, "/sys/devices/system/memory/%s/"
-				"state", entry->d_name);
-
-			if ((fd = open(buffer, O_RDONLY)) < 0 ) {
-				log_msg(NULL, "Could not open %s, %s",
-					buffer, strerror(errno));
-				continue;
-			}
-			if ((read(fd, state, 6)) == 6) {
-				if(!strncmp(state, "online", 6))
-					ctr++;
-				/* make sure its not the last lmb */
-				if (ctr >= 2) {
-					ret_val = 1;
-					close(fd);
-					break;
-				}
-			}
-			close(fd);
-		}
-	}
-
-	closedir(dir);
-	return ret_val;
+	return topology_online_lmbs() - drmgr_queue_lmbs_removing() >= 2;
 }
 
 /**
  * retrieve_drc_name
- * @brief retrieve the drc-name of a cpu
+ * @brief retrieve the drc-name of a cpu or an LMB
  * 
  * Retrieves a string containing the drc-name of the CPU specified by the ID 
- * passed as a parameter.  Returns 1 on success, 0 on failure.
+ * passed as a parameter, or of the LMB with the given drc-index.  Returns 1
+ * on success, 0 on failure.
  *
+ * @param type CPUTYPE or MEMTYPE
  * @param event rtas event pointer
- * @param id interrupt server number of the cpu
+ * @param id interrupt server number of the cpu, or drc-index of the LMB
  * @param buffer storeage for drc-name
  * @param bufsize size of buffer
  * @return 1 on success, 0 on failure
@@ -199,137 +169,41 @@ static int
 retrieve_drc_name(enum event_type type, struct event *event, unsigned int id,
 		      char *buffer, size_t bufsize)
 {
-	struct stat sbuf;
-	int rc, ret=1;
-	FILE *fp;
-	uint8_t status;
-	char *system_args[9] = {NULL,}; /* execv arguments      	*/
-	char tmp_sys_arg[100];		/* tmp sys_arg for snprintf	*/
-	pid_t cpid;                     /* child pid            	*/
-
-	if (stat(CONVERT_DT_PROPS_PROGRAM, &sbuf) < 0) {
-		log_msg(event, "The command \"%s\" does not exist, %s",
-			CONVERT_DT_PROPS_PROGRAM, strerror(errno));
-		return 0;
-	}
+	uint32_t drc_index;
 
-	system_args[0] = CONVERT_DT_PROPS_PROGRAM;
-	system_args[1] = "--context";
 	if (type == CPUTYPE) {
-		system_args[2] = "cpu";
-		system_args[3] = "--from";
-		system_args[4] = "interrupt-server";
-		system_args[5] = "--to";
-		system_args[6] = "drc-name";
-		snprintf(tmp_sys_arg, 100, "%u", id);
-		system_args[7] = tmp_sys_arg;
-	} else { /* event type is mem */
-		system_args[2] = "mem";
-		system_args[3] = "--from";
-		system_args[4] = "drc-index";
-		system_args[5] = "--to";
-		system_args[6] = "drc-name";
-		snprintf(tmp_sys_arg, 100, "0x%08x", id);
-		system_args[7] = tmp_sys_arg;
-	}
-
-	/* Note :
-	 *        rtas_errd sets up child signal handler
-	 * (setup_sigchld_handler()) which cleanup child process when it
-	 * exited. This caused pclose() to return non-zero value always
-	 * (No child process ). Resulted this function to return 0
-	 * (failure) always. To overcome this issue we will restore
-	 * SIGCHLD handler to default action before doing popen() and
-	 * setup again after completing pclose().
-	 */
-	restore_sigchld_default();
+		if (!cpu_interruptserver_to_drcindex(id, &drc_index)) {
+			log_msg(event, "Cannot obtain the drc-name for the "
+				"CPU with ID %u; could not find its drc-index",
+				id);
+			return 0;
+		}
 
-	fp = spopen(system_args, &cpid);
-	if (fp == NULL) {
-		if (type == CPUTYPE) {
+		if (!cpu_drcindex_to_drcname(drc_index, buffer, bufsize)) {
 			log_msg(event, "Cannot obtain the drc-name for the "
-				"CPU with ID %u; Could not run %s. %s", id,
-				CONVERT_DT_PROPS_PROGRAM, strerror(errno));
+				"CPU with ID %u; could not find the drc-name "
+				"for drc-index 0x%08x", id, drc_index);
+			return 0;
 		}
-		else {
+	} else { /* event type is mem */
+		if (!mem_drcindex_to_drcname(id, buffer, bufsize)) {
 			log_msg(event, "Cannot obtain the drc-name for the "
-				"Memory with ID %u; Could not run %s. %s", id,
-				CONVERT_DT_PROPS_PROGRAM, strerror(errno));
+				"MEMORY with ID %u; could not find the "
+				"drc-name for drc-index 0x%08x", id, id);
+			return 0;
 		}
-		setup_sigchld_handler();
-		return 0;
-	} /* fp == NULL */
+	}
 
-	rc = fread(buffer, 1, bufsize, fp);
-	if (rc == bufsize) {
+	if (strlen(buffer) == bufsize - 1) {
 		log_msg(event, "Cannot obtain the drc-name for the "
 			       "%s with ID %u; Buffer overflow in "
 			       "retrieve_drc_name",
 				(type == CPUTYPE) ? "CPU" : "MEMORY",
 				id);
-		buffer[bufsize-1] = '\0';
-		ret = 0;
-	} else if (rc > 0) {
-		buffer[rc-1] = '\0';	/* overwrite the newline at the end */
-	} else
-		buffer[0] = '\0';
-
-	status = spclose(fp, cpid);
-
-	setup_sigchld_handler();
-
-	if (status != 0) {
-		log_msg(event, "Cannot obtain the drc-name for the "
-			       "%s with ID %u; %s returned %d",
-				(type == CPUTYPE) ? "CPU" : "MEMORY",
-				id, CONVERT_DT_PROPS_PROGRAM, rc);
-		ret = 0;
-	}
-
-	return ret;
-}
-
-/**
- * parse_lparcfg
- * @brief Retrieves the value of the specified parameter from the lparcfg file.
- *
- * @param param lparcfg parameter
- * @return value of param from lparcfg, -1 on error
- */
-static long
-parse_lparcfg(char *param) {
-	FILE *fp;
-	int len;
-	char buffer[128], *pos;
-
-	if ((fp = fopen("/proc/ppc64/lparcfg", "r")) == NULL) {
-		log_msg(NULL, "Could not open /proc/ppc64/lparcfg, %s",
-			strerror(errno));
-		return -1;
-	}
-
-	len = strlen(param);
-	while ((fgets(buffer, 128, fp)) != NULL) {
-		if (!strncmp(param, buffer, len)) {
-			if ((pos = strchr(buffer, '=')) == NULL) {
-				log_msg(NULL, "Could not retrieve the value "
-					"for %s from /proc/ppc64/lparcfg",
-					param);
-				fclose(fp);
-				return -1;
-			}
-			pos++;
-			buffer[strlen(buffer)-1] = '\0';
-			fclose(fp);
-			return strtol(pos, NULL, 0);
-		}
+		return 0;
 	}
 
-	fclose(fp);
-	log_msg(NULL, "Could not find the parameter %s in /proc/ppc64/lparcfg",
-		param);
-
-	return -1;
+	return 1;
 }
 
 /**
@@ -357,7 +231,7 @@ guard_cpu(struct event *event, int cpu_id)
 	}
 
 	/* check to make sure this isn't the last CPU */
-	n_cpus = parse_lparcfg("partition_active_processors");
+	n_cpus = topology_active_processors();
 	if (n_cpus == 1) {
 		log_msg(event, "A request was received to deallocate a "
 			"processor due to a predictive CPU failure. "
@@ -413,7 +287,7 @@ guard_spcpu(struct event *event, int ent_loss)
 	 * entitled capacity.  System minimum is one virtual CPU
 	 * with 10 units of entitled capacity.
 	 */
-	ent_cap = parse_lparcfg("partition_entitled_capacity");
+	ent_cap = topology_entitled_capacity();
 	if (ent_cap <= min_ent_cap) {
 		log_msg(event, "A request was received to deallocate "
 			"entitled capacity due to a predictive CPU "
@@ -422,7 +296,7 @@ guard_spcpu(struct event *event, int ent_loss)
 			"minimum allowable entitled capacity");
 		return;
 	}
-	n_cpus = parse_lparcfg("partition_active_processors");
+	n_cpus = topology_active_processors();
 	if ((ent_cap - ent_loss) < min_ent_cap) {
 		ent_loss = ent_cap - min_ent_cap;
 	}
@@ -490,8 +364,8 @@ guard_mempage( struct event *event, uint64_t memory_address)
  *
  * parses error information to determine the lmb that requires
  * guarding operation. At this time only MEMLMB operations may
- * be guarded. DRMGR_PROGRAM is forked to actually remove
- * the LMB from the system.
+ * be guarded. The removal is queued for DRMGR_PROGRAM so that
+ * several LMBs failing together are removed by one drmgr call.
  *
  * @param event rtas event
  * @param drc index to be guarded.
@@ -501,8 +375,10 @@ guard_memlmb(struct event *event, unsigned int drc_index)
 {
 	char drc_name[30];
 
-	/* check to make sure there is more than one lmb to delete */
-	if (can_delete_lmb()==FALSE) {
+	/* check to make sure there is more than one lmb to delete, unless
+	 * this one is already on its way out
+	 */
+	if (!drmgr_queue_lmb_queued(drc_index) && can_delete_lmb()==FALSE) {
 		log_msg(event, "A request was received to deallocate a "
 			"LMB partition due to a predictive MEM failure "
 			"The request cannot be carried out because "
@@ -517,8 +393,8 @@ guard_memlmb(struct event *event, unsigned int drc_index)
 		return;
 	}
 
-	run_drmgr(MEM_LMB, drc_name, 0,0);
-	log_msg(event, "The following LMB has been offlined due to the "
+	drmgr_queue_add(event->seq_num, "mem", 1, 0, drc_index);
+	log_msg(event, "The following LMB is being offlined due to the "
 		       "reporting of a predictive memory failure:"
 			"0x%08x, drc-name %s", drc_index, drc_name);
 
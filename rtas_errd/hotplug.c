@@ -19,49 +19,43 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include <string.h>
-#include <stdlib.h>
-#include <errno.h>
-#include <sys/wait.h>
 
 #include <librtas.h>
 #include "rtas_errd.h"
 
-#define DRMGR_PROGRAM           "/usr/sbin/drmgr"
-#define DRMGR_PROGRAM_NOPATH    "drmgr"
-
+/**
+ * handle_hotplug_event
+ * @brief Queue the drmgr request carried by a hotplug event
+ *
+ * The request is not run right away; see drmgr_queue.c.
+ *
+ * @param re rtas event
+ */
 void handle_hotplug_event(struct event *re)
 {
         struct rtas_event_hdr *rtas_hdr = re->rtas_hdr;
         struct rtas_hotplug_scn *hotplug;
-        pid_t child;
-        int status;
-        char drc_index[11];
-	char count[4];
-        char *drmgr_args[] = { DRMGR_PROGRAM_NOPATH, "-c", NULL, NULL, NULL,
-                        NULL, NULL, "-d4", "-V", NULL};
+        const char *type;
+        int remove, by_count;
+        uint32_t value;
 
         /* Retrieve Hotplug section */
         if (rtas_hdr->version >= 6) {
 	        hotplug = rtas_get_hotplug_scn(re->rtas_event);
 
-                /* Build drmgr argument list */
-                dbg("Build drmgr command\n");
-
                 switch (hotplug->type) {
                         case RTAS_HP_TYPE_PCI:
-                                drmgr_args[2] = "pci";
-                                drmgr_args[6] = "-n";
+                                type = "pci";
                                 break;
 			case RTAS_HP_TYPE_CPU:
-				drmgr_args[2] = "cpu";
+				type = "cpu";
 				break;
 			case RTAS_HP_TYPE_MEMORY:
-				drmgr_args[2] = "mem";
+				type = "mem";
                                 break;
 			case RTAS_HP_TYPE_PHB:
-				drmgr_args[2] = "phb";
+				type = "phb";
                                 break;
                         default:
                                 dbg("Unknown or unsupported hotplug type %d\n",
@@ -71,10 +65,10 @@ void handle_hotplug_event(struct event *re)
 
                 switch (hotplug->action) {
                         case RTAS_HP_ACTION_ADD:
-                                drmgr_args[3] = "-a";
+                                remove = 0;
                                 break;
                         case RTAS_HP_ACTION_REMOVE:
-                                drmgr_args[3] = "-r";
+                                remove = 1;
                                 break;
                         default:
                                 dbg("Unknown hotplug action %d\n", hotplug->action);
@@ -83,14 +77,12 @@ void handle_hotplug_event(struct event *re)
 
                 switch (hotplug->identifier) {
                         case RTAS_HP_ID_DRC_INDEX:
-                                drmgr_args[4] = "-s";
-                                snprintf(drc_index, 11, "%#x", hotplug->u1.drc_index);
-                                drmgr_args[5] = drc_index;
+                                by_count = 0;
+                                value = hotplug->u1.drc_index;
                                 break;
 			case RTAS_HP_ID_DRC_COUNT:
-				drmgr_args[4] = "-q";
-				snprintf(count, 4, "%u", hotplug->u1.count);
-				drmgr_args[5] = count;
+				by_count = 1;
+				value = hotplug->u1.count;
 				break;
                         default:
                                 dbg("Unknown or unsupported hotplug identifier %d\n",
@@ -98,34 +90,10 @@ void handle_hotplug_event(struct event *re)
                                 return;
                 }
 
-                dbg("run: %s %s %s %s %s %s %s\n", drmgr_args[0],
-                        drmgr_args[1], drmgr_args[2], drmgr_args[3],
-                        drmgr_args[4], drmgr_args[5], drmgr_args[6]);
-
-#ifdef DEBUG
-		if(no_drmgr)
-			return;
-#endif
-                /* invoke drmgr */
-                dbg("Invoke drmgr command\n");
-
-                child = fork();
-                if (child == -1) {
-                        log_msg(NULL, "%s cannot be run to handle a hotplug event, %s",
-                                DRMGR_PROGRAM, strerror(errno));
-                        return;
-                } else if (child == 0) {
-                        /* child process */
-                        execv(DRMGR_PROGRAM, drmgr_args);
-
-                        /* shouldn't get here */
-                        log_msg(NULL, "Couldn not exec %s in response to hotplug event, %s",
-                                DRMGR_PROGRAM, strerror(errno));
-                        exit(1);
-                }
-
-                child = waitpid(child, &status, 0);
+                dbg("Queue drmgr %s %s %s %#x\n", type,
+                        remove ? "remove" : "add",
+                        by_count ? "count" : "drc-index", value);
 
-                dbg("drmgr call exited with %d\n", WEXITSTATUS(status));
+                drmgr_queue_add(re->seq_num, type, remove, by_count, value);
         }
 }
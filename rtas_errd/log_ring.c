@@ -0,0 +1,364 @@
+/**
+ * @file log_ring.c
+ * @brief Asynchronous writer for rtas_errd log messages
+ *
+ * log_msg(), dbg() and platform_log_write() hand their formatted
+ * messages to a ring buffer instead of writing them out themselves;
+ * a writer thread drains the ring to rtas_errd.log, the platform log
+ * (which is opened O_SYNC) and stdout.  The ring has a single producer,
+ * the thread that started the writer, and a single consumer, so it
+ * needs no locks; the producer only waits when the ring is full or
+ * when it asks for a flush.
+ *
+ * Messages from any other thread or process (e.g. a forked child that
+ * failed to exec) are written synchronously by the caller, under
+ * log_ring_lock().  So are messages from a thread that already holds
+ * that lock, which could otherwise wait for the writer thread while
+ * keeping it from writing.
+ *
+ * The flush policy is set with LogFlushPolicy in the ppc64-diag config
+ * file:
+ *  - async: messages are written in the background; messages about
+ *    EPOW and fatal events are flushed immediately (the default)
+ *  - event: as async, but the ring is also flushed after every event
+ *  - sync:  messages are written by the caller, as before
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include "rtas_errd.h"
+#include "config.h"
+
+/**
+ * @def LOG_RING_SIZE
+ * @brief Size of the ring buffer in bytes, must be a power of two
+ */
+#define LOG_RING_SIZE		(256 * 1024)
+
+/**
+ * @def LOG_RING_REC_MAX
+ * @brief Larger messages are written synchronously
+ */
+#define LOG_RING_REC_MAX	(LOG_RING_SIZE / 8)
+
+#define LOG_PAD			-1	/* skip to the start of the ring */
+
+struct log_rec {
+	uint32_t	len;		/**< length of the message */
+	int32_t		dest;		/**< LOG_RTAS_ERRD, ... or LOG_PAD */
+};
+
+#define LOG_REC_SIZE(len)	\
+	((sizeof(struct log_rec) + (len) + 7) & ~(unsigned long)7)
+
+static char log_ring[LOG_RING_SIZE] __attribute__((aligned(8)));
+
+/*
+ * log_head is only written by the producer and log_tail only by the
+ * writer thread; both count bytes and are never wrapped.
+ */
+static unsigned long log_head;
+static unsigned long log_tail;
+static unsigned long log_flush_target;	/**< log_head to flush up to */
+
+static sem_t log_work_sem;		/**< wakes the writer */
+static sem_t log_flushed_sem;		/**< flush completed */
+static pthread_mutex_t log_io_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t log_io_holder;		/**< holds log_ring_lock() */
+static int log_io_held;
+
+static pthread_t log_owner;		/**< the producer thread */
+static pthread_t log_writer;
+static pid_t log_pid;
+static int log_running;
+static int log_stopping;
+
+/**
+ * log_ring_drain
+ * @brief Write out everything in the ring
+ *
+ * Called by the writer thread only.
+ */
+static void
+log_ring_drain(void)
+{
+	unsigned long head, tail;
+	struct log_rec *rec;
+
+	pthread_mutex_lock(&log_io_mutex);
+
+	tail = log_tail;
+	head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+
+	while (tail != head) {
+		rec = (struct log_rec *)&log_ring[tail & (LOG_RING_SIZE - 1)];
+
+		if (rec->dest != LOG_PAD)
+			log_write_record(rec->dest, (char *)(rec + 1),
+					 rec->len);
+
+		tail += LOG_REC_SIZE(rec->len);
+		__atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+
+		if (tail == head)
+			head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+	}
+
+	pthread_mutex_unlock(&log_io_mutex);
+}
+
+static void *
+log_writer_thread(void *arg)
+{
+	unsigned long target;
+
+	while (1) {
+		while (sem_wait(&log_work_sem) && errno == EINTR)
+			;
+
+		log_ring_drain();
+
+		target = __atomic_load_n(&log_flush_target, __ATOMIC_ACQUIRE);
+		if (target &&
+		    __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) >= target) {
+			__atomic_store_n(&log_flush_target, 0,
+					 __ATOMIC_RELEASE);
+			sem_post(&log_flushed_sem);
+		}
+
+		if (__atomic_load_n(&log_stopping, __ATOMIC_ACQUIRE) &&
+		    __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) ==
+		    __atomic_load_n(&log_head, __ATOMIC_ACQUIRE))
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * log_io_mine
+ * @brief Does the caller hold log_ring_lock()?
+ */
+static int
+log_io_mine(void)
+{
+	return __atomic_load_n(&log_io_held, __ATOMIC_ACQUIRE) &&
+	       pthread_equal(pthread_self(), log_io_holder);
+}
+
+/**
+ * log_ring_producer
+ * @brief Is the caller allowed to queue messages?
+ */
+static int
+log_ring_producer(void)
+{
+	return log_running && getpid() == log_pid &&
+	       pthread_equal(pthread_self(), log_owner);
+}
+
+/**
+ * log_ring_flush
+ * @brief Wait until every queued message has been written out
+ */
+void
+log_ring_flush(void)
+{
+	if (!log_ring_producer())
+		return;
+
+	if (__atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) == log_head)
+		return;
+
+	__atomic_store_n(&log_flush_target, log_head, __ATOMIC_RELEASE);
+	sem_post(&log_work_sem);
+
+	while (sem_wait(&log_flushed_sem) && errno == EINTR)
+		;
+}
+
+/**
+ * log_ring_write
+ * @brief Queue a formatted message for the writer thread
+ *
+ * @param dest LOG_RTAS_ERRD, LOG_PLATFORM or LOG_STDOUT
+ * @param buf message
+ * @param len length of the message
+ * @param urgent non-zero to wait until the message has been written
+ * @return 0 if the message was queued, -1 if the caller has to write it
+ */
+int
+log_ring_write(int dest, const char *buf, int len, int urgent)
+{
+	unsigned long head = log_head, need, pad = 0, off;
+	struct log_rec *rec;
+
+	if (!log_ring_producer() || log_io_mine())
+		return -1;
+
+	/* Anything queued has to go out before this is written */
+	if (d_cfg.log_flush_policy == LOG_FLUSH_SYNC ||
+	    len > LOG_RING_REC_MAX) {
+		log_ring_flush();
+		return -1;
+	}
+
+	need = LOG_REC_SIZE(len);
+	off = head & (LOG_RING_SIZE - 1);
+	if (off + need > LOG_RING_SIZE)
+		pad = LOG_RING_SIZE - off;
+
+	/* Wait for the writer to make room */
+	while (head + pad + need -
+	       __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) > LOG_RING_SIZE) {
+		sem_post(&log_work_sem);
+		sched_yield();
+	}
+
+	if (pad) {
+		rec = (struct log_rec *)&log_ring[off];
+		rec->len = pad - sizeof(*rec);
+		rec->dest = LOG_PAD;
+		head += pad;
+		off = 0;
+	}
+
+	rec = (struct log_rec *)&log_ring[off];
+	rec->len = len;
+	rec->dest = dest;
+	memcpy(rec + 1, buf, len);
+
+	__atomic_store_n(&log_head, head + need, __ATOMIC_RELEASE);
+	sem_post(&log_work_sem);
+
+	if (urgent)
+		log_ring_flush();
+
+	return 0;
+}
+
+/**
+ * log_ring_lock
+ * @brief Serialize a synchronous write with the writer thread
+ *
+ * The caller may log while holding the lock; those messages are
+ * written synchronously rather than queued.
+ *
+ * @return value to pass to log_ring_unlock()
+ */
+int
+log_ring_lock(void)
+{
+	/* The writer thread already holds the lock, and in a forked
+	 * child there is no writer thread to serialize with.
+	 */
+	if (!log_running || getpid() != log_pid ||
+	    pthread_equal(pthread_self(), log_writer) || log_io_mine())
+		return 0;
+
+	pthread_mutex_lock(&log_io_mutex);
+	log_io_holder = pthread_self();
+	__atomic_store_n(&log_io_held, 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+void
+log_ring_unlock(int locked)
+{
+	if (locked) {
+		__atomic_store_n(&log_io_held, 0, __ATOMIC_RELEASE);
+		pthread_mutex_unlock(&log_io_mutex);
+	}
+}
+
+/**
+ * log_ring_stop
+ * @brief Write out everything queued and stop the writer thread
+ *
+ * Also called at exit(); does nothing if the writer is not running or
+ * if called from a forked child.
+ */
+void
+log_ring_stop(void)
+{
+	if (!log_ring_producer())
+		return;
+
+	__atomic_store_n(&log_stopping, 1, __ATOMIC_RELEASE);
+	sem_post(&log_work_sem);
+	pthread_join(log_writer, NULL);
+
+	log_running = 0;
+}
+
+/**
+ * log_ring_start
+ * @brief Start the writer thread
+ *
+ * Must be called after daemonizing.  Until it is called, and if it
+ * fails, messages are written synchronously.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int
+log_ring_start(void)
+{
+	static int registered;
+	sigset_t all, old;
+	int rc;
+
+	if (log_running)
+		return 0;
+
+	if (sem_init(&log_work_sem, 0, 0) || sem_init(&log_flushed_sem, 0, 0)) {
+		log_msg(NULL, "Could not initialize the log writer, %s",
+			strerror(errno));
+		return -1;
+	}
+
+	log_head = log_tail = log_flush_target = 0;
+	log_stopping = 0;
+	log_owner = pthread_self();
+	log_pid = getpid();
+
+	/* Signals are left to the main thread, as they were before */
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	rc = pthread_create(&log_writer, NULL, log_writer_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (rc) {
+		log_msg(NULL, "Could not start the log writer thread, %s",
+			strerror(rc));
+		return -1;
+	}
+
+	log_running = 1;
+
+	if (!registered && atexit(log_ring_stop) == 0)
+		registered = 1;
+
+	return 0;
+}
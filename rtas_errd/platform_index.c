@@ -0,0 +1,581 @@
+/**
+ * @file platform_index.c
+ * @brief Sequence number index for the RTAS events in the platform log
+ *
+ * The platform log (/var/log/platform) is a plain text file that grows
+ * for the lifetime of a partition.  To avoid searching it from the start
+ * every time an event is needed, rtas_errd keeps a sidecar index file
+ * (<platform_log>.idx) that maps each RTAS event sequence number to the
+ * byte offset and length of the event in the platform log.
+ *
+ * The index is appended to by print_rtas_event() as events are written.
+ * At startup it is validated against the platform log; if it is missing
+ * or does not match the log it is rebuilt with a single pass over the
+ * log, and any events appended to the log without being indexed are
+ * picked up by scanning only the unindexed tail of the log.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "rtas_errd.h"
+
+#define PLATFORM_INDEX_MAGIC	"RTASIDX"
+#define PLATFORM_INDEX_VERSION	1
+
+#define RTAS_START_PREFIX	"RTAS: "
+#define RTAS_END_LINE_TAIL	"RTAS event end ----------\n"
+
+/**
+ * struct platform_index_hdr
+ * @brief On-disk header of the platform log index
+ */
+struct platform_index_hdr {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	entry_size;
+};
+
+/**
+ * struct platform_index_entry
+ * @brief On-disk (and in-memory) record for one RTAS event
+ *
+ * The index is a local cache of the platform log and is never moved
+ * between machines, so records are stored in host endian.
+ */
+struct platform_index_entry {
+	uint32_t	seq_num;	/**< RTAS event sequence number */
+	uint32_t	length;		/**< bytes, begin line to end line */
+	uint64_t	offset;		/**< offset of the begin line */
+};
+
+/**
+ * @var platform_index_file
+ * @brief Path of the index file, derived from platform_log
+ */
+static char platform_index_file[PATH_MAX];
+static int platform_index_fd = -1;
+
+/**
+ * @var pindex
+ * @brief In-memory copy of the index, in platform log order
+ */
+static struct platform_index_entry *pindex;
+static size_t pindex_count;
+static size_t pindex_size;
+
+/**
+ * @var pindex_run
+ * @brief First entry of the current run of increasing sequence numbers
+ *
+ * RTAS event sequence numbers start over when the partition is
+ * rebooted, so the same number can appear more than once in the
+ * platform log.  Only the entries from pindex_run on belong to the
+ * current numbering; lookups never look before it.
+ */
+static size_t pindex_run;
+
+/**
+ * pindex_append
+ * @brief Append an entry to the in-memory index
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+static int
+pindex_append(uint32_t seq_num, uint64_t offset, uint32_t length)
+{
+	struct platform_index_entry *tmp;
+
+	if (pindex_count == pindex_size) {
+		size_t new_size = pindex_size ? pindex_size * 2 : 1024;
+
+		tmp = realloc(pindex, new_size * sizeof(*pindex));
+		if (tmp == NULL)
+			return -1;
+
+		pindex = tmp;
+		pindex_size = new_size;
+	}
+
+	if (pindex_count > pindex_run &&
+	    seq_num <= pindex[pindex_count - 1].seq_num) {
+		dbg("RTAS event numbers restarted at %u in %s", seq_num,
+		    platform_log);
+		pindex_run = pindex_count;
+	}
+
+	pindex[pindex_count].seq_num = seq_num;
+	pindex[pindex_count].offset = offset;
+	pindex[pindex_count].length = length;
+	pindex_count++;
+
+	return 0;
+}
+
+/**
+ * event_matches_log
+ * @brief Check that an index entry points at the right event in the log
+ *
+ * Reads the begin line and the tail of the end line of the event and
+ * verifies both carry the expected sequence number / marker.
+ *
+ * @param entry index entry to check
+ * @param log_size current size of the platform log
+ * @return 1 if the entry is valid, 0 otherwise
+ */
+static int
+event_matches_log(struct platform_index_entry *entry, off_t log_size)
+{
+	char	buf[64], expect[64];
+	int	len, tail = strlen(RTAS_END_LINE_TAIL);
+
+	if (entry->length < tail ||
+	    entry->offset + entry->length > (uint64_t)log_size)
+		return 0;
+
+	len = snprintf(expect, sizeof(expect), RTAS_START_PREFIX "%u ",
+		       entry->seq_num);
+	if (pread(platform_log_fd, buf, len, entry->offset) != len ||
+	    memcmp(buf, expect, len))
+		return 0;
+
+	if (pread(platform_log_fd, buf, tail,
+		  entry->offset + entry->length - tail) != tail ||
+	    memcmp(buf, RTAS_END_LINE_TAIL, tail))
+		return 0;
+
+	return 1;
+}
+
+/**
+ * scan_platform_log
+ * @brief Index the RTAS events found in part of the platform log
+ *
+ * @param start offset in the platform log to start scanning at
+ * @param log_size size of the platform log
+ * @param write_fd if >= 0, new entries are also written to this fd
+ * @return 0 on success, -1 on failure
+ */
+static int
+scan_platform_log(off_t start, off_t log_size, int write_fd)
+{
+	char	*log_mmap, *log_end, *begin, *end, *line;
+	off_t	map_start;
+	long	pagesize = sysconf(_SC_PAGESIZE);
+	int	rc = 0;
+
+	if (start >= log_size)
+		return 0;
+
+	/* mmap offsets have to be page aligned */
+	map_start = start - (start % pagesize);
+	log_mmap = mmap(0, log_size - map_start, PROT_READ, MAP_PRIVATE,
+			platform_log_fd, map_start);
+	if (log_mmap == MAP_FAILED) {
+		log_msg(NULL, "Cannot map %s to index RTAS events, %s",
+			platform_log, strerror(errno));
+		return -1;
+	}
+
+	log_end = log_mmap + (log_size - map_start);
+	begin = find_rtas_start(log_mmap + (start - map_start), log_end);
+	while (begin != NULL) {
+		struct platform_index_entry entry;
+		char *next;
+
+		end = find_rtas_end(begin, log_end);
+		if (end == NULL)
+			break;	/* partially written last event */
+
+		/* An event cut short (e.g. by a crash) has no end line of
+		 * its own; skip it rather than pair it with the next one.
+		 */
+		next = find_rtas_start(begin + strlen(RTAS_START), end);
+		if (next != NULL) {
+			begin = next;
+			continue;
+		}
+
+		/* back up to the start of the "RTAS: n" begin line */
+		line = begin;
+		while (line > log_mmap && *(line - 1) != '\n')
+			line--;
+
+		/* and forward past the newline of the end line */
+		while (end < log_end && *end != '\n')
+			end++;
+		if (end == log_end)
+			break;
+		end++;
+
+		entry.seq_num = get_rtas_no(begin);
+		entry.offset = map_start + (line - log_mmap);
+		entry.length = end - line;
+
+		if (pindex_append(entry.seq_num, entry.offset, entry.length)) {
+			rc = -1;
+			break;
+		}
+
+		if (write_fd >= 0 &&
+		    write(write_fd, &entry, sizeof(entry)) != sizeof(entry)) {
+			rc = -1;
+			break;
+		}
+
+		begin = find_rtas_start(end, log_end);
+	}
+
+	munmap(log_mmap, log_size - map_start);
+	return rc;
+}
+
+/**
+ * write_index_hdr
+ * @brief Write a fresh index header to fd
+ */
+static int
+write_index_hdr(int fd)
+{
+	struct platform_index_hdr hdr;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, PLATFORM_INDEX_MAGIC, sizeof(PLATFORM_INDEX_MAGIC));
+	hdr.version = PLATFORM_INDEX_VERSION;
+	hdr.entry_size = sizeof(struct platform_index_entry);
+
+	if (write(fd, &hdr, sizeof(hdr)) != sizeof(hdr))
+		return -1;
+
+	return 0;
+}
+
+/**
+ * rebuild_platform_index
+ * @brief Rebuild the index file from the whole platform log
+ *
+ * The new index is written to a temporary file and renamed over the old
+ * one, so a crash during the rebuild never leaves a truncated index.
+ *
+ * @param log_size size of the platform log
+ * @return 0 on success, -1 on failure
+ */
+static int
+rebuild_platform_index(off_t log_size)
+{
+	char	tmp_file[PATH_MAX + 8];
+	int	fd;
+
+	dbg("Rebuilding platform log index %s", platform_index_file);
+
+	pindex_count = pindex_run = 0;
+
+	snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", platform_index_file);
+	fd = open(tmp_file, O_WRONLY | O_CREAT | O_TRUNC,
+		  S_IRUSR | S_IWUSR | S_IRGRP /*0640*/);
+	if (fd < 0) {
+		log_msg(NULL, "Could not create platform log index %s, %s",
+			tmp_file, strerror(errno));
+		return -1;
+	}
+
+	if (write_index_hdr(fd) || scan_platform_log(0, log_size, fd)) {
+		log_msg(NULL, "Could not write platform log index %s, %s",
+			tmp_file, strerror(errno));
+		close(fd);
+		unlink(tmp_file);
+		return -1;
+	}
+
+	close(fd);
+
+	if (rename(tmp_file, platform_index_file)) {
+		log_msg(NULL, "Could not rename %s to %s, %s", tmp_file,
+			platform_index_file, strerror(errno));
+		unlink(tmp_file);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * load_platform_index
+ * @brief Read and validate an existing index file
+ *
+ * @param log_size size of the platform log
+ * @return 0 if the index was loaded and matches the log, -1 otherwise
+ */
+static int
+load_platform_index(off_t log_size)
+{
+	struct platform_index_hdr hdr;
+	struct stat sbuf;
+	size_t	count;
+	int	fd, rc = -1;
+
+	fd = open(platform_index_file, O_RDONLY);
+	if (fd < 0)
+		return -1;
+
+	if (fstat(fd, &sbuf) ||
+	    read(fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+	    memcmp(hdr.magic, PLATFORM_INDEX_MAGIC,
+		   sizeof(PLATFORM_INDEX_MAGIC)) ||
+	    hdr.version != PLATFORM_INDEX_VERSION ||
+	    hdr.entry_size != sizeof(struct platform_index_entry) ||
+	    (sbuf.st_size - sizeof(hdr)) % sizeof(struct platform_index_entry))
+		goto out;
+
+	count = (sbuf.st_size - sizeof(hdr)) /
+		sizeof(struct platform_index_entry);
+
+	pindex = malloc((count ? count : 1) * sizeof(*pindex));
+	if (pindex == NULL)
+		goto out;
+	pindex_size = count ? count : 1;
+
+	if (count && read(fd, pindex, count * sizeof(*pindex)) !=
+	    count * sizeof(*pindex))
+		goto out;
+	pindex_count = count;
+
+	/* The first and last entries pin the index to this log file;
+	 * a rotated or truncated log will not match them.
+	 */
+	if (count && (!event_matches_log(&pindex[0], log_size) ||
+		      !event_matches_log(&pindex[count - 1], log_size)))
+		goto out;
+
+	/* Re-anchor at the last restart of the sequence numbers */
+	for (pindex_run = count ? count - 1 : 0; pindex_run > 0; pindex_run--)
+		if (pindex[pindex_run - 1].seq_num >= pindex[pindex_run].seq_num)
+			break;
+
+	rc = 0;
+out:
+	if (rc)
+		pindex_count = pindex_run = 0;
+	close(fd);
+	return rc;
+}
+
+/**
+ * init_platform_index
+ * @brief Open (rebuilding if needed) the platform log index
+ *
+ * Must be called after the platform log has been opened.
+ *
+ * @return 0 on success, !0 if the index is unavailable
+ */
+int
+init_platform_index(void)
+{
+	struct stat sbuf;
+	off_t	indexed_end = 0;
+
+	if (fstat(platform_log_fd, &sbuf) < 0) {
+		log_msg(NULL, "Cannot get status of %s to index RTAS events, "
+			"%s", platform_log, strerror(errno));
+		return -1;
+	}
+
+	snprintf(platform_index_file, sizeof(platform_index_file), "%s.idx",
+		 platform_log);
+
+	if (load_platform_index(sbuf.st_size)) {
+		if (rebuild_platform_index(sbuf.st_size))
+			return -1;
+	}
+
+	platform_index_fd = open(platform_index_file, O_WRONLY | O_APPEND);
+	if (platform_index_fd < 0) {
+		log_msg(NULL, "Could not open platform log index %s, %s",
+			platform_index_file, strerror(errno));
+		return -1;
+	}
+
+	/* Pick up any events written without being indexed */
+	if (pindex_count)
+		indexed_end = pindex[pindex_count - 1].offset +
+			      pindex[pindex_count - 1].length;
+	if (indexed_end < sbuf.st_size)
+		scan_platform_log(indexed_end, sbuf.st_size,
+				  platform_index_fd);
+
+	return 0;
+}
+
+/**
+ * close_platform_index
+ * @brief Release the platform log index
+ */
+void
+close_platform_index(void)
+{
+	if (platform_index_fd >= 0)
+		close(platform_index_fd);
+	platform_index_fd = -1;
+
+	free(pindex);
+	pindex = NULL;
+	pindex_count = pindex_size = pindex_run = 0;
+}
+
+/**
+ * platform_index_add
+ * @brief Record the location of an RTAS event written to the platform log
+ *
+ * @param seq_num RTAS event sequence number
+ * @param offset offset of the event's begin line in the platform log
+ * @param length length of the event in the platform log
+ */
+void
+platform_index_add(int seq_num, off_t offset, size_t length)
+{
+	struct platform_index_entry *entry;
+
+	if (platform_index_fd < 0)
+		return;
+
+	if (pindex_append(seq_num, offset, length))
+		return;
+
+	entry = &pindex[pindex_count - 1];
+	if (write(platform_index_fd, entry, sizeof(*entry)) != sizeof(*entry))
+		dbg("Could not update platform log index %s",
+		    platform_index_file);
+}
+
+/**
+ * platform_index_last
+ * @brief Retrieve the sequence number of the last indexed RTAS event
+ *
+ * @return sequence number, 0 if there are no indexed events or -1 if
+ *	   the index is not available
+ */
+int
+platform_index_last(void)
+{
+	if (platform_index_fd < 0)
+		return -1;
+
+	if (pindex_count == 0)
+		return 0;
+
+	return pindex[pindex_count - 1].seq_num;
+}
+
+/**
+ * platform_index_lookup
+ * @brief Find the location of an RTAS event in the platform log
+ *
+ * Only the current run of sequence numbers is searched; an event with
+ * the same number from before the last restart is a different event.
+ * Sequence numbers normally increase by one per event, so the entry is
+ * first looked for at its expected position relative to the last entry.
+ * Failing that (an event was never written to the platform log) the run
+ * is binary searched, it is in increasing order.  A number newer than
+ * the last entry, the common case, is known to be absent right away.
+ *
+ * @param seq_num RTAS event sequence number
+ * @param offset filled in with the event offset in the platform log
+ * @param length filled in with the event length
+ * @return 0 if found, -1 otherwise
+ */
+int
+platform_index_lookup(int seq_num, off_t *offset, size_t *length)
+{
+	struct platform_index_entry *entry = NULL;
+	uint32_t last, seq = seq_num;
+	size_t	lo, hi, mid;
+
+	if (platform_index_fd < 0 || pindex_count == 0)
+		return -1;
+
+	last = pindex[pindex_count - 1].seq_num;
+	if (seq > last || seq < pindex[pindex_run].seq_num)
+		return -1;
+
+	if (last - seq < pindex_count - pindex_run &&
+	    pindex[pindex_count - 1 - (last - seq)].seq_num == seq) {
+		entry = &pindex[pindex_count - 1 - (last - seq)];
+	} else {
+		lo = pindex_run;
+		hi = pindex_count;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			if (pindex[mid].seq_num < seq) {
+				lo = mid + 1;
+			} else if (pindex[mid].seq_num > seq) {
+				hi = mid;
+			} else {
+				entry = &pindex[mid];
+				break;
+			}
+		}
+	}
+
+	if (entry == NULL)
+		return -1;
+
+	*offset = entry->offset;
+	*length = entry->length;
+	return 0;
+}
+
+/**
+ * platform_log_read_event
+ * @brief Read the text of an RTAS event from the platform log
+ *
+ * @param seq_num RTAS event sequence number
+ * @param len filled in with the length of the returned buffer
+ * @return malloc()ed, NUL terminated copy of the event, NULL if not found
+ */
+char *
+platform_log_read_event(int seq_num, size_t *len)
+{
+	off_t	offset;
+	size_t	length;
+	char	*buf;
+
+	if (platform_index_lookup(seq_num, &offset, &length))
+		return NULL;
+
+	buf = malloc(length + 1);
+	if (buf == NULL)
+		return NULL;
+
+	if (pread(platform_log_fd, buf, length, offset) != length) {
+		free(buf);
+		return NULL;
+	}
+
+	buf[length] = '\0';
+	*len = length;
+	return buf;
+}
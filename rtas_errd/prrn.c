@@ -33,8 +33,13 @@
 #include <librtas.h>
 #include "rtas_errd.h"
 
+/*
+ * Map of phandles (and, for LMBs, drc-indexes) to device tree nodes.
+ * It is an open addressed hash table, phandle 0 marks an empty slot.
+ * The map is kept between PRRN events and only rebuilt when the
+ * device tree has changed underneath it.
+ */
 struct pmap_struct {
-	struct pmap_struct	*next;
 	/* The fields below are stored in host endian */
 	uint32_t		phandle;
 	uint32_t		drc_index;
@@ -49,7 +54,14 @@ struct drconf_cell {
 	uint32_t	flags;
 };
 
-static struct pmap_struct *plist;
+static struct pmap_struct *pmap;
+static unsigned int pmap_size;
+static unsigned int pmap_count;
+static int pmap_valid;
+static int pmap_rebuilt;		/* rebuilt during this PRRN event */
+static struct stat pmap_drconf_sbuf;	/* DRCONF_PATH when last built */
+static uint64_t pmap_lmb_hash;		/* of the LMB drc-indexes in the map */
+static char lmb_name[] = "LMB";		/* shared name of all LMB entries */
 static int prrn_log_fd;
 static char prrn_filename[128];
 
@@ -104,49 +116,119 @@ uint32_t get_drc_index(const char *path)
 	return be32toh(drc_index);
 }
 
+static inline unsigned int pmap_slot(uint32_t phandle, unsigned int size)
+{
+	/* Knuth multiplicative hash, size is a power of two */
+	return (phandle * 2654435761u) & (size - 1);
+}
+
+/**
+ * pmap_insert
+ *
+ * @param pm table to insert into
+ * @param size size of pm, a power of two
+ * @param entry entry to insert; replaces any entry with the same phandle
+ */
+static void pmap_insert(struct pmap_struct *pm, unsigned int size,
+			struct pmap_struct *entry)
+{
+	unsigned int slot = pmap_slot(entry->phandle, size);
+
+	while (pm[slot].phandle && pm[slot].phandle != entry->phandle)
+		slot = (slot + 1) & (size - 1);
+
+	if (pm[slot].phandle) {
+		if (pm[slot].name != lmb_name)
+			free(pm[slot].name);
+	} else if (pm == pmap)
+		pmap_count++;
+
+	pm[slot] = *entry;
+}
+
+/**
+ * pmap_grow
+ *
+ * Double the size of the phandle map, keeping its load below one half.
+ *
+ * @returns 0 on success, -1 on allocation failure
+ */
+static int pmap_grow(void)
+{
+	struct pmap_struct *new_pmap;
+	unsigned int new_size = pmap_size ? pmap_size * 2 : 4096;
+	unsigned int i;
+
+	new_pmap = calloc(new_size, sizeof(*new_pmap));
+	if (!new_pmap)
+		return -1;
+
+	for (i = 0; i < pmap_size; i++) {
+		if (pmap[i].phandle)
+			pmap_insert(new_pmap, new_size, &pmap[i]);
+	}
+
+	free(pmap);
+	pmap = new_pmap;
+	pmap_size = new_size;
+	return 0;
+}
+
 /**
  * add_phandle_to_list
  *
- * @param name
+ * @param name node name, or lmb_name for LMBs
  * @param phandle
+ * @param drc_index
+ * @returns 0 on success, -1 on allocation failure
  */
-static void add_phandle_to_list(char *name, uint32_t phandle,
-				uint32_t drc_index)
+static int add_phandle_to_list(char *name, uint32_t phandle,
+			       uint32_t drc_index)
 {
-	struct pmap_struct *pm;
+	struct pmap_struct pm;
 
-	pm = calloc(1, sizeof(struct pmap_struct));
-	if (!pm)
-		return;
+	if (!phandle)
+		return 0;
 
-	pm->name = malloc(strlen(name) + 1);
-	if (!pm->name) {
-		free(pm);
-		return;
-	}
+	if ((pmap_count + 1) * 2 > pmap_size && pmap_grow())
+		return -1;
 
-	sprintf(pm->name, "%s", name);
+	if (name == lmb_name) {
+		pm.name = lmb_name;
+	} else {
+		pm.name = strdup(name);
+		if (!pm.name)
+			return -1;
+	}
 
-	pm->phandle = phandle;
-	pm->drc_index = drc_index;
-	pm->next = plist;
-	plist = pm;
+	pm.phandle = phandle;
+	pm.drc_index = drc_index;
+	pmap_insert(pmap, pmap_size, &pm);
+	return 0;
 }
 
 /**
- * phandle_to_name
+ * phandle_to_pms
  *
  * @param ph
  * @returns
  */
 static struct pmap_struct *phandle_to_pms(uint32_t phandle)
 {
-	struct pmap_struct *pms = plist;
+	unsigned int slot;
+
+	if (!pmap_size || !phandle)
+		return NULL;
+
+	slot = pmap_slot(phandle, pmap_size);
+	while (pmap[slot].phandle) {
+		if (pmap[slot].phandle == phandle)
+			return &pmap[slot];
 
-	while (pms && pms->phandle != phandle)
-		pms = pms->next;
+		slot = (slot + 1) & (pmap_size - 1);
+	}
 
-	return pms;
+	return NULL;
 }
 
 /**
@@ -200,9 +282,12 @@ static int add_std_phandles(char *parent, char *p)
 		*pend = '\0';
 
 		drc_index = get_drc_index(path);
-		add_phandle_to_list(path + strlen(OFDT_BASE), be32toh(phandle),
-				    drc_index);
 		fclose(fd);
+		if (add_phandle_to_list(path + strlen(OFDT_BASE),
+					be32toh(phandle), drc_index)) {
+			closedir(d);
+			return -1;
+		}
 	}
 
 	closedir(d);
@@ -210,27 +295,22 @@ static int add_std_phandles(char *parent, char *p)
 }
 
 /**
- * add_drconf_phandles
+ * read_drconf
  *
- * @returns
+ * @param membuf returns the ibm,dynamic-memory property, to be freed by
+ *	the caller; NULL if the system does not have it
+ * @param sbuf returns the stat of the property
+ * @returns 0 on success, -1 on failure
  */
-static int add_drconf_phandles()
+static int read_drconf(int **membuf, struct stat *sbuf)
 {
 	FILE *fd;
-	int *membuf;
-	int i, rc, entries;
-	struct stat sbuf;
-	struct drconf_cell *mem;
 
-	/* For PRRN Events the LMBs in dynamic-reconfiguration-memory that
-	 * will get updated have their drc-index reported instead of the
-	 * phandle in the list of phandles to update reported by
-	 * rtas_update_nodes(). So we need to build a list of the possible
-	 * LMBs.
-	 */
-	rc = stat(DRCONF_PATH, &sbuf);
-	if (rc)
+	*membuf = NULL;
+	if (stat(DRCONF_PATH, sbuf)) {
+		memset(sbuf, 0, sizeof(*sbuf));
 		return 0;
+	}
 
 	fd = fopen(DRCONF_PATH, "r");
 	if (!fd) {
@@ -238,29 +318,112 @@ static int add_drconf_phandles()
 		return 0;
 	}
 
-	membuf = malloc(sbuf.st_size);
-	if (!membuf) {
+	*membuf = malloc(sbuf->st_size);
+	if (!*membuf) {
 		fclose(fd);
 		return -1;
 	}
 
-	if ((fread(membuf, sbuf.st_size, 1, fd) < sbuf.st_size) && ferror(fd)) {
+	if ((fread(*membuf, sbuf->st_size, 1, fd) < sbuf->st_size) &&
+	    ferror(fd)) {
 		fclose(fd);
-		free(membuf);
+		free(*membuf);
+		*membuf = NULL;
 		return -1;
 	}
 	fclose(fd);
 
+	return 0;
+}
+
+/**
+ * drconf_lmb_hash
+ *
+ * @param membuf the ibm,dynamic-memory property, or NULL
+ * @returns a hash of the LMB drc-indexes listed in it
+ */
+static uint64_t drconf_lmb_hash(int *membuf)
+{
+	struct drconf_cell *mem;
+	uint64_t hash = 14695981039346656037ull;	/* FNV-1a */
+	uint32_t drc_index;
+	int i, entries;
+
+	if (!membuf)
+		return 0;
+
+	entries = be32toh(membuf[0]);
+	mem = (struct drconf_cell *)&membuf[1];
+	for (i = 0; i < entries; i++, mem++) {
+		drc_index = mem->drc_index;
+		hash ^= drc_index;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+/**
+ * add_drconf_phandles
+ *
+ * @param membuf the ibm,dynamic-memory property, or NULL
+ * @returns 0 on success, -1 on allocation failure
+ */
+static int add_drconf_phandles(int *membuf)
+{
+	struct drconf_cell *mem;
+	int i, entries;
+
+	/* For PRRN Events the LMBs in dynamic-reconfiguration-memory that
+	 * will get updated have their drc-index reported instead of the
+	 * phandle in the list of phandles to update reported by
+	 * rtas_update_nodes(). So we need to build a list of the possible
+	 * LMBs.
+	 */
+	pmap_lmb_hash = drconf_lmb_hash(membuf);
+	if (!membuf)
+		return 0;
+
 	entries = be32toh(membuf[0]);
 	mem = (struct drconf_cell *)&membuf[1];
 
 	for (i = 0; i < entries; i++) {
 		/* See comment above about rtas reporting drc_indexes. */
-		add_phandle_to_list("LMB", be32toh(mem->drc_index), be32toh(mem->drc_index));
+		if (add_phandle_to_list(lmb_name, be32toh(mem->drc_index),
+					be32toh(mem->drc_index)))
+			return -1;
 		mem++; /* trust your compiler */
 	}
 
-	free(membuf);
+	return 0;
+}
+
+/**
+ * drop_lmb_phandles
+ *
+ * Take the LMBs out of the map, keeping the device tree nodes.
+ *
+ * @returns 0 on success, -1 on allocation failure
+ */
+static int drop_lmb_phandles(void)
+{
+	struct pmap_struct *new_pmap;
+	unsigned int i;
+
+	new_pmap = calloc(pmap_size, sizeof(*new_pmap));
+	if (!new_pmap)
+		return -1;
+
+	pmap_count = 0;
+	for (i = 0; i < pmap_size; i++) {
+		if (pmap[i].phandle && pmap[i].name != lmb_name) {
+			pmap_insert(new_pmap, pmap_size, &pmap[i]);
+			pmap_count++;
+		}
+	}
+
+	free(pmap);
+	pmap = new_pmap;
 	return 0;
 }
 
@@ -270,15 +433,18 @@ static int add_drconf_phandles()
  */
 static void free_phandles()
 {
-	struct pmap_struct *pm;
-
-	while (plist) {
-		pm = plist;
-		plist = plist->next;
+	unsigned int i;
 
-		free(pm->name);
-		free(pm);
+	for (i = 0; i < pmap_size; i++) {
+		if (pmap[i].phandle && pmap[i].name != lmb_name)
+			free(pmap[i].name);
 	}
+
+	free(pmap);
+	pmap = NULL;
+	pmap_size = 0;
+	pmap_count = 0;
+	pmap_valid = 0;
 }
 
 /**
@@ -288,21 +454,146 @@ static void free_phandles()
  */
 static int add_phandles()
 {
+	int *membuf;
 	int rc;
 
+	dbg("Building phandle map");
+	free_phandles();
+
+	rc = read_drconf(&membuf, &pmap_drconf_sbuf);
+	if (rc)
+		return rc;
+
 	rc = add_std_phandles(OFDT_BASE, NULL);
+	if (!rc)
+		rc = add_drconf_phandles(membuf);
+	free(membuf);
 	if (rc) {
 		free_phandles();
 		return rc;
 	}
 
-	rc = add_drconf_phandles();
-	if (rc)
-		free_phandles();
+	dbg("Phandle map has %u entries", pmap_count);
+	pmap_valid = 1;
+	pmap_rebuilt = 1;
+	return 0;
+}
+
+/**
+ * invalidate_phandle_map
+ *
+ * Called after hotplug events, which add and remove device tree nodes;
+ * the map is rebuilt on the next PRRN event.
+ */
+void invalidate_phandle_map(void)
+{
+	pmap_valid = 0;
+}
+
+/**
+ * phandle_map_current
+ *
+ * The LMB list only changes if ibm,dynamic-memory is replaced, but
+ * every memory PRRN replaces it, mostly with the same LMBs and only
+ * their attributes changed.  So when it has been replaced, the map is
+ * kept if the set of LMB drc-indexes is the same, and otherwise only
+ * its LMBs are reloaded; the rest of the device tree is not walked.
+ *
+ * @returns 1 if the phandle map still matches the device tree
+ */
+static int phandle_map_current(void)
+{
+	struct stat sbuf;
+	int *membuf;
+	int rc = 0;
+
+	if (!pmap_valid)
+		return 0;
 
+	if (stat(DRCONF_PATH, &sbuf))
+		memset(&sbuf, 0, sizeof(sbuf));
+
+	if (sbuf.st_ino == pmap_drconf_sbuf.st_ino &&
+	    sbuf.st_size == pmap_drconf_sbuf.st_size &&
+	    sbuf.st_mtime == pmap_drconf_sbuf.st_mtime)
+		return 1;
+
+	if (read_drconf(&membuf, &sbuf))
+		return 0;
+
+	if (drconf_lmb_hash(membuf) != pmap_lmb_hash) {
+		dbg("The LMBs have changed, updating the phandle map");
+		if (drop_lmb_phandles() || add_drconf_phandles(membuf)) {
+			free_phandles();
+			goto out;
+		}
+	}
+
+	pmap_drconf_sbuf = sbuf;
+	rc = 1;
+out:
+	free(membuf);
 	return rc;
 }
 
+/**
+ * pms_current
+ *
+ * Nodes can be removed and added again (with new phandles) by drmgr
+ * without rtas_errd seeing an event, so check that a node found in
+ * the map still has the phandle it was recorded with.
+ *
+ * @param pms
+ * @returns 1 if the entry still matches the device tree
+ */
+static int pms_current(struct pmap_struct *pms)
+{
+	char path[PATH_MAX];
+	uint32_t phandle;
+	FILE *fp;
+	int rc;
+
+	if (pms->name == lmb_name)
+		return 1;
+
+	snprintf(path, sizeof(path), "%s%s/ibm,phandle", OFDT_BASE,
+		 pms->name);
+	fp = fopen(path, "r");
+	if (!fp)
+		return 0;
+
+	rc = fread(&phandle, sizeof(phandle), 1, fp);
+	fclose(fp);
+
+	return rc == 1 && be32toh(phandle) == pms->phandle;
+}
+
+/**
+ * find_pms
+ *
+ * Look up a phandle reported by rtas_update_nodes(), rebuilding the
+ * map (at most once per PRRN event) if it turns out to be stale.
+ *
+ * @param phandle
+ * @returns
+ */
+static struct pmap_struct *find_pms(uint32_t phandle)
+{
+	struct pmap_struct *pms = phandle_to_pms(phandle);
+
+	if (pms && pms_current(pms))
+		return pms;
+
+	if (pmap_rebuilt)
+		return pms;
+
+	dbg("Phandle %08x is not current in the phandle map", phandle);
+	if (add_phandles())
+		return NULL;
+
+	return phandle_to_pms(phandle);
+}
+
 /**
  * do_update
  *
@@ -542,7 +833,7 @@ static void update_nodes(unsigned int *op, unsigned int n)
 		phandle = be32toh(*op++);
 		dbg("Updating node with phandle %08x", phandle);
 
-		pms = phandle_to_pms(phandle);
+		pms = find_pms(phandle);
 		if (!pms)
 			continue;
 
@@ -568,7 +859,8 @@ static void devtree_update(uint scope)
 	unsigned int *op;
 
 	dbg("Updating device_tree");
-	if (add_phandles())
+	pmap_rebuilt = 0;
+	if (!phandle_map_current() && add_phandles())
 		return;
 
 	/* First 16 bytes of work area must be initialized to zero */
@@ -613,7 +905,6 @@ static void devtree_update(uint scope)
 		}
 	} while (rc == 1);
 
-	free_phandles();
 	dbg("Finished devtree update");
 }
 
@@ -0,0 +1,286 @@
+/**
+ * @file replay.c
+ * @brief Replay a corpus of RTAS events for load testing
+ *
+ * With the -b option rtas_errd reads its RTAS events from a binary
+ * corpus file rather than from the kernel, optionally at a fixed rate
+ * (-r events per second), and reports the throughput and the latency
+ * of handle_rtas_event() once the corpus is exhausted.  The
+ * rtas_errd/tests/rtas_errd_replay build runs against stubbed librtas,
+ * servicelog and external programs, so that the corpus can be replayed
+ * on any machine without side effects.
+ *
+ * A corpus starts with the 8 byte magic "RTASCRP1", followed by one
+ * record per event: the event length as a 32-bit big endian number and
+ * the raw event as read from /proc/ppc64/rtas/error_log, without the
+ * sequence number.  Sequence numbers are assigned while replaying.
+ * rtas_errd/tests/mkcorpus builds a corpus from the ASCII event files
+ * used by the -f and -s options.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifdef DEBUG
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <endian.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "rtas_errd.h"
+
+#define REPLAY_MAGIC		"RTASCRP1"
+#define REPLAY_MAGIC_LEN	8
+#define REPLAY_SEQ_BASE		100000
+
+/**
+ * @var replay_rate
+ * @brief Events per second to replay at, 0 for as fast as possible
+ */
+int replay_rate = 0;
+
+static char *corpus;
+static size_t corpus_size;
+static size_t corpus_pos;
+static int replay_count;
+
+static struct timespec replay_start;
+static uint64_t *latencies;
+static int nlatencies;
+static int latencies_size;
+
+/**
+ * replay_open
+ * @brief Map a corpus file and check its header
+ *
+ * @param path corpus file
+ * @return 0 on success, -1 on failure
+ */
+int
+replay_open(const char *path)
+{
+	struct stat sbuf;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		log_msg(NULL, "Could not open replay corpus %s, %s", path,
+			strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &sbuf) < 0 || sbuf.st_size < REPLAY_MAGIC_LEN) {
+		log_msg(NULL, "Replay corpus %s is too short", path);
+		close(fd);
+		return -1;
+	}
+
+	corpus = mmap(NULL, sbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (corpus == MAP_FAILED) {
+		log_msg(NULL, "Could not map replay corpus %s, %s", path,
+			strerror(errno));
+		corpus = NULL;
+		return -1;
+	}
+
+	if (memcmp(corpus, REPLAY_MAGIC, REPLAY_MAGIC_LEN)) {
+		log_msg(NULL, "%s is not an RTAS event corpus", path);
+		munmap(corpus, sbuf.st_size);
+		corpus = NULL;
+		return -1;
+	}
+
+	corpus_size = sbuf.st_size;
+	corpus_pos = REPLAY_MAGIC_LEN;
+	return 0;
+}
+
+/**
+ * replay_active
+ * @brief Are the events being read from a corpus?
+ */
+int
+replay_active(void)
+{
+	return corpus != NULL;
+}
+
+/**
+ * replay_pace
+ * @brief Wait until the next event is due at the requested rate
+ */
+static void
+replay_pace(void)
+{
+	struct timespec due;
+	uint64_t ns;
+
+	if (replay_rate <= 0)
+		return;
+
+	ns = (uint64_t)replay_count * 1000000000 / replay_rate;
+	due.tv_sec = replay_start.tv_sec + ns / 1000000000;
+	due.tv_nsec = replay_start.tv_nsec + ns % 1000000000;
+	if (due.tv_nsec >= 1000000000) {
+		due.tv_sec++;
+		due.tv_nsec -= 1000000000;
+	}
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) ==
+									EINTR)
+		;
+}
+
+/**
+ * replay_read
+ * @brief Read the next event from the corpus
+ *
+ * Fills in buf as a read of /proc/ppc64/rtas/error_log would, and sets
+ * testing_finished after the last event.
+ *
+ * @param buf buffer to read the RTAS event in to
+ * @param buflen length of buf
+ * @return number of bytes read, -1 on a malformed corpus
+ */
+int
+replay_read(char *buf, int buflen)
+{
+	uint32_t len;
+	int seq_num;
+
+	if (corpus_pos + sizeof(len) > corpus_size) {
+		log_msg(NULL, "The replay corpus is empty");
+		testing_finished = 1;
+		return -1;
+	}
+
+	memcpy(&len, corpus + corpus_pos, sizeof(len));
+	len = be32toh(len);
+	if (len + sizeof(len) > corpus_size - corpus_pos ||
+	    len + sizeof(seq_num) > buflen) {
+		log_msg(NULL, "Malformed replay corpus record at offset %zu",
+			corpus_pos);
+		testing_finished = 1;
+		return -1;
+	}
+
+	if (replay_count == 0)
+		clock_gettime(CLOCK_MONOTONIC, &replay_start);
+	replay_pace();
+
+	seq_num = REPLAY_SEQ_BASE + replay_count++;
+	memcpy(buf, &seq_num, sizeof(seq_num));
+	memcpy(buf + sizeof(seq_num), corpus + corpus_pos + sizeof(len), len);
+
+	corpus_pos += sizeof(len) + len;
+	if (corpus_pos + sizeof(len) > corpus_size)
+		testing_finished = 1;
+
+	return len + sizeof(seq_num);
+}
+
+/**
+ * replay_latency
+ * @brief Record how long an event took to handle
+ *
+ * @param ns nanoseconds spent in handle_rtas_event()
+ */
+void
+replay_latency(uint64_t ns)
+{
+	uint64_t *tmp;
+
+	if (corpus == NULL)
+		return;
+
+	if (nlatencies == latencies_size) {
+		int new_size = latencies_size ? latencies_size * 2 : 4096;
+
+		tmp = realloc(latencies, new_size * sizeof(*latencies));
+		if (tmp == NULL)
+			return;
+
+		latencies = tmp;
+		latencies_size = new_size;
+	}
+
+	latencies[nlatencies++] = ns;
+}
+
+static int
+latency_cmp(const void *a, const void *b)
+{
+	uint64_t l1 = *(const uint64_t *)a, l2 = *(const uint64_t *)b;
+
+	return (l1 > l2) - (l1 < l2);
+}
+
+static double
+percentile_us(int pct)
+{
+	int i = (nlatencies * pct + 99) / 100 - 1;
+
+	if (i < 0)
+		i = 0;
+
+	return (double)latencies[i] / 1000;
+}
+
+/**
+ * replay_report
+ * @brief Print the throughput and latency of the replay to stdout
+ */
+void
+replay_report(void)
+{
+	struct timespec now;
+	double elapsed;
+
+	if (corpus == NULL)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = (now.tv_sec - replay_start.tv_sec) +
+		  (double)(now.tv_nsec - replay_start.tv_nsec) / 1000000000;
+
+	printf("Replayed %d events in %.3f seconds (%.1f events/s)\n",
+	       replay_count, elapsed,
+	       elapsed > 0 ? replay_count / elapsed : 0);
+
+	if (nlatencies) {
+		qsort(latencies, nlatencies, sizeof(*latencies), latency_cmp);
+		printf("handle_rtas_event latency: p50 %.1fus, p99 %.1fus, "
+		       "max %.1fus\n", percentile_us(50), percentile_us(99),
+		       (double)latencies[nlatencies - 1] / 1000);
+	}
+
+	fflush(stdout);
+
+	free(latencies);
+	latencies = NULL;
+	nlatencies = latencies_size = 0;
+	munmap(corpus, corpus_size);
+	corpus = NULL;
+}
+
+#endif /* DEBUG */
@@ -32,6 +32,7 @@
 #include <librtas.h>
 
 #include "rtas_errd.h"
+#include "drc_info.h"
 #include "platform.h"
 
 /**
@@ -126,11 +127,23 @@ daemonize_error:
 int
 handle_rtas_event(struct event *event)
 {
-	int rc = 0;
+	int rc = 0, epow_status = 0, first_seq;
 	struct rtas_event_exthdr *exthdr;
+	uint64_t start;
 
 	dbg("Handling RTAS event %d", event->seq_num);
 
+	/*
+	 * EPOW events may require a shutdown within milliseconds, so
+	 * they are acted on before the event is logged or anything else
+	 * is done with it.
+	 */
+	if (event->rtas_hdr->type == RTAS_HDR_TYPE_EPOW) {
+		dbg("Entering check_epow()");
+		epow_status = check_epow(event);
+		log_ring_flush();
+	}
+
 	/*
 	 * check to determine if this is a platform dump notification,
 	 * which requires the dump to be copied to the OS;  this must
@@ -138,10 +151,14 @@ handle_rtas_event(struct event *event)
 	 * the log will be updated with the path to the dump
 	 */
 	dbg("Entering check_platform_dump()");
+	start = stats_now();
 	check_platform_dump(event);
+	stats_record(STAGE_PLATFORM_DUMP, start);
 
 	/* write the event to the platform file */
+	start = stats_now();
 	rc = print_rtas_event(event);
+	stats_record(STAGE_PRINT_EVENT, start);
 	if (rc <= 0) {
 		log_msg(event, "Could not write RTAS event %d to log file %s",
 			event->seq_num, platform_log);
@@ -151,6 +168,15 @@ handle_rtas_event(struct event *event)
 		return -1;
 	}
 
+	/*
+	 * Queued drmgr requests must be carried out before anything
+	 * that is not itself another such request.
+	 */
+	if (event->rtas_hdr->type != RTAS_HDR_TYPE_HOTPLUG &&
+	    event->rtas_hdr->type != RTAS_HDR_TYPE_RESOURCE_DEALLOC &&
+	    event->rtas_hdr->type != RTAS_HDR_TYPE_CACHE_PARITY)
+		drmgr_queue_flush();
+
 	switch (event->rtas_hdr->type) {
 	    case RTAS_HDR_TYPE_CACHE_PARITY:
 	    case RTAS_HDR_TYPE_RESOURCE_DEALLOC:
@@ -159,8 +185,8 @@ handle_rtas_event(struct event *event)
 		break;
 
 	    case RTAS_HDR_TYPE_EPOW:
-		dbg("Entering check_epow()");
-		if (check_epow(event) <= 0) {
+		/* handled above in check_epow() */
+		if (epow_status <= 0) {
 			dbg("Received EPOW 0 (all is normal) event");
 			return 0;
 		}
@@ -179,6 +205,9 @@ handle_rtas_event(struct event *event)
 	    case RTAS_HDR_TYPE_PRRN:
 		dbg("Entering PRRN handler");
 		handle_prrn_event(event);
+		invalidate_vpd_cache();
+		invalidate_dt_index();
+		drc_info_invalidate();
 
 		/* Nothing left to do for PRRN Events, there is no exthdr
 		 * for these events and they are not a serviceable event
@@ -211,13 +240,30 @@ handle_rtas_event(struct event *event)
 	if (exthdr->predictive)
 		event->flags |= RE_PREDICTIVE;
 
+	/*
+	 * An event delivered again (or found again in syslog) is acted on
+	 * as before, e.g. a dump that could not be extracted the first
+	 * time is tried again, but has already been analyzed and put in
+	 * servicelog.
+	 */
+	first_seq = event_dedup_check(event);
+	if (first_seq) {
+		log_msg(event, "Event was already analyzed as RTAS event %d, "
+			"not adding it to servicelog again", first_seq);
+		return 0;
+	}
+
+	start = stats_now();
 	if (event->rtas_hdr->version == 6)
 		process_v6(event);
 	else
 		process_pre_v6(event);
+	stats_record(STAGE_ELA, start);
 
 	/* Log the event in the servicelog DB */
+	start = stats_now();
 	log_event(event);
+	stats_record(STAGE_SERVICELOG, start);
 
 #if 0
 	if (event->flags & RE_ALREADY_REPORTED) {
@@ -248,19 +294,78 @@ handle_rtas_event(struct event *event)
 int
 read_rtas_events()
 {
-	struct event event = {0};
+	struct event *event;
 	ssize_t len;
 	int retries = 0;
+	int timeout, stats_wait, rc;
+	uint64_t start, ns;
+	sigset_t wait_sigs, wait_mask;
 
-	memset(&event, 0, sizeof(event));
+	sigemptyset(&wait_sigs);
+	sigaddset(&wait_sigs, SIGHUP);
+	sigaddset(&wait_sigs, SIGTERM);
 
 	while (1) {
+		/*
+		 * The SIGHUP and SIGTERM handlers only set a flag; re-read
+		 * the config file or stop here if they did.  Both signals
+		 * stay blocked from checking the flags until the wait below
+		 * begins, so one arriving in between still interrupts the
+		 * wait.
+		 */
+		sigprocmask(SIG_BLOCK, &wait_sigs, &wait_mask);
+		if (d_cfg.flags & RE_CFG_RECEIVED_SIGTERM) {
+			sigprocmask(SIG_UNBLOCK, &wait_sigs, NULL);
+			dbg("Received SIGTERM");
+			return 0;
+		}
+		if (d_cfg.flags & RE_CFG_RECEIVED_SIGHUP) {
+			d_cfg.flags &= ~RE_CFG_RECEIVED_SIGHUP;
+			diag_cfg(1, &cfg_log);
+		}
+		sigdelset(&wait_mask, SIGHUP);
+		sigdelset(&wait_mask, SIGTERM);
+
+		/*
+		 * Run any queued drmgr requests once no further event
+		 * has arrived within the coalescing window.
+		 */
+		timeout = drmgr_queue_timeout();
+		stats_wait = stats_timeout();
+		if (timeout < 0 || (stats_wait >= 0 && stats_wait < timeout))
+			timeout = stats_wait;
+
+		rc = wait_for_rtas_event(timeout, &wait_mask);
+		sigprocmask(SIG_UNBLOCK, &wait_sigs, NULL);
+
+		/*
+		 * Checked whether or not an event is waiting, so that a
+		 * steady stream of events can not hold the queued
+		 * requests back past their maximum delay.
+		 */
+		if (drmgr_queue_timeout() == 0)
+			drmgr_queue_flush();
+
+		switch (rc) {
+		    case 0:
+			if (stats_timeout() == 0)
+				stats_write();
+			continue;
+		    case -1:
+			continue;
+		}
+
+		event = event_get();
+		if (event == NULL)
+			return -1;
+
 		/*
 		 * Passing a reference to re to the read routine is correct.
 		 * see rtas_errd.h for details.
 		 */
-		len = read_proc_error_log((char *)&event, RTAS_ERROR_LOG_MAX);
+		len = read_proc_error_log((char *)event, RTAS_ERROR_LOG_MAX);
 		if (len <= 0) {
+			event_put(event);
 			retries++;
 			if (retries >= 3) {
 				log_msg(NULL, "Could not read error log file");
@@ -271,45 +376,48 @@ read_rtas_events()
 
 		retries = 0;
 
-		event.rtas_event = parse_rtas_event(event.event_buf, len);
-		if (event.rtas_event == NULL) {
-			log_msg(&event, "Could not parse RTAS event");
+		start = event->read_time = stats_now();
+		event->rtas_event = parse_rtas_event(event->event_buf, len);
+		if (event->rtas_event == NULL) {
+			log_msg(event, "Could not parse RTAS event");
+			event_put(event);
 			return -1;
 		}
 
-		event.rtas_hdr = rtas_get_event_hdr_scn(event.rtas_event);
-		if (event.rtas_hdr == NULL) {
-			log_msg(&event, "Could not retrieve event header");
-			cleanup_rtas_event(event.rtas_event);
+		event->rtas_hdr = rtas_get_event_hdr_scn(event->rtas_event);
+		if (event->rtas_hdr == NULL) {
+			log_msg(event, "Could not retrieve event header");
+			event_put(event);
 			return -1;
 		}
 
-		event.length = event.rtas_event->event_length;
+		stats_event_begin(event->rtas_hdr->type);
+		stats_record(STAGE_PARSE, start);
+
+		event->length = event->rtas_event->event_length;
 
 		if (scanlog != NULL)
-			event.flags |= RE_SCANLOG_AVAIL;
+			event->flags |= RE_SCANLOG_AVAIL;
 
-                dbg("Received RTAS event %d", event.seq_num);
+                dbg("Received RTAS event %d", event->seq_num);
 
-		/*
-		 * Mark ourselves as not being able to handle SIGHUP
-		 * signals while handling the RTAS event
-		 */
-		d_cfg.flags &= ~RE_CFG_RECFG_SAFE;
-		handle_rtas_event(&event);
-		d_cfg.flags |= RE_CFG_RECFG_SAFE;
+		start = stats_now();
+		handle_rtas_event(event);
+		ns = stats_record(STAGE_EVENT, start);
+		stats_event_end();
+#ifdef DEBUG
+		replay_latency(ns);
+#endif
 
-		if (d_cfg.flags & RE_CFG_RECEIVED_SIGHUP) {
-			diag_cfg(1, &cfg_log);
-			d_cfg.flags &= ~RE_CFG_RECEIVED_SIGHUP;
-		}
+		if (d_cfg.log_flush_policy == LOG_FLUSH_EVENT)
+			log_ring_flush();
+
+		/* the event goes back to the pool once it has been logged */
+		event_put(event);
 
-		/* cleanup the RTAS event */
-		if (event.loc_codes != NULL)
-			free(event.loc_codes);
-		free_diag_vpd(&event);
-		cleanup_rtas_event(event.rtas_event);
-		memset(&event, 0, sizeof(event));
+		/* also during a storm of events, when they matter most */
+		if (stats_timeout() == 0)
+			stats_write();
 
 #ifdef DEBUG
 		/*
@@ -328,6 +436,7 @@ static void print_usage(char *argv0)
 {
 	fprintf(stderr, "Usage: %s [OPTION]\n\n", argv0);
 #ifdef DEBUG
+	fprintf(stderr, "  -b, --corpus=FILE         replay the RTAS events in FILE\n");
 	fprintf(stderr, "  -c, --config=FILE         path to config file (default %s)\n",
 		config_file);
 #endif
@@ -344,6 +453,7 @@ static void print_usage(char *argv0)
 	fprintf(stderr, "  -m, --msgsfile=FILE       path to syslog\n");
 	fprintf(stderr, "  -p, --platformfile=FILE   path to platform_log (default %s)\n",
 		platform_log);
+	fprintf(stderr, "  -r, --rate=N              replay N events per second\n");
 	fprintf(stderr, "  -R, --nodrmgr             no drmgr\n");
 	fprintf(stderr, "  -s, --scenario=FILE       path to RTAS scenario file\n");
 #endif
@@ -363,6 +473,12 @@ static struct option longopts[] = {
 	.val = 'h'
 },
 #ifdef DEBUG
+{
+	.name = "corpus",
+	.has_arg = 1,
+	.flag = NULL,
+	.val = 'b'
+},
 {
 	.name = "config",
 	.has_arg = 1,
@@ -393,6 +509,12 @@ static struct option longopts[] = {
 	.flag = NULL,
 	.val = 'm'
 },
+{
+	.name = "rate",
+	.has_arg = 1,
+	.flag = NULL,
+	.val = 'r'
+},
 {
 	.name = "nodrmgr",
 	.has_arg = 0,
@@ -436,6 +558,7 @@ main(int argc, char *argv[])
 	int c;
 #ifdef DEBUG
 	int f_flag = 0, s_flag = 0;
+	char *corpus_file = NULL;
 #endif
 	int platform = 0;
 
@@ -458,6 +581,18 @@ main(int argc, char *argv[])
 				print_usage(argv[0]);
 				return 0;
 #ifdef DEBUG 
+			case 'b': /* RTAS event corpus to replay */
+				if (f_flag || s_flag) {
+					dbg("Only use one of the -b, -f or -s flags");
+					goto error_out;
+				}
+
+				f_flag++;
+				corpus_file = optarg;
+				proc_error_log1 = optarg;
+				proc_error_log2 = NULL;
+				break;
+
 			case 'c': /* ppc64-diag config file */
 				config_file = optarg;
 				break;
@@ -499,6 +634,10 @@ main(int argc, char *argv[])
 				scenario_file = optarg;
 				break;
 
+			case 'r': /* replay rate */
+				replay_rate = atoi(optarg);
+				break;
+
 			case 'R': /* No drmgr */
 				no_drmgr = 1;
 				break;
@@ -525,6 +664,16 @@ main(int argc, char *argv[])
 	if (rc)
 		goto error_out;
 
+#ifdef DEBUG
+	if (corpus_file && replay_open(corpus_file)) {
+		rc = -1;
+		goto error_out;
+	}
+#endif
+
+	/* From here on log messages are written by a separate thread */
+	log_ring_start();
+
 	/* Set up a signal handler for SIGALRM to handle EPOW events */
 	sigact.sa_handler = (void *)epow_timer_handler;
 	sigemptyset(&sigact.sa_mask);
@@ -545,6 +694,15 @@ main(int argc, char *argv[])
 			strerror(errno));
 	}
 
+	/* Set up a signal handler for SIGTERM to exit cleanly */
+	sigact.sa_handler = (void *)sigterm_handler;
+	sigemptyset(&sigact.sa_mask);
+	sigact.sa_flags = SA_RESTART;
+	if (sigaction(SIGTERM, &sigact, NULL)) {
+		log_msg(NULL, "Could not initialize signal handler for "
+			"shutting down (SIGTERM), %s", strerror(errno));
+	}
+
 	/* Ignore SIGPIPE */
 	sigact.sa_handler = SIG_IGN;
 	sigemptyset(&sigact.sa_mask);
@@ -556,6 +714,9 @@ main(int argc, char *argv[])
 	/* Set up a signal handler for SIGCHLD to handle terminating children */
 	setup_sigchld_handler();
 
+	/* drc index lookups report their errors to our log */
+	drc_info_init(&cfg_log);
+
 	/* Read any configuration options from the config file */
 	rc = diag_cfg(1, &cfg_log);
 	if (rc)
@@ -570,6 +731,21 @@ main(int argc, char *argv[])
 		slog = NULL;
 	}
 
+	/*
+	 * Write to servicelog from a separate thread, which also logs the
+	 * events of the other ppc64-diag tools; not for test events though.
+	 */
+#ifdef DEBUG
+	if (!f_flag && !s_flag)
+#endif
+		slog_server_start();
+
+	/* Test events are always analyzed, however often they are used */
+#ifdef DEBUG
+	if (!f_flag && !s_flag)
+#endif
+		init_event_dedup();
+
 	/* update RTAS events from syslog */
 	update_rtas_msgs();
 
@@ -596,10 +772,18 @@ main(int argc, char *argv[])
 #endif
 
 	rc = read_rtas_events();
+	drmgr_queue_flush();
+	stats_write();
+#ifdef DEBUG
+	replay_report();
+#endif
 
 error_out:
+	slog_server_stop();
 	errno = 0;
 	log_msg(NULL, "The rtas_errd daemon is exiting");
+	log_ring_stop();
+	close_event_dedup();
 	close_files();
 
 	if (slog != NULL)
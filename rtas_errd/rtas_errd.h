@@ -23,6 +23,7 @@
 #define _RTAS_ERRD_H
 
 #include <signal.h>
+#include <sys/types.h>
 #include <librtasevent.h>
 #include <servicelog-1/servicelog.h>
 #include "fru_prev6.h"
@@ -40,11 +41,12 @@ extern char *test_file;
 extern char *scenario_file;
 extern int testing_finished;
 extern int no_drmgr;
+extern int replay_rate;
 /**
  * @def RTAS_ERRD_ARGS 
  * @brief DEBUG args for rtas_errd
  */
-#define RTAS_ERRD_ARGS		"c:de:f:hl:m:p:Rs:"
+#define RTAS_ERRD_ARGS		"b:c:de:f:hl:m:p:r:Rs:"
 #else
 /**
  * @def RTAS_ERRD_ARGS
@@ -85,6 +87,18 @@ struct diag_vpd {
 	char *tm;  /* enclosure model number */
 };
 
+/**
+ * struct arena
+ * @brief Memory for everything built while analyzing an event
+ *
+ * Released as a whole when the event is done with (see event_pool.c).
+ */
+struct arena_chunk;
+struct arena {
+	struct arena_chunk	*first;
+	struct arena_chunk	*cur;
+};
+
 /**
  * @struct event
  * @brief struct to track and handle RTAS events in rtas_errd.
@@ -107,6 +121,10 @@ struct event {
 	struct diag_vpd		diag_vpd;
 	struct rtas_event	*rtas_event;
 	struct sl_event		*sl_entry;
+	uint64_t		read_time; /**< stats_now() when read */
+	struct arena		arena;	   /**< see event_alloc() */
+	int			refs;
+	struct event		*next_free;
 };
 
 /* flags for struct event */
@@ -132,6 +150,8 @@ int print_rtas_event(struct event *);
 int platform_log_write(char *, ...);
 void update_epow_status_file(int);
 int read_proc_error_log(char *, int);
+int wait_for_rtas_event(int, const sigset_t *);
+int log_write_record(int, const char *, int);
 
 /* dump.c */
 void check_scanlog_dump(void);
@@ -147,7 +167,39 @@ void handle_resource_dealloc(struct event *);
 int handle_rtas_event(struct event *);
 
 /* update.c */
+#define RTAS_START	"RTAS event begin"
+#define RTAS_END	"RTAS event end"
+
 void update_rtas_msgs(void);
+char *find_rtas_start(char *, char *);
+char *find_rtas_end(char *, char *);
+int get_rtas_no(char *);
+
+/* platform_index.c */
+int init_platform_index(void);
+void close_platform_index(void);
+void platform_index_add(int, off_t, size_t);
+int platform_index_last(void);
+int platform_index_lookup(int, off_t *, size_t *);
+char *platform_log_read_event(int, size_t *);
+
+/* dt_index.c */
+/**
+ * @struct dt_node
+ * @brief Device tree node properties kept by the device tree index
+ */
+struct dt_node {
+	char		*path;		/**< relative to /proc/device-tree */
+	char		*loc_code;	/**< ibm,loc-code, may be NULL */
+	char		*status;	/**< status, may be NULL */
+	uint32_t	drc_index;	/**< ibm,my-drc-index, 0 if none */
+	int		next;		/**< next node with the same loc_code */
+};
+
+void invalidate_dt_index(void);
+void dt_index_hotplug(const char *, int, uint32_t, int);
+struct dt_node *dt_index_find_loc(const char *);
+struct dt_node *dt_index_next(struct dt_node *);
 
 /* ela.c */
 int process_pre_v6(struct event *);
@@ -160,6 +212,7 @@ int process_v6(struct event *);
 char *get_dt_status(char *);
 char *diag_get_fru_pn(struct event *, char *);
 void free_diag_vpd(struct event *);
+void invalidate_vpd_cache(void);
 
 /* menugoal.c */
 int menugoal(struct event *, char *);
@@ -174,16 +227,90 @@ int servicelog_sev(int rtas_sev);
 void add_callout(struct event *event, char pri, int type, char *proc,
 		 char *loc, char *pn, char *sn, char *ccin);
 void log_event(struct event *);
+int log_sl_entry(struct servicelog *, struct sl_event *, uint64_t *);
+
+/* slog_server.c */
+int slog_server_start(void);
+void slog_server_stop(void);
+int slog_server_submit(struct event *);
+
+/* event_dedup.c */
+int init_event_dedup(void);
+void close_event_dedup(void);
+int event_dedup_check(struct event *);
+void event_dedup_add(struct event *);
+
+/* event_pool.c */
+struct event *event_get(void);
+void event_hold(struct event *);
+void event_put(struct event *);
+void *event_alloc(struct event *, size_t);
+char *event_strdup(struct event *, const char *);
 
 /* signal.c */
 void sighup_handler(int, siginfo_t, void *);
+void sigterm_handler(int, siginfo_t, void *);
 void restore_sigchld_default(void);
 void setup_sigchld_handler(void);
 
 /* prrn.c */
 void handle_prrn_event(struct event *);
+void invalidate_phandle_map(void);
 
 /* hotplug.c */
 void handle_hotplug_event(struct event *);
 
+/* log_ring.c */
+#define LOG_RTAS_ERRD		0	/* rtas_errd_log */
+#define LOG_PLATFORM		1	/* platform_log */
+#define LOG_STDOUT		2	/* debug output */
+
+int log_ring_start(void);
+void log_ring_stop(void);
+void log_ring_flush(void);
+int log_ring_write(int, const char *, int, int);
+int log_ring_lock(void);
+void log_ring_unlock(int);
+
+/* stats.c */
+#define STAGE_EVENT		0	/* all of handle_rtas_event() */
+#define STAGE_PARSE		1	/* parse_rtas_event() */
+#define STAGE_PLATFORM_DUMP	2	/* check_platform_dump() */
+#define STAGE_PRINT_EVENT	3	/* print_rtas_event() */
+#define STAGE_ELA		4	/* process_v6()/process_pre_v6() */
+#define STAGE_VPD		5	/* get_diag_vpd() */
+#define STAGE_DRMGR		6	/* waiting for drmgr */
+#define STAGE_SERVICELOG	7	/* log_event() */
+#define STAGE_EPOW_ACTION	8	/* event read to EPOW action taken */
+#define STATS_STAGES		9
+
+uint64_t stats_now(void);
+void stats_event_begin(int);
+void stats_event_end(void);
+uint64_t stats_record(int, uint64_t);
+int stats_timeout(void);
+void stats_write(void);
+
+#ifdef DEBUG
+/* replay.c */
+int replay_open(const char *);
+int replay_active(void);
+int replay_read(char *, int);
+void replay_latency(uint64_t);
+void replay_report(void);
+#endif
+
+/* drmgr_queue.c */
+void drmgr_queue_add(int, const char *, int, int, uint32_t);
+void drmgr_queue_flush(void);
+int drmgr_queue_lmb_queued(uint32_t);
+int drmgr_queue_lmbs_removing(void);
+int drmgr_queue_timeout(void);
+
+/* topology.c */
+long topology_active_processors(void);
+long topology_entitled_capacity(void);
+int topology_online_lmbs(void);
+void topology_invalidate(void);
+
 #endif /* _RTAS_ERRD_H */
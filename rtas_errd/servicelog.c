@@ -140,72 +140,103 @@ add_callout(struct event *event, char pri, int type, char *proc, char *loc,
 {
 	struct sl_callout *callout = event->sl_entry->callouts;
 
-	if (!callout) {
-		event->sl_entry->callouts = calloc(1, sizeof(*callout));
-		callout = event->sl_entry->callouts;
-	}
-	else {
-		while (callout->next)
-			callout = callout->next;
-		callout->next = calloc(1, sizeof(*callout));
-		callout = callout->next;
-	}
+	struct sl_callout *new;
 
-	if (!callout)
-		return;
+	/* The callout and its strings are in the event's arena */
+	new = event_alloc(event, sizeof(*new));
+	if (!new)
+		goto mem_fail;
 
-	callout->priority = pri;
-	callout->type = type;
+	new->priority = pri;
+	new->type = type;
 	if (proc) {
-		callout->procedure = malloc(strlen(proc) + 1);
-		if (callout->procedure == NULL)
+		new->procedure = event_strdup(event, proc);
+		if (new->procedure == NULL)
 			goto mem_fail;
-		strncpy(callout->procedure, proc, strlen(proc) + 1);
 	}
 	if (loc) {
-		callout->location = malloc(strlen(loc) + 1);
-		if (callout->location == NULL)
+		new->location = event_strdup(event, loc);
+		if (new->location == NULL)
 			goto mem_fail;
-		strncpy(callout->location, loc, strlen(loc) + 1);
 	}
 	if (pn) {
-		callout->fru = malloc(strlen(pn) + 1);
-		if (callout->fru == NULL)
+		new->fru = event_strdup(event, pn);
+		if (new->fru == NULL)
 			goto mem_fail;
-		strncpy(callout->fru, pn, strlen(pn) + 1);
 	}
 	if (sn) {
-		callout->serial = malloc(strlen(sn) + 1);
-		if (callout->serial == NULL)
+		new->serial = event_strdup(event, sn);
+		if (new->serial == NULL)
 			goto mem_fail;
-		strncpy(callout->serial, sn, strlen(sn) + 1);
 	}
 	if (ccin) {
-		callout->ccin = malloc(strlen(ccin) + 1);
-		if (callout->ccin == NULL)
+		new->ccin = event_strdup(event, ccin);
+		if (new->ccin == NULL)
 			goto mem_fail;
-		strncpy(callout->ccin, ccin, strlen(ccin) + 1);
+	}
+
+	/* only complete callouts are added to the list */
+	if (!callout) {
+		event->sl_entry->callouts = new;
+	}
+	else {
+		while (callout->next)
+			callout = callout->next;
+		callout->next = new;
 	}
 
 	return;
 
 mem_fail:
-	if (callout->ccin)
-		free(callout->ccin);
-	if (callout->serial)
-		free(callout->serial);
-	if (callout->fru)
-		free(callout->fru);
-	if (callout->location)
-		free(callout->location);
-	if (callout->procedure)
-		free(callout->procedure);
-	free(callout);
-
 	log_msg(event, "Memory allocation failed");
 	return;
 }
 
+/**
+ * log_sl_entry
+ * @brief Log a servicelog entry built in an event's arena
+ *
+ * servicelog_event_log() fills in the platform, machine and node fields
+ * that are left empty with strings of its own, which servicelog_event_free()
+ * would then free along with the rest of the entry.  The entry itself
+ * goes with the event, so only those strings are freed here.
+ *
+ * @param log servicelog handle
+ * @param entry the entry to log
+ * @param key set to the servicelog key of the new record
+ * @return 0 on success, the servicelog_event_log() error otherwise
+ */
+int
+log_sl_entry(struct servicelog *log, struct sl_event *entry, uint64_t *key)
+{
+	char *platform = entry->platform;
+	char *serial = entry->machine_serial;
+	char *model = entry->machine_model;
+	char *nodename = entry->nodename;
+	int rc;
+
+	rc = servicelog_event_log(log, entry, key);
+
+	if (entry->platform != platform) {
+		free(entry->platform);
+		entry->platform = platform;
+	}
+	if (entry->machine_serial != serial) {
+		free(entry->machine_serial);
+		entry->machine_serial = serial;
+	}
+	if (entry->machine_model != model) {
+		free(entry->machine_model);
+		entry->machine_model = model;
+	}
+	if (entry->nodename != nodename) {
+		free(entry->nodename);
+		entry->nodename = nodename;
+	}
+
+	return rc;
+}
+
 /**
  * log_event
  * @brief log the event in the servicelog DB
@@ -256,7 +287,7 @@ log_event(struct event *event)
 
 			new_len = strlen(event->sl_entry->description) +
 				  txtlen + 3;
-			new_desc = malloc(new_len);
+			new_desc = event_alloc(event, new_len);
 			if (new_desc == NULL) {
 				log_msg(event, "Memory allocation failed");
 				return;
@@ -265,10 +296,10 @@ log_event(struct event *event)
 				 event->sl_entry->description,
 				 event->addl_text);
 
-			free(event->sl_entry->description);
 			event->sl_entry->description = new_desc;
 		} else {
-			event->sl_entry->description = malloc(txtlen+1);
+			event->sl_entry->description =
+					event_alloc(event, txtlen+1);
 			if (event->sl_entry->description == NULL) {
 				log_msg(event, "Memory allocation failed");
 				return;
@@ -278,13 +309,19 @@ log_event(struct event *event)
 		}
 	}
 
+	/* Queue it for the servicelog writer, or log it here */
+	if (slog_server_submit(event) == 0)
+		return;
+
 	/* Log the event in the servicelog */
-	rc = servicelog_event_log(slog, event->sl_entry, &key);
-	servicelog_event_free(event->sl_entry);
+	rc = log_sl_entry(slog, event->sl_entry, &key);
 
-	if (rc)
+	if (rc) {
 		log_msg(event, "Could not log event to servicelog.\n%s\n",
 			servicelog_error(slog));
-	else
-		log_msg(event, "servicelog key %llu", key);
+		return;
+	}
+
+	log_msg(event, "servicelog key %llu", key);
+	event_dedup_add(event);
 }
@@ -33,17 +33,31 @@
  * @brief signal handler for SIGHUP
  *
  * The SIGHUP signal will cause the rtas_errd daemon to re-read
- * the configuration file.  If it is currently safe to re-configure
- * ourselves we do, otherwise we set a flag to indicate that a
- * re-configuration needs to occur at the next "safe" place
+ * the configuration file.  Re-reading it logs messages, which must
+ * not happen inside a signal handler, so only a flag is set here and
+ * the file is re-read by read_rtas_events() before it next waits for
+ * an event.  SIGHUP is only unblocked during that wait.
  */
 void
 sighup_handler(int sig, siginfo_t siginfo, void *context)
 {
-	if (d_cfg.flags & RE_CFG_RECFG_SAFE)
-		diag_cfg(1, &cfg_log);
-	else
-		d_cfg.flags |= RE_CFG_RECEIVED_SIGHUP;
+	d_cfg.flags |= RE_CFG_RECEIVED_SIGHUP;
+}
+
+/**
+ * sigterm_handler
+ * @brief signal handler for SIGTERM
+ *
+ * Like SIGHUP, SIGTERM only sets a flag.  read_rtas_events() returns
+ * once it sees it, so that the daemon shuts down the way it does on
+ * any other exit: the queued drmgr requests are run and the
+ * servicelog server logs everything it has queued before rtas_errd
+ * exits.
+ */
+void
+sigterm_handler(int sig, siginfo_t siginfo, void *context)
+{
+	d_cfg.flags |= RE_CFG_RECEIVED_SIGTERM;
 }
 
 /**
@@ -0,0 +1,450 @@
+/**
+ * @file slog_server.c
+ * @brief The shared servicelog writer
+ *
+ * A thread that owns rtas_errd's servicelog handle and does all of the
+ * servicelog writes, both for rtas_errd itself and for the other
+ * ppc64-diag tools, which send their events over SLOG_IPC_SOCKET (see
+ * common/slog_ipc.c) rather than opening the database for every event.
+ *
+ * rtas_errd's own events are queued on a pipe, so the event loop does
+ * not wait for the database.  Every pass of the thread takes whatever
+ * requests have arrived, from the pipe and from all clients, logs them
+ * one after the other on the same handle and only then sends the keys
+ * back to the clients and reports them in rtas_errd.log.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <servicelog-1/servicelog.h>
+#include "rtas_errd.h"
+#include "slog_ipc.h"
+
+/**
+ * @def SLOG_SERVER_CLIENTS
+ * @brief Connections beyond this wait in the listen backlog
+ */
+#define SLOG_SERVER_CLIENTS	32
+
+/**
+ * @def SLOG_SERVER_BATCH
+ * @brief Most requests taken in one pass
+ */
+#define SLOG_SERVER_BATCH	64
+
+struct slog_req {
+	struct event	*event;		/**< rtas_errd's own, NULL for clients */
+	struct sl_event	*entry;		/**< both NULL to stop the thread */
+	int		client;		/**< client socket, -1 for rtas_errd */
+	uint64_t	tag;		/**< client's tag */
+};
+
+struct slog_client {
+	int		fd;
+	int		closing;	/**< closed once the batch is done */
+};
+
+static struct {
+	pthread_t		thread;
+	int			running;
+	int			queue[2];	/**< rtas_errd's own events */
+	int			listen_fd;
+	struct slog_client	clients[SLOG_SERVER_CLIENTS];
+	int			nclients;
+	struct slog_req		batch[SLOG_SERVER_BATCH];
+	int			nbatch;
+	char			*msg;		/**< receive buffer */
+} srv = {
+	.queue = { -1, -1 },
+	.listen_fd = -1,
+};
+
+/**
+ * log_batch
+ * @brief Log the requests taken so far and report their keys
+ */
+static void
+log_batch(void)
+{
+	struct slog_req *req;
+	uint64_t key = 0;
+	int i, rc;
+
+	if (srv.nbatch == 0)
+		return;
+
+	for (i = 0; i < srv.nbatch; i++) {
+		req = &srv.batch[i];
+
+		if (req->client >= 0) {
+			rc = servicelog_event_log(slog, req->entry, &key);
+			servicelog_event_free(req->entry);
+			if (rc)
+				log_msg(NULL, "Could not log event to "
+					"servicelog for a client.\n%s\n",
+					servicelog_error(slog));
+			slog_ipc_reply(req->client, req->tag,
+				       rc ? SLOG_IPC_FAILED : SLOG_IPC_LOGGED,
+				       key);
+			continue;
+		}
+
+		rc = log_sl_entry(slog, req->entry, &key);
+		if (rc) {
+			log_msg(req->event, "Could not log event to "
+				"servicelog.\n%s\n", servicelog_error(slog));
+		} else {
+			log_msg(req->event, "servicelog key %llu", key);
+			event_dedup_add(req->event);
+		}
+
+		/* the entry is in the event's arena */
+		event_put(req->event);
+	}
+
+	dbg("Logged %d servicelog events", srv.nbatch);
+	srv.nbatch = 0;
+}
+
+/**
+ * read_queue
+ * @brief Take rtas_errd's own events off the queue
+ *
+ * @return 1 if rtas_errd asked the thread to stop, 0 otherwise
+ */
+static int
+read_queue(void)
+{
+	struct slog_req reqs[SLOG_SERVER_BATCH];
+	ssize_t len;
+	int i, stop = 0;
+
+	while (1) {
+		len = read(srv.queue[0], reqs, sizeof(reqs));
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0)
+			break;
+
+		/* The requests are written whole, so only whole ones are read */
+		for (i = 0; i < len / sizeof(*reqs); i++) {
+			if (reqs[i].event == NULL) {
+				stop = 1;
+				continue;
+			}
+
+			if (srv.nbatch == SLOG_SERVER_BATCH)
+				log_batch();
+			srv.batch[srv.nbatch++] = reqs[i];
+		}
+	}
+
+	return stop;
+}
+
+/**
+ * read_client
+ * @brief Take the requests a client has sent
+ */
+static void
+read_client(struct slog_client *client)
+{
+	struct sl_event *entry;
+	uint64_t tag;
+	ssize_t len;
+
+	while (1) {
+		len = recv(client->fd, srv.msg, SLOG_IPC_MAX_MSG,
+			   MSG_DONTWAIT | MSG_TRUNC);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break;
+		if (len <= 0) {
+			client->closing = 1;
+			break;
+		}
+
+		tag = 0;
+		entry = NULL;
+		if (len <= SLOG_IPC_MAX_MSG)
+			entry = slog_ipc_unpack(srv.msg, len, &tag);
+		if (entry == NULL) {
+			log_msg(NULL, "Received a malformed servicelog request");
+			slog_ipc_reply(client->fd, tag, SLOG_IPC_FAILED, 0);
+			continue;
+		}
+
+		if (srv.nbatch == SLOG_SERVER_BATCH)
+			log_batch();
+		srv.batch[srv.nbatch].event = NULL;
+		srv.batch[srv.nbatch].entry = entry;
+		srv.batch[srv.nbatch].client = client->fd;
+		srv.batch[srv.nbatch].tag = tag;
+		srv.nbatch++;
+	}
+}
+
+/**
+ * accept_clients
+ * @brief Accept new connections while there is room for them
+ */
+static void
+accept_clients(void)
+{
+	int fd;
+
+	while (srv.nclients < SLOG_SERVER_CLIENTS) {
+		fd = accept4(srv.listen_fd, NULL, NULL, SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		srv.clients[srv.nclients].fd = fd;
+		srv.clients[srv.nclients].closing = 0;
+		srv.nclients++;
+	}
+}
+
+/**
+ * close_clients
+ * @brief Drop the clients that have gone away
+ */
+static void
+close_clients(void)
+{
+	int i;
+
+	for (i = 0; i < srv.nclients; ) {
+		if (!srv.clients[i].closing) {
+			i++;
+			continue;
+		}
+
+		close(srv.clients[i].fd);
+		srv.clients[i] = srv.clients[--srv.nclients];
+	}
+}
+
+static void *
+slog_server_thread(void *arg)
+{
+	struct pollfd fds[2 + SLOG_SERVER_CLIENTS];
+	int i, nfds, stop = 0;
+
+	while (!stop) {
+		fds[0].fd = srv.queue[0];
+		fds[0].events = POLLIN;
+		/* not polled at all while there is no room for another */
+		fds[1].fd = srv.nclients < SLOG_SERVER_CLIENTS ?
+							srv.listen_fd : -1;
+		fds[1].events = POLLIN;
+		for (i = 0; i < srv.nclients; i++) {
+			fds[2 + i].fd = srv.clients[i].fd;
+			fds[2 + i].events = POLLIN;
+		}
+		nfds = 2 + srv.nclients;
+
+		if (poll(fds, nfds, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			log_msg(NULL, "The servicelog writer failed to wait for "
+				"requests, %s", strerror(errno));
+			break;
+		}
+
+		if (fds[0].revents)
+			stop = read_queue();
+
+		for (i = 0; i < nfds - 2; i++) {
+			if (fds[2 + i].revents)
+				read_client(&srv.clients[i]);
+		}
+
+		if (fds[1].revents)
+			accept_clients();
+
+		log_batch();
+		close_clients();
+	}
+
+	return NULL;
+}
+
+/**
+ * queue_req
+ * @brief Put a request on the writer's queue
+ */
+static int
+queue_req(struct event *event, struct sl_event *entry)
+{
+	struct slog_req req;
+	ssize_t len;
+
+	memset(&req, 0, sizeof(req));
+	req.event = event;
+	req.entry = entry;
+	req.client = -1;
+
+	do {
+		len = write(srv.queue[1], &req, sizeof(req));
+	} while (len < 0 && errno == EINTR);
+
+	return len == sizeof(req) ? 0 : -1;
+}
+
+/**
+ * slog_server_submit
+ * @brief Queue one of rtas_errd's own events for servicelog
+ *
+ * The writer holds a reference to the event, and so to its servicelog
+ * entry, until the entry has been logged.
+ *
+ * @param event the event whose sl_entry is to be logged
+ * @return 0 if the event was queued, -1 if the caller has to log it
+ */
+int
+slog_server_submit(struct event *event)
+{
+	if (!srv.running)
+		return -1;
+
+	event_hold(event);
+	if (queue_req(event, event->sl_entry)) {
+		event_put(event);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * slog_server_start
+ * @brief Hand the servicelog handle to the writer thread
+ *
+ * From here on slog must not be used by anything else until
+ * slog_server_stop() returns.
+ *
+ * @return 0 on success, -1 if servicelog is written directly
+ */
+int
+slog_server_start(void)
+{
+	sigset_t all, old;
+	int rc;
+
+	if (srv.running || slog == NULL)
+		return 0;
+
+	srv.msg = malloc(SLOG_IPC_MAX_MSG);
+	if (srv.msg == NULL) {
+		log_msg(NULL, "Could not start the servicelog writer, %s",
+			strerror(errno));
+		return -1;
+	}
+
+	if (pipe2(srv.queue, O_CLOEXEC) ||
+	    fcntl(srv.queue[0], F_SETFL, O_NONBLOCK)) {
+		log_msg(NULL, "Could not start the servicelog writer, %s",
+			strerror(errno));
+		goto err;
+	}
+
+	/* Without the socket the other tools log for themselves */
+	srv.listen_fd = slog_ipc_listen();
+	if (srv.listen_fd < 0)
+		log_msg(NULL, "Could not create %s, other tools will open "
+			"the servicelog database themselves, %s",
+			SLOG_IPC_SOCKET, strerror(errno));
+
+	/* Signals are left to the main thread */
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	rc = pthread_create(&srv.thread, NULL, slog_server_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (rc) {
+		log_msg(NULL, "Could not start the servicelog writer thread, "
+			"%s", strerror(rc));
+		goto err;
+	}
+
+	srv.running = 1;
+	return 0;
+
+err:
+	if (srv.listen_fd >= 0) {
+		close(srv.listen_fd);
+		unlink(SLOG_IPC_SOCKET);
+		srv.listen_fd = -1;
+	}
+	if (srv.queue[0] >= 0) {
+		close(srv.queue[0]);
+		close(srv.queue[1]);
+		srv.queue[0] = srv.queue[1] = -1;
+	}
+	free(srv.msg);
+	srv.msg = NULL;
+	return -1;
+}
+
+/**
+ * slog_server_stop
+ * @brief Log everything queued and take back the servicelog handle
+ */
+void
+slog_server_stop(void)
+{
+	int i;
+
+	if (!srv.running)
+		return;
+
+	/* Everything queued before this is logged before the thread exits */
+	queue_req(NULL, NULL);
+	pthread_join(srv.thread, NULL);
+	srv.running = 0;
+
+	if (srv.listen_fd >= 0) {
+		close(srv.listen_fd);
+		unlink(SLOG_IPC_SOCKET);
+		srv.listen_fd = -1;
+	}
+
+	for (i = 0; i < srv.nclients; i++)
+		close(srv.clients[i].fd);
+	srv.nclients = 0;
+
+	close(srv.queue[0]);
+	close(srv.queue[1]);
+	srv.queue[0] = srv.queue[1] = -1;
+
+	free(srv.msg);
+	srv.msg = NULL;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file stats.c
+ * @brief Per-stage latency statistics for RTAS event handling
+ *
+ * The time spent in each stage of handling an RTAS event is collected
+ * in a histogram per stage and event type, with power of two buckets
+ * from 1us to about 8s.  The histograms and the number of events seen
+ * of each type are written to StatsFile (see the ppc64-diag config
+ * file) in the Prometheus text format, so that a node exporter
+ * textfile collector can pick them up.  The file is rewritten at most
+ * every STATS_WRITE_INTERVAL seconds while there is something new to
+ * report, and when rtas_errd exits.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <librtasevent.h>
+#include "rtas_errd.h"
+#include "config.h"
+
+/**
+ * @def STATS_WRITE_INTERVAL
+ * @brief Minimum number of seconds between rewrites of the stats file
+ */
+#define STATS_WRITE_INTERVAL	10
+
+/**
+ * @def STATS_BUCKETS
+ * @brief Histogram bucket i counts durations below 2^i microseconds
+ */
+#define STATS_BUCKETS		24
+
+static const char *stage_names[STATS_STAGES] = {
+	[STAGE_EVENT]		= "event",
+	[STAGE_PARSE]		= "parse",
+	[STAGE_PLATFORM_DUMP]	= "platform_dump",
+	[STAGE_PRINT_EVENT]	= "print_event",
+	[STAGE_ELA]		= "ela",
+	[STAGE_VPD]		= "vpd",
+	[STAGE_DRMGR]		= "drmgr",
+	[STAGE_SERVICELOG]	= "servicelog",
+	[STAGE_EPOW_ACTION]	= "epow_action",
+};
+
+/**
+ * @var event_types
+ * @brief Event types reported separately; anything else is "other"
+ *
+ * Stages that run outside of the handling of an event (queued drmgr
+ * requests) are reported with the type "none".
+ */
+static const struct {
+	int		type;
+	const char	*name;
+} event_types[] = {
+	{ -1,					"none" },
+	{ -1,					"other" },
+	{ RTAS_HDR_TYPE_CACHE_PARITY,		"cache_parity" },
+	{ RTAS_HDR_TYPE_EPOW,			"epow" },
+	{ RTAS_HDR_TYPE_PRRN,			"prrn" },
+	{ RTAS_HDR_TYPE_PLATFORM_ERROR,		"platform_error" },
+	{ RTAS_HDR_TYPE_IBM_IO_EVENT,		"io_event" },
+	{ RTAS_HDR_TYPE_PLATFORM_INFO,		"platform_info" },
+	{ RTAS_HDR_TYPE_RESOURCE_DEALLOC,	"resource_dealloc" },
+	{ RTAS_HDR_TYPE_DUMP_NOTIFICATION,	"dump_notification" },
+	{ RTAS_HDR_TYPE_HOTPLUG,		"hotplug" },
+};
+
+#define STATS_TYPES	(sizeof(event_types) / sizeof(event_types[0]))
+#define TYPE_NONE	0
+#define TYPE_OTHER	1
+
+struct histogram {
+	uint64_t	buckets[STATS_BUCKETS + 1];	/* last is +Inf */
+	uint64_t	count;
+	uint64_t	sum_ns;
+};
+
+static struct histogram histograms[STATS_STAGES][STATS_TYPES];
+static uint64_t event_counts[STATS_TYPES];
+
+static int cur_type = TYPE_NONE;
+static int stats_dirty;
+static time_t stats_written;
+
+/**
+ * stats_now
+ * @brief Current monotonic time in nanoseconds
+ */
+uint64_t
+stats_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * stats_event_begin
+ * @brief Attribute the following stages to an event of the given type
+ *
+ * @param rtas_type RTAS event type from the event header
+ */
+void
+stats_event_begin(int rtas_type)
+{
+	int i;
+
+	cur_type = TYPE_OTHER;
+	for (i = TYPE_OTHER + 1; i < STATS_TYPES; i++) {
+		if (event_types[i].type == rtas_type) {
+			cur_type = i;
+			break;
+		}
+	}
+
+	event_counts[cur_type]++;
+	stats_dirty = 1;
+}
+
+/**
+ * stats_event_end
+ * @brief Done with the current event
+ */
+void
+stats_event_end(void)
+{
+	cur_type = TYPE_NONE;
+}
+
+/**
+ * stats_record
+ * @brief Record the duration of a stage
+ *
+ * @param stage STAGE_*
+ * @param start time the stage started, from stats_now()
+ * @return duration of the stage in nanoseconds
+ */
+uint64_t
+stats_record(int stage, uint64_t start)
+{
+	struct histogram *h = &histograms[stage][cur_type];
+	uint64_t ns = stats_now() - start;
+	uint64_t us = ns / 1000;
+	int b = 0;
+
+	while (b < STATS_BUCKETS && us >= (1ULL << b))
+		b++;
+
+	h->buckets[b]++;
+	h->count++;
+	h->sum_ns += ns;
+	stats_dirty = 1;
+
+	return ns;
+}
+
+/**
+ * stats_timeout
+ * @brief How long the event loop may wait before the stats are due
+ *
+ * @return milliseconds, or -1 if there is nothing new to write
+ */
+int
+stats_timeout(void)
+{
+	time_t due;
+
+	if (!stats_dirty || !strcmp(d_cfg.stats_file, "none"))
+		return -1;
+
+	due = stats_written + STATS_WRITE_INTERVAL - time(NULL);
+	if (due <= 0)
+		return 0;
+
+	return due * 1000;
+}
+
+/**
+ * stats_write
+ * @brief Write the statistics to the stats file
+ *
+ * The file is written to a temporary file and renamed over the old
+ * one, so readers never see a partial file.
+ */
+void
+stats_write(void)
+{
+	char tmp_path[PATH_MAX];
+	struct histogram *h;
+	uint64_t cum;
+	FILE *fp;
+	int s, t, b;
+
+	if (!stats_dirty || !strcmp(d_cfg.stats_file, "none"))
+		return;
+
+	stats_written = time(NULL);
+	stats_dirty = 0;
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", d_cfg.stats_file);
+	fp = fopen(tmp_path, "w");
+	if (fp == NULL) {
+		log_msg(NULL, "Could not open the statistics file %s, %s",
+			tmp_path, strerror(errno));
+		return;
+	}
+
+	fprintf(fp, "# HELP rtas_errd_events_total RTAS events handled "
+		"by rtas_errd.\n");
+	fprintf(fp, "# TYPE rtas_errd_events_total counter\n");
+	for (t = TYPE_OTHER; t < STATS_TYPES; t++)
+		fprintf(fp, "rtas_errd_events_total{type=\"%s\"} %llu\n",
+			event_types[t].name,
+			(unsigned long long)event_counts[t]);
+
+	fprintf(fp, "# HELP rtas_errd_stage_seconds Time spent in each "
+		"stage of handling RTAS events.\n");
+	fprintf(fp, "# TYPE rtas_errd_stage_seconds histogram\n");
+	for (s = 0; s < STATS_STAGES; s++) {
+		for (t = 0; t < STATS_TYPES; t++) {
+			h = &histograms[s][t];
+			if (h->count == 0)
+				continue;
+
+			cum = 0;
+			for (b = 0; b < STATS_BUCKETS; b++) {
+				cum += h->buckets[b];
+				fprintf(fp, "rtas_errd_stage_seconds_bucket"
+					"{stage=\"%s\",type=\"%s\",le=\"%.6f\"} "
+					"%llu\n", stage_names[s],
+					event_types[t].name,
+					(double)(1ULL << b) / 1000000,
+					(unsigned long long)cum);
+			}
+			fprintf(fp, "rtas_errd_stage_seconds_bucket"
+				"{stage=\"%s\",type=\"%s\",le=\"+Inf\"} %llu\n",
+				stage_names[s], event_types[t].name,
+				(unsigned long long)h->count);
+			fprintf(fp, "rtas_errd_stage_seconds_sum"
+				"{stage=\"%s\",type=\"%s\"} %.9f\n",
+				stage_names[s], event_types[t].name,
+				(double)h->sum_ns / 1000000000);
+			fprintf(fp, "rtas_errd_stage_seconds_count"
+				"{stage=\"%s\",type=\"%s\"} %llu\n",
+				stage_names[s], event_types[t].name,
+				(unsigned long long)h->count);
+		}
+	}
+
+	if (fclose(fp)) {
+		log_msg(NULL, "Could not write the statistics file %s, %s",
+			tmp_path, strerror(errno));
+		unlink(tmp_path);
+		return;
+	}
+
+	if (rename(tmp_path, d_cfg.stats_file)) {
+		log_msg(NULL, "Could not rename %s to %s, %s", tmp_path,
+			d_cfg.stats_file, strerror(errno));
+		unlink(tmp_path);
+	}
+}
@@ -0,0 +1,255 @@
+/**
+ * @file ela_symptom.c
+ * @brief Check the pre-v6 ELA symptom tables against the old lookup
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../ela_symptom.h"
+
+/*
+ * Reference implementation: the tables and the linear search that
+ * ela_symptom_row() replaced in rtas_errd's convert_symptom().
+ */
+#define NCPUSYMPTOMS	 9
+#define NMEMSYMPTOMS	17
+#define NIOSYMPTOMS	17
+#define NSPSYMPTOMS	33
+#define NSPSYMPTOMS_ADDITIONAL	9
+
+static int cpu_log_sig[NCPUSYMPTOMS] = {0x00, 0x80, 0x40, 0x20, 0x10,
+					0x08, 0x04, 0x02, 0x01};
+static char *cpu_log[NCPUSYMPTOMS][2]= {
+	{ MSGCPUALLZERO, DEFER_MSGALLZERO},
+	{ MSGCPUB12b0, DEFER_MSGCPUB12b0},
+	{ MSGCPUB12b1, DEFER_MSGCPUB12b1},
+	{ MSGCPUB12b2, DEFER_MSGCPUB12b2},
+	{ MSGCPUB12b3, DEFER_MSGCPUB12b3},
+	{ MSGCPUB12b4, DEFER_MSGCPUB12b4},
+	{ MSGCPUB12b5, DEFER_MSGCPUB12b5},
+	{ MSGCPUB12b6, DEFER_MSGCPUB12b6},
+	{ MSGCPUB12b7, DEFER_MSGCPUB12b7}
+};
+
+static int mem_log_sig[NMEMSYMPTOMS] = {0x0000, 0x8000, 0x4000, 0x2000,
+					0x1000, 0x0800, 0x0400, 0x0200,
+					0x0100, 0x0080, 0x0040, 0x0020,
+					0x0010, 0x0008, 0x0004, 0x0002,
+					0x0001};
+static char *mem_log[NMEMSYMPTOMS][2] = {
+	{ MSGMEMALLZERO, DEFER_MSGALLZERO},
+	{ MSGMEMB12b0, DEFER_MSGMEMB12b0},
+	{ MSGMEMB12b1, DEFER_MSGMEMB12b1},
+	{ MSGMEMB12b2, DEFER_MSGMEMB12b2},
+	{ MSGMEMB12b3, DEFER_MSGMEMB12b3},
+	{ MSGMEMB12b4, DEFER_MSGMEMB12b4},
+	{ MSGMEMB12b5, DEFER_MSGMEMB12b5},
+	{ MSGMEMB12b6, DEFER_MSGMEMB12b6},
+	{ MSGMEMB12b7, DEFER_MSGMEMB12b7},
+	{ MSGMEMB13b0, DEFER_MSGMEMB13b0},
+	{ MSGMEMB13b1, DEFER_MSGMEMB13b1},
+	{ MSGMEMB13b2, DEFER_MSGMEMB13b2},
+	{ MSGMEMB13b3, DEFER_MSGMEMB13b3},
+	{ MSGMEMB13b4, DEFER_MSGMEMB13b4},
+	{ MSGRESERVED, DEFER_MSGRESERVED},
+	{ MSGMEMB13b6, DEFER_MSGMEMB13b6},
+	{ MSGMEMB13b7, DEFER_MSGMEMB13b7},
+};
+
+static int io_log_sig[NIOSYMPTOMS] = {0x0000, 0x8000, 0x4000, 0x2000,
+				      0x1000, 0x0800, 0x0400, 0x0410,
+				      0x0200, 0x0210, 0x0100, 0x0110,
+				      0x0010, 0x0008, 0x0004, 0x0002,
+				      0x0001};
+static char *io_log[NIOSYMPTOMS][2] = {
+	{ MSGIOALLZERO, DEFER_MSGALLZERO},
+	{ MSGIOB12b0, DEFER_MSGIOB12b0},
+	{ MSGIOB12b1, DEFER_MSGIOB12b1},
+	{ MSGIOB12b2, DEFER_MSGIOB12b2},
+	{ MSGIOB12b3, DEFER_MSGIOB12b3},
+	{ MSGIOB12b4, DEFER_MSGIOB12b4},
+	{ MSGIOB12b5, DEFER_MSGIOB12b5},
+	{ MSGIOB12b5B13b3, DEFER_MSGIOB12b5B13b3},
+	{ MSGIOB12b6, DEFER_MSGIOB12b6},
+	{ MSGIOB12b6B13b3, DEFER_MSGIOB12b6B13b3},
+	{ MSGIOB12b7, DEFER_MSGIOB12b7},
+	{ MSGIOB12b7B13b3, DEFER_MSGIOB12b7B13b3},
+	{ MSGIOB13b3, DEFER_MSGIOB13b3},
+	{ MSGIOB13b4, DEFER_MSGIOB13b4},
+	{ MSGIOB13b5, DEFER_MSGIOB13b5},
+	{ MSGIOB13b6, DEFER_MSGIOB13b6},
+	{ MSGIOB13b7, DEFER_MSGIOB13b7},
+};
+
+static char *sp_log[NSPSYMPTOMS][2] = {
+	{ MSGSPALLZERO, DEFER_MSGALLZERO},
+	{ MSGSPB16b0, DEFER_MSGSPB16b0},
+	{ MSGSPB16b1, DEFER_MSGSPB16b1},
+	{ MSGSPB16b2, DEFER_MSGSPB16b2},
+	{ MSGSPB16b3, DEFER_MSGSPB16b3},
+	{ MSGSPB16b4, DEFER_MSGSPB16b4},
+	{ MSGSPB16b5, DEFER_MSGSPB16b5},
+	{ MSGSPB16b6, DEFER_MSGSPB16b6},
+	{ MSGSPB16b7, DEFER_MSGSPB16b7},
+	{ MSGSPB17b0, DEFER_MSGSPB17b0},
+	{ MSGSPB17b1, DEFER_MSGSPB17b1},
+	{ MSGSPB17b2, DEFER_MSGSPB17b2},
+	{ MSGSPB17b3, DEFER_MSGSPB17b3},
+	{ MSGSPB17b4, DEFER_MSGSPB17b4},
+	{ MSGSPB17b5, DEFER_MSGSPB17b5},
+	{ MSGRESERVED,DEFER_MSGRESERVED},
+	{ MSGRESERVED,DEFER_MSGRESERVED},
+	{ MSGSPB18b0, DEFER_MSGSPB18b0},
+	{ MSGSPB18b1, DEFER_MSGSPB18b1},
+	{ MSGSPB18b2, DEFER_MSGSPB18b2},
+	{ MSGSPB18b3, DEFER_MSGSPB18b3},
+	{ MSGSPB18b4, DEFER_MSGSPB18b4},
+	{ MSGRESERVED,DEFER_MSGRESERVED},
+	{ MSGSPB18b6, DEFER_MSGSPB18b6},
+	{ MSGSPB18b7, DEFER_MSGSPB18b7},
+	{ MSGSPB19b0, DEFER_MSGSPB19b0},
+	{ MSGSPB19b1, DEFER_MSGSPB19b1},
+	{ MSGRESERVED, DEFER_MSGRESERVED},
+	{ MSGRESERVED, DEFER_MSGRESERVED},
+	{ MSGSPB19b4, DEFER_MSGSPB19b4},
+	{ MSGSPB19b5, DEFER_MSGSPB19b5},
+	{ MSGSPB19b6, DEFER_MSGSPB19b6},
+	{ MSGRESERVED, DEFER_MSGRESERVED},
+};
+
+static char *sp_log_additional[NSPSYMPTOMS_ADDITIONAL][2] = {
+	{ MSGSPALLZERO, DEFER_MSGALLZERO},
+	{ MSGSPB28b0, DEFER_MSGSPB28b0},
+	{ MSGSPB28b1, DEFER_MSGSPB28b1},
+	{ MSGSPB28b2, DEFER_MSGSPB28b2},
+	{ MSGSPB28b3, DEFER_MSGSPB28b3},
+	{ MSGSPB28b4, DEFER_MSGSPB28b4},
+	{ MSGSPB28b5, DEFER_MSGSPB28b5},
+	{ MSGSPB28b6, DEFER_MSGSPB28b6},
+	{ MSGSPB28b7, DEFER_MSGSPB28b7},
+};
+
+/* The first signature matching sbits, 0 if none does */
+static int
+ref_seqn(const int *sig, int nsig, int sbits)
+{
+	int seqn;
+
+	for (seqn = 1; seqn < nsig; seqn++)
+		if ((sbits & sig[seqn]) == sig[seqn])
+			return seqn;
+
+	return 0;
+}
+
+/* The sp signatures are the 32 single bits, most significant first */
+static int
+ref_sp_seqn(unsigned int sbits, int nbits)
+{
+	int seqn;
+
+	for (seqn = 1; seqn <= nbits; seqn++)
+		if (sbits & (1U << (nbits - seqn)))
+			return seqn;
+
+	return 0;
+}
+
+static int failed;
+
+static void
+check(const char *what, unsigned int sbits, int seqn, char * const *msg,
+      int ref, char **ref_msg)
+{
+	int i;
+
+	if (seqn != ref) {
+		fprintf(stderr, "%s sequence number mismatch for %#x: "
+			"%d, expected %d\n", what, sbits, seqn, ref);
+		failed++;
+		return;
+	}
+
+	for (i = 0; i < 2; i++) {
+		if (strcmp(msg[i], ref_msg[i]) == 0)
+			continue;
+
+		fprintf(stderr, "%s message mismatch for %#x:\n%s\n%s\n",
+			what, sbits, msg[i], ref_msg[i]);
+		failed++;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int sbits, low;
+	int seqn, ref, i, j;
+
+	if (ELA_NROWS(ela_cpu_msg) != NCPUSYMPTOMS ||
+	    ELA_NROWS(ela_mem_msg) != NMEMSYMPTOMS ||
+	    ELA_NROWS(ela_io_msg) != NIOSYMPTOMS ||
+	    ELA_NROWS(ela_sp_msg) != NSPSYMPTOMS ||
+	    ELA_NROWS(ela_sp_additional_msg) != NSPSYMPTOMS_ADDITIONAL) {
+		fprintf(stderr, "symptom table size mismatch\n");
+		return 1;
+	}
+
+	for (sbits = 0; sbits < 0x100; sbits++) {
+		seqn = ela_symptom_row(sbits, NCPUSYMPTOMS - 1);
+		ref = ref_seqn(cpu_log_sig, NCPUSYMPTOMS, sbits);
+		check("cpu", sbits, seqn, ela_cpu_msg[seqn], ref,
+		      cpu_log[ref]);
+
+		seqn = ela_symptom_row(sbits, NSPSYMPTOMS_ADDITIONAL - 1);
+		ref = ref_sp_seqn(sbits, NSPSYMPTOMS_ADDITIONAL - 1);
+		check("sp additional", sbits, seqn,
+		      ela_sp_additional_msg[seqn], ref,
+		      sp_log_additional[ref]);
+	}
+
+	for (sbits = 0; sbits < 0x10000; sbits++) {
+		seqn = ela_symptom_row(sbits, NMEMSYMPTOMS - 1);
+		ref = ref_seqn(mem_log_sig, NMEMSYMPTOMS, sbits);
+		check("mem", sbits, seqn, ela_mem_msg[seqn], ref,
+		      mem_log[ref]);
+
+		seqn = ela_symptom_io_row(sbits);
+		ref = ref_seqn(io_log_sig, NIOSYMPTOMS, sbits & 0x0FF1F);
+		check("io", sbits, seqn, ela_io_msg[seqn], ref, io_log[ref]);
+	}
+
+	/* Every pair of sp bits, and every bit with all lower ones set */
+	for (i = 0; i < 32; i++) {
+		low = (1U << i) | ((1U << i) - 1);
+		seqn = ela_symptom_row(low, NSPSYMPTOMS - 1);
+		ref = ref_sp_seqn(low, NSPSYMPTOMS - 1);
+		check("sp", low, seqn, ela_sp_msg[seqn], ref, sp_log[ref]);
+
+		for (j = 0; j < 32; j++) {
+			sbits = (1U << i) | (1U << j);
+			seqn = ela_symptom_row(sbits, NSPSYMPTOMS - 1);
+			ref = ref_sp_seqn(sbits, NSPSYMPTOMS - 1);
+			check("sp", sbits, seqn, ela_sp_msg[seqn], ref,
+			      sp_log[ref]);
+		}
+	}
+
+	return failed ? 1 : 0;
+}
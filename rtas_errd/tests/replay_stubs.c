@@ -0,0 +1,212 @@
+/**
+ * @file replay_stubs.c
+ * @brief librtas and servicelog stand-ins for rtas_errd_replay
+ *
+ * rtas_errd_replay is rtas_errd linked against these instead of librtas
+ * and libservicelog, so that a corpus of RTAS events can be replayed
+ * without firmware, without touching the servicelog database and
+ * without root.  librtasevent is still the real one since parsing the
+ * events is part of what is measured.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <librtas.h>
+#include <librtasevent.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * Allocation counting, for rtas_errd/tests/replay_allocs.  With
+ * REPLAY_ALLOC_STATS set in the environment the number of allocations
+ * is printed on exit, with those made by librtasevent while parsing
+ * events (parse_rtas_event() is wrapped at link time) counted apart.
+ */
+
+extern void *__libc_malloc(size_t);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+extern void __libc_free(void *);
+
+static unsigned long alloc_count;
+static unsigned long parse_alloc_count;
+static __thread int in_parse;
+
+static inline void
+count_alloc(void)
+{
+	if (in_parse)
+		__atomic_add_fetch(&parse_alloc_count, 1, __ATOMIC_RELAXED);
+	else
+		__atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+}
+
+void *
+malloc(size_t size)
+{
+	count_alloc();
+	return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+	count_alloc();
+	return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+	count_alloc();
+	return __libc_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+	__libc_free(ptr);
+}
+
+struct rtas_event *__real_parse_rtas_event(char *, int);
+
+struct rtas_event *
+__wrap_parse_rtas_event(char *buf, int buflen)
+{
+	struct rtas_event *re;
+
+	in_parse = 1;
+	re = __real_parse_rtas_event(buf, buflen);
+	in_parse = 0;
+
+	return re;
+}
+
+static void __attribute__((destructor))
+report_allocs(void)
+{
+	if (getenv("REPLAY_ALLOC_STATS"))
+		fprintf(stderr, "allocations: %lu parse: %lu\n",
+			alloc_count, parse_alloc_count);
+}
+
+/* librtas */
+
+int
+rtas_set_debug(int level)
+{
+	return 0;
+}
+
+int
+rtas_get_sensor(int sensor, int index, int *state)
+{
+	*state = 0;	/* all is well */
+	return 0;
+}
+
+int
+rtas_set_sysparm(unsigned int parameter, char *data)
+{
+	return RTAS_UNKNOWN_OP;
+}
+
+int
+rtas_update_nodes(char *workarea, unsigned int scope)
+{
+	/* no nodes to update */
+	memset(workarea + 16, 0, 16);
+	return 0;
+}
+
+int
+rtas_update_properties(char *workarea, unsigned int scope)
+{
+	/* no properties to update */
+	memset(workarea + 16, 0, 16);
+	return 0;
+}
+
+/* libservicelog */
+
+static char stub_servicelog;
+static uint64_t stub_key;
+
+int
+servicelog_open(struct servicelog **slog, uint64_t flags)
+{
+	*slog = (struct servicelog *)&stub_servicelog;
+	return 0;
+}
+
+void
+servicelog_close(struct servicelog *slog)
+{
+}
+
+char *
+servicelog_error(struct servicelog *slog)
+{
+	return "servicelog stub";
+}
+
+int
+servicelog_event_log(struct servicelog *slog, struct sl_event *event,
+		     uint64_t *new_id)
+{
+	*new_id = ++stub_key;
+	return 0;
+}
+
+int
+servicelog_event_free(struct sl_event *events)
+{
+	struct sl_event *event;
+	struct sl_callout *callout;
+
+	while (events) {
+		event = events;
+		events = event->next;
+
+		while (event->callouts) {
+			callout = event->callouts;
+			event->callouts = callout->next;
+
+			free(callout->procedure);
+			free(callout->location);
+			free(callout->fru);
+			free(callout->serial);
+			free(callout->ccin);
+			free(callout);
+		}
+
+		free(event->platform);
+		free(event->machine_serial);
+		free(event->machine_model);
+		free(event->nodename);
+		free(event->refcode);
+		free(event->description);
+		free(event->raw_data);
+		free(event->addl_data);
+		free(event);
+	}
+
+	return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file v6ela_msg.c
+ * @brief Check the v6 ELA message tables against the old lookup
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../v6ela_msg.h"
+
+/*
+ * Reference implementation: the tables and the linear search that
+ * v6_message() replaced in rtas_errd's get_message_id().
+ */
+
+/*
+ * Table of V6 Error Messages. Each message, V6_ER_ss_vv,  is addressable
+ * by the Subsystem Id ("ss") and the Error Severity ("vv").
+ */
+static char *ref_v6_error[12][14] = {
+	{V6_ER_10_00, V6_ER_10_10, V6_ER_10_20, V6_ER_10_21, V6_ER_10_22,
+	 V6_ER_10_23, V6_ER_10_24, V6_ER_10_40, V6_ER_10_41, V6_ER_10_44,
+	 V6_ER_10_45, V6_ER_10_48, V6_ER_10_60, V6_ER_10_61},
+
+	{V6_ER_20_00, V6_ER_20_10, V6_ER_20_20, V6_ER_20_21, V6_ER_20_22,
+	 V6_ER_20_23, V6_ER_20_24, V6_ER_20_40, V6_ER_20_41, V6_ER_20_44,
+	 V6_ER_20_45, V6_ER_20_48, V6_ER_20_60, V6_ER_20_61},
+
+	{V6_ER_30_00, V6_ER_30_10, V6_ER_30_20, V6_ER_30_21, V6_ER_30_22,
+	 V6_ER_30_23, V6_ER_30_24, V6_ER_30_40, V6_ER_30_41, V6_ER_30_44,
+	 V6_ER_30_45, V6_ER_30_48, V6_ER_30_60, V6_ER_30_61},
+
+	{V6_ER_40_00, V6_ER_40_10, V6_ER_40_20, V6_ER_40_21, V6_ER_40_22,
+	 V6_ER_40_23, V6_ER_40_24, V6_ER_40_40, V6_ER_40_41, V6_ER_40_44,
+	 V6_ER_40_45, V6_ER_40_48, V6_ER_40_60, V6_ER_40_61},
+
+	{V6_ER_50_00, V6_ER_50_10, V6_ER_50_20, V6_ER_50_21, V6_ER_50_22,
+	 V6_ER_50_23, V6_ER_50_24, V6_ER_50_40, V6_ER_50_41, V6_ER_50_44,
+	 V6_ER_50_45, V6_ER_50_48, V6_ER_50_60, V6_ER_50_61},
+
+	{V6_ER_60_00, V6_ER_60_10, V6_ER_60_20, V6_ER_60_21, V6_ER_60_22,
+	 V6_ER_60_23, V6_ER_60_24, V6_ER_60_40, V6_ER_60_41, V6_ER_60_44,
+	 V6_ER_60_45, V6_ER_60_48, V6_ER_60_60, V6_ER_60_61},
+
+	{V6_ER_70_00, V6_ER_70_10, V6_ER_70_20, V6_ER_70_21, V6_ER_70_22,
+	 V6_ER_70_23, V6_ER_70_24, V6_ER_70_40, V6_ER_70_41, V6_ER_70_44,
+	 V6_ER_70_45, V6_ER_70_48, V6_ER_70_60, V6_ER_70_61},
+
+	{V6_ER_7A_00, V6_ER_7A_10, V6_ER_7A_20, V6_ER_7A_21, V6_ER_7A_22,
+	 V6_ER_7A_23, V6_ER_7A_24, V6_ER_7A_40, V6_ER_7A_41, V6_ER_7A_44,
+	 V6_ER_7A_45, V6_ER_7A_48, V6_ER_7A_60, V6_ER_7A_61},
+
+	{V6_ER_80_00, V6_ER_80_10, V6_ER_80_20, V6_ER_80_21, V6_ER_80_22,
+	 V6_ER_80_23, V6_ER_80_24, V6_ER_80_40, V6_ER_80_41, V6_ER_80_44,
+	 V6_ER_80_45, V6_ER_80_48, V6_ER_80_60, V6_ER_80_61},
+
+	{V6_ER_90_00, V6_ER_90_10, V6_ER_90_20, V6_ER_90_21, V6_ER_90_22,
+	 V6_ER_90_23, V6_ER_90_24, V6_ER_90_40, V6_ER_90_41, V6_ER_90_44,
+	 V6_ER_90_45, V6_ER_90_48, V6_ER_90_60, V6_ER_90_61},
+
+	{V6_ER_A0_00, V6_ER_A0_10, V6_ER_A0_20, V6_ER_A0_21, V6_ER_A0_22,
+	 V6_ER_A0_23, V6_ER_A0_24, V6_ER_A0_40, V6_ER_A0_41, V6_ER_A0_44,
+	 V6_ER_A0_45, V6_ER_A0_48, V6_ER_A0_60, V6_ER_A0_61},
+
+	{V6_ER_B0_00, V6_ER_B0_10, V6_ER_B0_20, V6_ER_B0_21, V6_ER_B0_22,
+	 V6_ER_B0_23, V6_ER_B0_24, V6_ER_B0_40, V6_ER_B0_41, V6_ER_B0_44,
+	 V6_ER_B0_45, V6_ER_B0_48, V6_ER_B0_60, V6_ER_B0_61}
+};
+
+/*
+ * Table of V6 Event Messages. Each message, V6_EV_ss_tt,  is addressable
+ * by the Subsystem Id ("ss") and the Event Subtype ("tt").
+ */
+static char *ref_v6_event[12][14] = {
+	{V6_EV_10_00, V6_EV_10_01, V6_EV_10_08, V6_EV_10_10, V6_EV_10_20,
+	 V6_EV_10_21, V6_EV_10_22, V6_EV_10_30, V6_EV_10_40, V6_EV_10_60,
+	 V6_EV_10_70, V6_EV_10_80, V6_EV_10_D0, V6_EV_10_E0},
+
+	{V6_EV_20_00, V6_EV_20_01, V6_EV_20_08, V6_EV_20_10, V6_EV_20_20,
+	 V6_EV_20_21, V6_EV_20_22, V6_EV_20_30, V6_EV_20_40, V6_EV_20_60,
+	 V6_EV_20_70, V6_EV_20_80, V6_EV_20_D0, V6_EV_20_E0},
+
+	{V6_EV_30_00, V6_EV_30_01, V6_EV_30_08, V6_EV_30_10, V6_EV_30_20,
+	 V6_EV_30_21, V6_EV_30_22, V6_EV_30_30, V6_EV_30_40, V6_EV_30_60,
+	 V6_EV_30_70, V6_EV_30_80, V6_EV_30_D0, V6_EV_30_E0},
+
+	{V6_EV_40_00, V6_EV_40_01, V6_EV_40_08, V6_EV_40_10, V6_EV_40_20,
+	 V6_EV_40_21, V6_EV_40_22, V6_EV_40_30, V6_EV_40_40, V6_EV_40_60,
+	 V6_EV_40_70, V6_EV_40_80, V6_EV_40_D0, V6_EV_40_E0},
+
+	{V6_EV_50_00, V6_EV_50_01, V6_EV_50_08, V6_EV_50_10, V6_EV_50_20,
+	 V6_EV_50_21, V6_EV_50_22, V6_EV_50_30, V6_EV_50_40, V6_EV_50_60,
+	 V6_EV_50_70, V6_EV_50_80, V6_EV_50_D0, V6_EV_50_E0},
+
+	{V6_EV_60_00, V6_EV_60_01, V6_EV_60_08, V6_EV_60_10, V6_EV_60_20,
+	 V6_EV_60_21, V6_EV_60_22, V6_EV_60_30, V6_EV_60_40, V6_EV_60_60,
+	 V6_EV_60_70, V6_EV_60_80, V6_EV_60_D0, V6_EV_60_E0},
+
+	{V6_EV_70_00, V6_EV_70_01, V6_EV_70_08, V6_EV_70_10, V6_EV_70_20,
+	 V6_EV_70_21, V6_EV_70_22, V6_EV_70_30, V6_EV_70_40, V6_EV_70_60,
+	 V6_EV_70_70, V6_EV_70_80, V6_EV_70_D0, V6_EV_70_E0},
+
+	{V6_EV_7A_00, V6_EV_7A_01, V6_EV_7A_08, V6_EV_7A_10, V6_EV_7A_20,
+	 V6_EV_7A_21, V6_EV_7A_22, V6_EV_7A_30, V6_EV_7A_40, V6_EV_7A_60,
+	 V6_EV_7A_70, V6_EV_7A_80, V6_EV_7A_D0, V6_EV_7A_E0},
+
+	{V6_EV_80_00, V6_EV_80_01, V6_EV_80_08, V6_EV_80_10, V6_EV_80_20,
+	 V6_EV_80_21, V6_EV_80_22, V6_EV_80_30, V6_EV_80_40, V6_EV_80_60,
+	 V6_EV_80_70, V6_EV_80_80, V6_EV_80_D0, V6_EV_80_E0},
+
+	{V6_EV_90_00, V6_EV_90_01, V6_EV_90_08, V6_EV_90_10, V6_EV_90_20,
+	 V6_EV_90_21, V6_EV_90_22, V6_EV_90_30, V6_EV_90_40, V6_EV_90_60,
+	 V6_EV_90_70, V6_EV_90_80, V6_EV_90_D0, V6_EV_90_E0},
+
+	{V6_EV_A0_00, V6_EV_A0_01, V6_EV_A0_08, V6_EV_A0_10, V6_EV_A0_20,
+	 V6_EV_A0_21, V6_EV_A0_22, V6_EV_A0_30, V6_EV_A0_40, V6_EV_A0_60,
+	 V6_EV_A0_70, V6_EV_A0_80, V6_EV_A0_D0, V6_EV_A0_E0},
+
+	{V6_EV_B0_00, V6_EV_B0_01, V6_EV_B0_08, V6_EV_B0_10, V6_EV_B0_20,
+	 V6_EV_B0_21, V6_EV_B0_22, V6_EV_B0_30, V6_EV_B0_40, V6_EV_B0_60,
+	 V6_EV_B0_70, V6_EV_B0_80, V6_EV_B0_D0, V6_EV_B0_E0}
+};
+
+static const char *
+ref_message(int type, int subid, int code)
+{
+	int i, j, k;
+	int supported_severity[14] = { 0, 0x10, 0x20, 0x21, 0x22,
+				       0x23, 0x24, 0x40, 0x41, 0x44,
+				       0x45, 0x48, 0x60, 0x61};
+	int supported_subtype[14]  = { 0, 0x01, 0x08, 0x10, 0x20,
+				       0x21, 0x22, 0x30, 0x40, 0x60,
+				       0x70, 0x80, 0xD0, 0xE0};
+
+	if (subid < 0x10)
+		return V6_INVALID_SUBID;
+
+	if (subid > 0xAF)
+		return V6_RESERVED_SUBID;
+
+	i = subid >> 4;
+	if (subid > 0x79)
+		i++;
+	i--;
+
+	if (type == V6_ERROR_MSG) {
+		for (k = 0, j = -1; k < 14 && j == -1; k++)
+			if (supported_severity[k] == code)
+				j = k;
+		if (j == -1)
+			j = 0;
+
+		return ref_v6_error[i][j];
+	}
+
+	for (k = 0, j = -1; k < 14 && j == -1; k++)
+		if (supported_subtype[k] == code)
+			j = k;
+	if (j == -1)
+		j = 0;
+
+	return ref_v6_event[i][j];
+}
+
+int main(int argc, char *argv[])
+{
+	const char *msg, *ref;
+	int type, subid, code, failed = 0;
+
+	for (type = V6_ERROR_MSG; type <= V6_EVENT_MSG; type++) {
+		for (subid = 0; subid < 0x100; subid++) {
+			/* codes beyond a byte must fall back to column 0 */
+			for (code = 0; code < 0x102; code++) {
+				msg = v6_message(type, subid, code);
+				ref = ref_message(type, subid, code);
+				if (strcmp(msg, ref) == 0)
+					continue;
+
+				fprintf(stderr, "%s message mismatch for "
+					"subsystem %#x, %s %#x:\n%s\n%s\n",
+					type == V6_ERROR_MSG ? "error" : "event",
+					subid,
+					type == V6_ERROR_MSG ? "severity" :
+							       "subtype",
+					code, msg, ref);
+				failed++;
+			}
+		}
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,396 @@
+/**
+ * @file topology.c
+ * @brief Cached partition topology for guard and DLPAR decisions
+ *
+ * Deciding whether a processor, entitled capacity or an LMB can be
+ * given up used to mean reading /proc/ppc64/lparcfg once per parameter
+ * and opening the state file of every memory block in
+ * /sys/devices/system/memory, of which there are tens of thousands on
+ * large machines.  Instead the number of active processors, the
+ * entitled capacity and the set of online memory blocks are loaded
+ * once and kept here.
+ *
+ * The memory blocks are kept current from kernel uevents: a
+ * NETLINK_KOBJECT_UEVENT socket is read (without blocking) before each
+ * lookup, and online/offline/add/remove events for memory blocks are
+ * applied to the set.  CPU uevents and the DLPAR operations rtas_errd
+ * runs itself mark the lparcfg values stale.  Everything is reloaded
+ * when the uevent socket overflowed, could not be opened, or the
+ * cache is older than TOPOLOGY_MAX_AGE.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include "rtas_errd.h"
+
+#define LPARCFG_FILE		"/proc/ppc64/lparcfg"
+#define MEMORY_SYSFS_DIR	"/sys/devices/system/memory"
+#define MEMORY_DEVPATH		"/devices/system/memory/memory"
+#define CPU_DEVPATH		"/devices/system/cpu/cpu"
+
+/**
+ * @def TOPOLOGY_MAX_AGE
+ * @brief Seconds after which the cache is checked against the system
+ */
+#define TOPOLOGY_MAX_AGE	300
+
+#define UEVENT_BUF_SZ		4096
+#define UEVENT_RCVBUF_SZ	(4 * 1024 * 1024)
+
+static struct {
+	long		active_processors;
+	long		entitled_capacity;
+	int		lparcfg_valid;
+	time_t		lparcfg_loaded;
+
+	uint64_t	*online;	/**< bitmap of online memory blocks */
+	unsigned int	online_size;	/**< in bits */
+	int		online_count;
+	int		memory_valid;
+	time_t		memory_loaded;
+
+	int		uevent_fd;
+	int		uevent_tried;
+} topo = {
+	.uevent_fd = -1,
+};
+
+/**
+ * lmb_set_online
+ * @brief Record the state of a memory block
+ *
+ * @param block memory block number
+ * @param online non-zero if the block is online
+ */
+static void
+lmb_set_online(unsigned int block, int online)
+{
+	uint64_t bit, *tmp;
+	unsigned int new_size;
+
+	if (block >= topo.online_size) {
+		if (!online)
+			return;
+
+		new_size = topo.online_size ? topo.online_size : 4096;
+		while (new_size <= block)
+			new_size *= 2;
+
+		tmp = realloc(topo.online, new_size / 8);
+		if (tmp == NULL) {
+			/* The set is rebuilt on the next lookup */
+			topo.memory_valid = 0;
+			return;
+		}
+
+		memset((char *)tmp + topo.online_size / 8, 0,
+		       (new_size - topo.online_size) / 8);
+		topo.online = tmp;
+		topo.online_size = new_size;
+	}
+
+	bit = 1ULL << (block % 64);
+	if (online && !(topo.online[block / 64] & bit)) {
+		topo.online[block / 64] |= bit;
+		topo.online_count++;
+	} else if (!online && (topo.online[block / 64] & bit)) {
+		topo.online[block / 64] &= ~bit;
+		topo.online_count--;
+	}
+}
+
+/**
+ * uevent_open
+ * @brief Start listening for kernel uevents
+ *
+ * Done before the first load, so that no change is missed in between.
+ */
+static void
+uevent_open(void)
+{
+	struct sockaddr_nl addr;
+	int fd, size = UEVENT_RCVBUF_SZ;
+
+	topo.uevent_tried = 1;
+
+	fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+		    NETLINK_KOBJECT_UEVENT);
+	if (fd < 0) {
+		dbg("Could not open uevent socket, %s", strerror(errno));
+		return;
+	}
+
+	/* Memory DLPAR of many LMBs produces a burst of uevents */
+	if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)))
+		setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = 1;	/* kernel events */
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		dbg("Could not bind uevent socket, %s", strerror(errno));
+		close(fd);
+		return;
+	}
+
+	topo.uevent_fd = fd;
+}
+
+/**
+ * uevent_drain
+ * @brief Apply the uevents received since the last lookup
+ */
+static void
+uevent_drain(void)
+{
+	char buf[UEVENT_BUF_SZ], *devpath;
+	unsigned int block;
+	ssize_t len;
+
+	if (topo.uevent_fd < 0)
+		return;
+
+	while (1) {
+		len = recv(topo.uevent_fd, buf, sizeof(buf) - 1, 0);
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == ENOBUFS) {
+				/* Events were lost; reload everything */
+				dbg("uevent socket overflowed");
+				topo.memory_valid = 0;
+				topo.lparcfg_valid = 0;
+				continue;
+			}
+			break;
+		}
+		buf[len] = '\0';
+
+		/* The first string is "<action>@<devpath>" */
+		devpath = strchr(buf, '@');
+		if (devpath == NULL)
+			continue;
+		*devpath++ = '\0';
+
+		if (!strncmp(devpath, CPU_DEVPATH, strlen(CPU_DEVPATH))) {
+			topo.lparcfg_valid = 0;
+			continue;
+		}
+
+		if (strncmp(devpath, MEMORY_DEVPATH, strlen(MEMORY_DEVPATH)) ||
+		    sscanf(devpath + strlen(MEMORY_DEVPATH), "%u",
+			   &block) != 1)
+			continue;
+
+		if (!strcmp(buf, "online"))
+			lmb_set_online(block, 1);
+		else if (!strcmp(buf, "offline") || !strcmp(buf, "remove"))
+			lmb_set_online(block, 0);
+	}
+}
+
+/**
+ * load_lparcfg
+ * @brief Read the processor values from the lparcfg file
+ */
+static void
+load_lparcfg(void)
+{
+	FILE *fp;
+	char buffer[128], *pos;
+	int found = 0;
+
+	topo.active_processors = -1;
+	topo.entitled_capacity = -1;
+	topo.lparcfg_valid = 1;
+	topo.lparcfg_loaded = time(NULL);
+
+	if ((fp = fopen(LPARCFG_FILE, "r")) == NULL) {
+		log_msg(NULL, "Could not open %s, %s", LPARCFG_FILE,
+			strerror(errno));
+		topo.lparcfg_valid = 0;
+		return;
+	}
+
+	while (found < 2 && (fgets(buffer, 128, fp)) != NULL) {
+		if ((pos = strchr(buffer, '=')) == NULL)
+			continue;
+		*pos++ = '\0';
+
+		if (!strcmp(buffer, "partition_active_processors")) {
+			topo.active_processors = strtol(pos, NULL, 0);
+			found++;
+		} else if (!strcmp(buffer, "partition_entitled_capacity")) {
+			topo.entitled_capacity = strtol(pos, NULL, 0);
+			found++;
+		}
+	}
+
+	fclose(fp);
+}
+
+/**
+ * load_memory
+ * @brief Read the state of every memory block from sysfs
+ */
+static void
+load_memory(void)
+{
+	DIR *dir;
+	struct dirent *entry;
+	char path[1024], state[7];
+	unsigned int block;
+	int fd;
+
+	if (topo.online)
+		memset(topo.online, 0, topo.online_size / 8);
+	topo.online_count = 0;
+	topo.memory_valid = 1;
+	topo.memory_loaded = time(NULL);
+
+	dir = opendir(MEMORY_SYSFS_DIR);
+	if (!dir)
+		return;
+
+	while ((entry = readdir(dir)) != NULL) {
+		/* ignore memory@0 situation */
+		if (!strncmp(entry->d_name, "memory@0", 8))
+			continue;
+
+		if (sscanf(entry->d_name, "memory%u", &block) != 1)
+			continue;
+
+		snprintf(path, sizeof(path), MEMORY_SYSFS_DIR "/%s/state",
+			 entry->d_name);
+		if ((fd = open(path, O_RDONLY)) < 0) {
+			log_msg(NULL, "Could not open %s, %s", path,
+				strerror(errno));
+			continue;
+		}
+
+		if (read(fd, state, 6) == 6 && !strncmp(state, "online", 6))
+			lmb_set_online(block, 1);
+		close(fd);
+	}
+
+	closedir(dir);
+	dbg("%d memory blocks online", topo.online_count);
+}
+
+/**
+ * topology_refresh
+ * @brief Bring the cache up to date, reloading only what is stale
+ */
+static void
+topology_refresh(void)
+{
+	time_t now = time(NULL);
+
+	if (!topo.uevent_tried)
+		uevent_open();
+
+	uevent_drain();
+
+	/* Without uevents the memory blocks can not be tracked */
+	if (topo.uevent_fd < 0 || now - topo.memory_loaded > TOPOLOGY_MAX_AGE)
+		topo.memory_valid = 0;
+	if (now - topo.lparcfg_loaded > TOPOLOGY_MAX_AGE)
+		topo.lparcfg_valid = 0;
+}
+
+/**
+ * topology_active_processors
+ * @brief Number of processors active in the partition
+ *
+ * @return partition_active_processors from lparcfg, -1 on error
+ */
+long
+topology_active_processors(void)
+{
+	topology_refresh();
+	if (!topo.lparcfg_valid)
+		load_lparcfg();
+
+	if (topo.active_processors < 0)
+		log_msg(NULL, "Could not find the parameter "
+			"partition_active_processors in " LPARCFG_FILE);
+
+	return topo.active_processors;
+}
+
+/**
+ * topology_entitled_capacity
+ * @brief Entitled processor capacity of the partition
+ *
+ * @return partition_entitled_capacity from lparcfg, -1 on error
+ */
+long
+topology_entitled_capacity(void)
+{
+	topology_refresh();
+	if (!topo.lparcfg_valid)
+		load_lparcfg();
+
+	if (topo.entitled_capacity < 0)
+		log_msg(NULL, "Could not find the parameter "
+			"partition_entitled_capacity in " LPARCFG_FILE);
+
+	return topo.entitled_capacity;
+}
+
+/**
+ * topology_online_lmbs
+ * @brief Number of online memory blocks
+ *
+ * LMBs queued for removal are still online until the drmgr queue is
+ * run; see drmgr_queue_lmbs_removing().
+ */
+int
+topology_online_lmbs(void)
+{
+	topology_refresh();
+	if (!topo.memory_valid)
+		load_memory();
+
+	return topo.online_count;
+}
+
+/**
+ * topology_invalidate
+ * @brief rtas_errd has changed the partition configuration
+ *
+ * Called after running drmgr.  The processor values are reloaded on
+ * the next lookup; memory block changes arrive as uevents, unless
+ * those are not available.
+ */
+void
+topology_invalidate(void)
+{
+	topo.lparcfg_valid = 0;
+	if (topo.uevent_fd < 0)
+		topo.memory_valid = 0;
+}
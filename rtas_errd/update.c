@@ -11,6 +11,11 @@
  * syslog and /var/log/platform. If they are not equal, we process
  * RTAS events from syslog until they are equal.
  *
+ * The inode, offset and last RTAS event number reached in syslog are
+ * saved in <platform_log>.msgs so that only messages written since the
+ * previous run, plus the tail of the most recently rotated syslog, need
+ * to be searched.
+ *
  * Copyright (C) 2004 IBM Corporation
  *
  * This program is free software; you can redistribute it and/or
@@ -28,36 +33,27 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>
+#include <glob.h>
+#include <endian.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include "rtas_errd.h"
 
 /**
- * @def BM_ARRAY_SIZE
- * @brief Array size for Boyer-Moore algorithm
- */
-#define BM_ARRAY_SIZE	256
-
-#define RTAS_START	"RTAS event begin"
-#define RTAS_END	"RTAS event end"
-
-/**
- * @var bad_char_start
- * @brief Boyer-Moore bad character array for finding RTAS event starts.
+ * @def MSGS_CKPT_MAGIC
+ * @brief Tag at the start of the syslog checkpoint file
  */
-int bad_char_start[BM_ARRAY_SIZE] = {-1};
-/**
- * @var bad_char_end
- * @brief Boyer-Moore bad character array for finding RTAS event ends.
- */
-int bad_char_end[BM_ARRAY_SIZE] = {-1};
+#define MSGS_CKPT_MAGIC		"RTASMSGS"
+#define MSGS_CKPT_VERSION	1
 
 /** 
  * @var messages_log 
@@ -74,60 +70,40 @@ char *messages_log = NULL;
 static int msgs_log_fd = -1;
 
 /**
- * setup_bc
- * @brief Initalize the bad character array for a Boyer-Moore search
- * 
- * @param str search string to initialize the array with
- * @param strlen search string length
- * @param bc bad character array to be initialized
+ * struct msgs_ckpt
+ * @brief Where the previous syslog reconciliation stopped
+ *
+ * Saved in <platform_log>.msgs so that the next daemon start only
+ * has to look at the part of syslog written since then.
  */
-void
-setup_bc(char *str, int strlen, int *bc)
-{
-	int i;
-	for (i = 0; i < BM_ARRAY_SIZE; i++)
-		bc[i] = strlen;
-	for (i = 0; i < (strlen - 1); i++)
-		bc[(int)str[i]] = strlen - i - 1;
-}
+struct msgs_ckpt {
+	ino_t	ino;		/**< inode of the syslog file that was scanned */
+	off_t	offset;		/**< first byte not yet scanned */
+	int	last_no;	/**< last RTAS event number seen in syslog */
+};
 
 /**
  * find_event
  * @brief Find an RTAS event
  * 
- * Search for a RTAS event in the given text.  This uses a scaled 
- * down version of the Boyer-Moore algorithm.  Since we know the 
- * search strings we also know there really isn't a good suffix worth 
- * looking for.  Thus we do not	use the good suffix rule for this search.
+ * Search for a RTAS event marker in the given text.  This is a thin
+ * wrapper around memmem(), which glibc implements with word-at-a-time
+ * and vector scanning for the first byte of the needle; that is far
+ * faster on large syslog files than comparing a byte at a time.
  *
  * @param str string to search for
  * @param strlen length of search string
- * @param text text to search for string in
- * @param textlen length of text to search
- * @param bad_char bad character array for Boyer-Moore search
+ * @param textstart text to search for string in
+ * @param textend end of text to search
  * @return pointer to string in text on success, NULL on failure
  */
-char *
-find_event(char *str, int strlen, char *text, int textlen, int bad_char[])
+static char *
+find_event(const char *str, size_t strlen, char *textstart, char *textend)
 {
-	int	i, j = 0;
-
-	while (j <= (textlen - strlen)) {
-		/* for (i = (strlen - 1); i >= 0 && str[i] == text[i+j]; i--);*/
-                i = strlen - 1;
-                while ((i >= 0) && (str[i] == text[i+j])) {
-                    i--;
-                }
-		if (i < 0)
-			return &text[j];
-		else
-			/* Since we're not using the good suffix rule
-			 * we need to guarantee progress.
-			 */
-                        j += MAX(1, bad_char[(int)text[i+j]] - strlen + 1 + i);
-	}
+	if (textstart == NULL || textend <= textstart)
+		return NULL;
 
-	return NULL;
+	return memmem(textstart, textend - textstart, str, strlen);
 }
 
 /** 
@@ -141,14 +117,8 @@ find_event(char *str, int strlen, char *text, int textlen, int bad_char[])
 char *
 find_rtas_start(char *textstart, char *textend)
 {
-	if (textstart == NULL)
-		return NULL;
-
-	if (bad_char_start[0] == -1)
-		setup_bc(RTAS_START, strlen(RTAS_START), bad_char_start);
-
-	return find_event(RTAS_START, strlen(RTAS_START), textstart,
-			  textend - textstart, bad_char_start);
+	return find_event(RTAS_START, sizeof(RTAS_START) - 1, textstart,
+			  textend);
 }
 
 /** 
@@ -162,14 +132,8 @@ find_rtas_start(char *textstart, char *textend)
 char *
 find_rtas_end(char *textstart, char *textend)
 {
-	if (textstart == NULL)
-		return NULL;
-
-	if (bad_char_end[0] == -1)
-		setup_bc(RTAS_END, strlen(RTAS_END), bad_char_end);
-
-	return find_event(RTAS_END, strlen(RTAS_END), textstart,
-			  textend - textstart, bad_char_end);
+	return find_event(RTAS_END, sizeof(RTAS_END) - 1, textstart,
+			  textend);
 }
 
 /**
@@ -195,6 +159,400 @@ get_rtas_no(char *ptr)
 
 	return strtoul(ptr, NULL, 10);
 }
+/**
+ * msgs_ckpt_path
+ * @brief Build the path of the syslog checkpoint file
+ *
+ * @param buf buffer to hold the path
+ * @param len size of buf
+ */
+static void
+msgs_ckpt_path(char *buf, size_t len)
+{
+	snprintf(buf, len, "%s.msgs", platform_log);
+}
+
+/**
+ * read_msgs_ckpt
+ * @brief Read the checkpoint left by the previous reconciliation
+ *
+ * @param ckpt checkpoint to fill in
+ * @return 0 on success, -1 if there is no usable checkpoint
+ */
+static int
+read_msgs_ckpt(struct msgs_ckpt *ckpt)
+{
+	char	path[PATH_MAX + 8];
+	unsigned long long ino, offset;
+	int	version, last_no;
+	FILE	*fp;
+	int	rc;
+
+	msgs_ckpt_path(path, sizeof(path));
+	fp = fopen(path, "r");
+	if (fp == NULL)
+		return -1;
+
+	rc = fscanf(fp, MSGS_CKPT_MAGIC " %d %llu %llu %d", &version,
+		    &ino, &offset, &last_no);
+	fclose(fp);
+
+	if (rc != 4 || version != MSGS_CKPT_VERSION) {
+		dbg("Ignoring invalid syslog checkpoint %s", path);
+		return -1;
+	}
+
+	ckpt->ino = ino;
+	ckpt->offset = offset;
+	ckpt->last_no = last_no;
+	return 0;
+}
+
+/**
+ * write_msgs_ckpt
+ * @brief Save where this reconciliation stopped
+ *
+ * The checkpoint is written to a temporary file and renamed into
+ * place so a crash never leaves a half written checkpoint behind.
+ *
+ * @param ckpt checkpoint to save
+ */
+static void
+write_msgs_ckpt(struct msgs_ckpt *ckpt)
+{
+	char	path[PATH_MAX + 8];
+	char	tmp_path[PATH_MAX + 16];
+	FILE	*fp;
+
+	msgs_ckpt_path(path, sizeof(path));
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+	fp = fopen(tmp_path, "w");
+	if (fp == NULL) {
+		log_msg(NULL, "Could not create syslog checkpoint %s, %s",
+			tmp_path, strerror(errno));
+		return;
+	}
+
+	fprintf(fp, MSGS_CKPT_MAGIC " %d %llu %llu %d\n", MSGS_CKPT_VERSION,
+		(unsigned long long)ckpt->ino,
+		(unsigned long long)ckpt->offset, ckpt->last_no);
+
+	if (fclose(fp) || rename(tmp_path, path)) {
+		log_msg(NULL, "Could not write syslog checkpoint %s, %s",
+			path, strerror(errno));
+		unlink(tmp_path);
+	}
+}
+
+/**
+ * open_rotated_log
+ * @brief Open the newest rotated copy of messages_log
+ *
+ * logrotate names the previous log either <log>.1 or, with dateext,
+ * <log>-YYYYMMDD.  Only the copy that was the live log when the
+ * checkpoint was taken is of any use, so match it by inode.
+ *
+ * @param ino inode recorded in the checkpoint
+ * @param sbuf filled in with the status of the rotated log
+ * @return file descriptor on success, -1 if it was not found
+ */
+static int
+open_rotated_log(ino_t ino, struct stat *sbuf)
+{
+	char	pattern[PATH_MAX];
+	glob_t	gl;
+	int	fd = -1;
+	size_t	i;
+
+	snprintf(pattern, sizeof(pattern), "%s.1", messages_log);
+	if (stat(pattern, sbuf) == 0 && sbuf->st_ino == ino)
+		return open(pattern, O_RDONLY);
+
+	snprintf(pattern, sizeof(pattern), "%s-[0-9]*", messages_log);
+	if (glob(pattern, 0, NULL, &gl))
+		return -1;
+
+	/* glob() sorts its results, the newest date is last */
+	for (i = gl.gl_pathc; i > 0; i--) {
+		if (stat(gl.gl_pathv[i - 1], sbuf) || sbuf->st_ino != ino)
+			continue;
+
+		fd = open(gl.gl_pathv[i - 1], O_RDONLY);
+		break;
+	}
+
+	globfree(&gl);
+	return fd;
+}
+
+/**
+ * rtas_text_to_buf
+ * @brief Convert the hexdump of an RTAS event back to binary
+ *
+ * Works on both the syslog and the platform log copy of an event.  The
+ * "RTAS: " lines (the end marker, the scanlog line in the platform log)
+ * hold no event data, the data lines are "RTAS <line>: ".
+ *
+ * @param tmp text of the event, just past the "RTAS event begin" marker
+ * @param rtas_msgs_end pointer to the "RTAS event end" marker
+ * @param buf buffer to fill in
+ * @param size size of buf
+ * @return number of bytes of buf filled in
+ */
+static size_t
+rtas_text_to_buf(char *tmp, char *rtas_msgs_end, char *buf, size_t size)
+{
+	uint32_t	*out_buf = (uint32_t *)buf;
+	unsigned long	val;
+	char		*val_end;
+	size_t		len = 0;
+	int		i;
+
+	while (tmp < rtas_msgs_end) {
+		/* find the word "RTAS" */
+		for ( ; tmp < rtas_msgs_end && *tmp != 'R'; tmp++);
+		if (tmp >= rtas_msgs_end || strncmp(tmp++, "RTAS", 4) != 0)
+			continue;
+
+		/* no data on the "RTAS: " lines */
+		tmp += 3;
+		if (*tmp == ':')
+			continue;
+
+		/* we found "RTAS", go to the colon */
+		for( ; tmp < rtas_msgs_end && *tmp != ':'; tmp++);
+
+		/* add two to get to the first value */
+		tmp += 2;
+
+		/* parse the values, the last line may hold fewer than 4 */
+		for (i = 0; i < 4 && len + sizeof(*out_buf) <= size; i++) {
+			val = strtoul(tmp, &val_end, 16);
+			if (val_end == tmp || memchr(tmp, '\n', val_end - tmp))
+				break;
+
+			/* the hexdump shows the bytes in event order */
+			*out_buf = htobe32(val);
+			out_buf++;
+			len += sizeof(*out_buf);
+			tmp = val_end;
+		}
+	}
+
+	return len;
+}
+
+/**
+ * platform_event_differs
+ * @brief Check the platform log event with the number of a syslog event
+ *
+ * The event is read back from the platform log through its index and
+ * compared with the copy in syslog.
+ *
+ * @param rtas_msgs_start pointer to the "RTAS event begin" marker
+ * @param rtas_msgs_end pointer to the "RTAS event end" marker
+ * @param rtas_no event number
+ * @return 1 if the platform log has a different event by that number,
+ *	   0 if it is the same one or that cannot be told
+ */
+static int
+platform_event_differs(char *rtas_msgs_start, char *rtas_msgs_end,
+		       int rtas_no)
+{
+	static char	log_buf[RTAS_ERROR_LOG_MAX];
+	static char	msgs_buf[RTAS_ERROR_LOG_MAX];
+	char		*text, *log_start, *log_end;
+	size_t		text_len, log_len, msgs_len;
+	int		rc = 0;
+
+	text = platform_log_read_event(rtas_no, &text_len);
+	if (text == NULL)
+		return 0;
+
+	log_start = find_rtas_start(text, text + text_len);
+	log_end = find_rtas_end(log_start, text + text_len);
+	if (log_start != NULL && log_end != NULL) {
+		log_len = rtas_text_to_buf(log_start + strlen(RTAS_START),
+					   log_end, log_buf, sizeof(log_buf));
+		msgs_len = rtas_text_to_buf(rtas_msgs_start +
+					    strlen(RTAS_START), rtas_msgs_end,
+					    msgs_buf, sizeof(msgs_buf));
+
+		/* syslog may have more of the event than was written out */
+		if (msgs_len < log_len)
+			log_len = msgs_len;
+
+		rc = log_len && memcmp(log_buf, msgs_buf, log_len);
+	}
+
+	free(text);
+	return rc;
+}
+
+/**
+ * update_rtas_event
+ * @brief Rebuild an RTAS event from syslog and handle it
+ *
+ * @param rtas_msgs_start pointer to the "RTAS event begin" marker
+ * @param rtas_msgs_end pointer to the "RTAS event end" marker
+ * @param rtas_no event number
+ */
+static void
+update_rtas_event(char *rtas_msgs_start, char *rtas_msgs_end, int rtas_no)
+{
+	struct event	*event;
+	uint64_t	start;
+
+	event = event_get();
+	if (event == NULL)
+		return;
+
+	memset(event->event_buf, 0, sizeof(event->event_buf));
+
+	/* skip past the "RTAS event begin" message */
+	rtas_text_to_buf(rtas_msgs_start + strlen(RTAS_START), rtas_msgs_end,
+			 event->event_buf, sizeof(event->event_buf));
+
+	/* Initializethe fields of the rtas event */
+	event->seq_num = rtas_no;
+
+	start = stats_now();
+	event->rtas_event = parse_rtas_event(event->event_buf,
+					     RTAS_ERROR_LOG_MAX);
+	if (event->rtas_event == NULL) {
+		log_msg(NULL, "Could not update RTAS Event %d to %s",
+			rtas_no, platform_log);
+		event_put(event);
+		return;
+	}
+
+	log_msg(NULL, "Updating RTAS event %d to %s", rtas_no, platform_log);
+
+	event->rtas_hdr = rtas_get_event_hdr_scn(event->rtas_event);
+	if (event->rtas_hdr == NULL) {
+		log_msg(NULL, "Could not update RTAS Event %d to %s",
+			rtas_no, platform_log);
+		event_put(event);
+		return;
+	}
+	event->length = event->rtas_hdr->ext_log_length + 8;
+
+	/* Counted by type just like events read from the kernel */
+	stats_event_begin(event->rtas_hdr->type);
+	stats_record(STAGE_PARSE, start);
+
+	start = stats_now();
+	handle_rtas_event(event);
+	stats_record(STAGE_EVENT, start);
+	stats_event_end();
+
+	event_put(event);
+}
+
+/**
+ * scan_msgs_log
+ * @brief Process the RTAS events in part of a syslog file
+ *
+ * Any RTAS event newer than the last one in the platform log, and
+ * not already recorded there, is handled.  NOTE:  There are scenarios
+ * in which we will process events that have already been processed.
+ * There is not much we can do about this, just accept it and move
+ * along.
+ *
+ * RTAS event numbers start over when the partition reboots.  When
+ * syslog shows a number lower than the one before it, the platform
+ * log is compared against the new numbering from then on: if its
+ * last event is numbered below where syslog restarted it has been
+ * written since the restart too, otherwise it has nothing from the
+ * new numbering and every following event is handled (last_log_no
+ * is set to -1 for this, the index only knows the old numbering).
+ * Syslog does not always show the restart, e.g. when it was rotated
+ * at boot, so an event numbered like one the platform log already
+ * has is compared with that event, read back through the index.  If
+ * they differ the numbers restarted all the same.
+ *
+ * @param fd syslog file descriptor
+ * @param name syslog file name, for messages
+ * @param start offset to start scanning from; must be a line start
+ * @param size size of the syslog file
+ * @param last_log_no last RTAS event number in the platform log,
+ *	  updated if syslog shows the numbers restarting
+ * @param last_msgs_no updated with the last RTAS event number seen
+ * @return offset the next scan of this file should start from
+ */
+static off_t
+scan_msgs_log(int fd, const char *name, off_t start, off_t size,
+	      int *last_log_no, int *last_msgs_no)
+{
+	char	*msgs_mmap, *msgs_mmap_end;
+	char	*text, *line, *rtas_msgs_start, *rtas_msgs_end;
+	off_t	map_start;
+	size_t	map_len;
+	off_t	resume;
+	int	rtas_no;
+
+	if (start >= size)
+		return size;
+
+	map_start = start & ~((off_t)getpagesize() - 1);
+	map_len = size - map_start;
+
+	msgs_mmap = mmap(0, map_len, PROT_READ, MAP_PRIVATE, fd, map_start);
+	if (msgs_mmap == MAP_FAILED) {
+		log_msg(NULL, "Cannot map %s to update RTAS events, %s",
+			name, strerror(errno));
+		return start;
+	}
+
+	text = msgs_mmap + (start - map_start);
+	msgs_mmap_end = msgs_mmap + map_len;
+
+	/* Only consume complete lines, syslog may be mid-write */
+	line = memrchr(text, '\n', msgs_mmap_end - text);
+	resume = line ? map_start + (line + 1 - msgs_mmap) : start;
+
+	rtas_msgs_start = find_rtas_start(text, msgs_mmap_end);
+	while (rtas_msgs_start != NULL) {
+		rtas_msgs_end = find_rtas_end(rtas_msgs_start, msgs_mmap_end);
+		if (rtas_msgs_end == NULL) {
+			/* The rest of this event has not reached syslog
+			 * yet, pick it up from its first line next time.
+			 */
+			line = memrchr(text, '\n', rtas_msgs_start - text);
+			line = line ? line + 1 : text;
+			resume = map_start + (line - msgs_mmap);
+			break;
+		}
+
+		rtas_no = get_rtas_no(rtas_msgs_start);
+		if (rtas_no < *last_msgs_no) {
+			dbg("RTAS event numbers restarted at %d in %s",
+			    rtas_no, name);
+			if (*last_log_no >= *last_msgs_no)
+				*last_log_no = -1;
+		}
+		*last_msgs_no = rtas_no;
+
+		if (rtas_no > *last_log_no) {
+			update_rtas_event(rtas_msgs_start, rtas_msgs_end,
+					  rtas_no);
+		} else if (platform_event_differs(rtas_msgs_start,
+						  rtas_msgs_end, rtas_no)) {
+			dbg("RTAS event %d in %s is not the one in %s, the "
+			    "numbers restarted", rtas_no, name, platform_log);
+			*last_log_no = -1;
+			update_rtas_event(rtas_msgs_start, rtas_msgs_end,
+					  rtas_no);
+		}
+
+		rtas_msgs_start = find_rtas_start(rtas_msgs_end,
+						  msgs_mmap_end);
+	}
+
+	munmap(msgs_mmap, map_len);
+	return resume;
+}
 
 /**
  * update_rtas_msgs
@@ -202,23 +560,30 @@ get_rtas_no(char *ptr)
  *
  * Update the file /var/log/platform with any RTAS events
  * found in syslog that have not been handled by rtas_errd.
+ *
+ * Only the part of syslog written since the previous call is
+ * scanned.  If syslog has been rotated since then, the tail of the
+ * rotated copy is scanned first and the new log from its start.
  */
 void
 update_rtas_msgs(void)
 {
-	struct stat	log_sbuf, msgs_sbuf;
+	struct stat	log_sbuf, msgs_sbuf, old_sbuf;
+	struct msgs_ckpt ckpt;
 	char		*log_mmap = NULL, *log_mmap_end;
-	char		*msgs_mmap = NULL, *msgs_mmap_end;
-	char		*rtas_msgs_end, *rtas_msgs_start, *msgs_p;
 	char		*log_p;
 	char		*last_p;
-	int		last_rtas_log_no, last_rtas_msgs_no, cur_rtas_no;
-
-	messages_log = "/var/log/messages";
-	if (access(messages_log, R_OK)) {
-		/* try /var/log/syslog */
-		if (!access("/var/log/syslog", R_OK)) {
-			messages_log = "/var/log/syslog";
+	int		last_rtas_log_no, last_rtas_msgs_no;
+	int		have_ckpt, old_fd;
+	off_t		start = 0;
+
+	if (messages_log == NULL) {
+		messages_log = "/var/log/messages";
+		if (access(messages_log, R_OK)) {
+			/* try /var/log/syslog */
+			if (!access("/var/log/syslog", R_OK)) {
+				messages_log = "/var/log/syslog";
+			}
 		}
 	}
 
@@ -234,21 +599,19 @@ update_rtas_msgs(void)
 		goto cleanup;
 	}
 
-	/* abort if file size is zero */
-	if (msgs_sbuf.st_size == 0) {
+	have_ckpt = (read_msgs_ckpt(&ckpt) == 0);
+	if (have_ckpt && ckpt.ino == msgs_sbuf.st_ino &&
+	    ckpt.offset == msgs_sbuf.st_size) {
+		dbg("No new messages in %s since the last RTAS event %d",
+		    messages_log, ckpt.last_no);
 		goto cleanup;
 	}
 
-	if ((msgs_mmap = mmap(0, msgs_sbuf.st_size, PROT_READ, MAP_PRIVATE,
-			      msgs_log_fd, 0)) == (char *)-1) {
-		log_msg(NULL, "Cannot map %s to update RTAS events",
-			messages_log);
-		msgs_mmap = NULL;
+	/* A freshly rotated, still empty syslog leaves only the tail of
+	 * the rotated copy to look at, so go on if there is one.
+	 */
+	if (msgs_sbuf.st_size == 0 && !have_ckpt)
 		goto cleanup;
-	}
-
-        msgs_p = msgs_mmap;
-	msgs_mmap_end = msgs_mmap + msgs_sbuf.st_size;
 
 	if ((fstat(platform_log_fd, &log_sbuf)) < 0) {
 		log_msg(NULL, "Cannot get status of %s to update RTAS events",
@@ -260,141 +623,70 @@ update_rtas_msgs(void)
 	if (log_sbuf.st_size == 0)
 		goto cleanup;
 
-	if ((log_mmap = mmap(0, log_sbuf.st_size, PROT_READ, MAP_PRIVATE,
-			     platform_log_fd, 0)) == (char *)-1) {
-		log_msg(NULL, "Cannot map %s to update RTAS events, %s",
-			platform_log, strerror(errno));
-		log_mmap = NULL;
-		goto cleanup;
-	}
-
-	log_p = log_mmap;
-	log_mmap_end = log_mmap + log_sbuf.st_size;
-
-	/* find the last RTAS event in /var/log/platform */
-	last_p = NULL;
-	log_p = find_rtas_start(log_p, log_mmap_end);
-	while (log_p != NULL) {
-		last_p = log_p;
-		log_p = find_rtas_start(log_p + sizeof(RTAS_START),
-					log_mmap_end);
-	}
-
-	if (last_p == NULL)
-		last_rtas_log_no = 0;
-	else
-		last_rtas_log_no = get_rtas_no(last_p);
-
-	/* We're finished with /var/log/platform; unamp it */
-	munmap(log_mmap, log_sbuf.st_size);
-	log_mmap = NULL;
-
-	/* find the last RTAS event in syslog */
-	last_p = NULL;
-	msgs_p = find_rtas_start(msgs_p, msgs_mmap_end);
-	while (msgs_p != NULL) {
-		last_p = msgs_p;
-		msgs_p = find_rtas_start(msgs_p + strlen(RTAS_START),
-					 msgs_mmap_end);
-	}
-
-	if (last_p == NULL) {
-		dbg("%s does not contain any RTAS events", messages_log);
-		goto cleanup;
-	}
-
-	last_rtas_msgs_no = get_rtas_no(last_p);
-
-	if (last_rtas_log_no >= last_rtas_msgs_no)
-		goto cleanup;
-
-	/*
-	 *  If we get here we know there are some events that have not
-	 *  been processed by rtas_errd, process them now.  NOTE:  There
-	 *  are scenarios in which we will process events that have 
-	 *  already been processed.  There is not much we can do about
-	 *  this, just accept it and move along.
-	 */
-
-	/* Move to the first event that has not been handled so we
-	 * can process them in order.
+	/* find the last RTAS event in /var/log/platform, the index
+	 * saves us from searching through the whole log.
 	 */
-	cur_rtas_no = 0;
-	rtas_msgs_start = msgs_mmap;
-	while (cur_rtas_no <= last_rtas_log_no) {
-		rtas_msgs_start =
-			find_rtas_start(rtas_msgs_start + strlen(RTAS_START),
-					msgs_mmap_end);
-		cur_rtas_no = get_rtas_no(rtas_msgs_start);
-	}
-
-	rtas_msgs_end = find_rtas_end(rtas_msgs_start, msgs_mmap_end);
-
-	/* Retrieve RTAS events from syslog */
-	while (rtas_msgs_start != NULL) {
-		struct event event;
-		unsigned long	*out_buf;
-		char		*tmp = rtas_msgs_start;
-
-		memset(&event, 0, sizeof(event));
-
-		out_buf = (unsigned long *)event.event_buf;
-
-		/* put event number in first */
-		cur_rtas_no = get_rtas_no(rtas_msgs_start);
-
-
-                /* skip past the "RTAS event begin" message */
-                tmp += strlen(RTAS_START);
-
-		while (tmp < rtas_msgs_end) {
-                        int i;
-
-			/* find the word "RTAS" */
-			for ( ; *tmp != 'R'; tmp++);
-			if (strncmp(tmp++, "RTAS", 4) != 0)
-				continue;
-
-			/* we found "RTAS", go to the colon */
-			for( ; *tmp != ':'; tmp++);
+	last_rtas_log_no = platform_index_last();
+	if (last_rtas_log_no < 0) {
+		if ((log_mmap = mmap(0, log_sbuf.st_size, PROT_READ,
+				     MAP_PRIVATE, platform_log_fd,
+				     0)) == (char *)-1) {
+			log_msg(NULL, "Cannot map %s to update RTAS events, "
+				"%s", platform_log, strerror(errno));
+			log_mmap = NULL;
+			goto cleanup;
+		}
 
-			/* add two to get to the first value */
-			tmp += 2;
+		log_p = log_mmap;
+		log_mmap_end = log_mmap + log_sbuf.st_size;
 
-			/* parse the values */
-                        for (i = 0; i < 4; i++) {
-				*out_buf = strtoul(tmp, NULL, 16);
-				out_buf++;
-				tmp += 9; /* char hex value + space */
-			}
+		last_p = NULL;
+		log_p = find_rtas_start(log_p, log_mmap_end);
+		while (log_p != NULL) {
+			last_p = log_p;
+			log_p = find_rtas_start(log_p + sizeof(RTAS_START),
+						log_mmap_end);
 		}
 
-		/* Initializethe fields of the rtas event */
-		event.seq_num = cur_rtas_no;
-
-		event.rtas_event = parse_rtas_event(event.event_buf,
-						    RTAS_ERROR_LOG_MAX);
-		if (event.rtas_event == NULL) {
-			log_msg(NULL, "Could not update RTAS Event %d to %s",
-				cur_rtas_no, platform_log);
-		} else {
-			log_msg(NULL, "Updating RTAS event %d to %s",
-				cur_rtas_no, platform_log);
+		if (last_p == NULL)
+			last_rtas_log_no = 0;
+		else
+			last_rtas_log_no = get_rtas_no(last_p);
 
-			event.rtas_hdr =
-				rtas_get_event_hdr_scn(event.rtas_event);
-			event.length = event.rtas_hdr->ext_log_length + 8;
+		/* We're finished with /var/log/platform; unamp it */
+		munmap(log_mmap, log_sbuf.st_size);
+		log_mmap = NULL;
+	}
 
-			handle_rtas_event(&event);
+	last_rtas_msgs_no = 0;
+
+	if (have_ckpt && ckpt.ino == msgs_sbuf.st_ino) {
+		/* same file; if it shrank it was truncated in place */
+		if (ckpt.offset < msgs_sbuf.st_size)
+			start = ckpt.offset;
+		last_rtas_msgs_no = ckpt.last_no;
+	} else if (have_ckpt) {
+		/* syslog was rotated, finish the old file first */
+		old_fd = open_rotated_log(ckpt.ino, &old_sbuf);
+		if (old_fd >= 0) {
+			dbg("Checking rotated %s from offset %llu",
+			    messages_log, (unsigned long long)ckpt.offset);
+			last_rtas_msgs_no = ckpt.last_no;
+			scan_msgs_log(old_fd, messages_log, ckpt.offset,
+				      old_sbuf.st_size, &last_rtas_log_no,
+				      &last_rtas_msgs_no);
+			close(old_fd);
 		}
-
-		rtas_msgs_start = find_rtas_start(rtas_msgs_end, msgs_mmap_end);
-		rtas_msgs_end = find_rtas_end(rtas_msgs_start, msgs_mmap_end);
 	}
 
+	ckpt.ino = msgs_sbuf.st_ino;
+	ckpt.offset = scan_msgs_log(msgs_log_fd, messages_log, start,
+				    msgs_sbuf.st_size, &last_rtas_log_no,
+				    &last_rtas_msgs_no);
+	ckpt.last_no = last_rtas_msgs_no;
+	write_msgs_ckpt(&ckpt);
+
 cleanup:
-	if (msgs_mmap)
-		munmap(msgs_mmap, msgs_sbuf.st_size);
 	if (msgs_log_fd != -1)
 		close(msgs_log_fd);
 
@@ -26,124 +26,9 @@
 #include <sys/types.h>
 
 #include "rtas_errd.h"
-#include "ela_msg.h"
+#include "v6ela_msg.h"
 #include "dchrp.h"
 
-#define V6_ERROR_MSG	0
-#define V6_EVENT_MSG	1
-
-#define NUM_SUBID	12
-#define NUM_SEVERITY	14
-#define NUM_SUBTYPE	14
-
-/* 
- * Table of V6 Error Messages. Each message, V6_ER_ss_vv,  is addressable 
- * by the Subsystem Id ("ss") and the Error Severity ("vv"). 
- */
-char *v6_error[NUM_SUBID][NUM_SEVERITY] = {
-	{V6_ER_10_00, V6_ER_10_10, V6_ER_10_20, V6_ER_10_21, V6_ER_10_22,
-	 V6_ER_10_23, V6_ER_10_24, V6_ER_10_40, V6_ER_10_41, V6_ER_10_44,
-	 V6_ER_10_45, V6_ER_10_48, V6_ER_10_60, V6_ER_10_61},
-
-	{V6_ER_20_00, V6_ER_20_10, V6_ER_20_20, V6_ER_20_21, V6_ER_20_22,
-	 V6_ER_20_23, V6_ER_20_24, V6_ER_20_40, V6_ER_20_41, V6_ER_20_44,
-	 V6_ER_20_45, V6_ER_20_48, V6_ER_20_60, V6_ER_20_61},
-
-	{V6_ER_30_00, V6_ER_30_10, V6_ER_30_20, V6_ER_30_21, V6_ER_30_22,
-	 V6_ER_30_23, V6_ER_30_24, V6_ER_30_40, V6_ER_30_41, V6_ER_30_44,
-	 V6_ER_30_45, V6_ER_30_48, V6_ER_30_60, V6_ER_30_61},
-
-	{V6_ER_40_00, V6_ER_40_10, V6_ER_40_20, V6_ER_40_21, V6_ER_40_22,
-	 V6_ER_40_23, V6_ER_40_24, V6_ER_40_40, V6_ER_40_41, V6_ER_40_44,
-	 V6_ER_40_45, V6_ER_40_48, V6_ER_40_60, V6_ER_40_61},
-
-	{V6_ER_50_00, V6_ER_50_10, V6_ER_50_20, V6_ER_50_21, V6_ER_50_22,
-	 V6_ER_50_23, V6_ER_50_24, V6_ER_50_40, V6_ER_50_41, V6_ER_50_44,
-	 V6_ER_50_45, V6_ER_50_48, V6_ER_50_60, V6_ER_50_61},
-
-	{V6_ER_60_00, V6_ER_60_10, V6_ER_60_20, V6_ER_60_21, V6_ER_60_22,
-	 V6_ER_60_23, V6_ER_60_24, V6_ER_60_40, V6_ER_60_41, V6_ER_60_44,
-	 V6_ER_60_45, V6_ER_60_48, V6_ER_60_60, V6_ER_60_61},
-
-	{V6_ER_70_00, V6_ER_70_10, V6_ER_70_20, V6_ER_70_21, V6_ER_70_22,
-	 V6_ER_70_23, V6_ER_70_24, V6_ER_70_40, V6_ER_70_41, V6_ER_70_44,
-	 V6_ER_70_45, V6_ER_70_48, V6_ER_70_60, V6_ER_70_61},
-
-	{V6_ER_7A_00, V6_ER_7A_10, V6_ER_7A_20, V6_ER_7A_21, V6_ER_7A_22,
-	 V6_ER_7A_23, V6_ER_7A_24, V6_ER_7A_40, V6_ER_7A_41, V6_ER_7A_44,
-	 V6_ER_7A_45, V6_ER_7A_48, V6_ER_7A_60, V6_ER_7A_61},
-
-	{V6_ER_80_00, V6_ER_80_10, V6_ER_80_20, V6_ER_80_21, V6_ER_80_22,
-	 V6_ER_80_23, V6_ER_80_24, V6_ER_80_40, V6_ER_80_41, V6_ER_80_44,
-	 V6_ER_80_45, V6_ER_80_48, V6_ER_80_60, V6_ER_80_61},
-
-	{V6_ER_90_00, V6_ER_90_10, V6_ER_90_20, V6_ER_90_21, V6_ER_90_22,
-	 V6_ER_90_23, V6_ER_90_24, V6_ER_90_40, V6_ER_90_41, V6_ER_90_44,
-	 V6_ER_90_45, V6_ER_90_48, V6_ER_90_60, V6_ER_90_61},
-
-	{V6_ER_A0_00, V6_ER_A0_10, V6_ER_A0_20, V6_ER_A0_21, V6_ER_A0_22,
-	 V6_ER_A0_23, V6_ER_A0_24, V6_ER_A0_40, V6_ER_A0_41, V6_ER_A0_44,
-	 V6_ER_A0_45, V6_ER_A0_48, V6_ER_A0_60, V6_ER_A0_61},
-
-	{V6_ER_B0_00, V6_ER_B0_10, V6_ER_B0_20, V6_ER_B0_21, V6_ER_B0_22,
-	 V6_ER_B0_23, V6_ER_B0_24, V6_ER_B0_40, V6_ER_B0_41, V6_ER_B0_44,
-	 V6_ER_B0_45, V6_ER_B0_48, V6_ER_B0_60, V6_ER_B0_61}
-};
-
-/* 
- * Table of V6 Event Messages. Each message, V6_EV_ss_tt,  is addressable 
- * by the Subsystem Id ("ss") and the Event Subtype ("tt"). 
- */
-char *v6_event[NUM_SUBID][NUM_SUBTYPE] = {
-	{V6_EV_10_00, V6_EV_10_01, V6_EV_10_08, V6_EV_10_10, V6_EV_10_20,
-	 V6_EV_10_21, V6_EV_10_22, V6_EV_10_30, V6_EV_10_40, V6_EV_10_60,
-	 V6_EV_10_70, V6_EV_10_80, V6_EV_10_D0, V6_EV_10_E0},
-
-	{V6_EV_20_00, V6_EV_20_01, V6_EV_20_08, V6_EV_20_10, V6_EV_20_20,
-	 V6_EV_20_21, V6_EV_20_22, V6_EV_20_30, V6_EV_20_40, V6_EV_20_60,
-	 V6_EV_20_70, V6_EV_20_80, V6_EV_20_D0, V6_EV_20_E0},
-
-	{V6_EV_30_00, V6_EV_30_01, V6_EV_30_08, V6_EV_30_10, V6_EV_30_20,
-	 V6_EV_30_21, V6_EV_30_22, V6_EV_30_30, V6_EV_30_40, V6_EV_30_60,
-	 V6_EV_30_70, V6_EV_30_80, V6_EV_30_D0, V6_EV_30_E0},
-
-	{V6_EV_40_00, V6_EV_40_01, V6_EV_40_08, V6_EV_40_10, V6_EV_40_20,
-	 V6_EV_40_21, V6_EV_40_22, V6_EV_40_30, V6_EV_40_40, V6_EV_40_60,
-	 V6_EV_40_70, V6_EV_40_80, V6_EV_40_D0, V6_EV_40_E0},
-
-	{V6_EV_50_00, V6_EV_50_01, V6_EV_50_08, V6_EV_50_10, V6_EV_50_20,
-	 V6_EV_50_21, V6_EV_50_22, V6_EV_50_30, V6_EV_50_40, V6_EV_50_60,
-	 V6_EV_50_70, V6_EV_50_80, V6_EV_50_D0, V6_EV_50_E0},
-
-	{V6_EV_60_00, V6_EV_60_01, V6_EV_60_08, V6_EV_60_10, V6_EV_60_20,
-	 V6_EV_60_21, V6_EV_60_22, V6_EV_60_30, V6_EV_60_40, V6_EV_60_60,
-	 V6_EV_60_70, V6_EV_60_80, V6_EV_60_D0, V6_EV_60_E0},
-
-	{V6_EV_70_00, V6_EV_70_01, V6_EV_70_08, V6_EV_70_10, V6_EV_70_20,
-	 V6_EV_70_21, V6_EV_70_22, V6_EV_70_30, V6_EV_70_40, V6_EV_70_60,
-	 V6_EV_70_70, V6_EV_70_80, V6_EV_70_D0, V6_EV_70_E0},
-
-	{V6_EV_7A_00, V6_EV_7A_01, V6_EV_7A_08, V6_EV_7A_10, V6_EV_7A_20,
-	 V6_EV_7A_21, V6_EV_7A_22, V6_EV_7A_30, V6_EV_7A_40, V6_EV_7A_60,
-	 V6_EV_7A_70, V6_EV_7A_80, V6_EV_7A_D0, V6_EV_7A_E0},
-
-	{V6_EV_80_00, V6_EV_80_01, V6_EV_80_08, V6_EV_80_10, V6_EV_80_20,
-	 V6_EV_80_21, V6_EV_80_22, V6_EV_80_30, V6_EV_80_40, V6_EV_80_60,
-	 V6_EV_80_70, V6_EV_80_80, V6_EV_80_D0, V6_EV_80_E0},
-
-	{V6_EV_90_00, V6_EV_90_01, V6_EV_90_08, V6_EV_90_10, V6_EV_90_20,
-	 V6_EV_90_21, V6_EV_90_22, V6_EV_90_30, V6_EV_90_40, V6_EV_90_60,
-	 V6_EV_90_70, V6_EV_90_80, V6_EV_90_D0, V6_EV_90_E0},
-
-	{V6_EV_A0_00, V6_EV_A0_01, V6_EV_A0_08, V6_EV_A0_10, V6_EV_A0_20,
-	 V6_EV_A0_21, V6_EV_A0_22, V6_EV_A0_30, V6_EV_A0_40, V6_EV_A0_60,
-	 V6_EV_A0_70, V6_EV_A0_80, V6_EV_A0_D0, V6_EV_A0_E0},
-
-	{V6_EV_B0_00, V6_EV_B0_01, V6_EV_B0_08, V6_EV_B0_10, V6_EV_B0_20,
-	 V6_EV_B0_21, V6_EV_B0_22, V6_EV_B0_30, V6_EV_B0_40, V6_EV_B0_60,
-	 V6_EV_B0_70, V6_EV_B0_80, V6_EV_B0_D0, V6_EV_B0_E0}
-};
-
 /**
  * get_message_id
  *
@@ -155,55 +40,14 @@ char *v6_event[NUM_SUBID][NUM_SUBTYPE] = {
  * RETURNS:	the message id for the dchrp.msg file
  *
  */
-char *
+static const char *
 get_message_id(int type, struct rtas_usr_hdr_scn *usrhdr)
 {
-	int i,j,k;
-	int supported_severity[NUM_SEVERITY] = { 0, 0x10, 0x20, 0x21, 0x22,
-	                                         0x23, 0x24, 0x40, 0x41, 0x44,
-	                                         0x45, 0x48, 0x60, 0x61};
-	int supported_subtype[NUM_SUBTYPE]   = { 0, 0x01, 0x08, 0x10, 0x20,
-	                                         0x21, 0x22, 0x30, 0x40, 0x60,
-	                                         0x70, 0x80, 0xD0, 0xE0};
-
-	/* Subsystem IDs start at 0x10 according to the PAPR.
-	   Anything below that is invalid */
-	if (usrhdr->subsystem_id < 0x10)
-		return (V6_INVALID_SUBID);
-
-	/* Subsystem IDs in the range 0xB0 to 0xFF are reserved */
-	if (usrhdr->subsystem_id > 0xAF)
-		return (V6_RESERVED_SUBID);
-
-	/* Use upper 4 bits for message index */
-	i = usrhdr->subsystem_id >> 4;
-
-	if (usrhdr->subsystem_id > 0x79)
-		i++;
-
-	/* Decrement subsystem ID index into message arrays
-	   (index 0 = message for subsystem ID 0x10 - 0x1F, etc) */
-	i--;
-
-	if (type == V6_ERROR_MSG) {
-		for (k = 0, j = -1; k < NUM_SEVERITY && j == -1; k++)
-			if (supported_severity[k] == usrhdr->event_severity)
-				j = k;
-		if (j == -1)
-			j = 0;
-
-		return (v6_error[i][j]);
-	}
-	else {
-		/* V6_EVENT_MSG */
-		for (k = 0, j = -1; k < NUM_SUBTYPE && j == -1; k++)
-			if (supported_subtype[k] == usrhdr->event_type)
-				j = k;
-		if (j == -1)
-			j = 0;
-
-		return (v6_event[i][j]);
-	}
+	if (type == V6_ERROR_MSG)
+		return v6_message(type, usrhdr->subsystem_id,
+				  usrhdr->event_severity);
+
+	return v6_message(type, usrhdr->subsystem_id, usrhdr->event_type);
 }
 
 /**
@@ -220,7 +64,7 @@ report_src(struct event *event, struct rtas_priv_hdr_scn *privhdr,
 	struct rtas_src_scn *src;
 	struct sl_data_rtas *rtas_data = event->sl_entry->addl_data;
 	int rc = 0;
-	char *msg;
+	const char *msg;
 
 	src = rtas_get_src_scn(event->rtas_event);
 	if (src == NULL) {
@@ -229,22 +73,19 @@ report_src(struct event *event, struct rtas_priv_hdr_scn *privhdr,
 		return 1;
 	}
 
-	event->sl_entry->refcode = malloc(strlen(src->primary_refcode)
-						  +1);
+	event->sl_entry->refcode = event_strdup(event, src->primary_refcode);
 	if (event->sl_entry->refcode == NULL) {
 		log_msg(event, "Memory allocation failed\n");
 		return 1;
 	}
-	strcpy(event->sl_entry->refcode, src->primary_refcode);
 
 	msg = get_message_id(V6_ERROR_MSG, usrhdr);
-	event->sl_entry->description = malloc(strlen(msg)+1);
+	event->sl_entry->description = event_strdup(event, msg);
 	if (event->sl_entry->description == NULL) {
-		free(event->sl_entry->refcode);
+		event->sl_entry->refcode = NULL;
 		log_msg(event, "Memory allocation failed\n");
 		return 1;
 	}
-	strcpy(event->sl_entry->description, msg);
 
 	rtas_data->addl_words[0] = src->ext_refcode2;
 	rtas_data->addl_words[1] = src->ext_refcode3;
@@ -319,7 +160,7 @@ report_menugoal(struct event *event, struct rtas_priv_hdr_scn *privhdr,
 		struct rtas_usr_hdr_scn *usrhdr)
 {
 	char buffer[MAX_MENUGOAL_SIZE], menu_num_str[20];
-	char *msg = NULL;
+	const char *msg = NULL;
 	int offset = 0;
 	uint menu_num = 0;
         long time_loc;
@@ -497,20 +338,18 @@ report_menugoal(struct event *event, struct rtas_priv_hdr_scn *privhdr,
 	event->sl_entry->call_home_status = SL_CALLHOME_NONE;
 
 	snprintf(menu_num_str, 20, "#%d", menu_num);
-	event->sl_entry->refcode = malloc(strlen(menu_num_str)+1);
+	event->sl_entry->refcode = event_strdup(event, menu_num_str);
 	if (event->sl_entry->refcode == NULL) {
 		log_msg(event, "Memory allocaion failed.\n");
 		return;
 	}
-	strcpy(event->sl_entry->refcode, menu_num_str);
 
-	event->sl_entry->description = malloc(strlen(msg)+1);
+	event->sl_entry->description = event_strdup(event, msg);
 	if (event->sl_entry->description == NULL) {
-		free(event->sl_entry->refcode);
+		event->sl_entry->refcode = NULL;
 		log_msg(event, "Memory allocaion failed.\n");
 		return;
 	}
-	strcpy(event->sl_entry->description, msg);
 
 	dbg("menugoal: number = %d, message = \"%s\"", menu_num, msg);
 
@@ -537,11 +376,11 @@ process_v6(struct event *event)
 	dbg("Processing version 6 event");
 
 	/* create and populate the servicelog entry */
-	event->sl_entry = calloc(1, sizeof(struct sl_event));
+	event->sl_entry = event_alloc(event, sizeof(struct sl_event));
 	if (event->sl_entry == NULL)
 		goto sl_entry;
 
-	rtas_data = calloc(1, sizeof(struct sl_data_rtas));
+	rtas_data = event_alloc(event, sizeof(struct sl_data_rtas));
 	if (rtas_data == NULL)
 		goto rtas_data;
 
@@ -555,19 +394,14 @@ process_v6(struct event *event)
 	mt = rtas_get_mt_scn(event->rtas_event);
 	if (mt != NULL) {
 		event->sl_entry->machine_model =
-				malloc(strlen(mt->mtms.model)+1);
-		if (event->sl_entry->machine_model)
-			strcpy(event->sl_entry->machine_model, mt->mtms.model);
-		else
-			goto machine_model;
+				event_strdup(event, mt->mtms.model);
+		if (event->sl_entry->machine_model == NULL)
+			goto rtas_data;
 
 		event->sl_entry->machine_serial =
-				malloc(strlen(mt->mtms.serial_no)+1);
-		if (event->sl_entry->machine_serial)
-			strcpy(event->sl_entry->machine_serial,
-			       mt->mtms.serial_no);
-		else
-			goto machine_serial;
+				event_strdup(event, mt->mtms.serial_no);
+		if (event->sl_entry->machine_serial == NULL)
+			goto rtas_data;
 	}
 
 	/*
@@ -592,9 +426,9 @@ process_v6(struct event *event)
 	}
 
 	event->sl_entry->raw_data_len = event->length;
-	event->sl_entry->raw_data = malloc(event->length);
+	event->sl_entry->raw_data = event_alloc(event, event->length);
 	if (event->sl_entry->raw_data == NULL)
-		goto raw_data;
+		goto rtas_data;
 	memcpy(event->sl_entry->raw_data, event->event_buf, event->length);
 
 	/* populate the "additional data" section of the servicelog entry */
@@ -613,7 +447,7 @@ process_v6(struct event *event)
 	if (usrhdr == NULL) {
 		log_msg(event, "No UH (user header) section in this v6 "
 			"RTAS event; strange, but not an error.");
-		goto raw_data;
+		goto rtas_data;
 	} else {
 		rtas_data->action_flags = usrhdr->action;
 		rtas_data->subsystem_id = usrhdr->subsystem_id;
@@ -637,16 +471,9 @@ process_v6(struct event *event)
 
 	return 0;
 
-raw_data:
-	if (event->sl_entry->machine_serial)
-		free(event->sl_entry->machine_serial);
-machine_serial:
-	if (event->sl_entry->machine_model)
-		free(event->sl_entry->machine_model);
-machine_model:
-	free(rtas_data);
 rtas_data:
-	free(event->sl_entry);
+	/* what was allocated goes with the event */
+	event->sl_entry = NULL;
 sl_entry:
 	log_msg(event, "Memory allocation failed\n");
 	return -1;
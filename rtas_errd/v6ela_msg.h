@@ -0,0 +1,133 @@
+/**
+ * @file v6ela_msg.h
+ * @brief Lookup tables for the v6 ELA messages
+ *
+ * The supported subsystem ids, error severities and event subtypes are
+ * listed once below; the message tables and the maps from an error
+ * severity or event subtype to its column are generated from those
+ * lists, so a message lookup is two array indexes rather than a search.
+ * Severities and subtypes that have no column of their own use the
+ * first one (0x00).
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _H_V6ELA_MSG
+#define _H_V6ELA_MSG
+
+#include "ela_msg.h"
+
+#define V6_ERROR_MSG	0
+#define V6_EVENT_MSG	1
+
+/*
+ * Subsystem ids with messages, one per table row.  Ids 0x10 - 0x79
+ * use the row of their upper 4 bits, 0x7A - 0x7F have a row of their
+ * own, and 0xB0 - 0xFF are reserved.
+ */
+#define V6_SUBID_LIST(X) \
+	X(10) X(20) X(30) X(40) X(50) X(60) X(70) X(7A) X(80) X(90) \
+	X(A0) X(B0)
+
+/* Error severities with messages, V6_ER_ss_vv */
+#define V6_SEVERITY_LIST(X, ss) \
+	X(ss, 00) X(ss, 10) X(ss, 20) X(ss, 21) X(ss, 22) X(ss, 23) \
+	X(ss, 24) X(ss, 40) X(ss, 41) X(ss, 44) X(ss, 45) X(ss, 48) \
+	X(ss, 60) X(ss, 61)
+
+/* Event subtypes with messages, V6_EV_ss_tt */
+#define V6_SUBTYPE_LIST(X, ss) \
+	X(ss, 00) X(ss, 01) X(ss, 08) X(ss, 10) X(ss, 20) X(ss, 21) \
+	X(ss, 22) X(ss, 30) X(ss, 40) X(ss, 60) X(ss, 70) X(ss, 80) \
+	X(ss, D0) X(ss, E0)
+
+#define V6_ROW_ENUM(ss)		V6_ROW_##ss,
+#define V6_SEV_ENUM(ss, vv)	V6_SEV_##vv,
+#define V6_SUB_ENUM(ss, tt)	V6_SUB_##tt,
+
+enum { V6_SUBID_LIST(V6_ROW_ENUM) NUM_SUBID };
+enum { V6_SEVERITY_LIST(V6_SEV_ENUM, -) NUM_SEVERITY };
+enum { V6_SUBTYPE_LIST(V6_SUB_ENUM, -) NUM_SUBTYPE };
+
+#define V6_SEV_COLUMN(ss, vv)	[0x##vv] = V6_SEV_##vv,
+#define V6_SUB_COLUMN(ss, tt)	[0x##tt] = V6_SUB_##tt,
+
+/* Column of the v6_error table for each error severity */
+static const unsigned char v6_severity_column[256] = {
+	V6_SEVERITY_LIST(V6_SEV_COLUMN, -)
+};
+
+/* Column of the v6_event table for each event subtype */
+static const unsigned char v6_subtype_column[256] = {
+	V6_SUBTYPE_LIST(V6_SUB_COLUMN, -)
+};
+
+#define V6_ER_MSG(ss, vv)	V6_ER_##ss##_##vv,
+#define V6_EV_MSG(ss, tt)	V6_EV_##ss##_##tt,
+#define V6_ER_ROW(ss)		{ V6_SEVERITY_LIST(V6_ER_MSG, ss) },
+#define V6_EV_ROW(ss)		{ V6_SUBTYPE_LIST(V6_EV_MSG, ss) },
+
+/*
+ * Table of V6 Error Messages. Each message, V6_ER_ss_vv,  is addressable
+ * by the Subsystem Id ("ss") and the Error Severity ("vv").
+ */
+static const char * const v6_error[NUM_SUBID][NUM_SEVERITY] = {
+	V6_SUBID_LIST(V6_ER_ROW)
+};
+
+/*
+ * Table of V6 Event Messages. Each message, V6_EV_ss_tt,  is addressable
+ * by the Subsystem Id ("ss") and the Event Subtype ("tt").
+ */
+static const char * const v6_event[NUM_SUBID][NUM_SUBTYPE] = {
+	V6_SUBID_LIST(V6_EV_ROW)
+};
+
+/**
+ * v6_message
+ * @brief Look up the message for a subsystem id and severity or subtype
+ *
+ * @param type V6_ERROR_MSG or V6_EVENT_MSG
+ * @param subid subsystem id
+ * @param code error severity for V6_ERROR_MSG, event subtype otherwise
+ * @return the message
+ */
+static inline const char *
+v6_message(int type, unsigned int subid, unsigned int code)
+{
+	int row;
+
+	/* Subsystem IDs start at 0x10 according to the PAPR.
+	   Anything below that is invalid */
+	if (subid < 0x10)
+		return V6_INVALID_SUBID;
+
+	/* Subsystem IDs in the range 0xB0 to 0xFF are reserved */
+	if (subid > 0xAF)
+		return V6_RESERVED_SUBID;
+
+	/* Use upper 4 bits for the row, with 0x7A - 0x7F in a row of
+	   their own (row 0 = messages for subsystem ID 0x10 - 0x1F) */
+	row = (subid >> 4) + (subid > 0x79) - 1;
+
+	if (type == V6_ERROR_MSG)
+		return v6_error[row][code < 256 ? v6_severity_column[code] : 0];
+
+	return v6_event[row][code < 256 ? v6_subtype_column[code] : 0];
+}
+
+#endif /* _H_V6ELA_MSG */